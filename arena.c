@@ -0,0 +1,177 @@
+#include "arena.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+arena_t g_line_arena = {.name = "line"};
+arena_t g_expand_arena = {.name = "expand"};
+
+/*
+ *  Make room for size bytes, reusing a spare chunk if one is big
+ *  enough and allocating a new chunk otherwise
+ */
+
+static void add_chunk(arena_t *arena, size_t size) {
+  arena_chunk_t *chunk = NULL;
+
+  if ((arena->spare != NULL) && (arena->spare->size >= size)) {
+    chunk = arena->spare;
+    arena->spare = chunk->next;
+  } else {
+    size_t chunk_size = (size > ARENA_CHUNK_SIZE) ? size : ARENA_CHUNK_SIZE;
+
+    chunk = (arena_chunk_t *)malloc(sizeof(arena_chunk_t) + chunk_size);
+
+    if (chunk == NULL) {
+      perror("malloc");
+      exit(1);
+    }
+
+    chunk->size = chunk_size;
+    arena->num_chunk_mallocs++;
+  }
+
+  chunk->used = 0;
+  chunk->next = arena->chunks;
+  arena->chunks = chunk;
+} /* add_chunk() */
+
+/*
+ *  Allocate size bytes from the arena, aligned for any type
+ */
+
+void *arena_alloc(arena_t *arena, size_t size) {
+  size_t align = _Alignof(max_align_t);
+  size = (size + align - 1) & ~(align - 1);
+
+  if ((arena->chunks == NULL) ||
+      (arena->chunks->size - arena->chunks->used < size)) {
+    add_chunk(arena, size);
+  }
+
+  void *memory = arena->chunks->data + arena->chunks->used;
+  arena->chunks->used += size;
+
+  arena->num_allocs++;
+  arena->num_bytes += size;
+
+  return memory;
+} /* arena_alloc() */
+
+/*
+ *  Copy at most length bytes of string into the arena
+ */
+
+char *arena_strndup(arena_t *arena, const char *string, size_t length) {
+  const char *end = memchr(string, '\0', length);
+
+  if (end != NULL) {
+    length = end - string;
+  }
+
+  char *copy = (char *)arena_alloc(arena, length + 1);
+
+  memcpy(copy, string, length);
+  copy[length] = '\0';
+
+  return copy;
+} /* arena_strndup() */
+
+/*
+ *  Copy a string into the arena
+ */
+
+char *arena_strdup(arena_t *arena, const char *string) {
+  return arena_strndup(arena, string, SIZE_MAX);
+} /* arena_strdup() */
+
+/*
+ *  Remember the current end of the arena
+ */
+
+arena_mark_t arena_mark(arena_t *arena) {
+  arena_mark_t mark = {arena->chunks, 0};
+
+  if (arena->chunks != NULL) {
+    mark.used = arena->chunks->used;
+  }
+
+  return mark;
+} /* arena_mark() */
+
+/*
+ *  Free everything allocated since mark was taken. Chunks that become
+ *  empty are kept as spares.
+ */
+
+void arena_release(arena_t *arena, arena_mark_t mark) {
+  while ((arena->chunks != NULL) && (arena->chunks != mark.chunk)) {
+    arena_chunk_t *chunk = arena->chunks;
+
+    arena->chunks = chunk->next;
+    chunk->next = arena->spare;
+    arena->spare = chunk;
+  }
+
+  if (arena->chunks != NULL) {
+    arena->chunks->used = mark.used;
+  }
+
+  arena->num_releases++;
+} /* arena_release() */
+
+/*
+ *  Free every chunk of an arena, for an arena that is not used again
+ */
+
+void arena_free(arena_t *arena) {
+  arena_chunk_t *lists[] = {arena->chunks, arena->spare};
+
+  for (int i = 0; i < 2; i++) {
+    while (lists[i] != NULL) {
+      arena_chunk_t *chunk = lists[i];
+
+      lists[i] = chunk->next;
+      free(chunk);
+    }
+  }
+
+  arena->chunks = NULL;
+  arena->spare = NULL;
+} /* arena_free() */
+
+/*
+ *  Print the counters of an arena
+ */
+
+void print_arena_stats(arena_t *arena) {
+  size_t in_use = 0;
+  size_t reserved = 0;
+
+  for (arena_chunk_t *chunk = arena->chunks; chunk != NULL;
+       chunk = chunk->next) {
+    in_use += chunk->used;
+    reserved += chunk->size;
+  }
+
+  for (arena_chunk_t *chunk = arena->spare; chunk != NULL;
+       chunk = chunk->next) {
+    reserved += chunk->size;
+  }
+
+  printf("arena %-8s allocs %lu bytes %lu chunk mallocs %lu releases %lu "
+         "in use %zu reserved %zu\n",
+         arena->name, arena->num_allocs, arena->num_bytes,
+         arena->num_chunk_mallocs, arena->num_releases, in_use, reserved);
+} /* print_arena_stats() */
+
+/*
+ *  Print the counters of a struct pool
+ */
+
+void print_pool_stats(pool_stats_t *pool) {
+  printf("pool  %-8s reused %lu malloced %lu\n", pool->name, pool->num_reused,
+         pool->num_malloced);
+} /* print_pool_stats() */
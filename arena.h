@@ -0,0 +1,72 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// Bump Arena Allocator
+//
+// Allocations are carved out of large chunks and never freed one by
+// one. A mark records the current position and releasing it frees
+// everything allocated since in one step. Released chunks are kept
+// and reused, so a loop that marks and releases stops calling malloc
+// once its chunks are allocated.
+
+#define ARENA_CHUNK_SIZE (64 * 1024)
+
+typedef struct arena_chunk {
+  struct arena_chunk *next;
+  size_t size;
+  size_t used;
+  char data[];
+} arena_chunk_t;
+
+typedef struct arena {
+  const char *name;
+
+  // Chunk being allocated from, older chunks follow through next
+
+  arena_chunk_t *chunks;
+
+  // Released chunks waiting to be reused
+
+  arena_chunk_t *spare;
+
+  // Counters reported by the stats builtin
+
+  unsigned long num_allocs;
+  unsigned long num_bytes;
+  unsigned long num_chunk_mallocs;
+  unsigned long num_releases;
+} arena_t;
+
+typedef struct arena_mark {
+  arena_chunk_t *chunk;
+  size_t used;
+} arena_mark_t;
+
+// Counters of a pool of freed structs kept for reuse
+
+typedef struct pool_stats {
+  const char *name;
+  unsigned long num_reused;
+  unsigned long num_malloced;
+} pool_stats_t;
+
+void *arena_alloc(arena_t *arena, size_t size);
+char *arena_strdup(arena_t *arena, const char *string);
+char *arena_strndup(arena_t *arena, const char *string, size_t length);
+arena_mark_t arena_mark(arena_t *arena);
+void arena_release(arena_t *arena, arena_mark_t mark);
+void arena_free(arena_t *arena);
+void print_arena_stats(arena_t *arena);
+void print_pool_stats(pool_stats_t *pool);
+
+// Words and file names of the command line being parsed
+
+extern arena_t g_line_arena;
+
+// Expanded words and expansion scratch space of the command running
+
+extern arena_t g_expand_arena;
+
+#endif // ARENA_H
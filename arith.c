@@ -0,0 +1,634 @@
+#include "arith.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "vars.h"
+
+// Longest variable name accepted in an expression
+
+#define MAX_ARITH_NAME (256)
+
+// How deep variables whose values are expressions are evaluated
+
+#define MAX_ARITH_DEPTH (32)
+
+// Arithmetic expressions for $(( )) and let.
+//
+// A precedence climbing parser that evaluates while it parses, on
+// 64-bit signed integers. Variables are read from and written to the
+// shell's variable store directly, so a counter loop never leaves the
+// shell.
+
+typedef struct arith_parser {
+  const char *pos;
+  bool error;
+
+  // Greater than zero while parsing the side of &&, || or ?: that is
+  // not taken. Nothing is assigned and division by zero is ignored.
+
+  int no_eval;
+  int depth;
+} arith_parser_t;
+
+typedef enum arith_op {
+  OP_OR,
+  OP_AND,
+  OP_BIT_OR,
+  OP_BIT_XOR,
+  OP_BIT_AND,
+  OP_EQ,
+  OP_NE,
+  OP_LT,
+  OP_LE,
+  OP_GT,
+  OP_GE,
+  OP_SHL,
+  OP_SHR,
+  OP_ADD,
+  OP_SUB,
+  OP_MUL,
+  OP_DIV,
+  OP_MOD,
+  OP_POW,
+} arith_op_t;
+
+// Binary operators, longer ones first so "<<" is not read as "<"
+
+static const struct {
+  const char *text;
+  arith_op_t op;
+  int precedence;
+} g_binary_ops[] = {
+    {"**", OP_POW, 11},    {"<<", OP_SHL, 8},     {">>", OP_SHR, 8},
+    {"<=", OP_LE, 7},      {">=", OP_GE, 7},      {"==", OP_EQ, 6},
+    {"!=", OP_NE, 6},      {"&&", OP_AND, 2},     {"||", OP_OR, 1},
+    {"<", OP_LT, 7},       {">", OP_GT, 7},       {"&", OP_BIT_AND, 5},
+    {"^", OP_BIT_XOR, 4},  {"|", OP_BIT_OR, 3},   {"+", OP_ADD, 9},
+    {"-", OP_SUB, 9},      {"*", OP_MUL, 10},     {"/", OP_DIV, 10},
+    {"%", OP_MOD, 10},
+};
+
+// Assignment operators and the binary operator they apply
+
+static const struct {
+  const char *text;
+  arith_op_t op;
+} g_assign_ops[] = {
+    {"<<=", OP_SHL}, {">>=", OP_SHR}, {"+=", OP_ADD},     {"-=", OP_SUB},
+    {"*=", OP_MUL},  {"/=", OP_DIV},  {"%=", OP_MOD},     {"&=", OP_BIT_AND},
+    {"^=", OP_BIT_XOR}, {"|=", OP_BIT_OR},
+};
+
+static long long parse_comma(arith_parser_t *p);
+static long long parse_assignment(arith_parser_t *p);
+static long long parse_ternary(arith_parser_t *p);
+
+/*
+ *  Report the first error found in an expression
+ */
+
+static void arith_error(arith_parser_t *p, const char *message) {
+  if (!p->error) {
+    fprintf(stderr, "arithmetic: %s\n", message);
+    p->error = true;
+  }
+} /* arith_error() */
+
+/*
+ *  Skip white space in the expression
+ */
+
+static void skip_spaces(arith_parser_t *p) {
+  while (isspace((unsigned char)*p->pos)) {
+    p->pos++;
+  }
+} /* skip_spaces() */
+
+/*
+ *  Length of the variable name at s, 0 if there is none
+ */
+
+static int name_length(const char *s) {
+  if ((!isalpha((unsigned char)s[0])) && (s[0] != '_')) {
+    return 0;
+  }
+
+  int len = 1;
+
+  while ((isalnum((unsigned char)s[len])) || (s[len] == '_')) {
+    len++;
+  }
+
+  return len;
+} /* name_length() */
+
+/*
+ *  Copy a variable name out of the expression into name
+ */
+
+static bool copy_name(arith_parser_t *p, const char *start, int len,
+                      char *name) {
+  if (len >= MAX_ARITH_NAME) {
+    arith_error(p, "variable name too long");
+    return false;
+  }
+
+  memcpy(name, start, len);
+  name[len] = '\0';
+
+  return true;
+} /* copy_name() */
+
+/*
+ *  Value of a variable. Unset and empty variables are 0, a value that
+ *  is not a number is evaluated as an expression itself.
+ */
+
+static long long get_number(arith_parser_t *p, const char *start, int len) {
+  char name[MAX_ARITH_NAME];
+
+  if (!copy_name(p, start, len, name)) {
+    return 0;
+  }
+
+  char *value = get_variable(name);
+
+  if ((value == NULL) || (value[0] == '\0')) {
+    return 0;
+  }
+
+  char *end = NULL;
+  long long number = strtoll(value, &end, 0);
+
+  while (isspace((unsigned char)*end)) {
+    end++;
+  }
+
+  if (*end == '\0') {
+    return number;
+  }
+
+  if (p->depth >= MAX_ARITH_DEPTH) {
+    arith_error(p, "expression recursion level exceeded");
+    return 0;
+  }
+
+  arith_parser_t sub = {value, false, p->no_eval, p->depth + 1};
+  number = parse_comma(&sub);
+  skip_spaces(&sub);
+
+  if ((!sub.error) && (*sub.pos != '\0')) {
+    arith_error(&sub, "syntax error in expression");
+  }
+
+  if (sub.error) {
+    p->error = true;
+  }
+
+  return number;
+} /* get_number() */
+
+/*
+ *  Assign a value to a variable, unless in a branch not taken
+ */
+
+static void set_number(arith_parser_t *p, const char *start, int len,
+                       long long value) {
+  if (p->no_eval > 0) {
+    return;
+  }
+
+  char name[MAX_ARITH_NAME];
+
+  if (!copy_name(p, start, len, name)) {
+    return;
+  }
+
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "%lld", value);
+
+  set_variable(name, buffer, false);
+} /* set_number() */
+
+/*
+ *  Apply a binary operator. Wraps around on overflow instead of
+ *  relying on undefined signed overflow.
+ */
+
+static long long apply_operator(arith_parser_t *p, arith_op_t op,
+                                long long lhs, long long rhs) {
+  unsigned long long ulhs = (unsigned long long)lhs;
+  unsigned long long urhs = (unsigned long long)rhs;
+
+  switch (op) {
+  case OP_OR:
+    return lhs || rhs;
+  case OP_AND:
+    return lhs && rhs;
+  case OP_BIT_OR:
+    return lhs | rhs;
+  case OP_BIT_XOR:
+    return lhs ^ rhs;
+  case OP_BIT_AND:
+    return lhs & rhs;
+  case OP_EQ:
+    return lhs == rhs;
+  case OP_NE:
+    return lhs != rhs;
+  case OP_LT:
+    return lhs < rhs;
+  case OP_LE:
+    return lhs <= rhs;
+  case OP_GT:
+    return lhs > rhs;
+  case OP_GE:
+    return lhs >= rhs;
+  case OP_SHL:
+    return (long long)(ulhs << (rhs & 63));
+  case OP_SHR:
+    return lhs >> (rhs & 63);
+  case OP_ADD:
+    return (long long)(ulhs + urhs);
+  case OP_SUB:
+    return (long long)(ulhs - urhs);
+  case OP_MUL:
+    return (long long)(ulhs * urhs);
+  case OP_DIV:
+  case OP_MOD:
+    if (rhs == 0) {
+      if (p->no_eval == 0) {
+        arith_error(p, "division by 0");
+      }
+      return 0;
+    }
+
+    if (rhs == -1) {
+      return (op == OP_DIV) ? (long long)(0 - ulhs) : 0;
+    }
+
+    return (op == OP_DIV) ? (lhs / rhs) : (lhs % rhs);
+  case OP_POW: {
+    if (rhs < 0) {
+      arith_error(p, "exponent less than 0");
+      return 0;
+    }
+
+    unsigned long long power = 1;
+
+    while (urhs > 0) {
+      if (urhs & 1) {
+        power *= ulhs;
+      }
+      ulhs *= ulhs;
+      urhs >>= 1;
+    }
+
+    return (long long)power;
+  }
+  }
+
+  return 0;
+} /* apply_operator() */
+
+/*
+ *  Numbers, variables with post increment/decrement and parentheses
+ */
+
+static long long parse_primary(arith_parser_t *p) {
+  skip_spaces(p);
+
+  if (*p->pos == '(') {
+    p->pos++;
+
+    long long value = parse_comma(p);
+    skip_spaces(p);
+
+    if (*p->pos != ')') {
+      arith_error(p, "missing `)'");
+      return 0;
+    }
+
+    p->pos++;
+    return value;
+  }
+
+  if (isdigit((unsigned char)*p->pos)) {
+    char *end = NULL;
+    long long value = strtoll(p->pos, &end, 0);
+
+    if ((isalnum((unsigned char)*end)) || (*end == '_')) {
+      arith_error(p, "value too great for base");
+      return 0;
+    }
+
+    p->pos = end;
+    return value;
+  }
+
+  int len = name_length(p->pos);
+
+  if (len > 0) {
+    const char *name = p->pos;
+    long long value = get_number(p, name, len);
+
+    p->pos += len;
+    skip_spaces(p);
+
+    if (((p->pos[0] == '+') || (p->pos[0] == '-')) &&
+        (p->pos[1] == p->pos[0])) {
+      long long step = (p->pos[0] == '+') ? 1 : -1;
+
+      p->pos += 2;
+      set_number(p, name, len, apply_operator(p, OP_ADD, value, step));
+    }
+
+    return value;
+  }
+
+  if (*p->pos == '\0') {
+    arith_error(p, "operand expected");
+  } else {
+    arith_error(p, "syntax error: operand expected");
+  }
+
+  return 0;
+} /* parse_primary() */
+
+/*
+ *  Unary operators and pre increment/decrement
+ */
+
+static long long parse_unary(arith_parser_t *p) {
+  skip_spaces(p);
+
+  if (((p->pos[0] == '+') || (p->pos[0] == '-')) &&
+      (p->pos[1] == p->pos[0])) {
+    const char *after = p->pos + 2;
+
+    while (isspace((unsigned char)*after)) {
+      after++;
+    }
+
+    int len = name_length(after);
+
+    if (len > 0) {
+      long long step = (p->pos[0] == '+') ? 1 : -1;
+      long long value =
+          apply_operator(p, OP_ADD, get_number(p, after, len), step);
+
+      set_number(p, after, len, value);
+      p->pos = after + len;
+
+      return value;
+    }
+  }
+
+  switch (*p->pos) {
+  case '-':
+    p->pos++;
+    return (long long)(0 - (unsigned long long)parse_unary(p));
+  case '+':
+    p->pos++;
+    return parse_unary(p);
+  case '!':
+    p->pos++;
+    return !parse_unary(p);
+  case '~':
+    p->pos++;
+    return ~parse_unary(p);
+  }
+
+  return parse_primary(p);
+} /* parse_unary() */
+
+/*
+ *  Find the binary operator at the current position, -1 if none.
+ *  An operator followed by = is an assignment and is not matched.
+ */
+
+static int peek_binary_operator(arith_parser_t *p) {
+  skip_spaces(p);
+
+  for (size_t i = 0; i < sizeof(g_binary_ops) / sizeof(g_binary_ops[0]);
+       i++) {
+    size_t len = strlen(g_binary_ops[i].text);
+
+    if (strncmp(p->pos, g_binary_ops[i].text, len) != 0) {
+      continue;
+    }
+
+    arith_op_t op = g_binary_ops[i].op;
+    bool comparison =
+        (op == OP_LE) || (op == OP_GE) || (op == OP_EQ) || (op == OP_NE);
+
+    if ((p->pos[len] == '=') && (!comparison)) {
+      return -1;
+    }
+
+    return (int)i;
+  }
+
+  return -1;
+} /* peek_binary_operator() */
+
+/*
+ *  Binary operators by precedence climbing
+ */
+
+static long long parse_binary(arith_parser_t *p, int min_precedence) {
+  long long lhs = parse_unary(p);
+
+  while (!p->error) {
+    int index = peek_binary_operator(p);
+
+    if ((index == -1) || (g_binary_ops[index].precedence < min_precedence)) {
+      break;
+    }
+
+    arith_op_t op = g_binary_ops[index].op;
+    int precedence = g_binary_ops[index].precedence;
+
+    p->pos += strlen(g_binary_ops[index].text);
+
+    // ** is right associative, everything else left
+
+    int next_precedence = (op == OP_POW) ? precedence : precedence + 1;
+
+    if ((op == OP_AND) || (op == OP_OR)) {
+      bool skip_rhs = (op == OP_AND) ? (lhs == 0) : (lhs != 0);
+
+      if (skip_rhs) {
+        p->no_eval++;
+      }
+
+      long long rhs = parse_binary(p, next_precedence);
+
+      if (skip_rhs) {
+        p->no_eval--;
+      }
+
+      lhs = apply_operator(p, op, lhs, rhs);
+      continue;
+    }
+
+    long long rhs = parse_binary(p, next_precedence);
+    lhs = apply_operator(p, op, lhs, rhs);
+  }
+
+  return lhs;
+} /* parse_binary() */
+
+/*
+ *  The conditional operator cond ? a : b
+ */
+
+static long long parse_ternary(arith_parser_t *p) {
+  long long condition = parse_binary(p, 1);
+
+  skip_spaces(p);
+
+  if ((p->error) || (*p->pos != '?')) {
+    return condition;
+  }
+
+  p->pos++;
+
+  if (!condition) {
+    p->no_eval++;
+  }
+
+  long long if_true = parse_assignment(p);
+
+  if (!condition) {
+    p->no_eval--;
+  }
+
+  skip_spaces(p);
+
+  if (*p->pos != ':') {
+    arith_error(p, "`:' expected for conditional expression");
+    return 0;
+  }
+
+  p->pos++;
+
+  if (condition) {
+    p->no_eval++;
+  }
+
+  long long if_false = parse_ternary(p);
+
+  if (condition) {
+    p->no_eval--;
+  }
+
+  return condition ? if_true : if_false;
+} /* parse_ternary() */
+
+/*
+ *  Assignments, name = expression and name op= expression
+ */
+
+static long long parse_assignment(arith_parser_t *p) {
+  skip_spaces(p);
+
+  int len = name_length(p->pos);
+
+  if (len > 0) {
+    const char *name = p->pos;
+    const char *after = p->pos + len;
+
+    while (isspace((unsigned char)*after)) {
+      after++;
+    }
+
+    int op_index = -1;
+    size_t op_len = 0;
+
+    if ((after[0] == '=') && (after[1] != '=')) {
+      op_len = 1;
+    } else {
+      for (size_t i = 0; i < sizeof(g_assign_ops) / sizeof(g_assign_ops[0]);
+           i++) {
+        size_t text_len = strlen(g_assign_ops[i].text);
+
+        if (strncmp(after, g_assign_ops[i].text, text_len) == 0) {
+          op_index = (int)i;
+          op_len = text_len;
+          break;
+        }
+      }
+    }
+
+    if (op_len > 0) {
+      p->pos = after + op_len;
+
+      long long value = parse_assignment(p);
+
+      if (op_index != -1) {
+        value = apply_operator(p, g_assign_ops[op_index].op,
+                               get_number(p, name, len), value);
+      }
+
+      if (!p->error) {
+        set_number(p, name, len, value);
+      }
+
+      return value;
+    }
+  }
+
+  return parse_ternary(p);
+} /* parse_assignment() */
+
+/*
+ *  Comma separated expressions, the value is the last one
+ */
+
+static long long parse_comma(arith_parser_t *p) {
+  long long value = parse_assignment(p);
+
+  skip_spaces(p);
+
+  while ((!p->error) && (*p->pos == ',')) {
+    p->pos++;
+    value = parse_assignment(p);
+    skip_spaces(p);
+  }
+
+  return value;
+} /* parse_comma() */
+
+/*
+ *  Evaluate an arithmetic expression. Prints a message and returns
+ *  false if the expression is not valid. An empty expression is 0.
+ */
+
+bool evaluate_arithmetic(const char *expression, long long *result) {
+  arith_parser_t p = {expression, false, 0, 0};
+
+  skip_spaces(&p);
+
+  if (*p.pos == '\0') {
+    *result = 0;
+    return true;
+  }
+
+  long long value = parse_comma(&p);
+
+  skip_spaces(&p);
+
+  if ((!p.error) && (*p.pos != '\0')) {
+    arith_error(&p, "syntax error in expression");
+  }
+
+  if (p.error) {
+    return false;
+  }
+
+  *result = value;
+  return true;
+} /* evaluate_arithmetic() */
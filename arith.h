@@ -0,0 +1,8 @@
+#ifndef ARITH_H
+#define ARITH_H
+
+#include <stdbool.h>
+
+bool evaluate_arithmetic(const char *expression, long long *result);
+
+#endif // ARITH_H
@@ -0,0 +1,252 @@
+#include "batch.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "shell.h"
+#include "vars.h"
+
+/*
+ *  Bytes an argument or environment string takes up for exec
+ */
+
+static size_t exec_size(const char *string) {
+  return strlen(string) + 1 + sizeof(char *);
+} /* exec_size() */
+
+/*
+ *  Parse the options of batch, sets first to the index of the command
+ *  to run. Returns false on a bad option.
+ */
+
+static bool parse_batch_options(char **argv, int argc, int *first, int *jobs,
+                                int *max_items) {
+  int i = 1;
+
+  while ((i < argc) && (argv[i][0] == '-')) {
+    if (!strcmp(argv[i], "--")) {
+      i++;
+      break;
+    }
+
+    if (((strcmp(argv[i], "-j")) && (strcmp(argv[i], "-n"))) ||
+        (i + 1 >= argc)) {
+      fprintf(stderr, "batch: usage: batch [-j jobs] [-n items] command\n");
+      return false;
+    }
+
+    int value = atoi(argv[i + 1]);
+
+    if (argv[i][1] == 'j') {
+      *jobs = (value > 0) ? value : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    } else {
+      *max_items = (value > 0) ? value : 0;
+    }
+
+    i += 2;
+  }
+
+  if (i >= argc) {
+    fprintf(stderr, "batch: command expected\n");
+    return false;
+  }
+
+  *first = i;
+  return true;
+} /* parse_batch_options() */
+
+/*
+ *  Wait for one batch, returns its exit status
+ */
+
+static int wait_batch() {
+  int wait_status = 0;
+
+  while (wait(&wait_status) == -1) {
+    if (errno != EINTR) {
+      perror("wait");
+      exit(1);
+    }
+  }
+
+  if (WIFEXITED(wait_status)) {
+    return WEXITSTATUS(wait_status);
+  }
+
+  return 128 + WTERMSIG(wait_status);
+} /* wait_batch() */
+
+/*
+ *  Run argv with the items between items_start and items_end split
+ *  into batches that fit in budget bytes, at most jobs at a time.
+ *  Returns the highest exit status of the batches.
+ */
+
+static int run_batches(char **argv, int argc, int items_start, int items_end,
+                       int jobs, int max_items, size_t budget) {
+  size_t fixed_size = 0;
+
+  for (int i = 0; i < items_start; i++) {
+    fixed_size += exec_size(argv[i]);
+  }
+
+  for (int i = items_end; i < argc; i++) {
+    fixed_size += exec_size(argv[i]);
+  }
+
+  char **batch_argv = (char **)malloc((argc + 1) * sizeof(char *));
+
+  if (batch_argv == NULL) {
+    perror("malloc");
+    exit(1);
+  }
+
+  memcpy(batch_argv, argv, items_start * sizeof(char *));
+
+  int worst_status = 0;
+  int running = 0;
+  int next = items_start;
+
+  while (next < items_end) {
+    // always take one item, even if it does not fit by itself
+
+    size_t size = fixed_size + exec_size(argv[next]);
+    int count = 1;
+
+    while ((next + count < items_end) &&
+           ((max_items == 0) || (count < max_items)) &&
+           (size + exec_size(argv[next + count]) <= budget)) {
+      size += exec_size(argv[next + count]);
+      count++;
+    }
+
+    memcpy(batch_argv + items_start, argv + next, count * sizeof(char *));
+    memcpy(batch_argv + items_start + count, argv + items_end,
+           (argc - items_end) * sizeof(char *));
+    batch_argv[items_start + count + argc - items_end] = NULL;
+
+    next += count;
+
+    if (running == jobs) {
+      int status = wait_batch();
+      worst_status = (status > worst_status) ? status : worst_status;
+      running--;
+    }
+
+    int ret = fork();
+
+    if (ret == -1) {
+      perror("fork");
+      exit(1);
+    }
+
+    if (ret == 0) {
+      execvp(batch_argv[0], batch_argv);
+      perror("execvp");
+      exit(127);
+    }
+
+    running++;
+  }
+
+  while (running > 0) {
+    int status = wait_batch();
+    worst_status = (status > worst_status) ? status : worst_status;
+    running--;
+  }
+
+  free(batch_argv);
+
+  return worst_status;
+} /* run_batches() */
+
+/*
+ *  Replace the process with a single command, running it in batches
+ *  if that was asked for and its arguments are too long for exec.
+ *  Never returns.
+ */
+
+void exec_single_command(single_command_t *simp, char **envp) {
+  char **argv = simp->arguments;
+  int argc = simp->num_args;
+  int first = 0;
+  int jobs = 0;
+  int max_items = 0;
+
+  if (!strcmp(argv[0], "batch")) {
+    jobs = 1;
+
+    if (!parse_batch_options(argv, argc, &first, &jobs, &max_items)) {
+      exit(2);
+    }
+  } else {
+    char *autobatch = get_variable("AUTOBATCH");
+
+    if ((autobatch != NULL) && (autobatch[0] != '\0') &&
+        (strcmp(autobatch, "0"))) {
+      jobs = (atoi(autobatch) > 0) ? atoi(autobatch) : 1;
+    }
+  }
+
+  environ = envp;
+  argv += first;
+  argc -= first;
+
+  if (jobs > 0) {
+    size_t env_size = 0;
+    size_t arg_size = 0;
+
+    for (int i = 0; envp[i] != NULL; i++) {
+      env_size += exec_size(envp[i]);
+    }
+
+    for (int i = 0; i < argc; i++) {
+      arg_size += exec_size(argv[i]);
+    }
+
+    long arg_max = sysconf(_SC_ARG_MAX);
+    size_t budget = BATCH_HEADROOM;
+
+    if ((arg_max > 0) && ((size_t)arg_max > env_size + 2 * BATCH_HEADROOM)) {
+      budget = arg_max - env_size - BATCH_HEADROOM;
+    }
+
+    if ((arg_size > budget) || (max_items > 0)) {
+      // split the wildcard matches, or every argument after the
+      // command name if there were none, or other arguments came
+      // between the matches of two wildcards
+
+      int items_start = 1;
+      int items_end = argc;
+
+      if ((simp->num_glob_ranges == 1) && (simp->glob_start >= first + 1)) {
+        items_start = simp->glob_start - first;
+        items_end = simp->glob_end - first;
+      }
+
+      // the batches are waited for here, not by child_collector()
+
+      signal(SIGCHLD, SIG_DFL);
+
+      exit(run_batches(argv, argc, items_start, items_end, jobs, max_items,
+                       budget));
+    }
+  }
+
+  execvp(argv[0], argv);
+
+  if (errno == E2BIG) {
+    fprintf(stderr, "%s: argument list too long, run it with batch\n",
+            argv[0]);
+  } else {
+    perror("execvp");
+  }
+
+  exit(1);
+} /* exec_single_command() */
@@ -0,0 +1,20 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "single_command.h"
+
+// Argument List Batching
+//
+// A command run as "batch [-j jobs] [-n items] command args", or any
+// command while AUTOBATCH is set, is split like xargs when its
+// arguments and environment do not fit in ARG_MAX. The arguments
+// expanded from wildcards are spread over several runs of the
+// command, keeping the words before and after them in every run.
+
+// Bytes of ARG_MAX left unused as a safety margin
+
+#define BATCH_HEADROOM (4096)
+
+void exec_single_command(single_command_t *simp, char **envp);
+
+#endif // BATCH_H
@@ -0,0 +1,425 @@
+#include "brace.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ *  Index of the '}' closing the brace at open, -1 if it is not closed
+ */
+
+static int closing_brace(const char *word, int open) {
+  int depth = 0;
+
+  for (int i = open; word[i] != '\0'; i++) {
+    if ((word[i] == '\\') && (word[i + 1] != '\0')) {
+      i++;
+    } else if (word[i] == '{') {
+      depth++;
+    } else if ((word[i] == '}') && (--depth == 0)) {
+      return i;
+    }
+  }
+
+  return -1;
+} /* closing_brace() */
+
+/*
+ *  Parse a decimal range end, returning false if text is not one
+ */
+
+static bool parse_number(const char *text, size_t length, long long *value) {
+  size_t i = (text[0] == '-') ? 1 : 0;
+
+  if ((i == length) || (length > 18)) {
+    return false;
+  }
+
+  for (size_t j = i; j < length; j++) {
+    if (!isdigit((unsigned char)text[j])) {
+      return false;
+    }
+  }
+
+  *value = strtoll(text, NULL, 10);
+
+  return true;
+} /* parse_number() */
+
+/*
+ *  True if a range end is written with a leading zero
+ */
+
+static bool zero_padded(const char *text, size_t length) {
+  size_t i = (text[0] == '-') ? 1 : 0;
+
+  return (length > i + 1) && (text[i] == '0');
+} /* zero_padded() */
+
+/*
+ *  Parse the inside of a brace group of length bytes as a range
+ *  a..b or a..b..step into part. Returns false if it is not one.
+ */
+
+static bool parse_range(const char *text, size_t length, brace_part_t *part) {
+  char *inside = strndup(text, length);
+
+  if (inside == NULL) {
+    perror("strndup");
+    exit(1);
+  }
+
+  char *first = inside;
+  char *second = strstr(first, "..");
+  char *third = (second == NULL) ? NULL : strstr(second + 2, "..");
+  long long start = 0;
+  long long end = 0;
+  long long step = 1;
+  bool valid = (second != NULL);
+
+  if (valid) {
+    *second = '\0';
+    second += 2;
+  }
+
+  if ((valid) && (third != NULL)) {
+    *third = '\0';
+    third += 2;
+    valid = parse_number(third, strlen(third), &step);
+  }
+
+  if (!valid) {
+    free(inside);
+    return false;
+  }
+
+  if ((strlen(first) == 1) && (strlen(second) == 1) &&
+      (isalpha((unsigned char)first[0])) &&
+      (isalpha((unsigned char)second[0]))) {
+    part->is_char = true;
+    start = first[0];
+    end = second[0];
+  } else if ((parse_number(first, strlen(first), &start)) &&
+             (parse_number(second, strlen(second), &end))) {
+    part->is_char = false;
+
+    if ((zero_padded(first, strlen(first))) ||
+        (zero_padded(second, strlen(second)))) {
+      part->width = (strlen(first) > strlen(second)) ? strlen(first)
+                                                     : strlen(second);
+    }
+  } else {
+    free(inside);
+    return false;
+  }
+
+  free(inside);
+
+  // the direction comes from the ends, only the size of the step counts
+
+  step = (step < 0) ? -step : step;
+  step = (step == 0) ? 1 : step;
+
+  part->kind = BRACE_RANGE;
+  part->start = start;
+  part->step = (end < start) ? -step : step;
+  part->count = ((end < start) ? start - end : end - start) / step + 1;
+
+  return true;
+} /* parse_range() */
+
+/*
+ *  Add a part to the iterator
+ */
+
+static brace_part_t *add_part(brace_iterator_t *iterator) {
+  iterator->parts = (brace_part_t *)realloc(
+      iterator->parts, (iterator->num_parts + 1) * sizeof(brace_part_t));
+
+  if (iterator->parts == NULL) {
+    perror("realloc");
+    exit(1);
+  }
+
+  brace_part_t *part = &iterator->parts[iterator->num_parts++];
+
+  memset(part, 0, sizeof(brace_part_t));
+  part->count = 1;
+
+  return part;
+} /* add_part() */
+
+/*
+ *  Add the literal text between start and end, if there is any
+ */
+
+static void add_literal(brace_iterator_t *iterator, const char *start,
+                        const char *end) {
+  if (end == start) {
+    return;
+  }
+
+  brace_part_t *part = add_part(iterator);
+
+  part->kind = BRACE_LITERAL;
+  part->text = strndup(start, end - start);
+
+  if (part->text == NULL) {
+    perror("strndup");
+    exit(1);
+  }
+} /* add_literal() */
+
+/*
+ *  Append the words an alternative expands to onto a list part
+ */
+
+static void add_alternative(brace_part_t *part, const char *text,
+                            size_t length) {
+  char *alternative = strndup(text, length);
+
+  if (alternative == NULL) {
+    perror("strndup");
+    exit(1);
+  }
+
+  brace_iterator_t *nested = open_brace_iterator(alternative);
+  char *word = alternative;
+
+  do {
+    if (nested != NULL) {
+      word = next_brace_word(nested);
+
+      if (word == NULL) {
+        break;
+      }
+    }
+
+    part->items = (char **)realloc(part->items,
+                                   (part->count + 1) * sizeof(char *));
+
+    if (part->items == NULL) {
+      perror("realloc");
+      exit(1);
+    }
+
+    part->items[part->count] = strdup(word);
+
+    if (part->items[part->count++] == NULL) {
+      perror("strdup");
+      exit(1);
+    }
+  } while (nested != NULL);
+
+  if (nested != NULL) {
+    close_brace_iterator(nested);
+  }
+
+  free(alternative);
+} /* add_alternative() */
+
+/*
+ *  Parse the inside of a brace group as a comma separated list into
+ *  part. Returns false if it has no comma at the top level.
+ */
+
+static bool parse_list(const char *text, size_t length, brace_part_t *part) {
+  int depth = 0;
+  size_t start = 0;
+  bool has_comma = false;
+
+  for (size_t i = 0; i < length; i++) {
+    if ((text[i] == '\\') && (i + 1 < length)) {
+      i++;
+    } else if (text[i] == '{') {
+      depth++;
+    } else if (text[i] == '}') {
+      depth--;
+    } else if ((text[i] == ',') && (depth == 0)) {
+      has_comma = true;
+    }
+  }
+
+  if (!has_comma) {
+    return false;
+  }
+
+  part->kind = BRACE_LIST;
+  part->count = 0;
+  depth = 0;
+
+  for (size_t i = 0; i <= length; i++) {
+    if ((i < length) && (text[i] == '\\') && (i + 1 < length)) {
+      i++;
+    } else if ((i < length) && (text[i] == '{')) {
+      depth++;
+    } else if ((i < length) && (text[i] == '}')) {
+      depth--;
+    } else if ((i == length) || ((text[i] == ',') && (depth == 0))) {
+      add_alternative(part, text + start, i - start);
+      start = i + 1;
+    }
+  }
+
+  return true;
+} /* parse_list() */
+
+/*
+ *  Start generating the brace expansions of word. Returns NULL if it
+ *  has no brace group to expand.
+ */
+
+brace_iterator_t *open_brace_iterator(const char *word) {
+  brace_iterator_t *iterator =
+      (brace_iterator_t *)calloc(1, sizeof(brace_iterator_t));
+
+  if (iterator == NULL) {
+    perror("calloc");
+    exit(1);
+  }
+
+  const char *literal = word;
+  bool expands = false;
+
+  for (int i = 0; word[i] != '\0'; i++) {
+    if ((word[i] == '\\') && (word[i + 1] != '\0')) {
+      i++;
+      continue;
+    }
+
+    if ((word[i] != '{') || ((i > 0) && (word[i - 1] == '$'))) {
+      continue;
+    }
+
+    int close = closing_brace(word, i);
+
+    if (close == -1) {
+      break;
+    }
+
+    // a group that is neither a list nor a range stays as text
+
+    brace_part_t group = {.count = 1};
+
+    if ((!parse_list(word + i + 1, close - i - 1, &group)) &&
+        (!parse_range(word + i + 1, close - i - 1, &group))) {
+      continue;
+    }
+
+    add_literal(iterator, literal, word + i);
+    *add_part(iterator) = group;
+    literal = word + close + 1;
+    expands = true;
+    i = close;
+  }
+
+  if (!expands) {
+    close_brace_iterator(iterator);
+    return NULL;
+  }
+
+  add_literal(iterator, literal, word + strlen(word));
+
+  return iterator;
+} /* open_brace_iterator() */
+
+/*
+ *  Append text to the current word
+ */
+
+static void append_text(brace_iterator_t *iterator, size_t *length,
+                        const char *text) {
+  size_t text_length = strlen(text);
+
+  if (*length + text_length + 1 > iterator->buffer_size) {
+    iterator->buffer_size = 2 * (*length + text_length + 1);
+    iterator->buffer = (char *)realloc(iterator->buffer, iterator->buffer_size);
+
+    if (iterator->buffer == NULL) {
+      perror("realloc");
+      exit(1);
+    }
+  }
+
+  memcpy(iterator->buffer + *length, text, text_length + 1);
+  *length += text_length;
+} /* append_text() */
+
+/*
+ *  Return the next word, or NULL when all have been generated. The
+ *  word belongs to the iterator and is valid until the next call.
+ */
+
+char *next_brace_word(brace_iterator_t *iterator) {
+  if (iterator->started) {
+    // advance the odometer, the last part first
+
+    int i = iterator->num_parts - 1;
+
+    while ((i >= 0) &&
+           (++iterator->parts[i].index == iterator->parts[i].count)) {
+      iterator->parts[i].index = 0;
+      i--;
+    }
+
+    if (i < 0) {
+      return NULL;
+    }
+  }
+
+  iterator->started = true;
+
+  size_t length = 0;
+
+  append_text(iterator, &length, "");
+
+  for (int i = 0; i < iterator->num_parts; i++) {
+    brace_part_t *part = &iterator->parts[i];
+    char number[32];
+
+    switch (part->kind) {
+    case BRACE_LITERAL:
+      append_text(iterator, &length, part->text);
+      break;
+    case BRACE_LIST:
+      append_text(iterator, &length, part->items[part->index]);
+      break;
+    case BRACE_RANGE:
+      if (part->is_char) {
+        snprintf(number, sizeof(number), "%c",
+                 (char)(part->start + part->index * part->step));
+      } else {
+        snprintf(number, sizeof(number), "%0*lld", part->width,
+                 part->start + part->index * part->step);
+      }
+
+      append_text(iterator, &length, number);
+      break;
+    }
+  }
+
+  return iterator->buffer;
+} /* next_brace_word() */
+
+/*
+ *  Free an iterator and its parts
+ */
+
+void close_brace_iterator(brace_iterator_t *iterator) {
+  for (int i = 0; i < iterator->num_parts; i++) {
+    brace_part_t *part = &iterator->parts[i];
+
+    free(part->text);
+
+    for (long long j = 0; (part->items != NULL) && (j < part->count); j++) {
+      free(part->items[j]);
+    }
+
+    free(part->items);
+  }
+
+  free(iterator->parts);
+  free(iterator->buffer);
+  free(iterator);
+} /* close_brace_iterator() */
@@ -0,0 +1,61 @@
+#ifndef BRACE_H
+#define BRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Brace Expansion
+//
+// A word such as a{b,c}d or file{01..10..2}.txt is split into parts:
+// literal text, lists of alternatives and numeric or character ranges
+// with an optional step. Zero padding is kept when an end of a range
+// is written with a leading zero. The words are generated one at a
+// time by counting through the parts like an odometer, the last part
+// changing fastest, so a range is never stored as a list. Lists are
+// expanded when the word is parsed, ranges nested inside them are
+// therefore not lazy. A ${ is not a brace group.
+
+typedef enum brace_part_kind {
+  BRACE_LITERAL,
+  BRACE_LIST,
+  BRACE_RANGE
+} brace_part_kind_t;
+
+typedef struct brace_part {
+  brace_part_kind_t kind;
+
+  // Text of BRACE_LITERAL, alternatives of BRACE_LIST
+
+  char *text;
+  char **items;
+
+  // First value and step of BRACE_RANGE, characters if is_char
+
+  long long start;
+  long long step;
+  int width;
+  bool is_char;
+
+  // Values the part takes, and the one of the current word
+
+  long long count;
+  long long index;
+} brace_part_t;
+
+typedef struct brace_iterator {
+  brace_part_t *parts;
+  int num_parts;
+
+  bool started;
+
+  // The current word, valid until the next call
+
+  char *buffer;
+  size_t buffer_size;
+} brace_iterator_t;
+
+brace_iterator_t *open_brace_iterator(const char *word);
+char *next_brace_word(brace_iterator_t *iterator);
+void close_brace_iterator(brace_iterator_t *iterator);
+
+#endif // BRACE_H
@@ -2,16 +2,34 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
+#include "arith.h"
+#include "batch.h"
+#include "complete.h"
+#include "dircache.h"
+#include "expand.h"
+#include "highlight.h"
+#include "history.h"
+#include "history_index.h"
+#include "key_input.h"
+#include "node.h"
+#include "prompt.h"
+#include "render.h"
 #include "shell.h"
+#include "suggest.h"
+#include "tty_raw_mode.h"
+#include "vars.h"
 
-char **g_env_var_array = NULL;
-int g_env_var_array_length = 0;
+pool_stats_t g_command_pool_stats = {.name = "command"};
+
+static command_t *g_command_pool[COMMAND_POOL_SIZE];
+static int g_command_pool_size = 0;
 
 /*
  *  Initialize a command_t
@@ -29,8 +47,32 @@ void create_command(command_t *command) {
   command->background = false;
 
   command->num_single_commands = 0;
+  command->max_single_commands = 0;
 } /* create_command() */
 
+/*
+ *  Get an empty command, reusing a freed one if there is one
+ */
+
+command_t *new_command() {
+  if (g_command_pool_size > 0) {
+    g_command_pool_stats.num_reused++;
+    return g_command_pool[--g_command_pool_size];
+  }
+
+  command_t *command = (command_t *)malloc(sizeof(command_t));
+
+  if (command == NULL) {
+    perror("malloc");
+    exit(1);
+  }
+
+  g_command_pool_stats.num_malloced++;
+  create_command(command);
+
+  return command;
+} /* new_command() */
+
 /*
  *  Insert a single command into the list of single commands in a command_t
  */
@@ -40,19 +82,31 @@ void insert_single_command(command_t *command, single_command_t *simp) {
     return;
   }
 
-  command->num_single_commands++;
-
   // single_commands is only an array of pointers, not of
-  // single_command structs
+  // single_command structs, it grows by doubling
+
+  if (command->num_single_commands == command->max_single_commands) {
+    command->max_single_commands = (command->max_single_commands == 0)
+                                       ? 4
+                                       : command->max_single_commands * 2;
+
+    int new_size = command->max_single_commands * sizeof(single_command_t *);
+    command->single_commands =
+        (single_command_t **)realloc(command->single_commands, new_size);
+
+    if (command->single_commands == NULL) {
+      perror("realloc");
+      exit(1);
+    }
+  }
 
-  int new_size = command->num_single_commands * sizeof(single_command_t *);
-  command->single_commands =
-      (single_command_t **)realloc(command->single_commands, new_size);
+  command->num_single_commands++;
   command->single_commands[command->num_single_commands - 1] = simp;
 } /* insert_single_command() */
 
 /*
- *  Free a command and its contents
+ *  Free a command and its contents. The file names belong to the
+ *  line arena, the struct goes back to the pool.
  */
 
 void free_command(command_t *command) {
@@ -64,29 +118,22 @@ void free_command(command_t *command) {
     free_single_command(command->single_commands[i]);
   }
 
-  if (command->single_commands != NULL) {
-    free(command->single_commands);
-  }
-
-  if (command->out_file) {
-    free(command->out_file);
-    command->out_file = NULL;
-  }
-
-  if (command->in_file) {
-    free(command->in_file);
-    command->in_file = NULL;
-  }
+  command->num_single_commands = 0;
 
-  if (command->err_file) {
-    free(command->err_file);
-    command->err_file = NULL;
-  }
+  command->out_file = NULL;
+  command->in_file = NULL;
+  command->err_file = NULL;
 
   command->append_out = false;
   command->append_err = false;
   command->background = false;
 
+  if (g_command_pool_size < COMMAND_POOL_SIZE) {
+    g_command_pool[g_command_pool_size++] = command;
+    return;
+  }
+
+  free(command->single_commands);
   free(command);
 } /* free_command() */
 
@@ -120,14 +167,55 @@ void print_command(command_t *command) {
 } /* print_command() */
 
 /*
- *  Execute a command chain
+ *  Expand a redirection file name, NULL if there is no redirection
+ */
+
+static char *expand_file_name(char *file_name) {
+  if (file_name == NULL) {
+    return NULL;
+  }
+
+  return expand_word(file_name);
+} /* expand_file_name() */
+
+/*
+ *  Execute a command chain and return its exit status,
+ *  which is the status of the last single command
  */
 
-void execute_command(command_t *command) {
+int execute_command(command_t *command) {
   // Don't do anything if there are no single commands
 
-  if (command->single_commands == NULL) {
-    return;
+  if (command->num_single_commands == 0) {
+    return 0;
+  }
+
+  // Expand the words of every single command, this is done on
+  // every execution so loop bodies see the current variables.
+  // Everything expanded is released in one step at the end.
+
+  arena_mark_t expand_mark = arena_mark(&g_expand_arena);
+
+  for (int i = 0; i < command->num_single_commands; i++) {
+    expand_single_command(command->single_commands[i]);
+  }
+
+  char *in_file = expand_file_name(command->in_file);
+  char *out_file = expand_file_name(command->out_file);
+  char *err_file = expand_file_name(command->err_file);
+
+  // Keep SIGCHLD blocked until the foreground child is waited for,
+  // otherwise child_collector() may reap it and lose its status
+
+  sigset_t chld_mask;
+  sigset_t old_mask;
+
+  sigemptyset(&chld_mask);
+  sigaddset(&chld_mask, SIGCHLD);
+
+  if (sigprocmask(SIG_BLOCK, &chld_mask, &old_mask) == -1) {
+    perror("sigprocmask");
+    exit(1);
   }
 
   // For every single command fork a new process
@@ -148,8 +236,8 @@ void execute_command(command_t *command) {
   // that first command uses its input.
 
   int input_fd = -1;
-  if (command->in_file != NULL) {
-    input_fd = open(command->in_file, O_RDONLY);
+  if (in_file != NULL) {
+    input_fd = open(in_file, O_RDONLY);
 
     if (input_fd == -1) {
       perror("open");
@@ -165,6 +253,7 @@ void execute_command(command_t *command) {
   }
 
   int ret = -1;
+  int status = 0;
   int output_fd = -1;
   int err_fd = -1;
 
@@ -190,14 +279,13 @@ void execute_command(command_t *command) {
       // then prepare to redirect output to a file and do so
       // with the proper options.
 
-      if (command->out_file != NULL) {
+      if (out_file != NULL) {
         // always create if it DNE
 
         if (command->append_out) {
           // open with append
 
-          output_fd =
-              open(command->out_file, O_WRONLY | O_CREAT | O_APPEND, 0644);
+          output_fd = open(out_file, O_WRONLY | O_CREAT | O_APPEND, 0644);
 
           if (output_fd == -1) {
             perror("open");
@@ -206,8 +294,7 @@ void execute_command(command_t *command) {
         } else {
           // open without append
 
-          output_fd =
-              open(command->out_file, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+          output_fd = open(out_file, O_WRONLY | O_CREAT | O_TRUNC, 0644);
 
           if (output_fd == -1) {
             perror("open");
@@ -227,16 +314,16 @@ void execute_command(command_t *command) {
 
       // Do the same for stderr
 
-      if (command->err_file != NULL) {
+      if (err_file != NULL) {
         if (command->append_err) {
-          err_fd = open(command->err_file, O_WRONLY | O_CREAT | O_APPEND, 0644);
+          err_fd = open(err_file, O_WRONLY | O_CREAT | O_APPEND, 0644);
 
           if (err_fd == -1) {
             perror("open");
             exit(1);
           }
         } else {
-          err_fd = open(command->err_file, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+          err_fd = open(err_file, O_WRONLY | O_CREAT | O_TRUNC, 0644);
 
           if (err_fd == -1) {
             perror("open");
@@ -294,55 +381,157 @@ void execute_command(command_t *command) {
     // The following is code to prepare and execute
     // one (the currently iterated) command of the command chain.
 
+    if (command->single_commands[i]->num_args == 0) {
+      continue;
+    }
+
     char *argument = command->single_commands[i]->arguments[0];
 
     // Bash built-ins implementation
 
-    if (!strcmp(argument, "setenv")) {
+    if (!strcmp(argument, "exit")) {
+      if (command->single_commands[i]->num_args > 1) {
+        exit(atoi(command->single_commands[i]->arguments[1]));
+      }
+
+      exit(0);
+    } else if ((!strcmp(argument, "break")) || (!strcmp(argument, "continue"))) {
+      if (g_loop_depth == 0) {
+        fprintf(stderr, "%s: only meaningful in a loop\n", argument);
+        status = 1;
+      } else if (!strcmp(argument, "break")) {
+        g_loop_break = true;
+        status = 0;
+      } else {
+        g_loop_continue = true;
+        status = 0;
+      }
+    } else if (!strcmp(argument, "let")) {
+      // Evaluated in the shell, 1 if the last value is 0
+
+      long long value = 0;
+      status = 1;
+
+      if (command->single_commands[i]->num_args < 2) {
+        fprintf(stderr, "let: expression expected\n");
+      }
+
+      for (int j = 1; j < command->single_commands[i]->num_args; j++) {
+        if (!evaluate_arithmetic(command->single_commands[i]->arguments[j],
+                                 &value)) {
+          value = 0;
+          break;
+        }
+      }
+
+      if (value != 0) {
+        status = 0;
+      }
+    } else if (!strcmp(argument, "stats")) {
+      // allocation counters
+
+      print_arena_stats(&g_line_arena);
+      print_arena_stats(&g_expand_arena);
+      print_pool_stats(&g_command_pool_stats);
+      print_pool_stats(&g_single_command_pool_stats);
+      print_pool_stats(&g_node_pool_stats);
+      print_dircache_stats();
+      print_render_stats();
+      print_highlight_stats();
+      print_key_input_stats();
+      print_tty_stats();
+      print_prompt_stats();
+      print_history_stats();
+      print_history_index_stats();
+      print_suggest_stats();
+      print_completion_stats();
+      status = 0;
+    } else if (!strcmp(argument, "setenv")) {
       if (command->single_commands[i]->num_args > 3) {
         fprintf(stderr, "setenv: too many arguments");
+        status = 1;
       } else {
         char *var_name = command->single_commands[i]->arguments[1];
-        char *var_val = command->single_commands[i]->arguments[2];
+        char *var_val = NULL;
+
+        if (command->single_commands[i]->num_args > 2) {
+          var_val = command->single_commands[i]->arguments[2];
+        }
 
-        int name_len = strlen(var_name);
+        if (var_name == NULL) {
+          fprintf(stderr, "setenv: variable name expected\n");
+          status = 1;
+        } else {
+          set_variable(var_name, (var_val == NULL) ? "" : var_val, true);
+          status = 0;
+        }
+      }
+    } else if (!strcmp(argument, "export")) {
+      // export name or name=value, the variable is passed to commands
 
-        char *env_var = malloc(name_len + strlen(var_val) + 2);
+      status = 0;
 
-        strcpy(env_var, var_name);
-        env_var[strlen(var_name)] = '=';
-        strcpy(env_var + strlen(var_name) + 1, var_val);
+      for (int j = 1; j < command->single_commands[i]->num_args; j++) {
+        char *var_name = strdup(command->single_commands[i]->arguments[j]);
+        char *equals = strchr(var_name, '=');
+        char *var_val = NULL;
 
-        putenv(env_var);
+        if (equals != NULL) {
+          *equals = '\0';
+          var_val = equals + 1;
+        } else {
+          var_val = get_variable(var_name);
+        }
 
-        g_env_var_array_length++;
-        g_env_var_array = (char **)realloc(
-            g_env_var_array, (g_env_var_array_length) * sizeof(char *));
-        g_env_var_array[g_env_var_array_length - 1] = env_var;
+        if (var_name[0] == '\0') {
+          fprintf(stderr, "export: bad variable name\n");
+          status = 1;
+        } else {
+          set_variable(var_name, (var_val == NULL) ? "" : var_val, true);
+        }
+
+        free(var_name);
       }
     } else if (!strcmp(argument, "unsetenv")) {
       if (command->single_commands[i]->num_args > 2) {
         fprintf(stderr, "unsetenv: too many arguments");
+        status = 1;
       } else {
         char *var_name = command->single_commands[i]->arguments[1];
 
-        unsetenv(var_name);
+        if (var_name != NULL) {
+          unset_variable(var_name);
+        }
+        status = 0;
       }
     } else if (!strcmp(argument, "cd")) {
       if (command->single_commands[i]->num_args > 2) {
         fprintf(stderr, "cd: too many arguments");
+        status = 1;
       } else {
         char *dir = command->single_commands[i]->arguments[1];
         if (dir == NULL) {
-          dir = getenv("HOME");
+          dir = get_variable("HOME");
         }
 
+        status = 0;
+
         if (chdir(dir) == -1) {
           fprintf(stderr, "cd: can't cd to %s\n", dir);
+          status = 1;
         }
       }
     } else {
       // If not a built-in, but a normal command
+      // the environment is only rebuilt when an exported variable changed
+
+      char **envp = get_environment();
+
+      // the command gets the terminal in the mode it was in before
+      // the line editor put it in raw mode
+
+      tty_cooked_mode();
+
       ret = fork();
 
       if (ret == -1) {
@@ -357,26 +546,29 @@ void execute_command(command_t *command) {
           exit(1);
         }
 
+        if (sigprocmask(SIG_SETMASK, &old_mask, NULL) == -1) {
+          perror("sigprocmask");
+          exit(1);
+        }
+
         // should never return
 
         if (!strcmp(command->single_commands[i]->arguments[0], "printenv")) {
           int itr = 0;
-          char *env_var = environ[itr];
+          char *env_var = envp[itr];
 
           while (env_var != NULL) {
             printf("%s\n", env_var);
             ++itr;
-            env_var = environ[itr];
+            env_var = envp[itr];
           }
 
           exit(0);
         } else {
-          // System call to run a bash command with arguments
+          // System call to run a bash command with arguments,
+          // split into batches if asked to
 
-          execvp(command->single_commands[i]->arguments[0],
-                 command->single_commands[i]->arguments);
-          perror("execvp");
-          exit(1);
+          exec_single_command(command->single_commands[i], envp);
         }
       }
     }
@@ -399,10 +591,14 @@ void execute_command(command_t *command) {
   }
 
   // Only wait for non-backgrounded processes.
+  // If the last single command was a built-in there is nothing
+  // to wait for and its status is already set.
 
-  if (!command->background) {
+  if ((!command->background) && (ret > 0)) {
     int prev_errno = errno;
-    if (waitpid(ret, NULL, 0) == -1) {
+    int wait_status = 0;
+
+    if (waitpid(ret, &wait_status, 0) == -1) {
       if (errno == ECHILD) {
 
         // Do nothing, sigaction picked it up
@@ -413,14 +609,39 @@ void execute_command(command_t *command) {
         perror("waitpid");
         exit(1);
       }
+    } else if (WIFEXITED(wait_status)) {
+      status = WEXITSTATUS(wait_status);
+    } else if (WIFSIGNALED(wait_status)) {
+      status = 128 + WTERMSIG(wait_status);
+    }
+  } else if (command->background) {
+    // a line of builtins started no process
+
+    if (ret > 0) {
+      g_last_background_pid = ret;
+      track_job(ret);
     }
+
+    status = 0;
+  }
+
+  if (sigprocmask(SIG_SETMASK, &old_mask, NULL) == -1) {
+    perror("sigprocmask");
+    exit(1);
   }
 
-  // print prompt again if isatty()
+  // Remember the last argument for ${_}
 
-  if ((isatty(STDIN_FILENO)) && (g_prompt_printed == false)) {
-    print_prompt();
-  } else {
-    g_prompt_printed = false;
+  single_command_t *last_single_command =
+      command->single_commands[command->num_single_commands - 1];
+
+  if (last_single_command->num_args != 0) {
+    free(g_last_arg);
+    g_last_arg = strdup(
+        last_single_command->arguments[last_single_command->num_args - 1]);
   }
+
+  arena_release(&g_expand_arena, expand_mark);
+
+  return status;
 } /* execute_command() */
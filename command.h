@@ -3,8 +3,13 @@
 
 #include <stdbool.h>
 
+#include "arena.h"
 #include "single_command.h"
 
+// Freed commands kept for reuse by new_command()
+
+#define COMMAND_POOL_SIZE (32)
+
 // Command Data Structure
 
 typedef struct command {
@@ -17,16 +22,17 @@ typedef struct command {
 
   single_command_t **single_commands;
   int num_single_commands;
+  int max_single_commands;
 } command_t;
 
 void create_command(command_t *);
+command_t *new_command();
 void insert_single_command(command_t *, single_command_t *);
 void free_command(command_t *);
 void print_command(command_t *);
-void execute_command(command_t *);
+int execute_command(command_t *);
 
 extern command_t *g_current_command;
-extern char **g_env_var_array;
-extern int g_env_var_array_length;
+extern pool_stats_t g_command_pool_stats;
 
 #endif // COMMAND_H
@@ -0,0 +1,575 @@
+#include "complete.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "arena.h"
+#include "dircache.h"
+#include "vars.h"
+
+static const char *g_builtins[] = {"batch",    "break",  "cd",     "continue",
+                                   "exit",     "export", "let",    "printenv",
+                                   "setenv",   "source", "stats",  "unsetenv"};
+
+// Index of $PATH, replaced by the builder thread under g_index_lock
+
+static pthread_mutex_t g_index_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_index_built = PTHREAD_COND_INITIALIZER;
+static command_index_t *g_command_index = NULL;
+static bool g_index_building = false;
+static unsigned long g_index_builds = 0;
+
+// Trie of the directory completed last, valid while the listing
+// cache returns the listing of the same generation
+
+static trie_t *g_dir_trie = NULL;
+static dev_t g_dir_trie_dev = 0;
+static ino_t g_dir_trie_ino = 0;
+static unsigned long g_dir_trie_generation = 0;
+static unsigned long g_dir_trie_builds = 0;
+
+// Matches of the last completion
+
+static arena_t g_completion_arena = {.name = "complete"};
+
+/*
+ *  Free a command index
+ */
+
+static void free_command_index(command_index_t *index) {
+  if (index == NULL) {
+    return;
+  }
+
+  free_trie(index->trie);
+  free(index->path);
+  free(index->mtimes);
+  free(index);
+} /* free_command_index() */
+
+/*
+ *  Split a copy of path at the colons, an empty entry is the current
+ *  directory
+ */
+
+static char **split_path(const char *path, int *num_dirs) {
+  int count = 1;
+
+  for (const char *c = path; *c != '\0'; c++) {
+    count += (*c == ':');
+  }
+
+  char **dirs = (char **)malloc(count * sizeof(char *) + strlen(path) + 1);
+
+  if (dirs == NULL) {
+    perror("malloc");
+    exit(1);
+  }
+
+  char *copy = (char *)(dirs + count);
+  strcpy(copy, path);
+
+  for (int i = 0; i < count; i++) {
+    char *colon = strchr(copy, ':');
+
+    if (colon != NULL) {
+      *colon = '\0';
+    }
+
+    dirs[i] = (*copy == '\0') ? "." : copy;
+    copy = (colon != NULL) ? colon + 1 : copy + strlen(copy);
+  }
+
+  *num_dirs = count;
+  return dirs;
+} /* split_path() */
+
+/*
+ *  Add the executables of a directory to the trie and record its
+ *  mtime
+ */
+
+static void index_directory(trie_t *trie, const char *path,
+                            struct timespec *mtime) {
+  DIR *dir = opendir(path);
+
+  if (dir == NULL) {
+    return;
+  }
+
+  struct stat dir_stat = {0};
+
+  if (fstat(dirfd(dir), &dir_stat) == 0) {
+    *mtime = dir_stat.st_mtim;
+  }
+
+  struct dirent *entry = NULL;
+
+  while ((entry = readdir(dir)) != NULL) {
+    if ((entry->d_name[0] == '.') || (entry->d_type == DT_DIR)) {
+      continue;
+    }
+
+    if (entry->d_type != DT_REG) {
+      struct stat file_stat = {0};
+
+      if ((fstatat(dirfd(dir), entry->d_name, &file_stat, 0) != 0) ||
+          (!S_ISREG(file_stat.st_mode))) {
+        continue;
+      }
+    }
+
+    if (faccessat(dirfd(dir), entry->d_name, X_OK, 0) == 0) {
+      trie_insert(trie, entry->d_name, DT_REG);
+    }
+  }
+
+  closedir(dir);
+} /* index_directory() */
+
+/*
+ *  Body of the builder thread, fills in the index and publishes it
+ */
+
+static void *build_command_index(void *argument) {
+  command_index_t *index = (command_index_t *)argument;
+  char **dirs = split_path(index->path, &index->num_dirs);
+
+  index->mtimes =
+      (struct timespec *)calloc(index->num_dirs, sizeof(struct timespec));
+
+  if (index->mtimes == NULL) {
+    perror("calloc");
+    exit(1);
+  }
+
+  index->trie = new_trie();
+
+  for (size_t i = 0; i < sizeof(g_builtins) / sizeof(g_builtins[0]); i++) {
+    trie_insert(index->trie, g_builtins[i], DT_REG);
+  }
+
+  for (int i = 0; i < index->num_dirs; i++) {
+    index_directory(index->trie, dirs[i], &index->mtimes[i]);
+  }
+
+  free(dirs);
+
+  pthread_mutex_lock(&g_index_lock);
+  command_index_t *old_index = g_command_index;
+  g_command_index = index;
+  g_index_building = false;
+  g_index_builds++;
+  pthread_cond_broadcast(&g_index_built);
+  pthread_mutex_unlock(&g_index_lock);
+
+  // completion only reaches the index under the lock, so nothing
+  // uses the old one now
+
+  free_command_index(old_index);
+
+  return NULL;
+} /* build_command_index() */
+
+/*
+ *  True if path or the mtime of one of its directories differs from
+ *  what the index was built from
+ */
+
+static bool command_index_stale(const command_index_t *index,
+                                const char *path) {
+  if (strcmp(index->path, path) != 0) {
+    return true;
+  }
+
+  int num_dirs = 0;
+  char **dirs = split_path(path, &num_dirs);
+  bool stale = false;
+
+  for (int i = 0; (i < num_dirs) && (!stale); i++) {
+    struct stat dir_stat = {0};
+    struct timespec mtime = {0};
+
+    if (stat(dirs[i], &dir_stat) == 0) {
+      mtime = dir_stat.st_mtim;
+    }
+
+    stale = (mtime.tv_sec != index->mtimes[i].tv_sec) ||
+            (mtime.tv_nsec != index->mtimes[i].tv_nsec);
+  }
+
+  free(dirs);
+
+  return stale;
+} /* command_index_stale() */
+
+/*
+ *  Start building the index of $PATH in the background if there is
+ *  none yet or it is out of date. Called before each line is read
+ */
+
+void update_command_index() {
+  char *path = get_variable("PATH");
+
+  if (path == NULL) {
+    path = "";
+  }
+
+  pthread_mutex_lock(&g_index_lock);
+
+  if ((g_index_building) || ((g_command_index != NULL) &&
+                             (!command_index_stale(g_command_index, path)))) {
+    pthread_mutex_unlock(&g_index_lock);
+    return;
+  }
+
+  command_index_t *index = (command_index_t *)calloc(1, sizeof(*index));
+
+  if ((index == NULL) || ((index->path = strdup(path)) == NULL)) {
+    perror("malloc");
+    exit(1);
+  }
+
+  pthread_t thread;
+  pthread_attr_t attributes;
+  sigset_t all_signals;
+  sigset_t old_mask;
+
+  // the builder starts with every signal blocked, so the SIGCHLD of
+  // a foreground command is not handled, and its child reaped, on it
+
+  sigfillset(&all_signals);
+  pthread_sigmask(SIG_SETMASK, &all_signals, &old_mask);
+  pthread_attr_init(&attributes);
+  pthread_attr_setdetachstate(&attributes, PTHREAD_CREATE_DETACHED);
+
+  if (pthread_create(&thread, &attributes, build_command_index, index) != 0) {
+    perror("pthread_create");
+    exit(1);
+  }
+
+  pthread_attr_destroy(&attributes);
+  pthread_sigmask(SIG_SETMASK, &old_mask, NULL);
+  g_index_building = true;
+  pthread_mutex_unlock(&g_index_lock);
+} /* update_command_index() */
+
+/*
+ *  Append text to the insertion, quoting the characters the lexer
+ *  would treat specially
+ */
+
+static void add_insert(completion_t *completion, const char *text) {
+  for (; *text != '\0'; text++) {
+    if (completion->insert_length + 3 > MAX_COMPLETION) {
+      return;
+    }
+
+    if (strchr(COMPLETION_QUOTED, *text) != NULL) {
+      completion->insert[completion->insert_length++] = '\\';
+    }
+
+    completion->insert[completion->insert_length++] = *text;
+  }
+
+  completion->insert[completion->insert_length] = '\0';
+} /* add_insert() */
+
+/*
+ *  Complete prefix from the words of a trie. A single match is
+ *  inserted whole, followed by a / for a directory or a space.
+ *  Otherwise the characters all matches share are inserted, and if
+ *  there are none the matches are listed. Hidden names only match a
+ *  prefix starting with a dot
+ */
+
+static void complete_from_trie(trie_t *trie, const char *prefix, int dirfd,
+                               completion_t *completion) {
+  trie_node_t *node = trie_find(trie, prefix);
+
+  if (node == NULL) {
+    return;
+  }
+
+  // leave out the hidden names below the root
+
+  trie_node_t *hidden = NULL;
+
+  if (*prefix == '\0') {
+    hidden = trie_find(trie, ".");
+  }
+
+  completion->num_matches =
+      node->num_words - ((hidden != NULL) ? hidden->num_words : 0);
+
+  if (completion->num_matches == 0) {
+    return;
+  }
+
+  char extension[MAX_COMPLETION] = "";
+  size_t extension_length = 0;
+
+  if (hidden == NULL) {
+    extension_length = trie_extension(node, extension, sizeof(extension));
+  } else {
+    // shared characters of the visible names, which exist only if
+    // they all start with the same character
+
+    trie_node_t *visible = NULL;
+    int num_visible = 0;
+
+    for (trie_node_t *child = node->child; child != NULL;
+         child = child->sibling) {
+      if (child != hidden) {
+        visible = child;
+        num_visible++;
+      }
+    }
+
+    if (num_visible == 1) {
+      extension[0] = visible->c;
+      extension_length =
+          1 + trie_extension(visible, extension + 1, sizeof(extension) - 1);
+    }
+  }
+
+  if (completion->num_matches == 1) {
+    // walk to the word itself to learn its type
+
+    char word[MAX_COMPLETION];
+
+    snprintf(word, sizeof(word), "%s%s", prefix, extension);
+    trie_node_t *match = trie_find(trie, word);
+    bool directory = (match != NULL) && (match->type == DT_DIR);
+
+    if ((match != NULL) &&
+        ((match->type == DT_UNKNOWN) || (match->type == DT_LNK)) &&
+        (dirfd != -1)) {
+      struct stat file_stat = {0};
+
+      directory = (fstatat(dirfd, word, &file_stat, 0) == 0) &&
+                  S_ISDIR(file_stat.st_mode);
+    }
+
+    add_insert(completion, extension);
+    add_insert(completion, directory ? "/" : "");
+
+    if (!directory) {
+      completion->insert[completion->insert_length++] = ' ';
+      completion->insert[completion->insert_length] = '\0';
+    }
+
+    return;
+  }
+
+  if (extension_length > 0) {
+    add_insert(completion, extension);
+    return;
+  }
+
+  // list the matches
+
+  node = trie_find(trie, prefix);
+
+  if (node->is_word) {
+    completion->matches[completion->num_listed++] =
+        arena_strdup(&g_completion_arena, prefix);
+  }
+
+  for (trie_node_t *child = node->child;
+       (child != NULL) && (completion->num_listed < MAX_LISTED_COMPLETIONS);
+       child = child->sibling) {
+    if (child == hidden) {
+      continue;
+    }
+
+    char child_prefix[MAX_COMPLETION];
+
+    snprintf(child_prefix, sizeof(child_prefix), "%s%c", prefix, child->c);
+    completion->num_listed += trie_words(
+        child, child_prefix, completion->matches + completion->num_listed,
+        MAX_LISTED_COMPLETIONS - completion->num_listed, &g_completion_arena);
+  }
+} /* complete_from_trie() */
+
+/*
+ *  Trie of the names in the directory open as dirfd, kept while the
+ *  directory cache returns the listing it was built from
+ */
+
+static trie_t *directory_trie(int dirfd) {
+  struct stat dir_stat = {0};
+  unsigned char *types = NULL;
+  int num_names = 0;
+  unsigned long generation = 0;
+
+  if (fstat(dirfd, &dir_stat) != 0) {
+    return NULL;
+  }
+
+  char **names = read_directory(dirfd, &types, &num_names, &generation);
+
+  if (names == NULL) {
+    return NULL;
+  }
+
+  if ((g_dir_trie != NULL) && (g_dir_trie_generation == generation) &&
+      (g_dir_trie_dev == dir_stat.st_dev) &&
+      (g_dir_trie_ino == dir_stat.st_ino)) {
+    return g_dir_trie;
+  }
+
+  free_trie(g_dir_trie);
+  g_dir_trie = new_trie();
+  g_dir_trie_generation = generation;
+  g_dir_trie_dev = dir_stat.st_dev;
+  g_dir_trie_ino = dir_stat.st_ino;
+  g_dir_trie_builds++;
+
+  for (int i = 0; i < num_names; i++) {
+    if ((strcmp(names[i], ".") != 0) && (strcmp(names[i], "..") != 0)) {
+      trie_insert(g_dir_trie, names[i], types[i]);
+    }
+  }
+
+  return g_dir_trie;
+} /* directory_trie() */
+
+/*
+ *  Complete the word ending at cursor in line. What to insert, or the
+ *  matches to list, are returned in completion
+ */
+
+void complete_word(const char *line, int cursor, completion_t *completion) {
+  arena_release(&g_completion_arena, (arena_mark_t){NULL, 0});
+
+  completion->insert[0] = '\0';
+  completion->insert_length = 0;
+  completion->num_listed = 0;
+  completion->num_matches = 0;
+
+  int start = cursor;
+
+  while ((start > 0) &&
+         ((strchr(COMPLETION_WORD_BREAKS, line[start - 1]) == NULL) ||
+          ((start > 1) && (line[start - 2] == '\\')))) {
+    start--;
+  }
+
+  // the word without its quoting backslashes
+
+  char word[MAX_COMPLETION];
+  size_t length = 0;
+
+  for (int i = start; (i < cursor) && (length + 1 < sizeof(word)); i++) {
+    if ((line[i] == '\\') && (i + 1 < cursor)) {
+      i++;
+    }
+
+    word[length++] = line[i];
+  }
+
+  word[length] = '\0';
+
+  // a word in command position without a / is a command
+
+  int before = start - 1;
+
+  while ((before >= 0) && ((line[before] == ' ') || (line[before] == '\t'))) {
+    before--;
+  }
+
+  if ((strchr(word, '/') == NULL) &&
+      ((before < 0) || (strchr(";|&(\n", line[before]) != NULL))) {
+    update_command_index();
+
+    pthread_mutex_lock(&g_index_lock);
+
+    while (g_command_index == NULL) {
+      pthread_cond_wait(&g_index_built, &g_index_lock);
+    }
+
+    complete_from_trie(g_command_index->trie, word, -1, completion);
+    pthread_mutex_unlock(&g_index_lock);
+    return;
+  }
+
+  // a file name, looked up in the directory part of the word
+
+  char path[MAX_COMPLETION];
+  char *slash = strrchr(word, '/');
+  const char *prefix = word;
+
+  if (slash == NULL) {
+    strcpy(path, ".");
+  } else {
+    prefix = slash + 1;
+
+    if ((word[0] == '~') && (word[1] == '/') &&
+        (get_variable("HOME") != NULL)) {
+      snprintf(path, sizeof(path), "%s%.*s", get_variable("HOME"),
+               (int)(slash - word), word + 1);
+    } else {
+      snprintf(path, sizeof(path), "%.*s", (int)(slash - word + 1), word);
+    }
+  }
+
+  int fd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+  if (fd == -1) {
+    return;
+  }
+
+  trie_t *trie = directory_trie(fd);
+
+  if (trie != NULL) {
+    complete_from_trie(trie, prefix, fd, completion);
+  }
+
+  close(fd);
+} /* complete_word() */
+
+/*
+ *  True if name is a builtin or an executable on $PATH. While the
+ *  index is first being built every name is taken as known
+ */
+
+bool is_command(const char *name) {
+  pthread_mutex_lock(&g_index_lock);
+
+  bool known = true;
+
+  if (g_command_index != NULL) {
+    trie_node_t *node = trie_find(g_command_index->trie, name);
+
+    known = (node != NULL) && (node->is_word);
+  }
+
+  pthread_mutex_unlock(&g_index_lock);
+
+  return known;
+} /* is_command() */
+
+/*
+ *  Print the completion counters
+ */
+
+void print_completion_stats() {
+  pthread_mutex_lock(&g_index_lock);
+  int num_commands = (g_command_index != NULL)
+                         ? g_command_index->trie->root->num_words
+                         : 0;
+  unsigned long builds = g_index_builds;
+  pthread_mutex_unlock(&g_index_lock);
+
+  printf("complete commands %d index builds %lu directory tries %lu\n",
+         num_commands, builds, g_dir_trie_builds);
+} /* print_completion_stats() */
@@ -0,0 +1,59 @@
+#ifndef COMPLETE_H
+#define COMPLETE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <time.h>
+
+#include "trie.h"
+
+// Tab Completion
+//
+// A word in command position is completed from a prefix trie of the
+// builtins and every executable on $PATH. The trie is built by a
+// thread of its own at startup and built again, while the old one
+// keeps answering, once $PATH or the mtime of one of its directories
+// has changed. Other words are completed as file names from the
+// directory listing cache, through a trie of the directory that is
+// kept until the listing changes.
+
+#define MAX_COMPLETION (4096)
+#define MAX_LISTED_COMPLETIONS (200)
+
+// Characters that end the word being completed, and the characters
+// quoted with a backslash when a name is inserted
+
+#define COMPLETION_WORD_BREAKS " \t\n;|&()<>"
+#define COMPLETION_QUOTED " \t;|&()<>*?[]{}$\\\"'`!~#"
+
+typedef struct command_index {
+  trie_t *trie;
+
+  // $PATH the trie was built from and the mtime of each of its
+  // directories then
+
+  char *path;
+  struct timespec *mtimes;
+  int num_dirs;
+} command_index_t;
+
+typedef struct completion {
+  // Characters to insert at the cursor
+
+  char insert[MAX_COMPLETION];
+  size_t insert_length;
+
+  // Words matching, listed when there is nothing to insert. They are
+  // valid until the next completion
+
+  char *matches[MAX_LISTED_COMPLETIONS];
+  int num_listed;
+  int num_matches;
+} completion_t;
+
+void update_command_index();
+void complete_word(const char *line, int cursor, completion_t *completion);
+bool is_command(const char *name);
+void print_completion_stats();
+
+#endif // COMPLETE_H
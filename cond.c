@@ -0,0 +1,512 @@
+#define _GNU_SOURCE
+
+#include "cond.h"
+
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "arith.h"
+#include "expand.h"
+#include "glob.h"
+#include "regex_cache.h"
+#include "shell.h"
+#include "vars.h"
+
+typedef struct cond_path {
+  char *path;
+  bool follow;
+  bool exists;
+  struct statx stx;
+} cond_path_t;
+
+typedef struct cond_state {
+  single_command_t *words;
+
+  // Words are expanded the first time they are needed
+
+  char **expanded;
+  int pos;
+  bool error;
+
+  // stat results for this evaluation, reused in a ring when full
+
+  cond_path_t paths[MAX_COND_PATHS];
+  int num_paths;
+} cond_state_t;
+
+static bool parse_or(cond_state_t *state, bool eval);
+
+/*
+ *  Report a syntax or evaluation error, only the first is printed
+ */
+
+static void cond_error(cond_state_t *state, const char *message,
+                       const char *word) {
+  if (!state->error) {
+    if (word != NULL) {
+      fprintf(stderr, "[[: %s: %s\n", message, word);
+    } else {
+      fprintf(stderr, "[[: %s\n", message);
+    }
+
+    state->error = true;
+  }
+} /* cond_error() */
+
+/*
+ *  Returns true if word index is the unquoted operator op
+ */
+
+static bool is_operator(cond_state_t *state, int index, const char *op) {
+  if (index >= state->words->num_words) {
+    return false;
+  }
+
+  return (!state->words->quoted[index]) &&
+         (!strcmp(state->words->words[index], op));
+} /* is_operator() */
+
+/*
+ *  Expanded value of word index, without splitting or wildcards
+ */
+
+static char *operand(cond_state_t *state, int index) {
+  if (state->expanded[index] == NULL) {
+    if (state->words->quoted[index]) {
+      state->expanded[index] = state->words->words[index];
+    } else {
+      state->expanded[index] = expand_word(state->words->words[index]);
+    }
+  }
+
+  return state->expanded[index];
+} /* operand() */
+
+/*
+ *  stat a path, following symbolic links or not. Each path is only
+ *  stat'd once per evaluation. Returns NULL if it does not exist.
+ */
+
+static const struct statx *get_stat(cond_state_t *state, const char *path,
+                                    bool follow) {
+  int cached = state->num_paths;
+
+  if (cached > MAX_COND_PATHS) {
+    cached = MAX_COND_PATHS;
+  }
+
+  for (int i = 0; i < cached; i++) {
+    cond_path_t *entry = &state->paths[i];
+
+    if ((entry->follow == follow) && (!strcmp(entry->path, path))) {
+      return entry->exists ? &entry->stx : NULL;
+    }
+  }
+
+  cond_path_t *entry = &state->paths[state->num_paths % MAX_COND_PATHS];
+
+  if (state->num_paths >= MAX_COND_PATHS) {
+    free(entry->path);
+  }
+
+  state->num_paths++;
+
+  entry->path = strdup(path);
+  entry->follow = follow;
+  entry->exists = (statx(AT_FDCWD, path, follow ? 0 : AT_SYMLINK_NOFOLLOW,
+                         STATX_BASIC_STATS, &entry->stx) == 0);
+
+  return entry->exists ? &entry->stx : NULL;
+} /* get_stat() */
+
+/*
+ *  Returns true if the shell's group list contains gid
+ */
+
+static bool in_group(gid_t gid) {
+  if (getegid() == gid) {
+    return true;
+  }
+
+  gid_t groups[256];
+  int num_groups = getgroups(sizeof(groups) / sizeof(groups[0]), groups);
+
+  for (int i = 0; i < num_groups; i++) {
+    if (groups[i] == gid) {
+      return true;
+    }
+  }
+
+  return false;
+} /* in_group() */
+
+/*
+ *  Check read (4), write (2) or execute (1) permission from the mode
+ *  bits of an already stat'd file
+ */
+
+static bool has_permission(const struct statx *stx, int permission) {
+  if (geteuid() == 0) {
+    if (permission != 1) {
+      return true;
+    }
+
+    return (stx->stx_mode & 0111) || S_ISDIR(stx->stx_mode);
+  }
+
+  if (stx->stx_uid == geteuid()) {
+    return stx->stx_mode & (permission << 6);
+  }
+
+  if (in_group(stx->stx_gid)) {
+    return stx->stx_mode & (permission << 3);
+  }
+
+  return stx->stx_mode & permission;
+} /* has_permission() */
+
+/*
+ *  Compare modification times, negative if a is older than b
+ */
+
+static int compare_mtime(const struct statx *a, const struct statx *b) {
+  if (a->stx_mtime.tv_sec != b->stx_mtime.tv_sec) {
+    return (a->stx_mtime.tv_sec < b->stx_mtime.tv_sec) ? -1 : 1;
+  }
+
+  if (a->stx_mtime.tv_nsec != b->stx_mtime.tv_nsec) {
+    return (a->stx_mtime.tv_nsec < b->stx_mtime.tv_nsec) ? -1 : 1;
+  }
+
+  return 0;
+} /* compare_mtime() */
+
+/*
+ *  Returns true if word is a unary operator
+ */
+
+static bool is_unary_operator(const char *word) {
+  return (strlen(word) == 2) && (word[0] == '-') &&
+         (strchr("abcdefghknprstuvwxzGLOS", word[1]) != NULL);
+} /* is_unary_operator() */
+
+/*
+ *  Returns true if word is a binary operator
+ */
+
+static bool is_binary_operator(const char *word) {
+  static const char *operators[] = {
+      "==", "=",   "!=",  "=~",  "<",   ">",   "-eq", "-ne",
+      "-lt", "-le", "-gt", "-ge", "-nt", "-ot", "-ef",
+  };
+
+  for (size_t i = 0; i < sizeof(operators) / sizeof(operators[0]); i++) {
+    if (!strcmp(word, operators[i])) {
+      return true;
+    }
+  }
+
+  return false;
+} /* is_binary_operator() */
+
+/*
+ *  Evaluate a unary test on operand
+ */
+
+static bool unary_test(cond_state_t *state, char op, char *word) {
+  const struct statx *stx = NULL;
+
+  switch (op) {
+  case 'z':
+    return word[0] == '\0';
+  case 'n':
+    return word[0] != '\0';
+  case 'v':
+    return get_variable(word) != NULL;
+  case 't':
+    return isatty(atoi(word));
+  case 'L':
+  case 'h':
+    stx = get_stat(state, word, false);
+    return (stx != NULL) && S_ISLNK(stx->stx_mode);
+  }
+
+  stx = get_stat(state, word, true);
+
+  if (stx == NULL) {
+    return false;
+  }
+
+  switch (op) {
+  case 'a':
+  case 'e':
+    return true;
+  case 'f':
+    return S_ISREG(stx->stx_mode);
+  case 'd':
+    return S_ISDIR(stx->stx_mode);
+  case 'b':
+    return S_ISBLK(stx->stx_mode);
+  case 'c':
+    return S_ISCHR(stx->stx_mode);
+  case 'p':
+    return S_ISFIFO(stx->stx_mode);
+  case 'S':
+    return S_ISSOCK(stx->stx_mode);
+  case 's':
+    return stx->stx_size > 0;
+  case 'r':
+    return has_permission(stx, 4);
+  case 'w':
+    return has_permission(stx, 2);
+  case 'x':
+    return has_permission(stx, 1);
+  case 'u':
+    return stx->stx_mode & S_ISUID;
+  case 'g':
+    return stx->stx_mode & S_ISGID;
+  case 'k':
+    return stx->stx_mode & S_ISVTX;
+  case 'O':
+    return stx->stx_uid == geteuid();
+  case 'G':
+    return stx->stx_gid == getegid();
+  }
+
+  return false;
+} /* unary_test() */
+
+/*
+ *  Evaluate both sides of an arithmetic comparison
+ */
+
+static int compare_numbers(cond_state_t *state, char *lhs, char *rhs) {
+  long long left = 0;
+  long long right = 0;
+
+  if ((!evaluate_arithmetic(lhs, &left)) ||
+      (!evaluate_arithmetic(rhs, &right))) {
+    state->error = true;
+    return 0;
+  }
+
+  return (left > right) - (left < right);
+} /* compare_numbers() */
+
+/*
+ *  Evaluate the binary test at word index op_index
+ */
+
+static bool binary_test(cond_state_t *state, int op_index) {
+  const char *op = state->words->words[op_index];
+  char *lhs = operand(state, op_index - 1);
+  char *rhs = operand(state, op_index + 1);
+  bool rhs_quoted = state->words->quoted[op_index + 1];
+
+  if ((!strcmp(op, "==")) || (!strcmp(op, "=")) || (!strcmp(op, "!="))) {
+    bool matched = rhs_quoted ? (!strcmp(lhs, rhs))
+                              : glob_matches(rhs, lhs);
+
+    return (op[0] == '!') ? !matched : matched;
+  }
+
+  if (!strcmp(op, "=~")) {
+    if (rhs_quoted) {
+      return strstr(lhs, rhs) != NULL;
+    }
+
+    regex_t *re = compile_regex(rhs, REG_EXTENDED | REG_NOSUB);
+
+    if (re == NULL) {
+      cond_error(state, "invalid regular expression", rhs);
+      return false;
+    }
+
+    return regexec(re, lhs, 0, NULL, 0) == 0;
+  }
+
+  if (!strcmp(op, "<")) {
+    return strcmp(lhs, rhs) < 0;
+  }
+
+  if (!strcmp(op, ">")) {
+    return strcmp(lhs, rhs) > 0;
+  }
+
+  if ((!strcmp(op, "-nt")) || (!strcmp(op, "-ot")) || (!strcmp(op, "-ef"))) {
+    const struct statx *left = get_stat(state, lhs, true);
+    const struct statx *right = get_stat(state, rhs, true);
+
+    if (!strcmp(op, "-nt")) {
+      return (left != NULL) &&
+             ((right == NULL) || (compare_mtime(left, right) > 0));
+    }
+
+    if (!strcmp(op, "-ot")) {
+      return (right != NULL) &&
+             ((left == NULL) || (compare_mtime(left, right) < 0));
+    }
+
+    return (left != NULL) && (right != NULL) &&
+           (left->stx_dev_major == right->stx_dev_major) &&
+           (left->stx_dev_minor == right->stx_dev_minor) &&
+           (left->stx_ino == right->stx_ino);
+  }
+
+  int comparison = compare_numbers(state, lhs, rhs);
+
+  if (!strcmp(op, "-eq")) {
+    return comparison == 0;
+  } else if (!strcmp(op, "-ne")) {
+    return comparison != 0;
+  } else if (!strcmp(op, "-lt")) {
+    return comparison < 0;
+  } else if (!strcmp(op, "-le")) {
+    return comparison <= 0;
+  } else if (!strcmp(op, "-gt")) {
+    return comparison > 0;
+  }
+
+  return comparison >= 0;
+} /* binary_test() */
+
+/*
+ *  ( expression ), unary tests, binary tests and a lone word
+ */
+
+static bool parse_primary(cond_state_t *state, bool eval) {
+  int num_words = state->words->num_words;
+  int pos = state->pos;
+
+  if (pos >= num_words) {
+    cond_error(state, "expression expected", NULL);
+    return false;
+  }
+
+  if (is_operator(state, pos, "(")) {
+    state->pos++;
+
+    bool value = parse_or(state, eval);
+
+    if (!is_operator(state, state->pos, ")")) {
+      cond_error(state, "expected `)'", NULL);
+      return false;
+    }
+
+    state->pos++;
+    return value;
+  }
+
+  char *word = state->words->words[pos];
+
+  if ((!state->words->quoted[pos]) && (is_unary_operator(word)) &&
+      (pos + 1 < num_words)) {
+    state->pos += 2;
+    return eval ? unary_test(state, word[1], operand(state, pos + 1)) : false;
+  }
+
+  if ((pos + 1 < num_words) && (!state->words->quoted[pos + 1]) &&
+      (is_binary_operator(state->words->words[pos + 1]))) {
+    if (pos + 2 >= num_words) {
+      cond_error(state, "argument expected after",
+                 state->words->words[pos + 1]);
+      return false;
+    }
+
+    state->pos += 3;
+    return eval ? binary_test(state, pos + 1) : false;
+  }
+
+  state->pos++;
+  return eval ? (operand(state, pos)[0] != '\0') : false;
+} /* parse_primary() */
+
+/*
+ *  ! expression
+ */
+
+static bool parse_not(cond_state_t *state, bool eval) {
+  if (is_operator(state, state->pos, "!")) {
+    state->pos++;
+    return !parse_not(state, eval);
+  }
+
+  return parse_primary(state, eval);
+} /* parse_not() */
+
+/*
+ *  expression && expression, the right side is only evaluated
+ *  if the left side is true
+ */
+
+static bool parse_and(cond_state_t *state, bool eval) {
+  bool value = parse_not(state, eval);
+
+  while ((!state->error) && (is_operator(state, state->pos, "&&"))) {
+    state->pos++;
+
+    bool rhs = parse_not(state, eval && value);
+    value = value && rhs;
+  }
+
+  return value;
+} /* parse_and() */
+
+/*
+ *  expression || expression, the right side is only evaluated
+ *  if the left side is false
+ */
+
+static bool parse_or(cond_state_t *state, bool eval) {
+  bool value = parse_and(state, eval);
+
+  while ((!state->error) && (is_operator(state, state->pos, "||"))) {
+    state->pos++;
+
+    bool rhs = parse_and(state, eval && (!value));
+    value = value || rhs;
+  }
+
+  return value;
+} /* parse_or() */
+
+/*
+ *  Evaluate the words between [[ and ]]. Returns 0 if the expression
+ *  is true, 1 if it is false and 2 on a syntax error.
+ */
+
+int evaluate_conditional(single_command_t *words) {
+  cond_state_t state = {0};
+  arena_mark_t expand_mark = arena_mark(&g_expand_arena);
+
+  state.words = words;
+  state.expanded =
+      (char **)arena_alloc(&g_expand_arena, words->num_words * sizeof(char *));
+  memset(state.expanded, 0, words->num_words * sizeof(char *));
+
+  bool value = parse_or(&state, true);
+
+  if ((!state.error) && (state.pos < words->num_words)) {
+    cond_error(&state, "syntax error near", words->words[state.pos]);
+  }
+
+  arena_release(&g_expand_arena, expand_mark);
+
+  int cached = (state.num_paths > MAX_COND_PATHS) ? MAX_COND_PATHS
+                                                  : state.num_paths;
+
+  for (int i = 0; i < cached; i++) {
+    free(state.paths[i].path);
+  }
+
+  if (state.error) {
+    return 2;
+  }
+
+  return value ? 0 : 1;
+} /* evaluate_conditional() */
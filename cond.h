@@ -0,0 +1,17 @@
+#ifndef COND_H
+#define COND_H
+
+#include "single_command.h"
+
+// Conditional Command [[ ]]
+//
+// Evaluated in the shell. Each path is stat'd at most once per
+// evaluation, and =~ patterns come from the compiled regex cache.
+
+// Most paths whose stat results are kept during one evaluation
+
+#define MAX_COND_PATHS (16)
+
+int evaluate_conditional(single_command_t *words);
+
+#endif // COND_H
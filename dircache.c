@@ -0,0 +1,254 @@
+#define _GNU_SOURCE
+
+#include "dircache.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static cached_dir_t g_dir_cache[MAX_CACHED_DIRS];
+static unsigned long g_dir_clock = 0;
+static size_t g_dir_cache_bytes = 0;
+static unsigned long g_dir_generation = 0;
+
+// Counters reported by the stats builtin
+
+static unsigned long g_dir_hits = 0;
+static unsigned long g_dir_misses = 0;
+static unsigned long g_dir_invalidations = 0;
+static unsigned long g_dir_evictions = 0;
+
+/*
+ *  Empty a cache entry
+ */
+
+static void drop_entry(cached_dir_t *entry) {
+  g_dir_cache_bytes -= entry->size;
+  free(entry->names);
+  entry->names = NULL;
+  entry->types = NULL;
+  entry->num_names = 0;
+  entry->size = 0;
+  entry->last_used = 0;
+} /* drop_entry() */
+
+/*
+ *  True if a cached listing still matches the directory
+ */
+
+static bool entry_is_current(cached_dir_t *entry, struct stat *st) {
+  return (entry->mtime.tv_sec == st->st_mtim.tv_sec) &&
+         (entry->mtime.tv_nsec == st->st_mtim.tv_nsec) &&
+         (entry->ctime.tv_sec == st->st_ctim.tv_sec) &&
+         (entry->ctime.tv_nsec == st->st_ctim.tv_nsec) &&
+         (entry->read_time > st->st_ctim.tv_sec + 1);
+} /* entry_is_current() */
+
+/*
+ *  Read the names in the directory open as fd into one allocation
+ *  holding the pointer array, the d_type values and the strings.
+ */
+
+static char **list_directory(int fd, unsigned char **types, int *num_names,
+                             size_t *size) {
+  size_t max_data = 4096;
+  size_t data_size = 0;
+  char *data = (char *)malloc(max_data);
+  int count = 0;
+  char buffer[DIRCACHE_BUFFER_SIZE];
+  ssize_t length = 0;
+
+  // each name is stored after its type byte while reading
+
+  while ((data != NULL) &&
+         ((length = getdents64(fd, buffer, sizeof(buffer))) > 0)) {
+    for (ssize_t offset = 0; offset < length;) {
+      struct dirent64 *ent = (struct dirent64 *)(buffer + offset);
+      size_t name_size = strlen(ent->d_name) + 1;
+
+      offset += ent->d_reclen;
+
+      if (data_size + name_size + 1 > max_data) {
+        max_data *= 2;
+        data = (char *)realloc(data, max_data);
+
+        if (data == NULL) {
+          break;
+        }
+      }
+
+      data[data_size] = (char)ent->d_type;
+      memcpy(data + data_size + 1, ent->d_name, name_size);
+      data_size += name_size + 1;
+      count++;
+    }
+  }
+
+  *size = (count + 1) * sizeof(char *) + data_size;
+
+  char **names = (data == NULL) ? NULL : (char **)malloc(*size);
+
+  if (names == NULL) {
+    perror("malloc");
+    exit(1);
+  }
+
+  *types = (unsigned char *)(names + count + 1);
+
+  char *strings = (char *)(*types + count);
+  char *record = data;
+
+  for (int i = 0; i < count; i++) {
+    size_t name_size = strlen(record + 1) + 1;
+
+    (*types)[i] = (unsigned char)record[0];
+    memcpy(strings, record + 1, name_size);
+    names[i] = strings;
+    strings += name_size;
+    record += name_size + 1;
+  }
+
+  free(data);
+  names[count] = NULL;
+  *num_names = count;
+
+  return names;
+} /* list_directory() */
+
+/*
+ *  Return the names in the directory open as dirfd, including . and
+ *  .., and their d_type values, reading it only if the cached
+ *  listing is missing or stale. The arrays belong to the cache and
+ *  stay valid until the next call. Returns NULL if the directory
+ *  cannot be read. If generation is not NULL the generation of the
+ *  listing is stored in it.
+ */
+
+char **read_directory(int dirfd, unsigned char **types, int *num_names,
+                      unsigned long *generation) {
+  struct stat st;
+
+  if ((fstatat(dirfd, ".", &st, 0) != 0) || (!S_ISDIR(st.st_mode))) {
+    return NULL;
+  }
+
+  cached_dir_t *victim = &g_dir_cache[0];
+  cached_dir_t *entry = NULL;
+
+  for (int i = 0; i < MAX_CACHED_DIRS; i++) {
+    cached_dir_t *candidate = &g_dir_cache[i];
+
+    if ((candidate->last_used != 0) && (candidate->dev == st.st_dev) &&
+        (candidate->ino == st.st_ino)) {
+      entry = candidate;
+      break;
+    }
+
+    if (candidate->last_used < victim->last_used) {
+      victim = candidate;
+    }
+  }
+
+  if (entry != NULL) {
+    if (entry_is_current(entry, &st)) {
+      g_dir_hits++;
+      entry->last_used = ++g_dir_clock;
+      *types = entry->types;
+      *num_names = entry->num_names;
+
+      if (generation != NULL) {
+        *generation = entry->generation;
+      }
+
+      return entry->names;
+    }
+
+    g_dir_invalidations++;
+    drop_entry(entry);
+    victim = entry;
+  }
+
+  g_dir_misses++;
+
+  // read through a descriptor of its own, dirfd may be AT_FDCWD
+
+  int fd = openat(dirfd, ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+  if (fd == -1) {
+    return NULL;
+  }
+
+  size_t size = 0;
+  char **names = list_directory(fd, types, num_names, &size);
+
+  close(fd);
+
+  if (victim->last_used != 0) {
+    g_dir_evictions++;
+    drop_entry(victim);
+  }
+
+  // make room by evicting the least recently used listings, a
+  // listing too large to ever fit is still returned in the entry
+
+  while ((g_dir_cache_bytes + size > DIRCACHE_MAX_BYTES) &&
+         (g_dir_cache_bytes > 0)) {
+    cached_dir_t *oldest = NULL;
+
+    for (int i = 0; i < MAX_CACHED_DIRS; i++) {
+      if ((g_dir_cache[i].last_used != 0) &&
+          ((oldest == NULL) ||
+           (g_dir_cache[i].last_used < oldest->last_used))) {
+        oldest = &g_dir_cache[i];
+      }
+    }
+
+    g_dir_evictions++;
+    drop_entry(oldest);
+  }
+
+  victim->dev = st.st_dev;
+  victim->ino = st.st_ino;
+  victim->mtime = st.st_mtim;
+  victim->ctime = st.st_ctim;
+  victim->read_time = time(NULL);
+  victim->names = names;
+  victim->types = *types;
+  victim->num_names = *num_names;
+  victim->size = size;
+  victim->last_used = ++g_dir_clock;
+  victim->generation = ++g_dir_generation;
+  g_dir_cache_bytes += size;
+
+  if (generation != NULL) {
+    *generation = victim->generation;
+  }
+
+  return names;
+} /* read_directory() */
+
+/*
+ *  Print the directory cache counters
+ */
+
+void print_dircache_stats() {
+  int num_entries = 0;
+
+  for (int i = 0; i < MAX_CACHED_DIRS; i++) {
+    if (g_dir_cache[i].last_used != 0) {
+      num_entries++;
+    }
+  }
+
+  unsigned long lookups = g_dir_hits + g_dir_misses;
+
+  printf("dircache entries %d bytes %zu hits %lu misses %lu invalidated %lu "
+         "evicted %lu hit rate %.1f%%\n",
+         num_entries, g_dir_cache_bytes, g_dir_hits, g_dir_misses,
+         g_dir_invalidations, g_dir_evictions,
+         (lookups == 0) ? 0.0 : 100.0 * g_dir_hits / lookups);
+} /* print_dircache_stats() */
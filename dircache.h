@@ -0,0 +1,61 @@
+#ifndef DIRCACHE_H
+#define DIRCACHE_H
+
+#include <stddef.h>
+#include <sys/stat.h>
+#include <time.h>
+
+// Directory Listing Cache
+//
+// Wildcard expansion reads directories through this cache. Listings
+// are keyed by device and inode and reused while the directory's
+// mtime and ctime are unchanged, so expanding the same pattern in a
+// loop does not read the directory again. A listing read within a
+// second of the directory changing is not trusted, since another
+// change in the same timestamp tick would not be seen.
+
+#define MAX_CACHED_DIRS (64)
+
+// Most bytes of names kept over all cached listings
+
+#define DIRCACHE_MAX_BYTES (16 * 1024 * 1024)
+
+// Bytes read by one getdents64() call
+
+#define DIRCACHE_BUFFER_SIZE (32 * 1024)
+
+typedef struct cached_dir {
+  dev_t dev;
+  ino_t ino;
+  struct timespec mtime;
+  struct timespec ctime;
+
+  // When the listing was read
+
+  time_t read_time;
+
+  // Number of the read, different for every listing read, so a
+  // listing can be told from the one it replaced even when it is
+  // given the same address
+
+  unsigned long generation;
+
+  // Names and their d_type values point into the same allocation
+  // as the array
+
+  char **names;
+  unsigned char *types;
+  int num_names;
+  size_t size;
+
+  // Value of g_dir_clock when the entry was last used, 0 if the
+  // entry is empty
+
+  unsigned long last_used;
+} cached_dir_t;
+
+char **read_directory(int dirfd, unsigned char **types, int *num_names,
+                      unsigned long *generation);
+void print_dircache_stats();
+
+#endif // DIRCACHE_H
@@ -0,0 +1,551 @@
+#include "expand.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "arena.h"
+#include "arith.h"
+#include "shell.h"
+#include "tty_raw_mode.h"
+#include "vars.h"
+
+typedef struct expand_buffer {
+  char *data;
+  size_t length;
+  size_t size;
+
+  // When split, the output of a command substitution is split into
+  // fields at blanks and newlines, each field ends with a NUL
+
+  bool split;
+  size_t field_start;
+  int num_fields;
+  bool substituted;
+
+  // When the result is a glob pattern escapes are kept, and a
+  // backslash in an expanded value is escaped itself
+
+  bool keep_escapes;
+} expand_buffer_t;
+
+// Values that do not change while the shell runs, computed on first use
+
+static char *g_shell_path = NULL;
+static char g_shell_pid[16] = "";
+
+static char *expand(char *word, bool tilde, expand_buffer_t *buffer);
+
+/*
+ *  Make room for at least extra more bytes and the terminator
+ */
+
+static void reserve(expand_buffer_t *buffer, size_t extra) {
+  if (buffer->length + extra + 1 <= buffer->size) {
+    return;
+  }
+
+  size_t size = buffer->size * 2;
+
+  while (size < buffer->length + extra + 1) {
+    size *= 2;
+  }
+
+  char *data = (char *)arena_alloc(&g_expand_arena, size);
+  memcpy(data, buffer->data, buffer->length);
+
+  buffer->data = data;
+  buffer->size = size;
+} /* reserve() */
+
+/*
+ *  Append length bytes of text to the buffer
+ */
+
+static void append(expand_buffer_t *buffer, const char *text, size_t length) {
+  reserve(buffer, length);
+
+  memcpy(buffer->data + buffer->length, text, length);
+  buffer->length += length;
+} /* append() */
+
+/*
+ *  Append a string to the buffer, nothing if it is NULL
+ */
+
+static void append_string(expand_buffer_t *buffer, const char *text) {
+  if (text == NULL) {
+    return;
+  }
+
+  if (!buffer->keep_escapes) {
+    append(buffer, text, strlen(text));
+    return;
+  }
+
+  while (*text != '\0') {
+    size_t run = strcspn(text, "\\");
+
+    append(buffer, text, run);
+    text += run;
+
+    if (*text == '\\') {
+      append(buffer, "\\\\", 2);
+      text++;
+    }
+  }
+} /* append_string() */
+
+/*
+ *  Append a number to the buffer
+ */
+
+static void append_number(expand_buffer_t *buffer, long long number) {
+  char digits[32];
+  int length = snprintf(digits, sizeof(digits), "%lld", number);
+
+  append(buffer, digits, length);
+} /* append_number() */
+
+/*
+ *  Absolute path of the shell for ${SHELL}
+ */
+
+static char *shell_path() {
+  if (g_shell_path == NULL) {
+    g_shell_path = realpath(g_argv[0], NULL);
+
+    if (g_shell_path == NULL) {
+      g_shell_path = strdup(g_argv[0]);
+    }
+  }
+
+  return g_shell_path;
+} /* shell_path() */
+
+/*
+ *  Process id of the shell for ${$}
+ */
+
+static char *shell_pid() {
+  if (g_shell_pid[0] == '\0') {
+    snprintf(g_shell_pid, sizeof(g_shell_pid), "%d", getpid());
+  }
+
+  return g_shell_pid;
+} /* shell_pid() */
+
+/*
+ *  Append the value of the variable whose name is length bytes at name
+ */
+
+static void append_variable(expand_buffer_t *buffer, const char *name,
+                            size_t length) {
+  if (length == 1) {
+    switch (name[0]) {
+    case '$':
+      append_string(buffer, shell_pid());
+      return;
+    case '?':
+      append_number(buffer, g_last_status);
+      return;
+    case '!':
+      append_number(buffer, g_last_background_pid);
+      return;
+    case '_':
+      append_string(buffer, g_last_arg);
+      return;
+    }
+  }
+
+  if ((length == 5) && (!strncmp(name, "SHELL", 5))) {
+    append_string(buffer, shell_path());
+    return;
+  }
+
+  char short_name[64];
+  char *var_name = short_name;
+
+  if (length >= sizeof(short_name)) {
+    var_name = arena_alloc(&g_expand_arena, length + 1);
+  }
+
+  memcpy(var_name, name, length);
+  var_name[length] = '\0';
+
+  append_string(buffer, get_variable(var_name));
+} /* append_variable() */
+
+/*
+ *  Append the home directory for a ~ or ~user at the start of word,
+ *  returns where the rest of the word starts
+ */
+
+static char *expand_tilde(expand_buffer_t *buffer, char *word) {
+  size_t user_length = strcspn(word + 1, "/");
+
+  if (user_length == 0) {
+    append_string(buffer, get_variable("HOME"));
+  } else {
+    append_string(buffer, "/homes/");
+    append(buffer, word + 1, user_length);
+  }
+
+  return word + 1 + user_length;
+} /* expand_tilde() */
+
+/*
+ *  Index of the ')' closing the '(' at text[open], -1 if it is not
+ *  closed in text
+ */
+
+int matching_paren(char *text, int open) {
+  int depth = 0;
+
+  for (int i = open; text[i] != '\0'; ++i) {
+    if (text[i] == '(') {
+      ++depth;
+    } else if (text[i] == ')') {
+      --depth;
+
+      if (depth == 0) {
+        return i;
+      }
+    }
+  }
+
+  return -1;
+} /* matching_paren() */
+
+/*
+ *  Expand the $(( )) at the start of text if it is complete, returns
+ *  the length consumed or 0
+ */
+
+static size_t expand_arithmetic(expand_buffer_t *buffer, char *text) {
+  int close = matching_paren(text, 1);
+
+  if ((close == -1) || (text[close - 1] != ')') ||
+      (matching_paren(text, 2) != close - 1)) {
+    return 0;
+  }
+
+  // the expression may use ${name} and nested $(( )), but ~ is the
+  // bitwise not operator there
+
+  expand_buffer_t expression_buffer = {0};
+  char *expression =
+      expand(arena_strndup(&g_expand_arena, text + 3, close - 4), false,
+             &expression_buffer);
+  long long value = 0;
+
+  if (evaluate_arithmetic(expression, &value)) {
+    append_number(buffer, value);
+  } else {
+    g_last_status = 1;
+  }
+
+  return close + 1;
+} /* expand_arithmetic() */
+
+/*
+ *  Append the output of running command in a subshell, a fork of the
+ *  shell that runs it as source would, so the shell variables that
+ *  are not exported, like loop variables, are seen too
+ */
+
+static void append_output(expand_buffer_t *buffer, const char *command) {
+  int pout[2] = {-1, -1};
+
+  if (pipe(pout) == -1) {
+    perror("pipe");
+    exit(1);
+  }
+
+  // the subshell is waited for here, the SIGCHLD handler must not
+  // reap it first
+
+  sigset_t chld_mask;
+  sigset_t old_mask;
+
+  sigemptyset(&chld_mask);
+  sigaddset(&chld_mask, SIGCHLD);
+
+  if (sigprocmask(SIG_BLOCK, &chld_mask, &old_mask) == -1) {
+    perror("sigprocmask");
+    exit(1);
+  }
+
+  // nothing buffered may be written twice
+
+  fflush(NULL);
+  tty_cooked_mode();
+
+  int ret = fork();
+
+  if (ret == -1) {
+    perror("fork");
+    exit(1);
+  }
+
+  if (ret == 0) {
+    // child, the command is copied out of the expansion arena, which
+    // the commands it runs release, and ended like a line
+
+    size_t length = strlen(command);
+    char *text = (char *)malloc(length + 2);
+
+    if (text == NULL) {
+      perror("malloc");
+      exit(1);
+    }
+
+    memcpy(text, command, length);
+    strcpy(text + length, "\n");
+
+    if (dup2(pout[1], 1) == -1) {
+      perror("dup2");
+      exit(1);
+    }
+
+    if ((close(pout[0]) == -1) || (close(pout[1]) == -1)) {
+      perror("close");
+      exit(1);
+    }
+
+    if (sigprocmask(SIG_SETMASK, &old_mask, NULL) == -1) {
+      perror("sigprocmask");
+      exit(1);
+    }
+
+    source_string(text);
+    fflush(NULL);
+    exit(g_last_status);
+  }
+
+  if (close(pout[1]) == -1) {
+    perror("close");
+    exit(1);
+  }
+
+  // read it straight into the buffer
+
+  ssize_t count = 0;
+
+  do {
+    reserve(buffer, 4096);
+    count = read(pout[0], buffer->data + buffer->length, 4096);
+
+    if (count > 0) {
+      buffer->length += count;
+    }
+  } while ((count > 0) || ((count == -1) && (errno == EINTR)));
+
+  if (close(pout[0]) == -1) {
+    perror("close");
+    exit(1);
+  }
+
+  while ((waitpid(ret, NULL, 0) == -1) && (errno == EINTR)) {
+  }
+
+  if (sigprocmask(SIG_SETMASK, &old_mask, NULL) == -1) {
+    perror("sigprocmask");
+    exit(1);
+  }
+} /* append_output() */
+
+/*
+ *  Expand the $( ) at the start of text if it is closed, running it
+ *  each time the word is expanded. Trailing newlines of the output
+ *  are dropped. Returns the length consumed or 0
+ */
+
+static size_t expand_substitution(expand_buffer_t *buffer, char *text) {
+  int close = matching_paren(text, 1);
+
+  if (close == -1) {
+    return 0;
+  }
+
+  size_t start = buffer->length;
+
+  append_output(buffer, arena_strndup(&g_expand_arena, text + 2, close - 2));
+
+  while ((buffer->length > start) &&
+         (buffer->data[buffer->length - 1] == '\n')) {
+    buffer->length--;
+  }
+
+  buffer->substituted = true;
+
+  if ((!buffer->split) && (!buffer->keep_escapes)) {
+    return close + 1;
+  }
+
+  // the output is copied back, when split each run of blanks ends the
+  // field unless it is still empty, and each backslash is escaped
+
+  size_t length = buffer->length - start;
+  char *output = (char *)arena_alloc(&g_expand_arena, length);
+
+  memcpy(output, buffer->data + start, length);
+  buffer->length = start;
+  reserve(buffer, length * 2);
+
+  size_t end = start;
+
+  for (size_t i = 0; i < length; i++) {
+    char c = output[i];
+
+    if ((buffer->split) && ((c == ' ') || (c == '\t') || (c == '\n'))) {
+      if (end > buffer->field_start) {
+        buffer->data[end++] = '\0';
+        buffer->field_start = end;
+        buffer->num_fields++;
+      }
+    } else {
+      if ((buffer->keep_escapes) && (c == '\\')) {
+        buffer->data[end++] = '\\';
+      }
+
+      buffer->data[end++] = c;
+    }
+  }
+
+  buffer->length = end;
+
+  return close + 1;
+} /* expand_substitution() */
+
+/*
+ *  Expand a word in a single pass. Plain text between the characters
+ *  that start an expansion is found with strcspn and copied in bulk.
+ */
+
+static char *expand(char *word, bool tilde, expand_buffer_t *buffer) {
+  buffer->size = strlen(word) + 16;
+  buffer->data = arena_alloc(&g_expand_arena, buffer->size);
+
+  char *p = word;
+
+  if ((tilde) && (*p == '~')) {
+    p = expand_tilde(buffer, p);
+  }
+
+  while (*p != '\0') {
+    size_t run = strcspn(p, "$\\");
+
+    append(buffer, p, run);
+    p += run;
+
+    if (*p == '\0') {
+      break;
+    }
+
+    if (*p == '\\') {
+      // an escaped character is taken as is, still escaped in a pattern
+
+      if (p[1] != '\0') {
+        if (buffer->keep_escapes) {
+          append(buffer, p, 2);
+        } else {
+          append(buffer, p + 1, 1);
+        }
+        p += 2;
+      } else {
+        p++;
+      }
+      continue;
+    }
+
+    if (p[1] == '{') {
+      char *close = strchr(p + 2, '}');
+
+      if (close != NULL) {
+        append_variable(buffer, p + 2, close - (p + 2));
+        p = close + 1;
+        continue;
+      }
+    } else if ((p[1] == '(') && (p[2] == '(')) {
+      size_t consumed = expand_arithmetic(buffer, p);
+
+      if (consumed > 0) {
+        p += consumed;
+        continue;
+      }
+    }
+
+    if (p[1] == '(') {
+      size_t consumed = expand_substitution(buffer, p);
+
+      if (consumed > 0) {
+        p += consumed;
+        continue;
+      }
+    }
+
+    append(buffer, p, 1);
+    p++;
+  }
+
+  buffer->data[buffer->length] = '\0';
+
+  return buffer->data;
+} /* expand() */
+
+/*
+ *  Expand a word as typed into the word passed to the command
+ */
+
+char *expand_word(char *word) {
+  expand_buffer_t buffer = {0};
+
+  return expand(word, true, &buffer);
+} /* expand_word() */
+
+/*
+ *  Expand a word as typed into a glob pattern, which keeps its
+ *  escapes so that quoted characters match only themselves
+ */
+
+char *expand_pattern(char *word) {
+  expand_buffer_t buffer = {.keep_escapes = true};
+
+  return expand(word, true, &buffer);
+} /* expand_pattern() */
+
+/*
+ *  Expand a word as typed into the arguments it stands for, more than
+ *  one if a command substitution in it outputs several words, none if
+ *  all it has is a substitution that outputs nothing. The fields keep
+ *  their escapes for globbing, see remove_glob_escapes()
+ */
+
+char **expand_fields(char *word, int *num_fields) {
+  expand_buffer_t buffer = {.split = true, .keep_escapes = true};
+  char *fields = expand(word, true, &buffer);
+
+  *num_fields = buffer.num_fields + 1;
+
+  if ((buffer.substituted) && (buffer.length == buffer.field_start)) {
+    (*num_fields)--;
+  }
+
+  char **array =
+      (char **)arena_alloc(&g_expand_arena, (*num_fields + 1) * sizeof(char *));
+
+  for (int i = 0; i < *num_fields; i++) {
+    array[i] = fields;
+    fields += strlen(fields) + 1;
+  }
+
+  array[*num_fields] = NULL;
+
+  return array;
+} /* expand_fields() */
@@ -0,0 +1,20 @@
+#ifndef EXPAND_H
+#define EXPAND_H
+
+// Word Expansion
+//
+// Expands a word as typed into the word passed to the command in one
+// left to right pass: escapes, ${name} and special variables, $(( ))
+// arithmetic, $( ) command substitution and a leading ~. The result
+// is built in a buffer in the expansion arena that grows by doubling.
+// A substitution is run every time its word is expanded, so one in a
+// loop body runs on each iteration. Where a word stands for arguments
+// its output is split into fields at blanks and newlines. A word that
+// is a glob pattern keeps its escapes for the matcher.
+
+char *expand_word(char *word);
+char *expand_pattern(char *word);
+char **expand_fields(char *word, int *num_fields);
+int matching_paren(char *text, int open);
+
+#endif // EXPAND_H
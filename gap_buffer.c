@@ -0,0 +1,189 @@
+#include "gap_buffer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GAP_BUFFER_MIN_SIZE (256)
+
+/*
+ *  Grow the buffer so the gap holds at least length bytes, the text
+ *  after the gap moves to the end of the new allocation
+ */
+
+static void reserve_gap(gap_buffer_t *buffer, size_t length) {
+  if (buffer->gap_end - buffer->gap_start >= length) {
+    return;
+  }
+
+  size_t after = buffer->size - buffer->gap_end;
+  size_t needed = buffer->gap_start + length + after;
+  size_t size = (buffer->size == 0) ? GAP_BUFFER_MIN_SIZE : buffer->size;
+
+  while (size < needed) {
+    size *= 2;
+  }
+
+  buffer->text = (char *)realloc(buffer->text, size);
+
+  if (buffer->text == NULL) {
+    perror("realloc");
+    exit(1);
+  }
+
+  memmove(buffer->text + size - after, buffer->text + buffer->gap_end, after);
+  buffer->gap_end = size - after;
+  buffer->size = size;
+} /* reserve_gap() */
+
+/*
+ *  Insert text at the cursor and move the cursor past it
+ */
+
+void gap_insert(gap_buffer_t *buffer, const char *text, size_t length) {
+  reserve_gap(buffer, length);
+
+  memcpy(buffer->text + buffer->gap_start, text, length);
+  buffer->gap_start += length;
+  buffer->copy_valid = false;
+} /* gap_insert() */
+
+/*
+ *  Delete up to count characters before the cursor
+ */
+
+void gap_delete_backward(gap_buffer_t *buffer, size_t count) {
+  if (count > buffer->gap_start) {
+    count = buffer->gap_start;
+  }
+
+  buffer->gap_start -= count;
+  buffer->copy_valid = buffer->copy_valid && (count == 0);
+} /* gap_delete_backward() */
+
+/*
+ *  Delete up to count characters after the cursor
+ */
+
+void gap_delete_forward(gap_buffer_t *buffer, size_t count) {
+  if (count > buffer->size - buffer->gap_end) {
+    count = buffer->size - buffer->gap_end;
+  }
+
+  buffer->gap_end += count;
+  buffer->copy_valid = buffer->copy_valid && (count == 0);
+} /* gap_delete_forward() */
+
+/*
+ *  Move the cursor to position, at most the length of the text
+ */
+
+void gap_move(gap_buffer_t *buffer, size_t position) {
+  if (position > gap_length(buffer)) {
+    position = gap_length(buffer);
+  }
+
+  if (position < buffer->gap_start) {
+    size_t count = buffer->gap_start - position;
+
+    memmove(buffer->text + buffer->gap_end - count, buffer->text + position,
+            count);
+    buffer->gap_start -= count;
+    buffer->gap_end -= count;
+  } else if (position > buffer->gap_start) {
+    size_t count = position - buffer->gap_start;
+
+    memmove(buffer->text + buffer->gap_start, buffer->text + buffer->gap_end,
+            count);
+    buffer->gap_start += count;
+    buffer->gap_end += count;
+  }
+} /* gap_move() */
+
+/*
+ *  Replace the text, the cursor ends up after it
+ */
+
+void gap_set(gap_buffer_t *buffer, const char *text, size_t length) {
+  gap_clear(buffer);
+  gap_insert(buffer, text, length);
+} /* gap_set() */
+
+/*
+ *  Remove all the text, the allocation is kept
+ */
+
+void gap_clear(gap_buffer_t *buffer) {
+  buffer->gap_start = 0;
+  buffer->gap_end = buffer->size;
+  buffer->copy_valid = false;
+} /* gap_clear() */
+
+/*
+ *  Number of characters in the text
+ */
+
+size_t gap_length(const gap_buffer_t *buffer) {
+  return buffer->size - (buffer->gap_end - buffer->gap_start);
+} /* gap_length() */
+
+/*
+ *  Position of the cursor in the text
+ */
+
+size_t gap_cursor(const gap_buffer_t *buffer) {
+  return buffer->gap_start;
+} /* gap_cursor() */
+
+/*
+ *  Character at position, which must be less than the length
+ */
+
+char gap_char(const gap_buffer_t *buffer, size_t position) {
+  if (position < buffer->gap_start) {
+    return buffer->text[position];
+  }
+
+  return buffer->text[position + (buffer->gap_end - buffer->gap_start)];
+} /* gap_char() */
+
+/*
+ *  The text as one NUL terminated string, valid until the next
+ *  change. It is copied out of the buffer only if it changed since
+ *  the last call
+ */
+
+char *gap_text(gap_buffer_t *buffer) {
+  if (buffer->copy_valid) {
+    return buffer->copy;
+  }
+
+  size_t length = gap_length(buffer);
+
+  if (length + 1 > buffer->copy_size) {
+    buffer->copy_size = (buffer->copy_size == 0) ? GAP_BUFFER_MIN_SIZE
+                                                 : buffer->copy_size;
+
+    while (buffer->copy_size < length + 1) {
+      buffer->copy_size *= 2;
+    }
+
+    buffer->copy = (char *)realloc(buffer->copy, buffer->copy_size);
+
+    if (buffer->copy == NULL) {
+      perror("realloc");
+      exit(1);
+    }
+  }
+
+  if (length > 0) {
+    memcpy(buffer->copy, buffer->text, buffer->gap_start);
+    memcpy(buffer->copy + buffer->gap_start, buffer->text + buffer->gap_end,
+           buffer->size - buffer->gap_end);
+  }
+
+  buffer->copy[length] = '\0';
+  buffer->copy_valid = true;
+
+  return buffer->copy;
+} /* gap_text() */
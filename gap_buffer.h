@@ -0,0 +1,44 @@
+#ifndef GAP_BUFFER_H
+#define GAP_BUFFER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Gap Buffer
+//
+// The text of the line editor is kept in one allocation with a gap at
+// the cursor: the text before the cursor at the start, the text after
+// it at the end. Typing and deleting at the cursor only move the ends
+// of the gap, moving the cursor moves the characters between the old
+// and new position across the gap, and the allocation doubles when
+// the gap is used up. A contiguous, NUL terminated copy of the text
+// is made for the readers that need one, only after a change.
+
+typedef struct gap_buffer {
+  // The text is text[0, gap_start) followed by text[gap_end, size),
+  // the cursor is at gap_start
+
+  char *text;
+  size_t size;
+  size_t gap_start;
+  size_t gap_end;
+
+  // Copy returned by gap_text()
+
+  char *copy;
+  size_t copy_size;
+  bool copy_valid;
+} gap_buffer_t;
+
+void gap_insert(gap_buffer_t *buffer, const char *text, size_t length);
+void gap_delete_backward(gap_buffer_t *buffer, size_t count);
+void gap_delete_forward(gap_buffer_t *buffer, size_t count);
+void gap_move(gap_buffer_t *buffer, size_t position);
+void gap_set(gap_buffer_t *buffer, const char *text, size_t length);
+void gap_clear(gap_buffer_t *buffer);
+size_t gap_length(const gap_buffer_t *buffer);
+size_t gap_cursor(const gap_buffer_t *buffer);
+char gap_char(const gap_buffer_t *buffer, size_t position);
+char *gap_text(gap_buffer_t *buffer);
+
+#endif // GAP_BUFFER_H
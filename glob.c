@@ -0,0 +1,636 @@
+#include "glob.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct cached_glob {
+  char *pattern;
+  glob_pattern_t *glob;
+
+  // Value of g_glob_clock when the entry was last used, 0 if the
+  // entry is empty
+
+  unsigned long last_used;
+} cached_glob_t;
+
+static cached_glob_t g_glob_cache[MAX_CACHED_GLOBS];
+static unsigned long g_glob_clock = 0;
+
+static glob_pattern_t *parse_glob(const char *pattern);
+static bool match_pattern(const glob_pattern_t *glob, const char *string,
+                          size_t length);
+static bool match_tokens(const glob_token_t *tokens, int num_tokens,
+                         const char *string, size_t length);
+
+/*
+ *  Index of the ')' closing the group opened at index open, -1 if
+ *  the group is not closed
+ */
+
+static int group_end(const char *pattern, int open) {
+  int depth = 0;
+
+  for (int i = open; pattern[i] != '\0'; i++) {
+    if ((pattern[i] == '\\') && (pattern[i + 1] != '\0')) {
+      i++;
+    } else if (pattern[i] == '(') {
+      depth++;
+    } else if ((pattern[i] == ')') && (--depth == 0)) {
+      return i;
+    }
+  }
+
+  return -1;
+} /* group_end() */
+
+/*
+ *  True if word has an unquoted wildcard, bracket expression or
+ *  extglob group in it
+ */
+
+bool has_glob(const char *word) {
+  for (int i = 0; word[i] != '\0'; i++) {
+    if ((word[i] == '\\') && (word[i + 1] != '\0')) {
+      i++;
+    } else if ((word[i] == '*') || (word[i] == '?')) {
+      return true;
+    } else if ((word[i] == '[') && (strchr(word + i + 1, ']') != NULL)) {
+      return true;
+    } else if ((strchr("+@!", word[i]) != NULL) && (word[i + 1] == '(')) {
+      return true;
+    }
+  }
+
+  return false;
+} /* has_glob() */
+
+/*
+ *  Drop the backslashes quoting characters of word, in place, for a
+ *  word that is used as is rather than matched. Returns word.
+ */
+
+char *remove_glob_escapes(char *word) {
+  char *to = word;
+
+  for (char *from = word; *from != '\0'; from++) {
+    if ((*from == '\\') && (from[1] != '\0')) {
+      from++;
+    }
+
+    *to++ = *from;
+  }
+
+  *to = '\0';
+
+  return word;
+} /* remove_glob_escapes() */
+
+/*
+ *  Add c to the characters matched by a bracket expression
+ */
+
+static void set_class_bit(glob_token_t *token, unsigned char c) {
+  token->class_bits[c / 64] |= (uint64_t)1 << (c % 64);
+} /* set_class_bit() */
+
+/*
+ *  Add the characters of a named [:class:] to a bracket expression.
+ *  Returns false if the name is not a class.
+ */
+
+static bool add_named_class(glob_token_t *token, const char *name,
+                            size_t length) {
+  static const struct {
+    const char *name;
+    int (*is_member)(int);
+  } classes[] = {
+      {"alnum", isalnum}, {"alpha", isalpha}, {"blank", isblank},
+      {"cntrl", iscntrl}, {"digit", isdigit}, {"graph", isgraph},
+      {"lower", islower}, {"print", isprint}, {"punct", ispunct},
+      {"space", isspace}, {"upper", isupper}, {"xdigit", isxdigit},
+  };
+
+  for (size_t i = 0; i < sizeof(classes) / sizeof(classes[0]); i++) {
+    if ((strlen(classes[i].name) == length) &&
+        (!strncmp(classes[i].name, name, length))) {
+      for (int c = 1; c < 256; c++) {
+        if (classes[i].is_member(c)) {
+          set_class_bit(token, c);
+        }
+      }
+
+      return true;
+    }
+  }
+
+  return false;
+} /* add_named_class() */
+
+/*
+ *  Parse the bracket expression starting at index start into token.
+ *  Returns the index after its closing ']', -1 if it is not closed.
+ */
+
+static int parse_bracket(const char *pattern, int start, glob_token_t *token) {
+  int i = start + 1;
+  bool negate = false;
+
+  if ((pattern[i] == '!') || (pattern[i] == '^')) {
+    negate = true;
+    i++;
+  }
+
+  token->kind = GLOB_CLASS;
+  memset(token->class_bits, 0, sizeof(token->class_bits));
+
+  // a ']' right after the opening bracket is a member
+
+  for (bool first = true; pattern[i] != '\0'; first = false) {
+    if ((pattern[i] == ']') && (!first)) {
+      if (negate) {
+        for (int j = 0; j < 4; j++) {
+          token->class_bits[j] = ~token->class_bits[j];
+        }
+      }
+
+      return i + 1;
+    }
+
+    if ((pattern[i] == '[') && (pattern[i + 1] == ':')) {
+      const char *end = strstr(pattern + i + 2, ":]");
+
+      if ((end != NULL) &&
+          (add_named_class(token, pattern + i + 2, end - pattern - i - 2))) {
+        i = end - pattern + 2;
+        continue;
+      }
+    }
+
+    if ((pattern[i] == '\\') && (pattern[i + 1] != '\0')) {
+      i++;
+    }
+
+    unsigned char low = pattern[i++];
+    unsigned char high = low;
+
+    if ((pattern[i] == '-') && (pattern[i + 1] != ']') &&
+        (pattern[i + 1] != '\0')) {
+      i++;
+
+      if ((pattern[i] == '\\') && (pattern[i + 1] != '\0')) {
+        i++;
+      }
+
+      high = pattern[i++];
+    }
+
+    for (int c = low; c <= high; c++) {
+      set_class_bit(token, c);
+    }
+  }
+
+  return -1;
+} /* parse_bracket() */
+
+/*
+ *  Compile the alternatives between the parentheses at open and close
+ *  into a group token
+ */
+
+static void parse_group(const char *pattern, int open, int close,
+                        glob_token_t *token) {
+  token->kind = GLOB_GROUP;
+  token->num_alternatives = 0;
+  token->alternatives = NULL;
+
+  int depth = 0;
+  int start = open + 1;
+
+  for (int i = open + 1; i <= close; i++) {
+    if ((pattern[i] == '\\') && (i + 1 < close)) {
+      i++;
+      continue;
+    }
+
+    if (pattern[i] == '(') {
+      depth++;
+    } else if ((pattern[i] == ')') && (depth > 0)) {
+      depth--;
+    } else if (((pattern[i] == '|') && (depth == 0)) || (i == close)) {
+      char *alternative = strndup(pattern + start, i - start);
+
+      token->alternatives = (glob_pattern_t **)realloc(
+          token->alternatives,
+          (token->num_alternatives + 1) * sizeof(glob_pattern_t *));
+
+      if ((alternative == NULL) || (token->alternatives == NULL)) {
+        perror("malloc");
+        exit(1);
+      }
+
+      token->alternatives[token->num_alternatives++] = parse_glob(alternative);
+      free(alternative);
+      start = i + 1;
+    }
+  }
+} /* parse_group() */
+
+/*
+ *  Compile a pattern into tokens. Malformed brackets and groups are
+ *  taken as literal characters, so this never fails.
+ */
+
+static glob_pattern_t *parse_glob(const char *pattern) {
+  glob_pattern_t *glob = (glob_pattern_t *)calloc(1, sizeof(glob_pattern_t));
+  int max_tokens = strlen(pattern) + 1;
+
+  if (glob != NULL) {
+    glob->tokens = (glob_token_t *)malloc(max_tokens * sizeof(glob_token_t));
+  }
+
+  if ((glob == NULL) || (glob->tokens == NULL)) {
+    perror("malloc");
+    exit(1);
+  }
+
+  for (int i = 0; pattern[i] != '\0';) {
+    glob_token_t *token = &glob->tokens[glob->num_tokens];
+    char c = pattern[i];
+
+    memset(token, 0, sizeof(glob_token_t));
+
+    if ((strchr("?*+@!", c) != NULL) && (pattern[i + 1] == '(')) {
+      int close = group_end(pattern, i + 1);
+
+      if (close != -1) {
+        parse_group(pattern, i + 1, close, token);
+        token->c = c;
+        glob->num_tokens++;
+        i = close + 1;
+        continue;
+      }
+    }
+
+    if (c == '[') {
+      int next = parse_bracket(pattern, i, token);
+
+      if (next != -1) {
+        glob->num_tokens++;
+        i = next;
+        continue;
+      }
+    }
+
+    if (c == '*') {
+      // consecutive stars match the same as one
+
+      if ((glob->num_tokens == 0) || (token[-1].kind != GLOB_STAR)) {
+        token->kind = GLOB_STAR;
+        glob->num_tokens++;
+      }
+    } else if (c == '?') {
+      token->kind = GLOB_ANY;
+      glob->num_tokens++;
+    } else {
+      if ((c == '\\') && (pattern[i + 1] != '\0')) {
+        c = pattern[++i];
+      }
+
+      token->kind = GLOB_LITERAL;
+      token->c = c;
+      glob->num_tokens++;
+    }
+
+    i++;
+  }
+
+  // the literal prefix and suffix let most names be rejected
+  // without walking the tokens
+
+  int num_prefix = 0;
+  int num_suffix = 0;
+
+  while ((num_prefix < glob->num_tokens) &&
+         (glob->tokens[num_prefix].kind == GLOB_LITERAL)) {
+    num_prefix++;
+  }
+
+  while ((num_prefix + num_suffix < glob->num_tokens) &&
+         (glob->tokens[glob->num_tokens - num_suffix - 1].kind ==
+          GLOB_LITERAL)) {
+    num_suffix++;
+  }
+
+  glob->prefix = (char *)malloc(num_prefix + num_suffix + 2);
+
+  if (glob->prefix == NULL) {
+    perror("malloc");
+    exit(1);
+  }
+
+  glob->suffix = glob->prefix + num_prefix + 1;
+  glob->prefix_length = num_prefix;
+  glob->suffix_length = num_suffix;
+
+  for (int i = 0; i < num_prefix; i++) {
+    glob->prefix[i] = glob->tokens[i].c;
+  }
+
+  for (int i = 0; i < num_suffix; i++) {
+    glob->suffix[i] = glob->tokens[glob->num_tokens - num_suffix + i].c;
+  }
+
+  glob->prefix[num_prefix] = '\0';
+  glob->suffix[num_suffix] = '\0';
+
+  for (int i = 0; i < glob->num_tokens; i++) {
+    glob_token_t *token = &glob->tokens[i];
+
+    if (token->kind == GLOB_STAR) {
+      glob->variable_length = true;
+    } else if (token->kind == GLOB_GROUP) {
+      glob->variable_length = true;
+
+      if ((token->c == '@') || (token->c == '+')) {
+        size_t shortest = (size_t)-1;
+
+        for (int j = 0; j < token->num_alternatives; j++) {
+          if (token->alternatives[j]->min_length < shortest) {
+            shortest = token->alternatives[j]->min_length;
+          }
+        }
+
+        glob->min_length += shortest;
+      }
+    } else {
+      glob->min_length++;
+    }
+  }
+
+  return glob;
+} /* parse_glob() */
+
+/*
+ *  Free a compiled pattern and its groups
+ */
+
+static void free_glob(glob_pattern_t *glob) {
+  for (int i = 0; i < glob->num_tokens; i++) {
+    for (int j = 0; j < glob->tokens[i].num_alternatives; j++) {
+      free_glob(glob->tokens[i].alternatives[j]);
+    }
+
+    free(glob->tokens[i].alternatives);
+  }
+
+  free(glob->tokens);
+  free(glob->prefix);
+  free(glob);
+} /* free_glob() */
+
+/*
+ *  Return the compiled form of pattern, compiling it only if it is
+ *  not already cached. The pattern belongs to the cache and stays
+ *  valid until MAX_CACHED_GLOBS other patterns are compiled.
+ */
+
+glob_pattern_t *compile_glob(const char *pattern) {
+  cached_glob_t *victim = &g_glob_cache[0];
+
+  for (int i = 0; i < MAX_CACHED_GLOBS; i++) {
+    cached_glob_t *entry = &g_glob_cache[i];
+
+    if ((entry->last_used != 0) && (!strcmp(entry->pattern, pattern))) {
+      entry->last_used = ++g_glob_clock;
+      return entry->glob;
+    }
+
+    if (entry->last_used < victim->last_used) {
+      victim = entry;
+    }
+  }
+
+  char *copy = strdup(pattern);
+
+  if (copy == NULL) {
+    perror("strdup");
+    exit(1);
+  }
+
+  // evict the least recently used entry
+
+  if (victim->last_used != 0) {
+    free_glob(victim->glob);
+    free(victim->pattern);
+  }
+
+  victim->pattern = copy;
+  victim->glob = parse_glob(pattern);
+  victim->last_used = ++g_glob_clock;
+
+  return victim->glob;
+} /* compile_glob() */
+
+/*
+ *  True if one of the alternatives of a group matches the first
+ *  length characters of string
+ */
+
+static bool match_alternative(const glob_token_t *group, const char *string,
+                              size_t length) {
+  for (int i = 0; i < group->num_alternatives; i++) {
+    if (match_pattern(group->alternatives[i], string, length)) {
+      return true;
+    }
+  }
+
+  return false;
+} /* match_alternative() */
+
+/*
+ *  Match zero or more repetitions of group followed by the tokens
+ *  in rest
+ */
+
+static bool match_repeat(const glob_token_t *group, const glob_token_t *rest,
+                         int num_rest, const char *string, size_t length) {
+  if (match_tokens(rest, num_rest, string, length)) {
+    return true;
+  }
+
+  // each repetition takes at least one character, so this ends
+
+  for (size_t i = 1; i <= length; i++) {
+    if ((match_alternative(group, string, i)) &&
+        (match_repeat(group, rest, num_rest, string + i, length - i))) {
+      return true;
+    }
+  }
+
+  return false;
+} /* match_repeat() */
+
+/*
+ *  Match exactly one occurrence of group followed by the tokens in rest
+ */
+
+static bool match_once(const glob_token_t *group, const glob_token_t *rest,
+                       int num_rest, const char *string, size_t length) {
+  for (size_t i = 0; i <= length; i++) {
+    if ((match_alternative(group, string, i)) &&
+        (match_tokens(rest, num_rest, string + i, length - i))) {
+      return true;
+    }
+  }
+
+  return false;
+} /* match_once() */
+
+/*
+ *  Match tokens starting with a group against string, trying every
+ *  length for the part the group takes
+ */
+
+static bool match_group(const glob_token_t *tokens, int num_tokens,
+                        const char *string, size_t length) {
+  const glob_token_t *group = &tokens[0];
+  const glob_token_t *rest = tokens + 1;
+  int num_rest = num_tokens - 1;
+
+  switch (group->c) {
+  case '*':
+    return match_repeat(group, rest, num_rest, string, length);
+  case '+':
+    for (size_t i = 0; i <= length; i++) {
+      if ((match_alternative(group, string, i)) &&
+          (match_repeat(group, rest, num_rest, string + i, length - i))) {
+        return true;
+      }
+    }
+
+    return false;
+  case '!':
+    for (size_t i = 0; i <= length; i++) {
+      if ((!match_alternative(group, string, i)) &&
+          (match_tokens(rest, num_rest, string + i, length - i))) {
+        return true;
+      }
+    }
+
+    return false;
+  case '?':
+    return (match_tokens(rest, num_rest, string, length)) ||
+           (match_once(group, rest, num_rest, string, length));
+  default:
+    return match_once(group, rest, num_rest, string, length);
+  }
+} /* match_group() */
+
+/*
+ *  Match tokens against exactly length characters of string.
+ *  A star is retried one character longer whenever the tokens after
+ *  it fail, only the last star needs to be retried.
+ */
+
+static bool match_tokens(const glob_token_t *tokens, int num_tokens,
+                         const char *string, size_t length) {
+  int token_index = 0;
+  size_t string_index = 0;
+  int star_token = -1;
+  size_t star_string = 0;
+
+  while ((token_index < num_tokens) || (string_index < length)) {
+    if (token_index < num_tokens) {
+      const glob_token_t *token = &tokens[token_index];
+      unsigned char c = string[string_index];
+      bool have_char = (string_index < length);
+
+      switch (token->kind) {
+      case GLOB_STAR:
+        star_token = token_index++;
+        star_string = string_index;
+        continue;
+      case GLOB_GROUP:
+        if (match_group(token, num_tokens - token_index,
+                        string + string_index, length - string_index)) {
+          return true;
+        }
+        break;
+      case GLOB_LITERAL:
+        if ((have_char) && (c == token->c)) {
+          token_index++;
+          string_index++;
+          continue;
+        }
+        break;
+      case GLOB_ANY:
+        if (have_char) {
+          token_index++;
+          string_index++;
+          continue;
+        }
+        break;
+      case GLOB_CLASS:
+        if ((have_char) &&
+            (token->class_bits[c / 64] & ((uint64_t)1 << (c % 64)))) {
+          token_index++;
+          string_index++;
+          continue;
+        }
+        break;
+      }
+    }
+
+    if ((star_token == -1) || (star_string >= length)) {
+      return false;
+    }
+
+    token_index = star_token + 1;
+    string_index = ++star_string;
+  }
+
+  return true;
+} /* match_tokens() */
+
+/*
+ *  Match a compiled pattern against exactly length characters
+ */
+
+static bool match_pattern(const glob_pattern_t *glob, const char *string,
+                          size_t length) {
+  if ((length < glob->min_length) ||
+      ((!glob->variable_length) && (length != glob->min_length))) {
+    return false;
+  }
+
+  if ((memcmp(string, glob->prefix, glob->prefix_length)) ||
+      (memcmp(string + length - glob->suffix_length, glob->suffix,
+              glob->suffix_length))) {
+    return false;
+  }
+
+  return match_tokens(glob->tokens + glob->prefix_length,
+                      glob->num_tokens - glob->prefix_length -
+                          glob->suffix_length,
+                      string + glob->prefix_length,
+                      length - glob->prefix_length - glob->suffix_length);
+} /* match_pattern() */
+
+/*
+ *  True if the whole of string matches a compiled pattern
+ */
+
+bool match_glob(const glob_pattern_t *glob, const char *string) {
+  return match_pattern(glob, string, strlen(string));
+} /* match_glob() */
+
+/*
+ *  True if the whole of string matches pattern, compiled through
+ *  the cache
+ */
+
+bool glob_matches(const char *pattern, const char *string) {
+  return match_glob(compile_glob(pattern), string);
+} /* glob_matches() */
@@ -0,0 +1,68 @@
+#ifndef GLOB_H
+#define GLOB_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Glob Pattern Matcher
+//
+// Patterns support *, ?, [...] bracket expressions with ranges,
+// [:class:] and ! or ^ negation, and the extglob groups ?(a|b),
+// *(a|b), +(a|b), @(a|b) and !(a|b). A backslash quotes the next
+// character, and a word that is used as is has those removed first.
+// Patterns are compiled into tokens once and kept in a small least
+// recently used cache.
+
+#define MAX_CACHED_GLOBS (32)
+
+typedef enum glob_token_kind {
+  GLOB_LITERAL,
+  GLOB_ANY,
+  GLOB_STAR,
+  GLOB_CLASS,
+  GLOB_GROUP
+} glob_token_kind_t;
+
+struct glob_pattern;
+
+typedef struct glob_token {
+  glob_token_kind_t kind;
+
+  // Character of GLOB_LITERAL, or the operator ? * + @ ! of GLOB_GROUP
+
+  unsigned char c;
+
+  // Characters matched by GLOB_CLASS, negation already applied
+
+  uint64_t class_bits[4];
+
+  struct glob_pattern **alternatives;
+  int num_alternatives;
+} glob_token_t;
+
+typedef struct glob_pattern {
+  glob_token_t *tokens;
+  int num_tokens;
+
+  // Literal characters every match starts and ends with, checked
+  // before the tokens are walked
+
+  char *prefix;
+  size_t prefix_length;
+  char *suffix;
+  size_t suffix_length;
+
+  // Shortest match, and whether longer ones exist
+
+  size_t min_length;
+  bool variable_length;
+} glob_pattern_t;
+
+bool has_glob(const char *word);
+char *remove_glob_escapes(char *word);
+glob_pattern_t *compile_glob(const char *pattern);
+bool match_glob(const glob_pattern_t *glob, const char *string);
+bool glob_matches(const char *pattern, const char *string);
+
+#endif // GLOB_H
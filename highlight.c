@@ -0,0 +1,562 @@
+#include "highlight.h"
+
+#include <ctype.h>
+#include <limits.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "complete.h"
+#include "render.h"
+
+// The line highlighted last is in g_highlighters[g_current], the
+// other one receives the next line
+
+static highlighter_t g_highlighters[2];
+static int g_current = 0;
+
+static unsigned long g_chars_lexed = 0;
+static unsigned long g_chars_reused = 0;
+
+// Operators, longest first where one starts another
+
+static const char *g_operators[] = {">>&", "2>", ">&", ">>", "||", "&&", ";;",
+                                    "|",   "&",  ";",  ">",  "<",  "\n"};
+
+// Keywords after which a command comes
+
+static const char *g_command_keywords[] = {"if",    "then",  "else", "elif",
+                                           "while", "until", "do",   "!"};
+
+/*
+ *  True if the length bytes of word are keyword
+ */
+
+static bool is_word(const char *word, int length, const char *keyword) {
+  return ((int)strlen(keyword) == length) &&
+         (memcmp(word, keyword, length) == 0);
+} /* is_word() */
+
+/*
+ *  Length of the operator at start, 0 if there is none
+ */
+
+static int operator_length(const char *line, int length, int start) {
+  for (size_t i = 0; i < sizeof(g_operators) / sizeof(g_operators[0]); i++) {
+    int operator_length = strlen(g_operators[i]);
+
+    if ((start + operator_length <= length) &&
+        (memcmp(line + start, g_operators[i], operator_length) == 0)) {
+      return operator_length;
+    }
+  }
+
+  return 0;
+} /* operator_length() */
+
+/*
+ *  Length of the word at start, a quoted word runs to its closing
+ *  quote or the end of the line
+ */
+
+static int word_length(const char *line, int length, int start) {
+  int end = start;
+
+  if (line[start] == '"') {
+    const char *quote = memchr(line + start + 1, '"', length - start - 1);
+
+    return (quote != NULL) ? quote - (line + start) + 1 : length - start;
+  }
+
+  while (end < length) {
+    if ((line[end] == '\\') && (end + 1 < length)) {
+      end += 2;
+    } else if ((line[end] == ' ') || (line[end] == '\t') ||
+               (strchr("<>&|;\n", line[end]) != NULL)) {
+      break;
+    } else {
+      end++;
+    }
+  }
+
+  return end - start;
+} /* word_length() */
+
+/*
+ *  Length of the variable or substitution starting with the $ at
+ *  word[start]
+ */
+
+static int variable_length(const char *word, int length, int start) {
+  int end = start + 1;
+
+  if (end == length) {
+    return 1;
+  }
+
+  if ((word[end] == '{') || (word[end] == '(')) {
+    char open = word[end];
+    char close = (open == '{') ? '}' : ')';
+    int depth = 0;
+
+    for (; end < length; end++) {
+      if (word[end] == open) {
+        depth++;
+      } else if ((word[end] == close) && (--depth == 0)) {
+        return end - start + 1;
+      }
+    }
+
+    return length - start;
+  }
+
+  if (strchr("?#@*!$0123456789", word[end]) != NULL) {
+    return 2;
+  }
+
+  while ((end < length) &&
+         ((word[end] == '_') || isalnum((unsigned char)word[end]))) {
+    end++;
+  }
+
+  return end - start;
+} /* variable_length() */
+
+/*
+ *  Length of the case pattern at the start of the length bytes of
+ *  word, up to the ) that ends it, which is not one closing an
+ *  extglob group like @(a|b). Returns -1 if the word has no such )
+ */
+
+static int case_pattern_length(const char *word, int length) {
+  for (int i = 0; i < length; i++) {
+    if (word[i] == '\\') {
+      i++;
+    } else if ((strchr("?*+@!", word[i]) != NULL) && (i + 1 < length) &&
+               (word[i + 1] == '(')) {
+      int depth = 0;
+      int end = i + 1;
+
+      for (; end < length; end++) {
+        if (word[end] == '(') {
+          depth++;
+        } else if ((word[end] == ')') && (--depth == 0)) {
+          break;
+        }
+      }
+
+      if (end < length) {
+        i = end;
+      }
+    } else if (word[i] == ')') {
+      return i;
+    }
+  }
+
+  return -1;
+} /* case_pattern_length() */
+
+/*
+ *  Color a word, quoted words yellow and variables blue on top of
+ *  color
+ */
+
+static void color_word(const char *word, int length, unsigned char color,
+                       unsigned char *colors) {
+  if (word[0] == '"') {
+    color = RENDER_YELLOW;
+  }
+
+  memset(colors, color, length);
+
+  for (int i = 0; i < length; i++) {
+    if ((word[i] == '\\') && (word[0] != '"')) {
+      i++;
+    } else if (word[i] == '$') {
+      int variable = variable_length(word, length, i);
+
+      memset(colors + i, RENDER_BLUE, variable);
+      i += variable - 1;
+    }
+  }
+} /* color_word() */
+
+/*
+ *  True if the word names a builtin or an executable. Words with a /
+ *  are checked on disk, others in the command index
+ */
+
+static bool is_known_command(const char *word, int length) {
+  char name[PATH_MAX];
+  int name_length = 0;
+
+  if (length >= PATH_MAX) {
+    return false;
+  }
+
+  for (int i = 0; i < length; i++) {
+    if ((word[i] == '\\') && (i + 1 < length)) {
+      i++;
+    }
+
+    name[name_length++] = word[i];
+  }
+
+  name[name_length] = '\0';
+
+  if (strchr(name, '/') != NULL) {
+    struct stat file_stat = {0};
+
+    return (stat(name, &file_stat) == 0) && (!S_ISDIR(file_stat.st_mode)) &&
+           (access(name, X_OK) == 0);
+  }
+
+  return is_command(name);
+} /* is_known_command() */
+
+/*
+ *  Lex the token at start in state, writing its colors. Returns the
+ *  state after it and its length in token_length
+ */
+
+static highlight_state_t lex_token(const char *line, int length, int start,
+                                   highlight_state_t state, int *token_length,
+                                   unsigned char *colors) {
+  if ((line[start] == ' ') || (line[start] == '\t')) {
+    int end = start;
+
+    while ((end < length) && ((line[end] == ' ') || (line[end] == '\t'))) {
+      end++;
+    }
+
+    *token_length = end - start;
+    memset(colors + start, RENDER_DEFAULT, *token_length);
+    return state;
+  }
+
+  int operator = operator_length(line, length, start);
+
+  if (operator > 0) {
+    *token_length = operator;
+    memset(colors + start, (line[start] == '\n') ? RENDER_DEFAULT : RENDER_CYAN,
+           operator);
+
+    if ((line[start] == '<') || (memchr(line + start, '>', operator) != NULL)) {
+      // a redirection, the file name follows
+
+      if (state.position != HIGHLIGHT_REDIRECT) {
+        state.after_redirect = (state.position == HIGHLIGHT_COMMAND)
+                                   ? HIGHLIGHT_COMMAND
+                                   : HIGHLIGHT_ARGUMENT;
+      }
+
+      state.position = HIGHLIGHT_REDIRECT;
+    } else if (((state.position == HIGHLIGHT_CASE_IN) ||
+                (state.position == HIGHLIGHT_CASE_PATTERN)) &&
+               (line[start] == '\n')) {
+      // in and the first pattern can be on later rows
+    } else if ((state.position == HIGHLIGHT_CASE_PATTERN) &&
+               (operator == 1) && (line[start] == '|')) {
+      // another pattern of the same item follows
+    } else if ((operator == 2) && (line[start] == ';') &&
+               (line[start + 1] == ';')) {
+      state.position = HIGHLIGHT_CASE_PATTERN;
+    } else {
+      state.position = HIGHLIGHT_COMMAND;
+    }
+
+    return state;
+  }
+
+  const char *word = line + start;
+  int word_end = word_length(line, length, start);
+
+  *token_length = word_end;
+  unsigned char *word_colors = colors + start;
+
+  switch (state.position) {
+  case HIGHLIGHT_COMMAND:
+    for (size_t i = 0;
+         i < sizeof(g_command_keywords) / sizeof(g_command_keywords[0]);
+         i++) {
+      if (is_word(word, word_end, g_command_keywords[i])) {
+        memset(word_colors, RENDER_MAGENTA, word_end);
+        return state;
+      }
+    }
+
+    if (is_word(word, word_end, "fi") || is_word(word, word_end, "done") ||
+        is_word(word, word_end, "esac")) {
+      state.position = HIGHLIGHT_ARGUMENT;
+      memset(word_colors, RENDER_MAGENTA, word_end);
+    } else if (is_word(word, word_end, "for")) {
+      state.position = HIGHLIGHT_FOR_NAME;
+      memset(word_colors, RENDER_MAGENTA, word_end);
+    } else if (is_word(word, word_end, "case")) {
+      state.position = HIGHLIGHT_CASE_WORD;
+      memset(word_colors, RENDER_MAGENTA, word_end);
+    } else if (is_word(word, word_end, "[[")) {
+      state.position = HIGHLIGHT_COND;
+      memset(word_colors, RENDER_MAGENTA, word_end);
+    } else {
+      // a name that is expanded cannot be checked
+
+      unsigned char color = RENDER_DEFAULT;
+
+      if ((word[0] != '"') && (memchr(word, '$', word_end) == NULL)) {
+        color =
+            is_known_command(word, word_end) ? RENDER_GREEN : RENDER_RED;
+      }
+
+      state.position = HIGHLIGHT_ARGUMENT;
+      color_word(word, word_end, color, word_colors);
+    }
+    break;
+  case HIGHLIGHT_REDIRECT:
+    state.position = state.after_redirect;
+    color_word(word, word_end, RENDER_DEFAULT, word_colors);
+    break;
+  case HIGHLIGHT_FOR_NAME:
+    state.position = HIGHLIGHT_FOR_IN;
+    color_word(word, word_end, RENDER_DEFAULT, word_colors);
+    break;
+  case HIGHLIGHT_FOR_IN:
+  case HIGHLIGHT_CASE_IN:
+    if (is_word(word, word_end, "in")) {
+      state.position = (state.position == HIGHLIGHT_CASE_IN)
+                           ? HIGHLIGHT_CASE_PATTERN
+                           : HIGHLIGHT_ARGUMENT;
+      memset(word_colors, RENDER_MAGENTA, word_end);
+    } else {
+      state.position = HIGHLIGHT_ARGUMENT;
+      color_word(word, word_end, RENDER_DEFAULT, word_colors);
+    }
+    break;
+  case HIGHLIGHT_CASE_PATTERN:
+    if (is_word(word, word_end, "esac")) {
+      state.position = HIGHLIGHT_ARGUMENT;
+      memset(word_colors, RENDER_MAGENTA, word_end);
+      break;
+    }
+
+    // the ) ending the pattern is a token of its own, after which a
+    // command comes
+
+    int pattern_length = case_pattern_length(word, word_end);
+
+    if (pattern_length == 0) {
+      *token_length = 1;
+      state.position = HIGHLIGHT_COMMAND;
+      memset(word_colors, RENDER_CYAN, 1);
+      break;
+    }
+
+    if (pattern_length > 0) {
+      *token_length = pattern_length;
+    }
+
+    color_word(word, *token_length, RENDER_DEFAULT, word_colors);
+    break;
+  case HIGHLIGHT_CASE_WORD:
+    state.position = HIGHLIGHT_CASE_IN;
+    color_word(word, word_end, RENDER_DEFAULT, word_colors);
+    break;
+  case HIGHLIGHT_COND:
+    if (is_word(word, word_end, "]]")) {
+      state.position = HIGHLIGHT_ARGUMENT;
+      memset(word_colors, RENDER_MAGENTA, word_end);
+    } else {
+      color_word(word, word_end, RENDER_DEFAULT, word_colors);
+    }
+    break;
+  default:
+    color_word(word, word_end, RENDER_DEFAULT, word_colors);
+    break;
+  }
+
+  return state;
+} /* lex_token() */
+
+/*
+ *  Grow the buffers of a highlighter to hold a line of length
+ *  characters and its tokens
+ */
+
+static void reserve_highlighter(highlighter_t *highlighter, int length) {
+  if ((size_t)length + 1 > highlighter->size) {
+    highlighter->size = (highlighter->size == 0) ? 256 : highlighter->size;
+
+    while (highlighter->size < (size_t)length + 1) {
+      highlighter->size *= 2;
+    }
+
+    highlighter->line = (char *)realloc(highlighter->line, highlighter->size);
+    highlighter->colors =
+        (unsigned char *)realloc(highlighter->colors, highlighter->size);
+    highlighter->tokens = (highlight_token_t *)realloc(
+        highlighter->tokens, highlighter->size * sizeof(highlight_token_t));
+
+    if ((highlighter->line == NULL) || (highlighter->colors == NULL) ||
+        (highlighter->tokens == NULL)) {
+      perror("realloc");
+      exit(1);
+    }
+  }
+} /* reserve_highlighter() */
+
+/*
+ *  Colors of the length characters of line, as render_color_t
+ *  values. Only the tokens from the one the edit since the last call
+ *  touched up to where the old tokens line up again are lexed
+ */
+
+const unsigned char *highlight_line(const char *line, int length) {
+  highlighter_t *old = &g_highlighters[g_current];
+  highlighter_t *new = &g_highlighters[g_current ^ 1];
+
+  reserve_highlighter(old, 0);
+  reserve_highlighter(new, length);
+
+  // the characters before prefix and after suffix did not change
+
+  int prefix = 0;
+
+  while ((prefix < length) && (prefix < old->length) &&
+         (line[prefix] == old->line[prefix])) {
+    prefix++;
+  }
+
+  int suffix = 0;
+
+  while ((suffix < length - prefix) && (suffix < old->length - prefix) &&
+         (line[length - 1 - suffix] == old->line[old->length - 1 - suffix])) {
+    suffix++;
+  }
+
+  int delta = length - old->length;
+
+  // restart at the last token starting before the edit
+
+  int restart = 0;
+
+  while ((restart < old->num_tokens) &&
+         (old->tokens[restart].start < prefix)) {
+    restart++;
+  }
+
+  restart = (restart > 0) ? restart - 1 : 0;
+
+  int position = 0;
+  highlight_state_t state = {.position = HIGHLIGHT_COMMAND,
+                             .after_redirect = HIGHLIGHT_COMMAND};
+
+  if (restart < old->num_tokens) {
+    position = old->tokens[restart].start;
+    state = old->tokens[restart].state;
+  }
+
+  memcpy(new->tokens, old->tokens, restart * sizeof(highlight_token_t));
+  memcpy(new->colors, old->colors, position);
+  new->num_tokens = restart;
+
+  int old_token = restart;
+
+  while (position < length) {
+    if (position >= length - suffix) {
+      // in the unchanged end, reuse the old tokens once one starts
+      // here in the same state
+
+      int old_position = position - delta;
+
+      while ((old_token < old->num_tokens) &&
+             (old->tokens[old_token].start < old_position)) {
+        old_token++;
+      }
+
+      if ((old_token < old->num_tokens) &&
+          (old->tokens[old_token].start == old_position) &&
+          (memcmp(&old->tokens[old_token].state, &state, sizeof(state)) ==
+           0)) {
+        for (int i = old_token; i < old->num_tokens; i++) {
+          new->tokens[new->num_tokens] = old->tokens[i];
+          new->tokens[new->num_tokens].start += delta;
+          new->num_tokens++;
+        }
+
+        memcpy(new->colors + position, old->colors + old_position,
+               length - position);
+        g_chars_reused += length - position;
+        break;
+      }
+    }
+
+    int token_length = 0;
+    highlight_state_t next =
+        lex_token(line, length, position, state, &token_length, new->colors);
+
+    new->tokens[new->num_tokens++] =
+        (highlight_token_t){.start = position, .length = token_length,
+                            .state = state};
+    g_chars_lexed += token_length;
+    position += token_length;
+    state = next;
+  }
+
+  memcpy(new->line, line, length);
+  new->length = length;
+  g_current ^= 1;
+
+  return new->colors;
+} /* highlight_line() */
+
+/*
+ *  Number of if, case and loop blocks the line highlighted last
+ *  opens and does not close
+ */
+
+int highlight_open_blocks() {
+  const highlighter_t *highlighter = &g_highlighters[g_current];
+  int depth = 0;
+
+  for (int i = 0; i < highlighter->num_tokens; i++) {
+    const highlight_token_t *token = &highlighter->tokens[i];
+    const char *word = highlighter->line + token->start;
+
+    if (token->state.position == HIGHLIGHT_CASE_PATTERN) {
+      // esac in place of a pattern, after ;;
+
+      depth -= is_word(word, token->length, "esac");
+      continue;
+    }
+
+    if (token->state.position != HIGHLIGHT_COMMAND) {
+      continue;
+    }
+
+    if (is_word(word, token->length, "if") ||
+        is_word(word, token->length, "case") ||
+        is_word(word, token->length, "for") ||
+        is_word(word, token->length, "while") ||
+        is_word(word, token->length, "until")) {
+      depth++;
+    } else if (is_word(word, token->length, "fi") ||
+               is_word(word, token->length, "esac") ||
+               is_word(word, token->length, "done")) {
+      depth--;
+    }
+  }
+
+  return depth;
+} /* highlight_open_blocks() */
+
+/*
+ *  Print the highlighting counters
+ */
+
+void print_highlight_stats() {
+  printf("highlight chars lexed %lu reused %lu\n", g_chars_lexed,
+         g_chars_reused);
+} /* print_highlight_stats() */
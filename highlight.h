@@ -0,0 +1,65 @@
+#ifndef HIGHLIGHT_H
+#define HIGHLIGHT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Line Editor Syntax Highlighting
+//
+// The line being edited is split into tokens by a small tokenizer of
+// its own, which follows the shell's grammar only as far as coloring
+// needs: commands, keywords, operators and redirections, quoted
+// words and variables. The state at the start of each token is kept.
+// After an edit, lexing restarts at the token the edit touched and
+// stops as soon as it reaches a token boundary in the unchanged end
+// of the line in the same state as before; the tokens and colors
+// after it are moved over instead of lexed again. Command names are
+// checked against the command index of complete.c. The tokens also
+// tell the line editor whether the line leaves an if, a loop or a
+// case open, so Enter continues it on a new row.
+
+typedef enum highlight_position {
+  HIGHLIGHT_COMMAND,
+  HIGHLIGHT_ARGUMENT,
+  HIGHLIGHT_REDIRECT,
+  HIGHLIGHT_FOR_NAME,
+  HIGHLIGHT_FOR_IN,
+  HIGHLIGHT_CASE_WORD,
+  HIGHLIGHT_CASE_IN,
+  HIGHLIGHT_CASE_PATTERN,
+  HIGHLIGHT_COND
+} highlight_position_t;
+
+typedef struct highlight_state {
+  uint8_t position;
+
+  // Position after the file name of a redirection
+
+  uint8_t after_redirect;
+} highlight_state_t;
+
+typedef struct highlight_token {
+  int start;
+  int length;
+  highlight_state_t state;
+} highlight_token_t;
+
+typedef struct highlighter {
+  char *line;
+  int length;
+  unsigned char *colors;
+  highlight_token_t *tokens;
+  int num_tokens;
+
+  // Room in line, colors and tokens, every token is at least one
+  // character long
+
+  size_t size;
+} highlighter_t;
+
+const unsigned char *highlight_line(const char *line, int length);
+int highlight_open_blocks();
+void print_highlight_stats();
+
+#endif // HIGHLIGHT_H
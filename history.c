@@ -0,0 +1,440 @@
+#include "history.h"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "suggest.h"
+#include "vars.h"
+
+// Longest entry accepted from the file, a longer length means the
+// record is damaged
+
+#define HISTORY_MAX_LENGTH (64 * 1024)
+
+history_store_t g_history = {0};
+
+static history_file_t g_history_file = {.fd = -1};
+
+/*
+ *  Read a positive limit from a variable, or use the default
+ */
+
+static long history_limit(const char *name, long default_limit) {
+  char *value = get_variable(name);
+
+  if (value == NULL) {
+    return default_limit;
+  }
+
+  char *end = NULL;
+  long limit = strtol(value, &end, 10);
+
+  if ((end == value) || (*end != '\0') || (limit < 1)) {
+    fprintf(stderr, "%s: %s: not a positive number\n", name, value);
+    return default_limit;
+  }
+
+  return limit;
+} /* history_limit() */
+
+/*
+ *  Set up the ring and the hash set, sized from HISTSIZE and
+ *  HISTBYTES
+ */
+
+static void init_history_store() {
+  long capacity = history_limit("HISTSIZE", HISTORY_DEFAULT_SIZE);
+
+  if (capacity > (1 << 24)) {
+    capacity = 1 << 24;
+  }
+
+  g_history.capacity = capacity;
+  g_history.max_bytes = history_limit("HISTBYTES", HISTORY_DEFAULT_BYTES);
+  g_history.ring =
+      (history_entry_t **)calloc(capacity, sizeof(history_entry_t *));
+
+  g_history.table_size = 64;
+
+  while (g_history.table_size < capacity) {
+    g_history.table_size *= 2;
+  }
+
+  g_history.table = (history_entry_t **)calloc(g_history.table_size,
+                                               sizeof(history_entry_t *));
+
+  if ((g_history.ring == NULL) || (g_history.table == NULL)) {
+    perror("calloc");
+    exit(1);
+  }
+} /* init_history_store() */
+
+/*
+ *  FNV-1a hash of a line
+ */
+
+static unsigned long hash_line(const char *text) {
+  unsigned long hash = 2166136261u;
+
+  for (; *text != '\0'; text++) {
+    hash = (hash ^ (unsigned char)*text) * 16777619u;
+  }
+
+  return hash;
+} /* hash_line() */
+
+/*
+ *  Find the interned entry of a line, adding it if it is new
+ */
+
+static history_entry_t *intern_line(const char *text) {
+  unsigned long hash = hash_line(text);
+  history_entry_t **slot = &g_history.table[hash & (g_history.table_size - 1)];
+
+  for (history_entry_t *entry = *slot; entry != NULL; entry = entry->next) {
+    if ((entry->hash == hash) && (strcmp(entry->text, text) == 0)) {
+      return entry;
+    }
+  }
+
+  // the text shares the allocation of the entry
+
+  size_t length = strlen(text);
+  history_entry_t *entry =
+      (history_entry_t *)malloc(sizeof(history_entry_t) + length + 1);
+
+  if (entry == NULL) {
+    perror("malloc");
+    exit(1);
+  }
+
+  *entry = (history_entry_t){.text = (char *)(entry + 1),
+                             .length = length,
+                             .hash = hash,
+                             .next = *slot};
+  memcpy(entry->text, text, length + 1);
+
+  *slot = entry;
+  g_history.num_unique++;
+  g_history.bytes += sizeof(history_entry_t) + length + 1;
+
+  return entry;
+} /* intern_line() */
+
+/*
+ *  Drop the oldest entry of the ring, freeing its line when no other
+ *  slot holds it
+ */
+
+static void evict_history() {
+  history_entry_t *entry = g_history.ring[g_history.start % g_history.capacity];
+  g_history.ring[g_history.start % g_history.capacity] = NULL;
+  g_history.start++;
+
+  if (--entry->references > 0) {
+    return;
+  }
+
+  history_entry_t **link =
+      &g_history.table[entry->hash & (g_history.table_size - 1)];
+
+  while (*link != entry) {
+    link = &(*link)->next;
+  }
+
+  *link = entry->next;
+  remove_suggestion(entry);
+  g_history.num_unique--;
+  g_history.bytes -= sizeof(history_entry_t) + entry->length + 1;
+  free(entry);
+} /* evict_history() */
+
+/*
+ *  Append a line to the history, dropping the oldest entries past
+ *  the limits
+ */
+
+static void push_history(const char *text) {
+  if (g_history.ring == NULL) {
+    init_history_store();
+  }
+
+  history_entry_t *entry = intern_line(text);
+  entry->count++;
+  entry->last_used = time(NULL);
+  entry->last_number = g_history.end;
+  entry->references++;
+
+  if (g_history.end - g_history.start == g_history.capacity) {
+    evict_history();
+  }
+
+  g_history.ring[g_history.end % g_history.capacity] = entry;
+  g_history.end++;
+
+  while ((g_history.bytes > g_history.max_bytes) &&
+         (g_history.end - g_history.start > 1)) {
+    evict_history();
+  }
+
+  add_suggestion(entry);
+} /* push_history() */
+
+/*
+ *  Line of the entry numbered number, NULL if it is no longer kept
+ */
+
+const char *get_history(int number) {
+  if ((number < g_history.start) || (number >= g_history.end)) {
+    return NULL;
+  }
+
+  return g_history.ring[number % g_history.capacity]->text;
+} /* get_history() */
+
+/*
+ *  Bytes taken in the file by a record with length bytes of text
+ */
+
+static size_t record_size(uint32_t length) {
+  return sizeof(history_record_t) +
+         ((length + HISTORY_ALIGNMENT - 1) & ~(HISTORY_ALIGNMENT - 1));
+} /* record_size() */
+
+/*
+ *  Add the entries of the records in data to the history, after
+ *  skipping the first skip of them, and count them in num_entries.
+ *  Returns the bytes of whole records, a record still being written
+ *  is left for the next call
+ */
+
+static size_t scan_records(const char *data, size_t size, long skip,
+                           long *num_entries) {
+  size_t offset = 0;
+
+  while (offset + sizeof(history_record_t) <= size) {
+    history_record_t record = {0};
+    memcpy(&record, data + offset, sizeof(record));
+
+    if ((record.length > HISTORY_MAX_LENGTH) ||
+        ((record.magic != HISTORY_ENTRY_MAGIC) &&
+         (record.magic != HISTORY_HEADER_MAGIC))) {
+      // damaged, look for the next record
+
+      offset += HISTORY_ALIGNMENT;
+      continue;
+    }
+
+    size_t total = record_size(record.length);
+
+    if (offset + total > size) {
+      break;
+    }
+
+    const char *text = data + offset + sizeof(history_record_t);
+
+    // headers of shells that created the file at the same time
+    // are skipped
+
+    if ((record.magic == HISTORY_ENTRY_MAGIC) && (record.length > 0) &&
+        (text[record.length - 1] == '\0')) {
+      if (*num_entries >= skip) {
+        push_history(text);
+      }
+
+      (*num_entries)++;
+    }
+
+    offset += total;
+  }
+
+  return offset;
+} /* scan_records() */
+
+/*
+ *  Append a record with one write, so it is never interleaved with
+ *  the records of other shells
+ */
+
+static bool append_record(uint32_t magic, const char *text,
+                          uint32_t length) {
+  size_t total = record_size(length);
+  char *buffer = (char *)calloc(1, total);
+
+  if (buffer == NULL) {
+    perror("calloc");
+    exit(1);
+  }
+
+  history_record_t record = {.magic = magic, .length = length};
+  memcpy(buffer, &record, sizeof(record));
+  memcpy(buffer + sizeof(record), text, length);
+
+  ssize_t written = write(g_history_file.fd, buffer, total);
+  free(buffer);
+
+  if (written != (ssize_t)total) {
+    perror("write history");
+    return false;
+  }
+
+  return true;
+} /* append_record() */
+
+/*
+ *  Open the history file named by HISTFILE, or ~/.shell_history, and
+ *  load it. Without a usable file history is kept in memory only
+ */
+
+void open_history() {
+  char *path = get_variable("HISTFILE");
+  char *home_path = NULL;
+
+  if ((path == NULL) || (*path == '\0')) {
+    char *home = get_variable("HOME");
+
+    if (home == NULL) {
+      return;
+    }
+
+    home_path = (char *)malloc(strlen(home) + strlen(HISTORY_FILE_NAME) + 2);
+
+    if (home_path == NULL) {
+      perror("malloc");
+      exit(1);
+    }
+
+    sprintf(home_path, "%s/%s", home, HISTORY_FILE_NAME);
+    path = home_path;
+  }
+
+  int fd = open(path, O_RDWR | O_APPEND | O_CREAT | O_CLOEXEC, 0600);
+
+  if (fd == -1) {
+    perror(path);
+    free(home_path);
+    return;
+  }
+
+  if (g_history.ring == NULL) {
+    init_history_store();
+  }
+
+  g_history_file.fd = fd;
+
+  struct stat file_stat = {0};
+
+  if ((fstat(fd, &file_stat) == 0) && (file_stat.st_size == 0)) {
+    append_record(HISTORY_HEADER_MAGIC, "", 0);
+  }
+
+  history_record_t header = {0};
+
+  if ((fstat(fd, &file_stat) == -1) ||
+      (file_stat.st_size < (off_t)sizeof(header)) ||
+      (pread(fd, &header, sizeof(header), 0) != sizeof(header)) ||
+      (header.magic != HISTORY_HEADER_MAGIC)) {
+    fprintf(stderr, "%s: not a history file\n", path);
+    close(fd);
+    g_history_file.fd = -1;
+    free(home_path);
+    return;
+  }
+
+  free(home_path);
+
+  void *map = mmap(NULL, file_stat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+  if (map == MAP_FAILED) {
+    perror("mmap");
+    close(fd);
+    g_history_file.fd = -1;
+    return;
+  }
+
+  // count the entries, then load only the newest ones the ring holds
+
+  long num_entries = 0;
+  scan_records(map, file_stat.st_size, LONG_MAX, &num_entries);
+
+  long skip = num_entries - g_history.capacity;
+  num_entries = 0;
+  g_history_file.end =
+      scan_records(map, file_stat.st_size, (skip > 0) ? skip : 0, &num_entries);
+
+  munmap(map, file_stat.st_size);
+} /* open_history() */
+
+/*
+ *  Pick up the records appended since the file was last read, by this
+ *  shell or another one
+ */
+
+void update_history() {
+  if (g_history_file.fd == -1) {
+    return;
+  }
+
+  struct stat file_stat = {0};
+
+  if ((fstat(g_history_file.fd, &file_stat) == -1) ||
+      (file_stat.st_size <= g_history_file.end)) {
+    return;
+  }
+
+  size_t size = file_stat.st_size - g_history_file.end;
+  char *block = (char *)malloc(size);
+
+  if (block == NULL) {
+    perror("malloc");
+    exit(1);
+  }
+
+  ssize_t length = pread(g_history_file.fd, block, size, g_history_file.end);
+  long num_entries = 0;
+
+  if (length > 0) {
+    g_history_file.end += scan_records(block, length, 0, &num_entries);
+  }
+
+  free(block);
+} /* update_history() */
+
+/*
+ *  Save a line typed. It is appended to the file and read back with
+ *  anything other shells added in the meantime, so every shell sees
+ *  the same order
+ */
+
+void add_history(const char *line) {
+  if (*line == '\0') {
+    return;
+  }
+
+  if ((g_history_file.fd != -1) &&
+      append_record(HISTORY_ENTRY_MAGIC, line, strlen(line) + 1)) {
+    update_history();
+    return;
+  }
+
+  push_history(line);
+} /* add_history() */
+
+/*
+ *  Print the size of the history
+ */
+
+void print_history_stats() {
+  printf("history entries %d unique %d bytes %zu limit entries %d bytes %zu\n",
+         g_history.end - g_history.start, g_history.num_unique,
+         g_history.bytes + g_history.capacity * sizeof(history_entry_t *) +
+             g_history.table_size * sizeof(history_entry_t *),
+         g_history.capacity, g_history.max_bytes);
+} /* print_history_stats() */
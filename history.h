@@ -0,0 +1,108 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <time.h>
+
+// Shared History File
+//
+// History is kept in a log of records that is only ever appended to.
+// Each record is an 8 byte header, a magic number and the length of
+// the text, followed by the text with its NUL, padded to 8 bytes, and
+// is written with one write() on a descriptor opened with O_APPEND,
+// so shells sharing the file never interleave their lines. The first
+// record is a file header. On startup the file is mmap'd and the
+// record headers are walked, only the newest HISTSIZE entries are
+// loaded. Records appended later, by this shell or any other, are
+// picked up by reading only the bytes past the end of what was seen,
+// before each line is read.
+//
+// In memory the history is a ring of HISTSIZE entries, trimmed
+// further while the lines take more than HISTBYTES. Lines are
+// interned in a hash set, so a command entered many times is stored
+// once with a count of its uses. Entries are numbered from the first
+// one added, and g_history.start and g_history.end bound the numbers
+// still kept.
+
+#define HISTORY_FILE_NAME ".shell_history"
+
+// Limits used when HISTSIZE or HISTBYTES is not set
+
+#define HISTORY_DEFAULT_SIZE (50000)
+#define HISTORY_DEFAULT_BYTES (8 * 1024 * 1024)
+
+#define HISTORY_HEADER_MAGIC (0x31485348u)
+#define HISTORY_ENTRY_MAGIC (0x45485348u)
+#define HISTORY_ALIGNMENT (8)
+
+typedef struct history_record {
+  uint32_t magic;
+
+  // Bytes of text following the header, NUL included, not counting
+  // the padding
+
+  uint32_t length;
+} history_record_t;
+
+typedef struct history_file {
+  int fd;
+
+  // Bytes of the file that have been read into the history
+
+  off_t end;
+} history_file_t;
+
+typedef struct history_entry {
+  char *text;
+  size_t length;
+  unsigned long hash;
+
+  // Times the line was entered and the last time, as seen by this
+  // shell
+
+  unsigned long count;
+  time_t last_used;
+
+  // Number of its newest entry in the ring
+
+  int last_number;
+
+  // Ring slots holding the entry, it is freed when none is left
+
+  int references;
+
+  struct history_entry *next;
+} history_entry_t;
+
+typedef struct history_store {
+  history_entry_t **ring;
+  int capacity;
+  size_t max_bytes;
+
+  // Number of the oldest entry kept, and one past the newest
+
+  int start;
+  int end;
+
+  // Interned lines, chained by hash
+
+  history_entry_t **table;
+  int table_size;
+  int num_unique;
+
+  // Bytes of the interned entries
+
+  size_t bytes;
+} history_store_t;
+
+extern history_store_t g_history;
+
+void open_history();
+void update_history();
+void add_history(const char *line);
+const char *get_history(int number);
+void print_history_stats();
+
+#endif // HISTORY_H
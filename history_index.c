@@ -0,0 +1,445 @@
+#include "history_index.h"
+
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "history.h"
+
+// Most trigrams of a pattern looked up, and the longest literal run
+// taken from it, more only narrows the candidates further
+
+#define MAX_QUERY_TRIGRAMS (32)
+#define MAX_QUERY_RUN (64)
+
+static posting_list_t *g_trigrams = NULL;
+static int g_trigram_slots = 0;
+static int g_num_trigrams = 0;
+
+// Entries numbered below g_indexed_end are in the index, and no list
+// has entries below g_swept_start
+
+static int g_indexed_end = 0;
+static int g_swept_start = 0;
+
+/*
+ *  Pack three characters into a trigram
+ */
+
+static uint32_t pack_trigram(const char *text) {
+  return ((uint32_t)(unsigned char)text[0] << 16) |
+         ((uint32_t)(unsigned char)text[1] << 8) |
+         (uint32_t)(unsigned char)text[2];
+} /* pack_trigram() */
+
+/*
+ *  Slot of trigram in table, or the empty slot it would go in
+ */
+
+static posting_list_t *find_slot(posting_list_t *table, int slots,
+                                 uint32_t trigram) {
+  int i = (trigram * 2654435761u) & (slots - 1);
+
+  while ((table[i].trigram != 0) && (table[i].trigram != trigram)) {
+    i = (i + 1) & (slots - 1);
+  }
+
+  return &table[i];
+} /* find_slot() */
+
+/*
+ *  Double the trigram table
+ */
+
+static void grow_trigrams() {
+  int slots =
+      (g_trigram_slots == 0) ? INITIAL_TRIGRAM_SLOTS : 2 * g_trigram_slots;
+  posting_list_t *table =
+      (posting_list_t *)calloc(slots, sizeof(posting_list_t));
+
+  if (table == NULL) {
+    perror("calloc");
+    exit(1);
+  }
+
+  for (int i = 0; i < g_trigram_slots; i++) {
+    if (g_trigrams[i].trigram != 0) {
+      *find_slot(table, slots, g_trigrams[i].trigram) = g_trigrams[i];
+    }
+  }
+
+  free(g_trigrams);
+  g_trigrams = table;
+  g_trigram_slots = slots;
+} /* grow_trigrams() */
+
+/*
+ *  Drop the entries no longer in the history from a list
+ */
+
+static void prune_list(posting_list_t *list) {
+  int dropped = 0;
+
+  while ((dropped < list->num_entries) &&
+         (list->entries[dropped] < g_history.start)) {
+    dropped++;
+  }
+
+  if (dropped > 0) {
+    memmove(list->entries, list->entries + dropped,
+            (list->num_entries - dropped) * sizeof(int));
+    list->num_entries -= dropped;
+  }
+} /* prune_list() */
+
+/*
+ *  Record that entry contains trigram. Entries are added in order, so
+ *  each list stays sorted
+ */
+
+static void add_posting(uint32_t trigram, int entry) {
+  if (2 * (g_num_trigrams + 1) > g_trigram_slots) {
+    grow_trigrams();
+  }
+
+  posting_list_t *list = find_slot(g_trigrams, g_trigram_slots, trigram);
+
+  if (list->trigram == 0) {
+    list->trigram = trigram;
+    g_num_trigrams++;
+  }
+
+  if ((list->num_entries > 0) &&
+      (list->entries[list->num_entries - 1] == entry)) {
+    return;
+  }
+
+  if (list->num_entries == list->size) {
+    prune_list(list);
+  }
+
+  if (list->num_entries == list->size) {
+    list->size = (list->size == 0) ? 4 : 2 * list->size;
+    list->entries = (int *)realloc(list->entries, list->size * sizeof(int));
+
+    if (list->entries == NULL) {
+      perror("realloc");
+      exit(1);
+    }
+  }
+
+  list->entries[list->num_entries++] = entry;
+} /* add_posting() */
+
+/*
+ *  Index the entries added to the history since the last search. Once
+ *  as many entries as the history holds have been dropped, the
+ *  entries no longer kept are pruned from every list
+ */
+
+static void update_index() {
+  if (g_indexed_end < g_history.start) {
+    g_indexed_end = g_history.start;
+  }
+
+  for (; g_indexed_end < g_history.end; g_indexed_end++) {
+    const char *text = get_history(g_indexed_end);
+
+    for (int i = 0; (text[i] != '\0') && (text[i + 1] != '\0') &&
+                    (text[i + 2] != '\0');
+         i++) {
+      add_posting(pack_trigram(text + i), g_indexed_end);
+    }
+  }
+
+  if (g_history.start - g_swept_start >= g_history.capacity) {
+    for (int i = 0; i < g_trigram_slots; i++) {
+      prune_list(&g_trigrams[i]);
+    }
+
+    g_swept_start = g_history.start;
+  }
+} /* update_index() */
+
+/*
+ *  Index just past the bracket expression opened at index open
+ */
+
+static int skip_bracket(const char *pattern, int open) {
+  int i = open + 1;
+
+  if (pattern[i] == '^') {
+    i++;
+  }
+
+  if (pattern[i] == ']') {
+    i++;
+  }
+
+  while ((pattern[i] != '\0') && (pattern[i] != ']')) {
+    if ((pattern[i] == '[') && (pattern[i + 1] != '\0') &&
+        (strchr(":.=", pattern[i + 1]) != NULL)) {
+      char *close = strchr(pattern + i + 2, ']');
+
+      if (close == NULL) {
+        return strlen(pattern);
+      }
+
+      i = close - pattern;
+    }
+
+    i++;
+  }
+
+  return (pattern[i] == ']') ? i + 1 : i;
+} /* skip_bracket() */
+
+/*
+ *  Index just past the group opened at index open
+ */
+
+static int skip_group(const char *pattern, int open) {
+  int depth = 0;
+  int i = open;
+
+  while (pattern[i] != '\0') {
+    if ((pattern[i] == '\\') && (pattern[i + 1] != '\0')) {
+      i += 2;
+    } else if (pattern[i] == '[') {
+      i = skip_bracket(pattern, i);
+    } else if ((pattern[i] == ')') && (--depth == 0)) {
+      return i + 1;
+    } else {
+      if (pattern[i] == '(') {
+        depth++;
+      }
+      i++;
+    }
+  }
+
+  return i;
+} /* skip_group() */
+
+/*
+ *  Add the trigrams of a literal run to the query
+ */
+
+static void add_run(const char *run, int length, uint32_t *trigrams,
+                    int *num_trigrams) {
+  for (int i = 0; (i + 3 <= length) && (*num_trigrams < MAX_QUERY_TRIGRAMS);
+       i++) {
+    trigrams[(*num_trigrams)++] = pack_trigram(run + i);
+  }
+} /* add_run() */
+
+/*
+ *  Find the trigrams every match of the extended regular expression
+ *  must contain. Literal characters are collected into runs, and a
+ *  run ends at anything else: groups, bracket expressions, anchors
+ *  and any character a quantifier applies to. Returns false if the
+ *  pattern has a top level |, so no run is required
+ */
+
+static bool required_trigrams(const char *pattern, uint32_t *trigrams,
+                              int *num_trigrams) {
+  char run[MAX_QUERY_RUN];
+  int run_length = 0;
+  int i = 0;
+
+  *num_trigrams = 0;
+
+  while (pattern[i] != '\0') {
+    char c = pattern[i];
+    int next = i + 1;
+
+    if (c == '|') {
+      return false;
+    }
+
+    if (c == '\\') {
+      // escaped letters and digits are classes or back references
+      // and \< \> \` \' are anchors
+
+      c = pattern[i + 1];
+      next = i + 2;
+
+      if ((c == '\0') || isalnum((unsigned char)c) ||
+          (strchr("<>`'", c) != NULL)) {
+        add_run(run, run_length, trigrams, num_trigrams);
+        run_length = 0;
+        i = (c == '\0') ? i + 1 : i + 2;
+        continue;
+      }
+    } else if (strchr(".^$[()*?+{}", c) != NULL) {
+      add_run(run, run_length, trigrams, num_trigrams);
+      run_length = 0;
+
+      if (c == '[') {
+        i = skip_bracket(pattern, i);
+      } else if (c == '(') {
+        i = skip_group(pattern, i);
+      } else if (c == '{') {
+        char *close = strchr(pattern + i, '}');
+        i = (close == NULL) ? (int)strlen(pattern) : close - pattern + 1;
+      } else {
+        i++;
+      }
+      continue;
+    }
+
+    // a literal character, optional if followed by * ? or {, and
+    // not adjacent to what follows if followed by +
+
+    char quantifier = pattern[next];
+
+    if ((quantifier == '*') || (quantifier == '?') || (quantifier == '{')) {
+      add_run(run, run_length, trigrams, num_trigrams);
+      run_length = 0;
+    } else {
+      if (run_length == MAX_QUERY_RUN) {
+        add_run(run, run_length, trigrams, num_trigrams);
+        run_length = 0;
+      }
+
+      run[run_length++] = c;
+
+      if (quantifier == '+') {
+        add_run(run, run_length, trigrams, num_trigrams);
+        run_length = 0;
+      }
+    }
+
+    i = next;
+  }
+
+  add_run(run, run_length, trigrams, num_trigrams);
+
+  return true;
+} /* required_trigrams() */
+
+/*
+ *  True if the sorted list has entry
+ */
+
+static bool has_entry(const posting_list_t *list, int entry) {
+  int low = 0;
+  int high = list->num_entries;
+
+  while (low < high) {
+    int middle = low + (high - low) / 2;
+
+    if (list->entries[middle] < entry) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+
+  return (low < list->num_entries) && (list->entries[low] == entry);
+} /* has_entry() */
+
+/*
+ *  Position of the last entry of the sorted list not past start, -1
+ *  if there is none
+ */
+
+static int last_entry_at(const posting_list_t *list, int start) {
+  int low = 0;
+  int high = list->num_entries;
+
+  while (low < high) {
+    int middle = low + (high - low) / 2;
+
+    if (list->entries[middle] <= start) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+
+  return low - 1;
+} /* last_entry_at() */
+
+/*
+ *  Number of the newest history entry at or before start that re,
+ *  compiled from pattern, matches. Returns -1 if there is none
+ */
+
+int search_history_index(const char *pattern, regex_t *re, int start) {
+  update_index();
+
+  if (start >= g_history.end) {
+    start = g_history.end - 1;
+  }
+
+  uint32_t trigrams[MAX_QUERY_TRIGRAMS];
+  int num_trigrams = 0;
+
+  if (!required_trigrams(pattern, trigrams, &num_trigrams) ||
+      (num_trigrams == 0)) {
+    for (int j = start; j >= g_history.start; j--) {
+      if (regexec(re, get_history(j), 0, NULL, 0) == 0) {
+        return j;
+      }
+    }
+
+    return -1;
+  }
+
+  if (g_trigram_slots == 0) {
+    return -1;
+  }
+
+  // walk the shortest list and check the others for each entry
+
+  posting_list_t *lists[MAX_QUERY_TRIGRAMS];
+  int shortest = 0;
+
+  for (int i = 0; i < num_trigrams; i++) {
+    lists[i] = find_slot(g_trigrams, g_trigram_slots, trigrams[i]);
+
+    if (lists[i]->trigram == 0) {
+      return -1;
+    }
+
+    if (lists[i]->num_entries < lists[shortest]->num_entries) {
+      shortest = i;
+    }
+  }
+
+  for (int p = last_entry_at(lists[shortest], start); p >= 0; p--) {
+    int entry = lists[shortest]->entries[p];
+    bool candidate = true;
+
+    if (entry < g_history.start) {
+      break;
+    }
+
+    for (int i = 0; (i < num_trigrams) && candidate; i++) {
+      candidate = (i == shortest) || has_entry(lists[i], entry);
+    }
+
+    if (candidate && (regexec(re, get_history(entry), 0, NULL, 0) == 0)) {
+      return entry;
+    }
+  }
+
+  return -1;
+} /* search_history_index() */
+
+/*
+ *  Print the size of the trigram index
+ */
+
+void print_history_index_stats() {
+  size_t postings = 0;
+
+  for (int i = 0; i < g_trigram_slots; i++) {
+    postings += g_trigrams[i].size;
+  }
+
+  printf("history index trigrams %d bytes %zu\n", g_num_trigrams,
+         g_trigram_slots * sizeof(posting_list_t) + postings * sizeof(int));
+} /* print_history_index_stats() */
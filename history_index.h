@@ -0,0 +1,34 @@
+#ifndef HISTORY_INDEX_H
+#define HISTORY_INDEX_H
+
+#include <regex.h>
+#include <stdint.h>
+
+// History Trigram Index
+//
+// For every three character sequence in the history, the index keeps
+// the ascending list of the numbers of the entries containing it. A search pattern is
+// scanned for the literal runs every match must contain, and only
+// the entries in all the lists of their trigrams are tried with
+// regexec(). Patterns without such a run, like a.b or x|y, fall back
+// to trying every entry. The index is brought up to date with the
+// entries added since the last search, so it is never rebuilt, and
+// numbers of entries dropped from the history are pruned from it.
+
+#define INITIAL_TRIGRAM_SLOTS (4096)
+
+typedef struct posting_list {
+  // Three characters packed into the low 24 bits, 0 if the slot is
+  // empty
+
+  uint32_t trigram;
+
+  int *entries;
+  int num_entries;
+  int size;
+} posting_list_t;
+
+int search_history_index(const char *pattern, regex_t *re, int start);
+void print_history_index_stats();
+
+#endif // HISTORY_INDEX_H
@@ -0,0 +1,329 @@
+#include "key_input.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define PASTE_END "\033[201~"
+#define PASTE_END_LENGTH (6)
+
+typedef enum decode_state {
+  DECODE_ESCAPE,
+  DECODE_CSI,
+  DECODE_SS3
+} decode_state_t;
+
+static key_input_t g_input = {.wakeup = -1};
+
+/*
+ *  Make sure there is input in the buffer, reading everything the
+ *  terminal has with one read(). If timeout is not negative, give up
+ *  after that many milliseconds. Returns false at end of input or on
+ *  timeout
+ */
+
+static bool fill_input(int timeout) {
+  if (g_input.start < g_input.end) {
+    return true;
+  }
+
+  if (timeout >= 0) {
+    struct pollfd input = {.fd = 0, .events = POLLIN};
+
+    if (poll(&input, 1, timeout) <= 0) {
+      return false;
+    }
+  }
+
+  ssize_t result = 0;
+
+  do {
+    result = read(0, g_input.buffer, KEY_INPUT_BUFFER_SIZE);
+  } while ((result < 0) && (errno == EINTR));
+
+  if (result <= 0) {
+    return false;
+  }
+
+  g_input.start = 0;
+  g_input.end = result;
+  g_input.num_reads++;
+  g_input.num_bytes += result;
+
+  return true;
+} /* fill_input() */
+
+/*
+ *  Take the next input byte, -1 at end of input or on timeout
+ */
+
+static int next_byte(int timeout) {
+  if (!fill_input(timeout)) {
+    return -1;
+  }
+
+  return (unsigned char)g_input.buffer[g_input.start++];
+} /* next_byte() */
+
+/*
+ *  True for the characters inserted into the line as typed, which
+ *  include the bytes of multibyte UTF-8 characters
+ */
+
+static bool is_printable(int ch) {
+  return (ch >= 32) && (ch != 127);
+} /* is_printable() */
+
+/*
+ *  Append a byte to the paste being read
+ */
+
+static void paste_append(char ch) {
+  if (g_input.paste_length == g_input.paste_size) {
+    g_input.paste_size =
+        (g_input.paste_size == 0) ? KEY_INPUT_BUFFER_SIZE
+                                  : 2 * g_input.paste_size;
+    g_input.paste = (char *)realloc(g_input.paste, g_input.paste_size);
+
+    if (g_input.paste == NULL) {
+      perror("realloc");
+      exit(1);
+    }
+  }
+
+  g_input.paste[g_input.paste_length++] = ch;
+} /* paste_append() */
+
+/*
+ *  Read a bracketed paste up to ESC [ 201 ~. Control characters,
+ *  newlines included, become spaces so a paste never runs a command
+ *  by itself
+ */
+
+static void read_paste(key_event_t *key) {
+  g_input.paste_length = 0;
+
+  while (1) {
+    int ch = next_byte(-1);
+
+    if (ch < 0) {
+      break;
+    }
+
+    paste_append(ch);
+
+    if ((g_input.paste_length >= PASTE_END_LENGTH) &&
+        (memcmp(g_input.paste + g_input.paste_length - PASTE_END_LENGTH,
+                PASTE_END, PASTE_END_LENGTH) == 0)) {
+      g_input.paste_length -= PASTE_END_LENGTH;
+      break;
+    }
+  }
+
+  for (size_t i = 0; i < g_input.paste_length; i++) {
+    if (!is_printable((unsigned char)g_input.paste[i])) {
+      g_input.paste[i] = ' ';
+    }
+  }
+
+  g_input.num_pastes++;
+
+  key->kind = KEY_PASTE;
+  key->text = g_input.paste;
+  key->length = g_input.paste_length;
+} /* read_paste() */
+
+/*
+ *  Name the key of a CSI or SS3 sequence from its final character and
+ *  first numeric parameter
+ */
+
+static void decode_sequence(key_event_t *key, int final, int parameter) {
+  switch (final) {
+  case 'A':
+    key->kind = KEY_UP;
+    break;
+  case 'B':
+    key->kind = KEY_DOWN;
+    break;
+  case 'C':
+    key->kind = KEY_RIGHT;
+    break;
+  case 'D':
+    key->kind = KEY_LEFT;
+    break;
+  case 'H':
+    key->kind = KEY_HOME;
+    break;
+  case 'F':
+    key->kind = KEY_END;
+    break;
+  case '~':
+    if ((parameter == 1) || (parameter == 7)) {
+      key->kind = KEY_HOME;
+    } else if ((parameter == 4) || (parameter == 8)) {
+      key->kind = KEY_END;
+    } else if (parameter == 3) {
+      key->kind = KEY_DELETE;
+    } else if (parameter == 200) {
+      read_paste(key);
+    }
+    break;
+  default:
+    break;
+  }
+} /* decode_sequence() */
+
+/*
+ *  Decode the rest of a sequence started by ESC. A lone ESC, or one
+ *  whose sequence stops arriving, is the escape key
+ */
+
+static void decode_escape(key_event_t *key) {
+  decode_state_t state = DECODE_ESCAPE;
+  int parameter = 0;
+  bool first_parameter = true;
+
+  key->kind = KEY_UNKNOWN;
+
+  while (1) {
+    int ch = next_byte(KEY_ESCAPE_TIMEOUT);
+
+    if (ch < 0) {
+      if (state == DECODE_ESCAPE) {
+        key->kind = KEY_ESCAPE;
+      }
+      return;
+    }
+
+    switch (state) {
+    case DECODE_ESCAPE:
+      if (ch == '[') {
+        state = DECODE_CSI;
+      } else if (ch == 'O') {
+        state = DECODE_SS3;
+      } else {
+        // alt and another key, not bound
+
+        return;
+      }
+      break;
+    case DECODE_CSI:
+      if ((ch >= '0') && (ch <= '9')) {
+        if (first_parameter && (parameter < 10000)) {
+          parameter = parameter * 10 + (ch - '0');
+        }
+      } else if (ch == ';') {
+        // only the first parameter names the key, the others are
+        // modifiers
+
+        first_parameter = false;
+      } else if ((ch >= 0x40) && (ch <= 0x7e)) {
+        decode_sequence(key, ch, parameter);
+        return;
+      } else if ((ch < 0x20) || (ch > 0x3f)) {
+        // not part of a sequence
+
+        return;
+      }
+      break;
+    case DECODE_SS3:
+      decode_sequence(key, ch, 0);
+      return;
+    }
+  }
+} /* decode_escape() */
+
+/*
+ *  Wait for input or the wakeup descriptor. Returns true if the
+ *  wakeup descriptor is readable, after emptying it
+ */
+
+static bool wait_for_wakeup() {
+  if ((g_input.wakeup < 0) || (g_input.start < g_input.end)) {
+    return false;
+  }
+
+  struct pollfd inputs[2] = {{.fd = 0, .events = POLLIN},
+                             {.fd = g_input.wakeup, .events = POLLIN}};
+
+  int ready = 0;
+
+  do {
+    ready = poll(inputs, 2, -1);
+  } while ((ready < 0) && (errno == EINTR));
+
+  if ((inputs[1].revents & POLLIN) == 0) {
+    return false;
+  }
+
+  char buffer[64];
+  ssize_t count = 0;
+
+  do {
+    count = read(g_input.wakeup, buffer, sizeof(buffer));
+  } while (count > 0);
+
+  return true;
+} /* wait_for_wakeup() */
+
+/*
+ *  Read the next key typed. A run of printable characters that is
+ *  already in the buffer comes back as one KEY_TEXT
+ */
+
+void read_key(key_event_t *key) {
+  key->c = '\0';
+  key->text = NULL;
+  key->length = 0;
+
+  if (wait_for_wakeup()) {
+    key->kind = KEY_WAKEUP;
+    return;
+  }
+
+  int ch = next_byte(-1);
+
+  if (ch < 0) {
+    key->kind = KEY_EOF;
+  } else if (is_printable(ch)) {
+    size_t start = g_input.start - 1;
+
+    while ((g_input.start < g_input.end) &&
+           is_printable((unsigned char)g_input.buffer[g_input.start])) {
+      g_input.start++;
+    }
+
+    key->kind = KEY_TEXT;
+    key->text = g_input.buffer + start;
+    key->length = g_input.start - start;
+  } else if ((ch == 8) || (ch == 127)) {
+    key->kind = KEY_BACKSPACE;
+  } else if (ch == 27) {
+    decode_escape(key);
+  } else {
+    key->kind = KEY_CONTROL;
+    key->c = ch;
+  }
+} /* read_key() */
+
+/*
+ *  Watch fd while waiting for a key, -1 to stop. The descriptor must
+ *  be non-blocking
+ */
+
+void set_key_wakeup(int fd) {
+  g_input.wakeup = fd;
+} /* set_key_wakeup() */
+
+/*
+ *  Print the input counters
+ */
+
+void print_key_input_stats() {
+  printf("input reads %lu bytes %lu pastes %lu\n", g_input.num_reads,
+         g_input.num_bytes, g_input.num_pastes);
+} /* print_key_input_stats() */
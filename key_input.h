@@ -0,0 +1,87 @@
+#ifndef KEY_INPUT_H
+#define KEY_INPUT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Terminal Input Decoder
+//
+// Input is read from the terminal with one read() for everything that
+// is available and decoded into keys by a state machine that knows the
+// CSI (ESC [) and SS3 (ESC O) sequences. A run of printable
+// characters, the bytes of UTF-8 ones passed through unchanged, is
+// returned as one key, and a bracketed paste, the text between
+// ESC [ 200 ~ and ESC [ 201 ~, is returned whole, so either is
+// inserted and drawn once. While waiting for a key, a wakeup
+// descriptor can be watched too, for a key telling the line editor to
+// redraw.
+
+#define KEY_INPUT_BUFFER_SIZE (4096)
+
+// Milliseconds to wait for the rest of a sequence after ESC before it
+// is taken as the escape key by itself
+
+#define KEY_ESCAPE_TIMEOUT (50)
+
+#define BRACKETED_PASTE_ON "\033[?2004h"
+#define BRACKETED_PASTE_OFF "\033[?2004l"
+
+typedef enum key_kind {
+  KEY_TEXT,
+  KEY_PASTE,
+  KEY_CONTROL,
+  KEY_BACKSPACE,
+  KEY_DELETE,
+  KEY_UP,
+  KEY_DOWN,
+  KEY_LEFT,
+  KEY_RIGHT,
+  KEY_HOME,
+  KEY_END,
+  KEY_ESCAPE,
+  KEY_UNKNOWN,
+  KEY_WAKEUP,
+  KEY_EOF
+} key_kind_t;
+
+typedef struct key_event {
+  key_kind_t kind;
+
+  // Control character of KEY_CONTROL
+
+  char c;
+
+  // Characters of KEY_TEXT and KEY_PASTE, valid until the next key
+  // is read
+
+  const char *text;
+  size_t length;
+} key_event_t;
+
+typedef struct key_input {
+  char buffer[KEY_INPUT_BUFFER_SIZE];
+  size_t start;
+  size_t end;
+
+  // Text of the paste being read
+
+  char *paste;
+  size_t paste_length;
+  size_t paste_size;
+
+  // Descriptor that gives KEY_WAKEUP when readable, -1 for none
+
+  int wakeup;
+
+  // Counters reported by the stats builtin
+
+  unsigned long num_reads;
+  unsigned long num_bytes;
+  unsigned long num_pastes;
+} key_input_t;
+
+void read_key(key_event_t *key);
+void set_key_wakeup(int fd);
+void print_key_input_stats();
+
+#endif // KEY_INPUT_H
@@ -373,8 +373,8 @@ static void yynoreturn yy_fatal_error ( const char* msg  );
 		YY_FATAL_ERROR( "token too large, exceeds YYLMAX" ); \
 	yy_flex_strncpy( yytext, (yytext_ptr), yyleng + 1 ); \
 	(yy_c_buf_p) = yy_cp;
-#define YY_NUM_RULES 15
-#define YY_END_OF_BUFFER 16
+#define YY_NUM_RULES 19
+#define YY_END_OF_BUFFER 20
 /* This struct is not used in this scanner,
    but its presence is necessary. */
 struct yy_trans_info
@@ -382,13 +382,21 @@ struct yy_trans_info
 	flex_int32_t yy_verify;
 	flex_int32_t yy_nxt;
 	};
-static const flex_int16_t yy_accept[49] =
+static const flex_int16_t yy_accept[119] =
     {   0,
-        0,    0,   16,    3,    6,    5,    3,    3,   12,    3,
-       14,   13,    3,    3,    7,    3,    3,    3,    0,    2,
-        3,    3,    8,   10,   11,    3,    3,    3,    2,    3,
-        2,    3,    3,    0,    1,    3,    9,    3,    1,    3,
-        1,    3,    3,    3,    3,    0,    4,    0
+        0,    0,   20,    3,    6,    5,    3,    3,    3,   16,
+        3,   11,   18,   17,    3,    3,    7,    3,    3,    3,
+        3,    3,    0,    3,    2,    3,    3,    9,   12,   10,
+       14,   15,    3,    3,    3,    3,    3,    8,    3,    3,
+        3,    3,    3,    3,    3,    3,    3,    0,    2,    3,
+        3,    3,    3,    2,    3,    3,    0,    3,    1,    3,
+       13,    3,    3,    3,    3,    3,    0,    3,    3,    3,
+        3,    3,    3,    3,    3,    2,    3,    3,    0,    1,
+        3,    3,    3,    3,    1,    3,    3,    3,    3,    3,
+        3,    3,    3,    3,    3,    2,    3,    3,    3,    2,
+
+        3,    3,    3,    1,    3,    0,    3,    3,    3,    1,
+        3,    3,    1,    3,    0,    4,    4,    0
     } ;
 
 static const YY_CHAR yy_ec[256] =
@@ -396,17 +404,17 @@ static const YY_CHAR yy_ec[256] =
         1,    1,    1,    1,    1,    1,    1,    1,    2,    3,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
-        1,    4,    1,    5,    1,    6,    1,    7,    1,    8,
-        9,    1,    1,    1,    1,    1,    1,    1,    1,   10,
-        1,    1,    1,    1,    1,    1,    1,    1,    1,   11,
-        1,   12,    1,    1,    1,    1,    1,    1,    1,    1,
+        1,    4,    5,    6,    1,    7,    1,    8,    1,    9,
+       10,    5,    5,    1,    1,    1,    1,    1,    1,   11,
+        1,    1,    1,    1,    1,    1,    1,    1,   12,   13,
+        1,   14,    5,    5,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
-        1,   13,    1,    1,    1,    1,    1,    1,   14,    1,
+        1,   15,    1,    1,    1,    1,    1,    1,   16,    1,
 
-       15,    1,    1,    1,    1,    1,    1,    1,    1,    1,
-       16,    1,    1,   17,   18,    1,   19,    1,    1,    1,
-        1,    1,    1,   20,    1,    1,    1,    1,    1,    1,
+       17,    1,    1,    1,    1,    1,    1,    1,    1,    1,
+       18,    1,    1,   19,   20,    1,   21,    1,    1,    1,
+        1,    1,    1,   22,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
@@ -423,82 +431,657 @@ static const YY_CHAR yy_ec[256] =
         1,    1,    1,    1,    1
     } ;
 
-static const YY_CHAR yy_meta[21] =
+static const YY_CHAR yy_meta[23] =
     {   0,
-        1,    2,    3,    2,    1,    1,    2,    1,    1,    1,
-        2,    2,    1,    1,    1,    1,    1,    1,    1,    2
+        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
+        1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
+        1,    1
     } ;
 
-static const flex_int16_t yy_base[54] =
+static const flex_int16_t yy_base[119] =
     {   0,
-        0,    0,   81,   64,  154,  154,   20,   33,  154,   30,
-      154,   37,   48,   32,  154,   63,   67,    0,   70,    0,
-       87,  107,  154,  154,   66,   57,    0,   34,   62,    0,
-        0,    0,    0,   57,    0,  127,  154,   41,   56,    0,
-        0,    0,   43,   49,   59,    0,    0,  154,   50,  147,
-      149,  151,   22
+        1,   24,   47,   70,   93,  116,  139,  162,  185,  208,
+      231,  254,  277,  300,  323,  346,  369,  392,  415,  438,
+      461,  484,  507,  530,  553,  576,  599,  622,  645,  668,
+      691,  714,  737,  760,  783,  806,  829,  852,  875,  898,
+      921,  944,  967,  990, 1013, 1036, 1059, 1082, 1105, 1128,
+     1151, 1174, 1197, 1220, 1243, 1266, 1289, 1312, 1335, 1358,
+     1381, 1404, 1427, 1450, 1473, 1496, 1519, 1542, 1565, 1588,
+     1611, 1634, 1657, 1680, 1703, 1726, 1749, 1772, 1795, 1818,
+     1841, 1864, 1887, 1910, 1933, 1956, 1979, 2002, 2025, 2048,
+     2071, 2094, 2117, 2140, 2163, 2186, 2209, 2232, 2255, 2278,
+
+     2301, 2324, 2347, 2370, 2393, 2416, 2439, 2462, 2485, 2508,
+     2531, 2554, 2577, 2600, 2623, 2646, 2669, 2692
     } ;
 
-static const flex_int16_t yy_def[54] =
+static const flex_int16_t yy_def[119] =
     {   0,
-       48,    1,   48,   49,   48,   48,   48,   49,   48,   49,
-       48,   48,   50,   49,   48,   49,   50,    7,   51,    7,
-       48,   48,   48,   48,   48,   49,   17,   49,   51,    7,
-        7,   21,   22,   52,   22,   48,   48,   49,   52,   22,
-       22,   36,   49,   49,   49,   53,   53,    0,   48,   48,
-       48,   48,   48
+      118,  118,  118,  118,  118,  118,  118,  118,  118,  118,
+      118,  118,  118,  118,  118,  118,  118,  118,  118,  118,
+      118,  118,  118,  118,  118,  118,  118,  118,  118,  118,
+      118,  118,  118,  118,  118,  118,  118,  118,  118,  118,
+      118,  118,  118,  118,  118,  118,  118,  118,  118,  118,
+      118,  118,  118,  118,  118,  118,  118,  118,  118,  118,
+      118,  118,  118,  118,  118,  118,  118,  118,  118,  118,
+      118,  118,  118,  118,  118,  118,  118,  118,  118,  118,
+      118,  118,  118,  118,  118,  118,  118,  118,  118,  118,
+      118,  118,  118,  118,  118,  118,  118,  118,  118,  118,
+
+      118,  118,  118,  118,  118,  118,  118,  118,  118,  118,
+      118,  118,  118,  118,  118,  118,  118,    0
     } ;
 
-static const flex_int16_t yy_nxt[175] =
+static const flex_int16_t yy_nxt[2715] =
     {   0,
-        4,    5,    6,    5,    7,    8,    9,    4,    4,   10,
-       11,   12,   13,    4,    4,    4,    4,   14,    4,   15,
-       18,   19,   47,   19,   20,   18,   19,   18,   18,   18,
-       19,   19,   21,   18,   18,   18,   18,   18,   18,   19,
-       22,   23,   17,   24,   17,   17,   17,   28,   25,   16,
-       16,   16,   38,   17,   16,   17,   44,   43,   16,   16,
-       27,   17,   46,   45,   39,   39,   29,   16,   16,   17,
-       16,   17,   37,   16,   29,   17,   17,   16,   16,   27,
-       48,   48,   48,   48,   48,   48,   16,   30,   18,   48,
-       18,   31,   30,   18,   30,   30,   30,   18,   18,   32,
-
-       30,   30,   30,   30,   30,   30,   18,   33,   34,   48,
-       34,   33,   33,   34,   33,   35,   33,   34,   34,   36,
-       33,   33,   33,   33,   33,   33,   34,   40,   33,   48,
-       33,   40,   40,   33,   40,   41,   40,   33,   33,   42,
-       40,   40,   40,   40,   40,   40,   33,   26,   26,   19,
-       19,   34,   34,    3,   48,   48,   48,   48,   48,   48,
-       48,   48,   48,   48,   48,   48,   48,   48,   48,   48,
-       48,   48,   48,   48
+        3,    4,    5,    6,    5,    7,    8,    9,   10,    4,
+        4,   11,   12,   13,   14,   15,    4,    4,    4,    4,
+       16,    4,   17,    3,    4,    5,    6,    5,    7,    8,
+        9,   10,    4,    4,   11,   12,   13,   14,   15,    4,
+        4,    4,    4,   16,    4,   17,  118,  118,  118,  118,
+      118,  118,  118,  118,  118,  118,  118,  118,  118,  118,
+      118,  118,  118,  118,  118,  118,  118,  118,  118,    3,
+       18,  118,  118,  118,   19,   18,   18,  118,   18,   18,
+       18,  118,  118,  118,   20,   18,   18,   18,   18,   18,
+       18,  118,  118,  118,  118,  118,  118,  118,  118,  118,
+
+      118,  118,  118,  118,  118,  118,  118,  118,  118,  118,
+      118,  118,  118,  118,  118,  118,  118,  118,  118,  118,
+      118,  118,  118,  118,  118,  118,  118,  118,  118,  118,
+      118,  118,  118,  118,  118,  118,  118,  118,    3,   18,
+      118,  118,  118,   19,   18,   18,  118,   21,   18,   18,
+      118,  118,  118,   20,   18,   18,   18,   18,   18,   18,
+      118,    3,   22,   23,  118,   23,   24,   25,   22,   23,
+       22,   22,   22,   23,   23,   23,   26,   22,   22,   22,
+       22,   22,   22,   23,    3,   18,  118,  118,  118,   19,
+       18,   18,  118,   27,   18,   18,  118,  118,  118,   20,
+
+       18,   18,   18,   18,   18,   18,  118,    3,  118,  118,
+      118,  118,  118,  118,  118,   28,  118,  118,  118,  118,
+      118,  118,  118,  118,  118,  118,  118,  118,  118,  118,
+        3,   18,  118,  118,  118,   19,   18,   18,  118,   18,
+       18,   18,  118,  118,   29,   20,   18,   18,   18,   18,
+       18,   18,  118,    3,  118,  118,  118,  118,  118,  118,
+      118,  118,  118,  118,  118,   30,  118,  118,  118,  118,
+      118,  118,  118,  118,  118,  118,  118,  118,  118,  118,
+      118,  118,  118,  118,  118,  118,  118,  118,  118,  118,
+      118,  118,  118,  118,  118,  118,  118,  118,  118,    3,
+
+      118,  118,  118,  118,  118,  118,  118,   31,  118,  118,
+      118,  118,  118,   32,  118,  118,  118,  118,  118,  118,
+      118,  118,    3,   33,   34,  118,   34,   35,   33,   33,
+       34,   33,   33,   33,   34,   34,   34,   36,   33,   33,
+       33,   33,   33,   33,   34,    3,   18,  118,  118,  118,
+       19,   18,   18,  118,   18,   18,   18,  118,  118,  118,
+       20,   18,   18,   37,   18,   18,   18,  118,    3,  118,
+      118,  118,  118,  118,  118,  118,  118,  118,  118,  118,
+      118,  118,  118,  118,  118,  118,  118,  118,  118,  118,
+       38,    3,   18,  118,  118,  118,   19,   18,   18,  118,
+
+       18,   18,   18,  118,  118,  118,   20,   18,   18,   18,
+       18,   18,   18,  118,    3,   18,  118,  118,  118,   19,
+       18,   18,  118,   39,   18,   18,  118,  118,  118,   20,
+       18,   18,   18,   18,   18,   18,  118,    3,   40,   41,
+      118,   41,   42,   40,   40,   41,   40,   40,   40,   41,
+       41,   41,   43,   40,   40,   40,   40,   40,   40,   41,
+        3,   44,  118,  118,  118,   45,   44,   44,  118,   18,
+       46,   44,  118,  118,  118,   47,   44,   44,   44,   44,
+       44,   44,   48,    3,   22,   23,  118,   23,   24,   25,
+       22,   23,   22,   22,   22,   23,   23,   23,   26,   22,
+
+       22,   22,   22,   22,   22,   23,    3,   23,   23,  118,
+       23,   23,   49,   23,   23,   23,   23,   23,   23,   23,
+       23,   23,   23,   23,   23,   23,   23,   23,   23,    3,
+       22,   23,  118,   23,   24,   25,   22,   23,   50,   22,
+       22,   23,   23,   23,   26,   22,   22,   22,   22,   22,
+       22,   23,    3,   18,  118,  118,  118,   19,   18,   18,
+      118,   18,   18,   18,  118,  118,  118,   20,   18,   18,
+       18,   18,   18,   18,  118,    3,   51,   52,  118,   52,
+       53,   54,   51,   52,   51,   51,   51,   52,   52,   52,
+       55,   51,   51,   51,   51,   51,   51,   52,    3,   56,
+
+       57,  118,   57,   58,   56,   56,   57,   56,   59,   56,
+       57,   57,   57,   60,   56,   56,   56,   56,   56,   56,
+       57,  118,  118,  118,  118,  118,  118,  118,  118,  118,
+      118,  118,  118,  118,  118,  118,  118,  118,  118,  118,
+      118,  118,  118,  118,  118,  118,  118,  118,  118,  118,
+      118,  118,  118,  118,  118,  118,  118,  118,  118,  118,
+      118,  118,  118,  118,  118,  118,  118,  118,  118,  118,
+      118,  118,  118,  118,  118,  118,  118,  118,  118,  118,
+      118,  118,  118,  118,  118,  118,  118,  118,  118,  118,
+      118,  118,  118,  118,  118,  118,  118,  118,  118,  118,
+
+      118,  118,  118,  118,  118,  118,  118,  118,  118,  118,
+      118,  118,  118,    3,  118,  118,  118,  118,  118,  118,
+      118,   61,  118,  118,  118,  118,  118,  118,  118,  118,
+      118,  118,  118,  118,  118,  118,    3,   18,  118,  118,
+      118,   19,   18,   18,  118,   18,   18,   18,  118,  118,
+      118,   20,   18,   18,   18,   18,   18,   18,  118,    3,
+       18,  118,  118,  118,   19,   18,   18,  118,   18,   18,
+       18,  118,  118,  118,   20,   18,   18,   18,   18,   18,
+       18,  118,    3,   18,  118,  118,  118,   19,   18,   18,
+      118,   39,   18,   18,  118,  118,  118,   20,   18,   18,
+
+       18,   18,   18,   18,  118,    3,   40,   41,  118,   41,
+       42,   40,   40,   41,   40,   40,   40,   41,   41,   41,
+       43,   40,   40,   40,   40,   40,   40,   41,    3,   18,
+      118,  118,  118,   19,   18,   18,  118,   18,   18,   18,
+      118,  118,  118,   20,   18,   18,   18,   18,   18,   62,
+      118,  118,  118,  118,  118,  118,  118,  118,  118,  118,
+      118,  118,  118,  118,  118,  118,  118,  118,  118,  118,
+      118,  118,  118,  118,    3,   63,  118,  118,  118,   64,
+       63,   63,  118,   18,   65,   63,  118,  118,  118,   66,
+       63,   63,   63,   63,   63,   63,   67,    3,   18,  118,
+
+      118,  118,   19,   18,   18,  118,   18,   18,   18,  118,
+      118,  118,   20,   18,   18,   18,   18,   18,   18,  118,
+        3,   18,  118,  118,  118,   19,   18,   18,  118,   18,
+       18,   18,  118,  118,  118,   20,   18,   18,   18,   18,
+       18,   18,  118,    3,   18,  118,  118,  118,   19,   18,
+       18,  118,   39,   18,   18,  118,  118,  118,   20,   18,
+       18,   18,   18,   18,   18,  118,    3,   40,   41,  118,
+       41,   42,   40,   40,   41,   40,   40,   40,   41,   41,
+       41,   43,   40,   40,   40,   40,   40,   40,   41,    3,
+       44,  118,  118,  118,   45,   44,   44,  118,   18,   46,
+
+       44,  118,  118,  118,   47,   44,   44,   44,   44,   44,
+       44,   48,    3,   44,  118,  118,  118,   45,   44,   44,
+      118,   39,   46,   44,  118,  118,  118,   47,   44,   44,
+       44,   44,   44,   44,   48,    3,   18,  118,  118,  118,
+       19,   18,   18,  118,   18,   18,   18,  118,  118,  118,
+       20,   18,   18,   18,   18,   18,   18,  118,    3,   68,
+       41,  118,   41,   69,   68,   68,   41,   40,   70,   68,
+       41,   41,   41,   71,   68,   68,   68,   68,   68,   68,
+       72,    3,   48,  118,  118,  118,   48,   48,   48,  118,
+      118,   73,   48,  118,  118,  118,   48,   48,   48,   48,
+
+       48,   48,   48,   48,  118,  118,  118,  118,  118,  118,
+      118,  118,  118,  118,  118,  118,  118,  118,  118,  118,
+      118,  118,  118,  118,  118,  118,  118,    3,   74,   23,
+      118,   23,   75,   76,   74,   23,   22,   77,   74,   23,
+       23,   23,   78,   74,   74,   74,   74,   74,   74,   79,
+        3,   22,   23,  118,   23,   24,   25,   22,   23,   22,
+       22,   22,   23,   23,   23,   26,   22,   22,   22,   22,
+       22,   22,   23,    3,   22,   23,  118,   23,   24,   25,
+       22,   23,   22,   22,   22,   23,   23,   23,   26,   22,
+       22,   22,   22,   22,   22,   23,    3,   22,   23,  118,
+
+       23,   24,   25,   22,   23,   50,   22,   22,   23,   23,
+       23,   26,   22,   22,   22,   22,   22,   22,   23,    3,
+       18,  118,  118,  118,   19,   18,   18,  118,   18,   18,
+       18,  118,  118,  118,   20,   18,   18,   18,   18,   18,
+       18,  118,    3,   51,   52,  118,   52,   53,   54,   51,
+       52,   51,   51,   51,   52,   52,   52,   55,   51,   51,
+       51,   51,   51,   51,   52,    3,   56,   57,  118,   57,
+       58,   56,   56,   57,   56,   59,   56,   57,   57,   57,
+       60,   56,   56,   56,   56,   56,   56,   57,    3,   57,
+       57,  118,   57,   57,   57,   57,   57,   57,   80,   57,
+
+       57,   57,   57,   57,   57,   57,   57,   57,   57,   57,
+       57,    3,   56,   57,  118,   57,   58,   56,   56,   57,
+       81,   59,   56,   57,   57,   57,   60,   56,   56,   56,
+       56,   56,   56,   57,    3,   56,   57,  118,   57,   58,
+       56,   56,   57,   56,   59,   56,   57,   57,   57,   60,
+       56,   56,   56,   56,   56,   56,   57,    3,   82,   83,
+      118,   83,   84,   82,   82,   83,   82,   85,   82,   83,
+       83,   83,   86,   82,   82,   82,   82,   82,   82,   83,
+      118,  118,  118,  118,  118,  118,  118,  118,  118,  118,
+      118,  118,  118,  118,  118,  118,  118,  118,  118,  118,
+
+      118,  118,  118,    3,   18,  118,  118,  118,   19,   18,
+       18,  118,   18,   18,   18,  118,  118,  118,   20,   18,
+       18,   18,   87,   18,   18,  118,    3,   63,  118,  118,
+      118,   64,   63,   63,  118,   18,   65,   63,  118,  118,
+      118,   66,   63,   63,   63,   63,   63,   63,   67,    3,
+       63,  118,  118,  118,   64,   63,   63,  118,   39,   65,
+       63,  118,  118,  118,   66,   63,   63,   63,   63,   63,
+       63,   67,    3,   18,  118,  118,  118,   19,   18,   18,
+      118,   18,   18,   18,  118,  118,  118,   20,   18,   18,
+       18,   18,   18,   18,  118,    3,   88,   41,  118,   41,
+
+       89,   88,   88,   41,   40,   90,   88,   41,   41,   41,
+       91,   88,   88,   88,   88,   88,   88,   92,    3,   67,
+      118,  118,  118,   67,   67,   67,  118,  118,   93,   67,
+      118,  118,  118,   67,   67,   67,   67,   67,   67,   67,
+       67,    3,   44,  118,  118,  118,   45,   44,   44,  118,
+       18,   46,   44,  118,  118,  118,   47,   44,   44,   44,
+       44,   44,   44,   48,    3,   44,  118,  118,  118,   45,
+       44,   44,  118,   39,   46,   44,  118,  118,  118,   47,
+       44,   44,   44,   44,   44,   44,   48,    3,   18,  118,
+      118,  118,   19,   18,   18,  118,   18,   18,   18,  118,
+
+      118,  118,   20,   18,   18,   18,   18,   18,   18,  118,
+        3,   68,   41,  118,   41,   69,   68,   68,   41,   40,
+       70,   68,   41,   41,   41,   71,   68,   68,   68,   68,
+       68,   68,   72,    3,   44,  118,  118,  118,   45,   44,
+       44,  118,   18,   46,   44,  118,  118,  118,   47,   44,
+       44,   44,   44,   44,   44,   48,    3,   18,  118,  118,
+      118,   19,   18,   18,  118,   18,   18,   18,  118,  118,
+      118,   20,   18,   18,   18,   18,   18,   18,  118,    3,
+       74,   23,  118,   23,   75,   76,   74,   23,   22,   77,
+       74,   23,   23,   23,   78,   74,   74,   74,   74,   74,
+
+       74,   79,    3,   74,   23,  118,   23,   75,   76,   74,
+       23,   50,   77,   74,   23,   23,   23,   78,   74,   74,
+       74,   74,   74,   74,   79,    3,   63,  118,  118,  118,
+       64,   63,   63,  118,   18,   65,   63,  118,  118,  118,
+       66,   63,   63,   63,   63,   63,   63,   67,    3,   22,
+       23,  118,   23,   24,   25,   22,   23,   22,   22,   22,
+       23,   23,   23,   26,   22,   22,   22,   22,   22,   22,
+       23,    3,   94,   52,  118,   52,   95,   96,   94,   52,
+       51,   97,   94,   52,   52,   52,   98,   94,   94,   94,
+       94,   94,   94,   99,    3,   79,   23,  118,   23,   79,
+
+      100,   79,   23,   23,  101,   79,   23,   23,   23,   79,
+       79,   79,   79,   79,   79,   79,   79,    3,   57,   57,
+      118,   57,   57,   57,   57,   57,   57,   80,   57,   57,
+       57,   57,   57,   57,   57,   57,   57,   57,   57,   57,
+        3,  102,   57,  118,   57,  103,  102,  102,   57,   56,
+      104,  102,   57,   57,   57,  105,  102,  102,  102,  102,
+      102,  102,  106,    3,   56,   57,  118,   57,   58,   56,
+       56,   57,   56,   59,   56,   57,   57,   57,   60,   56,
+       56,   56,   56,   56,   56,   57,    3,   56,   57,  118,
+       57,   58,   56,   56,   57,   56,   59,   56,   57,   57,
+
+       57,   60,   56,   56,   56,   56,   56,   56,   57,    3,
+       56,   57,  118,   57,   58,   56,   56,   57,   81,   59,
+       56,   57,   57,   57,   60,   56,   56,   56,   56,   56,
+       56,   57,    3,   56,   57,  118,   57,   58,   56,   56,
+       57,   56,   59,   56,   57,   57,   57,   60,   56,   56,
+       56,   56,   56,   56,   57,    3,   82,   83,  118,   83,
+       84,   82,   82,   83,   82,   85,   82,   83,   83,   83,
+       86,   82,   82,   82,   82,   82,   82,   83,    3,   18,
+      118,  118,  118,   19,   18,   18,  118,   18,   18,   18,
+      118,  118,  118,   20,  107,   18,   18,   18,   18,   18,
+
+      118,    3,   63,  118,  118,  118,   64,   63,   63,  118,
+       18,   65,   63,  118,  118,  118,   66,   63,   63,   63,
+       63,   63,   63,   67,    3,   63,  118,  118,  118,   64,
+       63,   63,  118,   39,   65,   63,  118,  118,  118,   66,
+       63,   63,   63,   63,   63,   63,   67,    3,   18,  118,
+      118,  118,   19,   18,   18,  118,   18,   18,   18,  118,
+      118,  118,   20,   18,   18,   18,   18,   18,   18,  118,
+        3,   88,   41,  118,   41,   89,   88,   88,   41,   40,
+       90,   88,   41,   41,   41,   91,   88,   88,   88,   88,
+       88,   88,   92,    3,   63,  118,  118,  118,   64,   63,
+
+       63,  118,   18,   65,   63,  118,  118,  118,   66,   63,
+       63,   63,   63,   63,   63,   67,    3,   18,  118,  118,
+      118,   19,   18,   18,  118,   18,   18,   18,  118,  118,
+      118,   20,   18,   18,   18,   18,   18,   18,  118,    3,
+       74,   23,  118,   23,   75,   76,   74,   23,   22,   77,
+       74,   23,   23,   23,   78,   74,   74,   74,   74,   74,
+       74,   79,    3,   74,   23,  118,   23,   75,   76,   74,
+       23,   50,   77,   74,   23,   23,   23,   78,   74,   74,
+       74,   74,   74,   74,   79,    3,   63,  118,  118,  118,
+       64,   63,   63,  118,   18,   65,   63,  118,  118,  118,
+
+       66,   63,   63,   63,   63,   63,   63,   67,    3,   22,
+       23,  118,   23,   24,   25,   22,   23,   22,   22,   22,
+       23,   23,   23,   26,   22,   22,   22,   22,   22,   22,
+       23,    3,   94,   52,  118,   52,   95,   96,   94,   52,
+       51,   97,   94,   52,   52,   52,   98,   94,   94,   94,
+       94,   94,   94,   99,    3,   74,   23,  118,   23,   75,
+       76,   74,   23,   22,   77,   74,   23,   23,   23,   78,
+       74,   74,   74,   74,   74,   74,   79,    3,   67,  118,
+      118,  118,   67,   67,   67,  118,  118,   93,   67,  118,
+      118,  118,   67,   67,   67,   67,   67,   67,   67,   67,
+
+        3,   22,   23,  118,   23,   24,   25,   22,   23,   22,
+       22,   22,   23,   23,   23,   26,   22,   22,   22,   22,
+       22,   22,   23,    3,  102,   57,  118,   57,  103,  102,
+      102,   57,   56,  104,  102,   57,   57,   57,  105,  102,
+      102,  102,  102,  102,  102,  106,    3,  102,   57,  118,
+       57,  103,  102,  102,   57,   81,  104,  102,   57,   57,
+       57,  105,  102,  102,  102,  102,  102,  102,  106,    3,
+       56,   57,  118,   57,   58,   56,   56,   57,   56,   59,
+       56,   57,   57,   57,   60,   56,   56,   56,   56,   56,
+       56,   57,    3,  108,   83,  118,   83,  109,  108,  108,
+
+       83,   82,  110,  108,   83,   83,   83,  111,  108,  108,
+      108,  108,  108,  108,  112,    3,  106,   57,  118,   57,
+      106,  106,  106,   57,   57,  113,  106,   57,   57,   57,
+      106,  106,  106,  106,  106,  106,  106,  106,    3,   18,
+      118,  118,  118,   19,   18,   18,  118,   18,   18,   18,
+      118,  118,  118,   20,   18,  114,   18,   18,   18,   18,
+      118,    3,  102,   57,  118,   57,  103,  102,  102,   57,
+       56,  104,  102,   57,   57,   57,  105,  102,  102,  102,
+      102,  102,  102,  106,    3,  102,   57,  118,   57,  103,
+      102,  102,   57,   81,  104,  102,   57,   57,   57,  105,
+
+      102,  102,  102,  102,  102,  102,  106,    3,   56,   57,
+      118,   57,   58,   56,   56,   57,   56,   59,   56,   57,
+       57,   57,   60,   56,   56,   56,   56,   56,   56,   57,
+        3,  108,   83,  118,   83,  109,  108,  108,   83,   82,
+      110,  108,   83,   83,   83,  111,  108,  108,  108,  108,
+      108,  108,  112,    3,  102,   57,  118,   57,  103,  102,
+      102,   57,   56,  104,  102,   57,   57,   57,  105,  102,
+      102,  102,  102,  102,  102,  106,    3,   56,   57,  118,
+       57,   58,   56,   56,   57,   56,   59,   56,   57,   57,
+       57,   60,   56,   56,   56,   56,   56,   56,   57,    3,
+
+       18,  118,  118,  115,   19,   18,   18,  118,   18,   18,
+       18,  118,  118,  118,   20,   18,   18,   18,   18,   18,
+       18,  118,    3,  116,  118,  118,  118,  116,  116,  116,
+      118,  116,  116,  116,  118,  118,  118,  116,  116,  116,
+      116,  116,  116,  116,  118,    3,  117,  118,  118,  118,
+      117,  117,  117,  118,  117,  117,  117,  118,  118,  118,
+      117,  117,  117,  117,  117,  117,  117,  118,    3,  117,
+      118,  118,  118,  117,  117,  117,  118,  117,  117,  117,
+      118,  118,  118,  117,  117,  117,  117,  117,  117,  117,
+      118,    3,  118,  118,  118,  118,  118,  118,  118,  118,
+
+      118,  118,  118,  118,  118,  118,  118,  118,  118,  118,
+      118,  118,  118,  118
     } ;
 
-static const flex_int16_t yy_chk[175] =
+static const flex_int16_t yy_chk[2715] =
     {   0,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
-        7,    7,   53,    7,    7,    7,    7,    7,    7,    7,
+        1,    1,    1,    2,    2,    2,    2,    2,    2,    2,
+        2,    2,    2,    2,    2,    2,    2,    2,    2,    2,
+        2,    2,    2,    2,    2,    2,    3,    3,    3,    3,
+        3,    3,    3,    3,    3,    3,    3,    3,    3,    3,
+        3,    3,    3,    3,    3,    3,    3,    3,    3,    4,
+        4,    4,    4,    4,    4,    4,    4,    4,    4,    4,
+        4,    4,    4,    4,    4,    4,    4,    4,    4,    4,
+        4,    4,    5,    5,    5,    5,    5,    5,    5,    5,
+
+        5,    5,    5,    5,    5,    5,    5,    5,    5,    5,
+        5,    5,    5,    5,    5,    6,    6,    6,    6,    6,
+        6,    6,    6,    6,    6,    6,    6,    6,    6,    6,
+        6,    6,    6,    6,    6,    6,    6,    6,    7,    7,
+        7,    7,    7,    7,    7,    7,    7,    7,    7,    7,
         7,    7,    7,    7,    7,    7,    7,    7,    7,    7,
-        8,   10,   10,   12,   14,    8,   28,   14,   12,   13,
-       49,   13,   28,   38,   13,   43,   43,   38,   13,   13,
-       13,   44,   45,   44,   39,   34,   29,   13,   17,   26,
-       17,   45,   25,   17,   19,   16,    4,   17,   17,   17,
-        3,    0,    0,    0,    0,    0,   17,   21,   21,    0,
+        7,    8,    8,    8,    8,    8,    8,    8,    8,    8,
+        8,    8,    8,    8,    8,    8,    8,    8,    8,    8,
+        8,    8,    8,    8,    9,    9,    9,    9,    9,    9,
+        9,    9,    9,    9,    9,    9,    9,    9,    9,    9,
+
+        9,    9,    9,    9,    9,    9,    9,   10,   10,   10,
+       10,   10,   10,   10,   10,   10,   10,   10,   10,   10,
+       10,   10,   10,   10,   10,   10,   10,   10,   10,   10,
+       11,   11,   11,   11,   11,   11,   11,   11,   11,   11,
+       11,   11,   11,   11,   11,   11,   11,   11,   11,   11,
+       11,   11,   11,   12,   12,   12,   12,   12,   12,   12,
+       12,   12,   12,   12,   12,   12,   12,   12,   12,   12,
+       12,   12,   12,   12,   12,   12,   13,   13,   13,   13,
+       13,   13,   13,   13,   13,   13,   13,   13,   13,   13,
+       13,   13,   13,   13,   13,   13,   13,   13,   13,   14,
+
+       14,   14,   14,   14,   14,   14,   14,   14,   14,   14,
+       14,   14,   14,   14,   14,   14,   14,   14,   14,   14,
+       14,   14,   15,   15,   15,   15,   15,   15,   15,   15,
+       15,   15,   15,   15,   15,   15,   15,   15,   15,   15,
+       15,   15,   15,   15,   15,   16,   16,   16,   16,   16,
+       16,   16,   16,   16,   16,   16,   16,   16,   16,   16,
+       16,   16,   16,   16,   16,   16,   16,   16,   17,   17,
+       17,   17,   17,   17,   17,   17,   17,   17,   17,   17,
+       17,   17,   17,   17,   17,   17,   17,   17,   17,   17,
+       17,   18,   18,   18,   18,   18,   18,   18,   18,   18,
+
+       18,   18,   18,   18,   18,   18,   18,   18,   18,   18,
+       18,   18,   18,   18,   19,   19,   19,   19,   19,   19,
+       19,   19,   19,   19,   19,   19,   19,   19,   19,   19,
+       19,   19,   19,   19,   19,   19,   19,   20,   20,   20,
+       20,   20,   20,   20,   20,   20,   20,   20,   20,   20,
+       20,   20,   20,   20,   20,   20,   20,   20,   20,   20,
        21,   21,   21,   21,   21,   21,   21,   21,   21,   21,
-
-       21,   21,   21,   21,   21,   21,   21,   22,   22,    0,
+       21,   21,   21,   21,   21,   21,   21,   21,   21,   21,
+       21,   21,   21,   22,   22,   22,   22,   22,   22,   22,
        22,   22,   22,   22,   22,   22,   22,   22,   22,   22,
-       22,   22,   22,   22,   22,   22,   22,   36,   36,    0,
+
+       22,   22,   22,   22,   22,   22,   23,   23,   23,   23,
+       23,   23,   23,   23,   23,   23,   23,   23,   23,   23,
+       23,   23,   23,   23,   23,   23,   23,   23,   23,   24,
+       24,   24,   24,   24,   24,   24,   24,   24,   24,   24,
+       24,   24,   24,   24,   24,   24,   24,   24,   24,   24,
+       24,   24,   25,   25,   25,   25,   25,   25,   25,   25,
+       25,   25,   25,   25,   25,   25,   25,   25,   25,   25,
+       25,   25,   25,   25,   25,   26,   26,   26,   26,   26,
+       26,   26,   26,   26,   26,   26,   26,   26,   26,   26,
+       26,   26,   26,   26,   26,   26,   26,   26,   27,   27,
+
+       27,   27,   27,   27,   27,   27,   27,   27,   27,   27,
+       27,   27,   27,   27,   27,   27,   27,   27,   27,   27,
+       27,   28,   28,   28,   28,   28,   28,   28,   28,   28,
+       28,   28,   28,   28,   28,   28,   28,   28,   28,   28,
+       28,   28,   28,   28,   29,   29,   29,   29,   29,   29,
+       29,   29,   29,   29,   29,   29,   29,   29,   29,   29,
+       29,   29,   29,   29,   29,   29,   29,   30,   30,   30,
+       30,   30,   30,   30,   30,   30,   30,   30,   30,   30,
+       30,   30,   30,   30,   30,   30,   30,   30,   30,   30,
+       31,   31,   31,   31,   31,   31,   31,   31,   31,   31,
+
+       31,   31,   31,   31,   31,   31,   31,   31,   31,   31,
+       31,   31,   31,   32,   32,   32,   32,   32,   32,   32,
+       32,   32,   32,   32,   32,   32,   32,   32,   32,   32,
+       32,   32,   32,   32,   32,   32,   33,   33,   33,   33,
+       33,   33,   33,   33,   33,   33,   33,   33,   33,   33,
+       33,   33,   33,   33,   33,   33,   33,   33,   33,   34,
+       34,   34,   34,   34,   34,   34,   34,   34,   34,   34,
+       34,   34,   34,   34,   34,   34,   34,   34,   34,   34,
+       34,   34,   35,   35,   35,   35,   35,   35,   35,   35,
+       35,   35,   35,   35,   35,   35,   35,   35,   35,   35,
+
+       35,   35,   35,   35,   35,   36,   36,   36,   36,   36,
        36,   36,   36,   36,   36,   36,   36,   36,   36,   36,
-       36,   36,   36,   36,   36,   36,   36,   50,   50,   51,
-       51,   52,   52,   48,   48,   48,   48,   48,   48,   48,
+       36,   36,   36,   36,   36,   36,   36,   36,   37,   37,
+       37,   37,   37,   37,   37,   37,   37,   37,   37,   37,
+       37,   37,   37,   37,   37,   37,   37,   37,   37,   37,
+       37,   38,   38,   38,   38,   38,   38,   38,   38,   38,
+       38,   38,   38,   38,   38,   38,   38,   38,   38,   38,
+       38,   38,   38,   38,   39,   39,   39,   39,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   39,   39,   39,
+       39,   39,   39,   39,   39,   39,   39,   40,   40,   40,
+
+       40,   40,   40,   40,   40,   40,   40,   40,   40,   40,
+       40,   40,   40,   40,   40,   40,   40,   40,   40,   40,
+       41,   41,   41,   41,   41,   41,   41,   41,   41,   41,
+       41,   41,   41,   41,   41,   41,   41,   41,   41,   41,
+       41,   41,   41,   42,   42,   42,   42,   42,   42,   42,
+       42,   42,   42,   42,   42,   42,   42,   42,   42,   42,
+       42,   42,   42,   42,   42,   42,   43,   43,   43,   43,
+       43,   43,   43,   43,   43,   43,   43,   43,   43,   43,
+       43,   43,   43,   43,   43,   43,   43,   43,   43,   44,
+       44,   44,   44,   44,   44,   44,   44,   44,   44,   44,
+
+       44,   44,   44,   44,   44,   44,   44,   44,   44,   44,
+       44,   44,   45,   45,   45,   45,   45,   45,   45,   45,
+       45,   45,   45,   45,   45,   45,   45,   45,   45,   45,
+       45,   45,   45,   45,   45,   46,   46,   46,   46,   46,
+       46,   46,   46,   46,   46,   46,   46,   46,   46,   46,
+       46,   46,   46,   46,   46,   46,   46,   46,   47,   47,
+       47,   47,   47,   47,   47,   47,   47,   47,   47,   47,
+       47,   47,   47,   47,   47,   47,   47,   47,   47,   47,
+       47,   48,   48,   48,   48,   48,   48,   48,   48,   48,
        48,   48,   48,   48,   48,   48,   48,   48,   48,   48,
-       48,   48,   48,   48
+
+       48,   48,   48,   48,   49,   49,   49,   49,   49,   49,
+       49,   49,   49,   49,   49,   49,   49,   49,   49,   49,
+       49,   49,   49,   49,   49,   49,   49,   50,   50,   50,
+       50,   50,   50,   50,   50,   50,   50,   50,   50,   50,
+       50,   50,   50,   50,   50,   50,   50,   50,   50,   50,
+       51,   51,   51,   51,   51,   51,   51,   51,   51,   51,
+       51,   51,   51,   51,   51,   51,   51,   51,   51,   51,
+       51,   51,   51,   52,   52,   52,   52,   52,   52,   52,
+       52,   52,   52,   52,   52,   52,   52,   52,   52,   52,
+       52,   52,   52,   52,   52,   52,   53,   53,   53,   53,
+
+       53,   53,   53,   53,   53,   53,   53,   53,   53,   53,
+       53,   53,   53,   53,   53,   53,   53,   53,   53,   54,
+       54,   54,   54,   54,   54,   54,   54,   54,   54,   54,
+       54,   54,   54,   54,   54,   54,   54,   54,   54,   54,
+       54,   54,   55,   55,   55,   55,   55,   55,   55,   55,
+       55,   55,   55,   55,   55,   55,   55,   55,   55,   55,
+       55,   55,   55,   55,   55,   56,   56,   56,   56,   56,
+       56,   56,   56,   56,   56,   56,   56,   56,   56,   56,
+       56,   56,   56,   56,   56,   56,   56,   56,   57,   57,
+       57,   57,   57,   57,   57,   57,   57,   57,   57,   57,
+
+       57,   57,   57,   57,   57,   57,   57,   57,   57,   57,
+       57,   58,   58,   58,   58,   58,   58,   58,   58,   58,
+       58,   58,   58,   58,   58,   58,   58,   58,   58,   58,
+       58,   58,   58,   58,   59,   59,   59,   59,   59,   59,
+       59,   59,   59,   59,   59,   59,   59,   59,   59,   59,
+       59,   59,   59,   59,   59,   59,   59,   60,   60,   60,
+       60,   60,   60,   60,   60,   60,   60,   60,   60,   60,
+       60,   60,   60,   60,   60,   60,   60,   60,   60,   60,
+       61,   61,   61,   61,   61,   61,   61,   61,   61,   61,
+       61,   61,   61,   61,   61,   61,   61,   61,   61,   61,
+
+       61,   61,   61,   62,   62,   62,   62,   62,   62,   62,
+       62,   62,   62,   62,   62,   62,   62,   62,   62,   62,
+       62,   62,   62,   62,   62,   62,   63,   63,   63,   63,
+       63,   63,   63,   63,   63,   63,   63,   63,   63,   63,
+       63,   63,   63,   63,   63,   63,   63,   63,   63,   64,
+       64,   64,   64,   64,   64,   64,   64,   64,   64,   64,
+       64,   64,   64,   64,   64,   64,   64,   64,   64,   64,
+       64,   64,   65,   65,   65,   65,   65,   65,   65,   65,
+       65,   65,   65,   65,   65,   65,   65,   65,   65,   65,
+       65,   65,   65,   65,   65,   66,   66,   66,   66,   66,
+
+       66,   66,   66,   66,   66,   66,   66,   66,   66,   66,
+       66,   66,   66,   66,   66,   66,   66,   66,   67,   67,
+       67,   67,   67,   67,   67,   67,   67,   67,   67,   67,
+       67,   67,   67,   67,   67,   67,   67,   67,   67,   67,
+       67,   68,   68,   68,   68,   68,   68,   68,   68,   68,
+       68,   68,   68,   68,   68,   68,   68,   68,   68,   68,
+       68,   68,   68,   68,   69,   69,   69,   69,   69,   69,
+       69,   69,   69,   69,   69,   69,   69,   69,   69,   69,
+       69,   69,   69,   69,   69,   69,   69,   70,   70,   70,
+       70,   70,   70,   70,   70,   70,   70,   70,   70,   70,
+
+       70,   70,   70,   70,   70,   70,   70,   70,   70,   70,
+       71,   71,   71,   71,   71,   71,   71,   71,   71,   71,
+       71,   71,   71,   71,   71,   71,   71,   71,   71,   71,
+       71,   71,   71,   72,   72,   72,   72,   72,   72,   72,
+       72,   72,   72,   72,   72,   72,   72,   72,   72,   72,
+       72,   72,   72,   72,   72,   72,   73,   73,   73,   73,
+       73,   73,   73,   73,   73,   73,   73,   73,   73,   73,
+       73,   73,   73,   73,   73,   73,   73,   73,   73,   74,
+       74,   74,   74,   74,   74,   74,   74,   74,   74,   74,
+       74,   74,   74,   74,   74,   74,   74,   74,   74,   74,
+
+       74,   74,   75,   75,   75,   75,   75,   75,   75,   75,
+       75,   75,   75,   75,   75,   75,   75,   75,   75,   75,
+       75,   75,   75,   75,   75,   76,   76,   76,   76,   76,
+       76,   76,   76,   76,   76,   76,   76,   76,   76,   76,
+       76,   76,   76,   76,   76,   76,   76,   76,   77,   77,
+       77,   77,   77,   77,   77,   77,   77,   77,   77,   77,
+       77,   77,   77,   77,   77,   77,   77,   77,   77,   77,
+       77,   78,   78,   78,   78,   78,   78,   78,   78,   78,
+       78,   78,   78,   78,   78,   78,   78,   78,   78,   78,
+       78,   78,   78,   78,   79,   79,   79,   79,   79,   79,
+
+       79,   79,   79,   79,   79,   79,   79,   79,   79,   79,
+       79,   79,   79,   79,   79,   79,   79,   80,   80,   80,
+       80,   80,   80,   80,   80,   80,   80,   80,   80,   80,
+       80,   80,   80,   80,   80,   80,   80,   80,   80,   80,
+       81,   81,   81,   81,   81,   81,   81,   81,   81,   81,
+       81,   81,   81,   81,   81,   81,   81,   81,   81,   81,
+       81,   81,   81,   82,   82,   82,   82,   82,   82,   82,
+       82,   82,   82,   82,   82,   82,   82,   82,   82,   82,
+       82,   82,   82,   82,   82,   82,   83,   83,   83,   83,
+       83,   83,   83,   83,   83,   83,   83,   83,   83,   83,
+
+       83,   83,   83,   83,   83,   83,   83,   83,   83,   84,
+       84,   84,   84,   84,   84,   84,   84,   84,   84,   84,
+       84,   84,   84,   84,   84,   84,   84,   84,   84,   84,
+       84,   84,   85,   85,   85,   85,   85,   85,   85,   85,
+       85,   85,   85,   85,   85,   85,   85,   85,   85,   85,
+       85,   85,   85,   85,   85,   86,   86,   86,   86,   86,
+       86,   86,   86,   86,   86,   86,   86,   86,   86,   86,
+       86,   86,   86,   86,   86,   86,   86,   86,   87,   87,
+       87,   87,   87,   87,   87,   87,   87,   87,   87,   87,
+       87,   87,   87,   87,   87,   87,   87,   87,   87,   87,
+
+       87,   88,   88,   88,   88,   88,   88,   88,   88,   88,
+       88,   88,   88,   88,   88,   88,   88,   88,   88,   88,
+       88,   88,   88,   88,   89,   89,   89,   89,   89,   89,
+       89,   89,   89,   89,   89,   89,   89,   89,   89,   89,
+       89,   89,   89,   89,   89,   89,   89,   90,   90,   90,
+       90,   90,   90,   90,   90,   90,   90,   90,   90,   90,
+       90,   90,   90,   90,   90,   90,   90,   90,   90,   90,
+       91,   91,   91,   91,   91,   91,   91,   91,   91,   91,
+       91,   91,   91,   91,   91,   91,   91,   91,   91,   91,
+       91,   91,   91,   92,   92,   92,   92,   92,   92,   92,
+
+       92,   92,   92,   92,   92,   92,   92,   92,   92,   92,
+       92,   92,   92,   92,   92,   92,   93,   93,   93,   93,
+       93,   93,   93,   93,   93,   93,   93,   93,   93,   93,
+       93,   93,   93,   93,   93,   93,   93,   93,   93,   94,
+       94,   94,   94,   94,   94,   94,   94,   94,   94,   94,
+       94,   94,   94,   94,   94,   94,   94,   94,   94,   94,
+       94,   94,   95,   95,   95,   95,   95,   95,   95,   95,
+       95,   95,   95,   95,   95,   95,   95,   95,   95,   95,
+       95,   95,   95,   95,   95,   96,   96,   96,   96,   96,
+       96,   96,   96,   96,   96,   96,   96,   96,   96,   96,
+
+       96,   96,   96,   96,   96,   96,   96,   96,   97,   97,
+       97,   97,   97,   97,   97,   97,   97,   97,   97,   97,
+       97,   97,   97,   97,   97,   97,   97,   97,   97,   97,
+       97,   98,   98,   98,   98,   98,   98,   98,   98,   98,
+       98,   98,   98,   98,   98,   98,   98,   98,   98,   98,
+       98,   98,   98,   98,   99,   99,   99,   99,   99,   99,
+       99,   99,   99,   99,   99,   99,   99,   99,   99,   99,
+       99,   99,   99,   99,   99,   99,   99,  100,  100,  100,
+      100,  100,  100,  100,  100,  100,  100,  100,  100,  100,
+      100,  100,  100,  100,  100,  100,  100,  100,  100,  100,
+
+      101,  101,  101,  101,  101,  101,  101,  101,  101,  101,
+      101,  101,  101,  101,  101,  101,  101,  101,  101,  101,
+      101,  101,  101,  102,  102,  102,  102,  102,  102,  102,
+      102,  102,  102,  102,  102,  102,  102,  102,  102,  102,
+      102,  102,  102,  102,  102,  102,  103,  103,  103,  103,
+      103,  103,  103,  103,  103,  103,  103,  103,  103,  103,
+      103,  103,  103,  103,  103,  103,  103,  103,  103,  104,
+      104,  104,  104,  104,  104,  104,  104,  104,  104,  104,
+      104,  104,  104,  104,  104,  104,  104,  104,  104,  104,
+      104,  104,  105,  105,  105,  105,  105,  105,  105,  105,
+
+      105,  105,  105,  105,  105,  105,  105,  105,  105,  105,
+      105,  105,  105,  105,  105,  106,  106,  106,  106,  106,
+      106,  106,  106,  106,  106,  106,  106,  106,  106,  106,
+      106,  106,  106,  106,  106,  106,  106,  106,  107,  107,
+      107,  107,  107,  107,  107,  107,  107,  107,  107,  107,
+      107,  107,  107,  107,  107,  107,  107,  107,  107,  107,
+      107,  108,  108,  108,  108,  108,  108,  108,  108,  108,
+      108,  108,  108,  108,  108,  108,  108,  108,  108,  108,
+      108,  108,  108,  108,  109,  109,  109,  109,  109,  109,
+      109,  109,  109,  109,  109,  109,  109,  109,  109,  109,
+
+      109,  109,  109,  109,  109,  109,  109,  110,  110,  110,
+      110,  110,  110,  110,  110,  110,  110,  110,  110,  110,
+      110,  110,  110,  110,  110,  110,  110,  110,  110,  110,
+      111,  111,  111,  111,  111,  111,  111,  111,  111,  111,
+      111,  111,  111,  111,  111,  111,  111,  111,  111,  111,
+      111,  111,  111,  112,  112,  112,  112,  112,  112,  112,
+      112,  112,  112,  112,  112,  112,  112,  112,  112,  112,
+      112,  112,  112,  112,  112,  112,  113,  113,  113,  113,
+      113,  113,  113,  113,  113,  113,  113,  113,  113,  113,
+      113,  113,  113,  113,  113,  113,  113,  113,  113,  114,
+
+      114,  114,  114,  114,  114,  114,  114,  114,  114,  114,
+      114,  114,  114,  114,  114,  114,  114,  114,  114,  114,
+      114,  114,  115,  115,  115,  115,  115,  115,  115,  115,
+      115,  115,  115,  115,  115,  115,  115,  115,  115,  115,
+      115,  115,  115,  115,  115,  116,  116,  116,  116,  116,
+      116,  116,  116,  116,  116,  116,  116,  116,  116,  116,
+      116,  116,  116,  116,  116,  116,  116,  116,  117,  117,
+      117,  117,  117,  117,  117,  117,  117,  117,  117,  117,
+      117,  117,  117,  117,  117,  117,  117,  117,  117,  117,
+      117,  118,  118,  118,  118,  118,  118,  118,  118,  118,
+
+      118,  118,  118,  118,  118,  118,  118,  118,  118,  118,
+      118,  118,  118,  118
     } ;
 
 /* Table of booleans, true if rule could match eol. */
-static const flex_int32_t yy_rule_can_match_eol[16] =
+static const flex_int32_t yy_rule_can_match_eol[20] =
     {   0,
-0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,     };
+0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,     };
 
 static yy_state_type yy_last_accepting_state;
 static char *yy_last_accepting_cpos;
@@ -527,8 +1110,11 @@ char *yytext_ptr;
 
 #include <string.h>
 
+#include "arena.h"
+#include "expand.h"
 #include "read_line.h"
 #include "shell.h"
+#include "vars.h"
 #include "y.tab.h"
 
 extern char *read_line();
@@ -563,149 +1149,268 @@ void myunputc(int c) {
   unput(c);
 }
 
-char* expand_variables(char* original_word) {
-  int beg_ind = -1;
-  int end_ind = -1;
+// Reserved words are only recognized where a command name can start,
+// so "echo done" still passes done as an argument. for and case need
+// a little more context to find their name, "in" and patterns, and
+// between [[ and ]] operators like && and < are plain words.
+
+typedef enum lex_state {
+  LEX_NORMAL,
+  LEX_FOR_NAME,
+  LEX_FOR_IN,
+  LEX_CASE_WORD,
+  LEX_CASE_IN,
+  LEX_CASE_PATTERN,
+  LEX_COND,
+} lex_state_t;
+
+static bool g_command_start = true;
+static lex_state_t g_lex_state = LEX_NORMAL;
+
+int lex_token(int token) {
+  switch (token) {
+    case WORD:
+    case QUOTED_WORD:
+    case FI:
+    case DONE:
+    case ESAC:
+    case IN:
+    case COND_END:
+    case STDOUT:
+    case STDIN:
+    case STDERR:
+    case BOTH:
+    case APPEND:
+    case APPENDBOTH:
+      g_command_start = false;
+      break;
+    case DSEMI:
+      g_lex_state = LEX_CASE_PATTERN;
+      g_command_start = true;
+      break;
+    default:
+      g_command_start = true;
+  }
 
-  int needed_space = strlen(original_word);
+  return token;
+}
 
-  char* expanded_word = malloc(1000);
+int reserved_word(char* word) {
+  static const struct {
+    char* word;
+    int token;
+  } reserved[] = {
+    { "if", IF }, { "then", THEN }, { "else", ELSE }, { "elif", ELIF },
+    { "fi", FI }, { "while", WHILE }, { "until", UNTIL }, { "do", DO },
+    { "done", DONE }, { "for", FOR }, { "case", CASE }, { "esac", ESAC },
+    { "[[", COND_START },
+  };
+
+  switch (g_lex_state) {
+    case LEX_FOR_NAME:
+      g_lex_state = LEX_FOR_IN;
+      return WORD;
+    case LEX_FOR_IN:
+      g_lex_state = LEX_NORMAL;
+
+      if (!strcmp(word, "in")) {
+        return IN;
+      }
+      break;
+    case LEX_CASE_WORD:
+      g_lex_state = LEX_CASE_IN;
+      return WORD;
+    case LEX_CASE_IN:
+      if (!strcmp(word, "in")) {
+        g_lex_state = LEX_CASE_PATTERN;
+        return IN;
+      }
 
-  if (expanded_word == NULL) {
-    perror("malloc");
-    exit(1);
+      g_lex_state = LEX_NORMAL;
+      break;
+    case LEX_CASE_PATTERN:
+      if (!strcmp(word, "esac")) {
+        g_lex_state = LEX_NORMAL;
+        return ESAC;
+      }
+
+      return WORD;
+    case LEX_COND:
+      if (!strcmp(word, "]]")) {
+        g_lex_state = LEX_NORMAL;
+        return COND_END;
+      }
+
+      return WORD;
+    case LEX_NORMAL:
+      break;
   }
 
-  int i = 0;
-  int expanded_ind = 0;
+  if (!g_command_start) {
+    return WORD;
+  }
 
-  while (i < strlen(original_word)) {
-    if (original_word[i] == '$') {
-      if ((i + 1 < strlen(original_word) - 1) &&
-          (original_word[i+1] == '{')) {
-        beg_ind = i;
+  for (size_t i = 0; i < sizeof(reserved) / sizeof(reserved[0]); ++i) {
+    if (!strcmp(word, reserved[i].word)) {
+      if (reserved[i].token == FOR) {
+        g_lex_state = LEX_FOR_NAME;
+      }
+      else if (reserved[i].token == CASE) {
+        g_lex_state = LEX_CASE_WORD;
+      }
+      else if (reserved[i].token == COND_START) {
+        g_lex_state = LEX_COND;
       }
-    }
-    
-    if ((beg_ind != -1) && (original_word[i] == '}')) {
-      end_ind = i;
 
-      // count number of chars between the brackets
+      return reserved[i].token;
+    }
+  }
 
-      int num_chars = end_ind - beg_ind - 2;
+  return WORD;
+}
 
-      // extract the variable name
+// Operators between [[ and ]] are evaluated by cond.c, not the parser
 
-      char* var_name = malloc(num_chars + 1);
-      var_name[num_chars] = '\0';
+int cond_operator() {
+  yylval.string = arena_strdup(&g_line_arena, yytext);
+  return lex_token(WORD);
+}
 
+// Forget any partially lexed for or case after a syntax error
 
-      strncpy(var_name, original_word + beg_ind + 2, num_chars);
+void reset_lex_state() {
+  g_command_start = true;
+  g_lex_state = LEX_NORMAL;
+}
 
-      // if its a special variable
+// Length of the case pattern at the start of word, up to the first
+// unescaped ')'. Returns -1 if the pattern does not end in this word.
 
-      if (!strcmp(var_name, "!")) {
-        exit(1);
+int case_pattern_length(char* word) {
+  for (int i = 0; word[i] != '\0'; ++i) {
+    if (word[i] == '\\') {
+      if (word[i + 1] == '\0') {
+        break;
       }
-      else if (!strcmp(var_name, "$")) {
-        free(var_name);
 
-        int shell_pid = getpid();
-        
-        int digits = shell_pid;
+      ++i;
+    }
+    else if ((strchr("?*+@!", word[i]) != NULL) && (word[i + 1] == '(')) {
+      // skip an extglob group, its ')' does not end the pattern
 
-        int num_digits = 0;
+      int close_paren = matching_paren(word, i + 1);
 
-        while (digits > 0) {
-          digits /= 10;
-          ++num_digits;
-        }
+      if (close_paren != -1) {
+        i = close_paren;
+      }
+    }
+    else if (word[i] == ')') {
+      return i;
+    }
+  }
 
-        char* shell_pid_str = malloc(num_digits + 1);
+  return -1;
+}
 
-        if (shell_pid_str == NULL) {
-          perror("malloc");
-          exit(1);
-        }
+// Length of a word starting with $( up to the first separator after
+// its closing ), the command inside it may contain spaces.
+// Returns -1 if a $( in text is not closed.
 
-        sprintf(shell_pid_str, "%d", shell_pid);
-        shell_pid_str[num_digits] = '\0';
+int substitution_word_length(char* text) {
+  int i = 0;
 
-        strcpy(expanded_word + expanded_ind - 1 - 2, shell_pid_str);
-        expanded_ind += num_digits - 1 - 2;
-        free(shell_pid_str);
+  while ((text[i] != '\0') && (strchr(" \t\n<>&|;", text[i]) == NULL)) {
+    if ((text[i] == '\\') && (text[i + 1] != '\0')) {
+      i += 2;
+    }
+    else if (!strncmp(text + i, "$(", 2)) {
+      int close = matching_paren(text, i + 1);
 
-        i = end_ind + 1;
+      if (close == -1) {
+        return -1;
+      }
 
-        beg_ind = -1;
-        end_ind = -1;
+      i = close + 1;
+    }
+    else {
+      ++i;
+    }
+  }
 
-      }
-      else if (!strcmp(var_name, "SHELL")) {
-        free(var_name);
+  return i;
+}
 
-        char* rel_path = g_argv[0];
-        char* abs_path = realpath(rel_path, NULL);
+// Length of a word starting with $(( up to the first separator after
+// its closing )), arithmetic inside it may contain spaces.
+// Returns -1 if text does not start with a complete $(( )).
 
-        int value_len = strlen(abs_path);
+int arithmetic_word_length(char* text) {
+  int i = 0;
 
-        strcpy(expanded_word + expanded_ind - 5 - 2, abs_path);
-        expanded_ind += value_len - 5 - 2;
-        free(abs_path);
+  while ((text[i] != '\0') && (strchr(" \t\n<>&|;", text[i]) == NULL)) {
+    if ((text[i] == '\\') && (text[i + 1] != '\0')) {
+      i += 2;
+    }
+    else if (!strncmp(text + i, "$((", 3)) {
+      int close = matching_paren(text, i + 1);
 
-        i = end_ind + 1;
-        beg_ind = -1;
-        end_ind = -1;
+      if ((close == -1) || (text[close - 1] != ')') ||
+          (matching_paren(text, i + 2) != close - 1)) {
+        return -1;
       }
-      else if (!strcmp(var_name, "_")) {
-        free(var_name);
 
-        int value_len = strlen(g_last_arg);
+      i = close + 1;
+    }
+    else {
+      ++i;
+    }
+  }
 
-        strcpy(expanded_word + expanded_ind - 1 - 2, g_last_arg);
-        expanded_ind += value_len - 1 - 2;
+  return i;
+}
 
-        i = end_ind + 1;
-        beg_ind = -1;
-        end_ind = -1;
-      }
-      else {
-        
-        // not special, normal env var
+// Parse and run the commands read from src_fp, then go back to the
+// input that was being read
 
-        char* value = getenv(var_name);
+void source_stream(FILE* src_fp) {
+  g_prompts_off = true;
 
+  // lines of the sourced file release the line arena back to here,
+  // keeping the words of the line that ran source
 
-        if (value == NULL) {
-          value = "";
-        }
+  arena_mark_t outer_line_mark = g_line_mark;
+  g_line_mark = arena_mark(&g_line_arena);
 
-        // take the output and put it into expanded_word
+  YY_BUFFER_STATE src_buffer = yy_create_buffer(src_fp, YY_BUF_SIZE);
+  yypush_buffer_state(src_buffer);
+  yyparse();
+  yypop_buffer_state();
 
-        int value_len = strlen(value);
+  g_line_mark = outer_line_mark;
+  g_prompts_off = false;
+}
 
-        strcpy(expanded_word + expanded_ind - strlen(var_name) - 2, value);
-        expanded_ind += value_len - strlen(var_name) - 2;
-        free(var_name);
+// Run the commands in text in this process, as source does with a
+// file. A command substitution runs its command this way in a forked
+// child, which sees all the variables of the shell.
 
-        i = end_ind + 1;
+void source_string(char* text) {
+  size_t length = strlen(text);
 
-        // reset beg & end indexes
-        
-        beg_ind = -1;
-        end_ind = -1;
-      }
-    }
-    else {
-      expanded_word[expanded_ind] = original_word[i]; 
-      ++expanded_ind;
-      ++i;
-    }
+  if (length == 0) {
+    return;
   }
 
-  expanded_word[expanded_ind] = '\0';
+  FILE *src_fp = fmemopen(text, length, "r");
+
+  if (src_fp == NULL) {
+    perror("fmemopen");
+    exit(1);
+  }
 
-  return expanded_word;
+  reset_lex_state();
+  source_stream(src_fp);
+  fclose(src_fp);
 }
 
 void source(char* file_name, bool init) {
@@ -724,16 +1429,11 @@ void source(char* file_name, bool init) {
     }
   }
   else {
-    g_prompts_off = true;
-    YY_BUFFER_STATE src_buffer = yy_create_buffer(src_fp, YY_BUF_SIZE);
-    yypush_buffer_state(src_buffer);
-    yyparse();
-    yypop_buffer_state();
-    
+    source_stream(src_fp);
+
     // error check
     
     fclose(src_fp);
-    g_prompts_off = false;
 
     if (init == true) {
       yyrestart(stdin);
@@ -741,9 +1441,9 @@ void source(char* file_name, bool init) {
   }
 }
 
-#line 744 "lex.yy.c"
+#line 1444 "lex.yy.c"
 #define YY_NO_INPUT 1
-#line 746 "lex.yy.c"
+#line 1446 "lex.yy.c"
 
 #define INITIAL 0
 
@@ -960,10 +1660,10 @@ YY_DECL
 		}
 
 	{
-#line 228 "shell.l"
+#line 345 "shell.l"
 
 
-#line 966 "lex.yy.c"
+#line 1666 "lex.yy.c"
 
 	while ( /*CONSTCOND*/1 )		/* loops until end-of-file is reached */
 		{
@@ -990,13 +1690,13 @@ yy_match:
 			while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 				{
 				yy_current_state = (int) yy_def[yy_current_state];
-				if ( yy_current_state >= 49 )
+				if ( yy_current_state >= 119 )
 					yy_c = yy_meta[yy_c];
 				}
 			yy_current_state = yy_nxt[yy_base[yy_current_state] + yy_c];
 			++yy_cp;
 			}
-		while ( yy_base[yy_current_state] != 154 );
+		while ( yy_base[yy_current_state] != 2692 );
 
 yy_find_action:
 		yy_act = yy_accept[yy_current_state];
@@ -1032,148 +1732,38 @@ do_action:	/* This label is used only to access EOF actions. */
 
 case 1:
 YY_RULE_SETUP
-#line 230 "shell.l"
+#line 347 "shell.l"
 {
-  // read from pipe using read(fd, buffer, sizeof(buffer));
-  // use malloc for buffer then free it after
-
-  int pin[2] = {-1, -1};
-
-  if (pipe(pin) == -1) {
-    perror("pipe");
-    exit(1);
-  }
-
-  int pout[2] = {-1, -1};
-
-  if (pipe(pout) == -1) {
-    perror("pipe");
-    exit(1);
-  }
+  // $(( )) is arithmetic, kept as a word and evaluated by
+  // expand_word() without running a subshell
 
-  int default_in = dup(0);
-  int default_out = dup(1);
+  if (!strncmp(yytext, "$((", 3)) {
+    int length = arithmetic_word_length(yytext);
 
-  char* subshell_cmd = malloc(strlen(yytext) - 3 + 7);
-
-  if (subshell_cmd == NULL) {
-    perror("malloc");
-    exit(1);
-  }
-
-  strncpy(subshell_cmd, yytext + 2, strlen(yytext) - 3);
-  strcpy(subshell_cmd + strlen(yytext) - 3, "\nexit\n\0");
-
-  if (write(pin[1], subshell_cmd, strlen(subshell_cmd)) == -1) {
-    perror("write");
-    exit(1);
-  }
-
-  if (close(pin[1]) == -1) {
-    perror("close");
-    exit(1);
-  }
-
-  int ret = fork();
-
-  if (ret == -1) {
-    perror("fork");
-    exit(1);
-  }
-
-  if (ret == 0) {
-  
-    // child
-
-    if ((close(default_in) == -1) ||
-        (close(default_out) == -1)) {
-      perror("close");
-      exit(1);
-    }
-
-    if (dup2(pin[0], 0) == -1) {
-      perror("dup2");
-      exit(1);
-    }
-
-    if (close(pin[0]) == -1) { 
-      perror("close");
-      exit(1);
-    }
-    
-    if (dup2(pout[1], 1) == -1) {
-      perror("dup2");
-      exit(1);
+    if (length > 0) {
+      yyless(length);
+      yylval.string = arena_strdup(&g_line_arena, yytext);
+      return lex_token(reserved_word(yytext));
     }
-
-    if ((close(pout[1]) == -1) ||
-        (close(pout[0]) == -1)) {
-      perror("close");
-      exit(1);
-    }
-
-    char *args[] = { "/proc/self/exe", NULL };
-
-    execvp(args[0], args);
-    perror("execvp");
-    exit(1);
-  }
-
-  if (close(pin[0])) {
-    perror("close");
-    exit(1);
-  }
-
-  if (close(pout[1])) {
-    perror("close");
-    exit(1);
-  }
-
-  free(subshell_cmd);
-
-  int buf_size = 2000;
-  char *buffer = malloc(buf_size);
-  
-  if (buffer == NULL) {
-    perror("malloc");
-    exit(1);
-  }
-
-  // buf_size -1 for null terminator
-
-  int bytes_read = read(pout[0], buffer, buf_size - 1); 
-
-  if (close(pout[0]) == -1) {
-    perror("close");
-    exit(1);
   }
 
-  if (bytes_read == -1) {
-    perror("read");
-    exit(1);
-  }
+  // a command substitution is kept as a word too and run by
+  // expand_word() each time the word is expanded, only up to the
+  // matching paren, "$(a) $(b)" is two words
 
-  if ((close(default_in) == -1) ||
-      (close(default_out) == -1)) {
-    perror("close");
-    exit(1);
-  }
+  int length = substitution_word_length(yytext);
 
-  for (int i = bytes_read - 1; i >= 0; --i) {
-    if (buffer[i] == '\n') {
-      myunputc(' ');
-    }
-    else {
-      myunputc(buffer[i]);
-    }
+  if (length > 0) {
+    yyless(length);
   }
 
-  free(buffer);
+  yylval.string = arena_strdup(&g_line_arena, yytext);
+  return lex_token(reserved_word(yytext));
 }
 	YY_BREAK
 case 2:
 YY_RULE_SETUP
-#line 368 "shell.l"
+#line 375 "shell.l"
 {
   // preserve all (most) characters in double quotes
   // escapes appear as \ unless they are followed by a special character?...
@@ -1181,14 +1771,9 @@ YY_RULE_SETUP
   // yytext - this is the word that is captured
 
   int length = strlen(yytext);
-  char* new_text = malloc(length - 2 + 1);
+  char* new_text = arena_alloc(&g_line_arena, length - 2 + 1);
   new_text[length - 2] = '\0';
 
-  if (new_text == NULL) {
-    perror("malloc");
-    exit(1);
-  }
-
   int src_itr = 0;
   int dest_itr = 0;
 
@@ -1201,116 +1786,67 @@ YY_RULE_SETUP
     ++src_itr;
   }
 
-  yylval.string = strdup(new_text);
+  yylval.string = new_text;
 
-  free(new_text);
+  if (g_lex_state == LEX_FOR_NAME) {
+    g_lex_state = LEX_FOR_IN;
+  }
+  else if (g_lex_state == LEX_CASE_WORD) {
+    g_lex_state = LEX_CASE_IN;
+  }
+  else if ((g_lex_state != LEX_CASE_PATTERN) && (g_lex_state != LEX_COND)) {
+    g_lex_state = LEX_NORMAL;
+  }
 
-  return QUOTED_WORD;
+  return lex_token(QUOTED_WORD);
 }
 	YY_BREAK
 case 3:
 YY_RULE_SETUP
-#line 402 "shell.l"
+#line 412 "shell.l"
 {
-  char* buffer = malloc(strlen(yytext) + 1);
-  buffer[strlen(yytext)] = '\0';
-  int len = 0;
+  // Words are kept as typed, expand_word() runs when the
+  // command is executed. An extglob group like @(a|b) is part
+  // of the word, its | does not start a pipe.
 
-  if (buffer == NULL) {
-    perror("malloc");
-    exit(1);
-  }
+  if (g_lex_state == LEX_CASE_PATTERN) {
+    // a case pattern ends with ')', which is returned on its own
 
-  int i = 0;
-  char escape = '\\';
+    int length = case_pattern_length(yytext);
 
-  while (i < strlen(yytext)) {
-    if (yytext[i] == escape) {
-      buffer[len] = yytext[i+1];
-      ++len;
-      i += 2;
-    }
-    else {
-      buffer[len] = yytext[i];
-      ++len;
-      ++i;
+    if (length == 0) {
+      yyless(1);
+      g_lex_state = LEX_NORMAL;
+      return lex_token(RPAREN);
     }
-  }
-
-  char* filtered_word = malloc(len + 1);
-  filtered_word[len] = '\0';
-  strncpy(filtered_word, buffer, len);
-  yylval.string = strdup(filtered_word);
-  free(filtered_word);
-  free(buffer);
-
-  char* expanded_word = expand_variables(yylval.string);
-  
-  free(yylval.string);
-  yylval.string = strdup(expanded_word);
-  free(expanded_word);
-
-  // tilde stuff!
-
-  len = 0;
-  i = 0;
-
-  buffer = malloc(800);
-  
-  if (buffer == NULL) {
-    perror("malloc");
-    exit(1);
-  }
-
-  // if ~ is by itself or before / its user home
-
-  // if ~ is before a word its that users home
-
-  while (i < strlen(yylval.string)) {
-    if (yylval.string[i] == '~') {
-      if ((i + 1 >= strlen(yylval.string)) ||
-          (yylval.string[i + 1] == '/')) {
-        char* home_dir = getenv("HOME");
-
-        strcpy(buffer + len, home_dir);
-        len += strlen(home_dir);
-
-        if (yylval.string[i + 1] == '/') {
-          ++i;
-        }
-
-        ++i;
-      }
-      else {
-        char* home_path = "/homes/";
 
-        strcpy(buffer + len, home_path);
-        len += strlen(home_path);
+    if (length > 0) {
+      yyless(length);
+    }
 
-        ++i;
-      }
+    if ((yytext[0] == '(') && (yyleng > 1)) {
+      yylval.string = arena_strdup(&g_line_arena, yytext + 1);
     }
     else {
-      buffer[len] = yylval.string[i];
-      ++len;
-      ++i;
+      yylval.string = arena_strdup(&g_line_arena, yytext);
     }
   }
+  else {
+    yylval.string = arena_strdup(&g_line_arena, yytext);
+  }
 
-  filtered_word = malloc(len + 1);
-  filtered_word[len] = '\0';
-  strncpy(filtered_word, buffer, len);
-  free(yylval.string);
-  yylval.string = strdup(filtered_word);
-  free(filtered_word);
-  free(buffer);
+  int token = reserved_word(yytext);
 
-  return WORD;
+  if (token != WORD) {
+    yylval.string = NULL;
+  }
+
+  return lex_token(token);
 }
 	YY_BREAK
 case 4:
 YY_RULE_SETUP
-#line 499 "shell.l"
+#line 452 "shell.l"
 {
   char* file_name = malloc(strlen(yytext) - 7 + 1); 
 
@@ -1325,87 +1861,138 @@ YY_RULE_SETUP
 case 5:
 /* rule 5 can match eol */
 YY_RULE_SETUP
-#line 510 "shell.l"
+#line 463 "shell.l"
 {
-  return NEWLINE;
+  return lex_token(NEWLINE);
 }
 	YY_BREAK
 case 6:
 YY_RULE_SETUP
-#line 514 "shell.l"
+#line 467 "shell.l"
 {
   /* Discard spaces and tabs */
 }
 	YY_BREAK
 case 7:
 YY_RULE_SETUP
-#line 518 "shell.l"
+#line 471 "shell.l"
 {
   // pipe
-  return PIPE;
+  return lex_token(PIPE);
 }
 	YY_BREAK
 case 8:
 YY_RULE_SETUP
-#line 524 "shell.l"
+#line 476 "shell.l"
 {
-  // redirect stderr
-  return STDERR;
+  // run if the previous command failed
+
+  if (g_lex_state == LEX_COND) {
+    return cond_operator();
+  }
+
+  return lex_token(OR_IF);
 }
 	YY_BREAK
 case 9:
 YY_RULE_SETUP
-#line 529 "shell.l"
+#line 486 "shell.l"
 {
-  // redirect stdout and stderr to append to file?
-  return APPENDBOTH;
+  // run if the previous command succeeded
+
+  if (g_lex_state == LEX_COND) {
+    return cond_operator();
+  }
+
+  return lex_token(AND_IF);
 }
 	YY_BREAK
 case 10:
 YY_RULE_SETUP
-#line 534 "shell.l"
+#line 496 "shell.l"
 {
-  // redirect stdout and stderr
-  return BOTH;
+  // end of a case item
+  return lex_token(DSEMI);
 }
 	YY_BREAK
 case 11:
 YY_RULE_SETUP
-#line 539 "shell.l"
+#line 501 "shell.l"
 {
-  // append to file
-  return APPEND;
+  // command separator
+  return lex_token(SEMI);
 }
 	YY_BREAK
 case 12:
 YY_RULE_SETUP
-#line 544 "shell.l"
+#line 507 "shell.l"
 {
-  // background task
-  return AMPERSAND;
+  // redirect stderr
+  return lex_token(STDERR);
 }
 	YY_BREAK
 case 13:
 YY_RULE_SETUP
-#line 549 "shell.l"
+#line 512 "shell.l"
 {
-  return STDOUT;
+  // redirect stdout and stderr to append to file?
+  return lex_token(APPENDBOTH);
 }
 	YY_BREAK
 case 14:
 YY_RULE_SETUP
-#line 553 "shell.l"
+#line 517 "shell.l"
 {
-  // stdin
-  return STDIN;
+  // redirect stdout and stderr
+  return lex_token(BOTH);
 }
 	YY_BREAK
 case 15:
 YY_RULE_SETUP
-#line 557 "shell.l"
+#line 522 "shell.l"
+{
+  // append to file
+  return lex_token(APPEND);
+}
+	YY_BREAK
+case 16:
+YY_RULE_SETUP
+#line 527 "shell.l"
+{
+  // background task
+  return lex_token(AMPERSAND);
+}
+	YY_BREAK
+case 17:
+YY_RULE_SETUP
+#line 532 "shell.l"
+{
+  if (g_lex_state == LEX_COND) {
+    return cond_operator();
+  }
+
+  return lex_token(STDOUT);
+}
+	YY_BREAK
+case 18:
+YY_RULE_SETUP
+#line 540 "shell.l"
+{
+  // stdin
+
+  if (g_lex_state == LEX_COND) {
+    return cond_operator();
+  }
+
+  return lex_token(STDIN);
+}
+	YY_BREAK
+case 19:
+YY_RULE_SETUP
+#line 549 "shell.l"
 ECHO;
 	YY_BREAK
-#line 1408 "lex.yy.c"
+#line 1995 "lex.yy.c"
 case YY_STATE_EOF(INITIAL):
 	yyterminate();
 
@@ -1702,7 +2289,7 @@ static int yy_get_next_buffer (void)
 		while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 			{
 			yy_current_state = (int) yy_def[yy_current_state];
-			if ( yy_current_state >= 49 )
+			if ( yy_current_state >= 119 )
 				yy_c = yy_meta[yy_c];
 			}
 		yy_current_state = yy_nxt[yy_base[yy_current_state] + yy_c];
@@ -1730,11 +2317,11 @@ static int yy_get_next_buffer (void)
 	while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 		{
 		yy_current_state = (int) yy_def[yy_current_state];
-		if ( yy_current_state >= 49 )
+		if ( yy_current_state >= 119 )
 			yy_c = yy_meta[yy_c];
 		}
 	yy_current_state = yy_nxt[yy_base[yy_current_state] + yy_c];
-	yy_is_jam = (yy_current_state == 48);
+	yy_is_jam = (yy_current_state == 118);
 
 		return yy_is_jam ? 0 : yy_current_state;
 }
@@ -2422,4 +3009,4 @@ void yyfree (void * ptr )
 
 #define YYTABLES_NAME "yytables"
 
-#line 557 "shell.l"
+#line 549 "shell.l"
@@ -0,0 +1,437 @@
+#include "node.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "brace.h"
+#include "cond.h"
+#include "expand.h"
+#include "glob.h"
+#include "prompt.h"
+#include "qualifier.h"
+#include "shell.h"
+#include "tty_raw_mode.h"
+#include "vars.h"
+#include "wildcard.h"
+
+int g_loop_depth = 0;
+bool g_loop_break = false;
+bool g_loop_continue = false;
+pool_stats_t g_node_pool_stats = {.name = "node"};
+
+static node_t *g_node_pool[NODE_POOL_SIZE];
+static int g_node_pool_size = 0;
+
+/*
+ *  Allocate and initialize a node of the given type, reusing a freed
+ *  node if there is one
+ */
+
+node_t *create_node(node_type_t type) {
+  node_t *node = NULL;
+
+  if (g_node_pool_size > 0) {
+    node = g_node_pool[--g_node_pool_size];
+    g_node_pool_stats.num_reused++;
+  } else {
+    node = (node_t *)malloc(sizeof(node_t));
+
+    if (node == NULL) {
+      perror("malloc");
+      exit(1);
+    }
+
+    g_node_pool_stats.num_malloced++;
+  }
+
+  node->type = type;
+  node->command = NULL;
+  node->left = NULL;
+  node->right = NULL;
+  node->else_part = NULL;
+  node->var_name = NULL;
+  node->words = NULL;
+  node->background = false;
+
+  return node;
+} /* create_node() */
+
+/*
+ *  Wrap a pipeline in a node
+ */
+
+node_t *create_command_node(command_t *command) {
+  node_t *node = create_node(NODE_COMMAND);
+  node->command = command;
+
+  return node;
+} /* create_command_node() */
+
+/*
+ *  Create a list node (sequence, && or ||) joining left and right
+ */
+
+node_t *create_binary_node(node_type_t type, node_t *left, node_t *right) {
+  node_t *node = create_node(type);
+  node->left = left;
+  node->right = right;
+
+  return node;
+} /* create_binary_node() */
+
+/*
+ *  Mark a node to run in the background.
+ *  For a pipeline this is the same as a trailing & used to be,
+ *  anything else is run by a forked copy of the shell.
+ */
+
+void set_node_background(node_t *node) {
+  if (node->type == NODE_COMMAND) {
+    node->command->background = true;
+  } else {
+    node->background = true;
+  }
+} /* set_node_background() */
+
+/*
+ *  Free a node and everything below it. The loop variable name belongs
+ *  to the line arena.
+ */
+
+void free_node(node_t *node) {
+  if (node == NULL) {
+    return;
+  }
+
+  if (node->command != NULL) {
+    free_command(node->command);
+  }
+
+  free_node(node->left);
+  free_node(node->right);
+  free_node(node->else_part);
+
+  if (node->words != NULL) {
+    free_single_command(node->words);
+  }
+
+  if (g_node_pool_size < NODE_POOL_SIZE) {
+    g_node_pool[g_node_pool_size++] = node;
+    return;
+  }
+
+  free(node);
+} /* free_node() */
+
+/*
+ *  Returns true if a break or continue is unwinding the current loop
+ */
+
+static bool loop_interrupted() {
+  return g_loop_break || g_loop_continue;
+} /* loop_interrupted() */
+
+/*
+ *  Run a while or until loop
+ */
+
+static int execute_loop(node_t *node) {
+  int status = 0;
+
+  g_loop_depth++;
+
+  while (1) {
+    int condition = execute_node(node->left);
+
+    if (loop_interrupted()) {
+      break;
+    }
+
+    if ((condition == 0) != (node->type == NODE_WHILE)) {
+      break;
+    }
+
+    status = execute_node(node->right);
+
+    if (g_loop_break) {
+      break;
+    }
+
+    g_loop_continue = false;
+  }
+
+  g_loop_break = false;
+  g_loop_continue = false;
+  g_loop_depth--;
+
+  return status;
+} /* execute_loop() */
+
+/*
+ *  Run the body of a for loop with its variable set to value.
+ *  Returns false if the loop was broken out of.
+ */
+
+static bool run_for_body(node_t *node, const char *value, int *status) {
+  set_variable(node->var_name, value, false);
+
+  *status = execute_node(node->left);
+
+  if (g_loop_break) {
+    return false;
+  }
+
+  g_loop_continue = false;
+
+  return true;
+} /* run_for_body() */
+
+/*
+ *  Run the body of a for loop for one field of an expanded word, or
+ *  each match if it is a wildcard, which is iterated one match at a
+ *  time. Returns false if the loop was broken out of.
+ */
+
+static bool run_for_field(node_t *node, char *word, int *status) {
+  glob_qualifier_t qualifier;
+  char *pattern = split_glob_qualifier(word, &qualifier);
+
+  if (pattern == NULL) {
+    pattern = word;
+    memset(&qualifier, 0, sizeof(qualifier));
+  }
+
+  if (!has_glob(pattern)) {
+    return run_for_body(node, remove_glob_escapes(word), status);
+  }
+
+  glob_iterator_t *iterator = open_glob_iterator(pattern, &qualifier);
+  char *match = NULL;
+  bool matched = false;
+  bool running = true;
+
+  while ((running) && ((match = next_glob_match(iterator)) != NULL)) {
+    matched = true;
+    running = run_for_body(node, match, status);
+  }
+
+  close_glob_iterator(iterator);
+
+  if ((!matched) && (!qualifier.null_glob)) {
+    running = run_for_body(node, remove_glob_escapes(word), status);
+  }
+
+  return running;
+} /* run_for_field() */
+
+/*
+ *  Run the body of a for loop for each argument an unquoted word,
+ *  after brace expansion, expands to. Returns false if the loop was
+ *  broken out of.
+ */
+
+static bool run_for_word(node_t *node, char *brace_word, int *status) {
+  int num_fields = 0;
+  char **fields = expand_fields(brace_word, &num_fields);
+  bool running = true;
+
+  for (int i = 0; (i < num_fields) && (running); i++) {
+    running = run_for_field(node, fields[i], status);
+  }
+
+  return running;
+} /* run_for_word() */
+
+/*
+ *  Run a for loop. Words are expanded as the loop reaches them, and
+ *  brace ranges and wildcards are generated one value at a time, so
+ *  {1..10000000} is never held as a list and the body starts before
+ *  a large directory tree has been read in full.
+ */
+
+static int execute_for(node_t *node) {
+  int status = 0;
+  single_command_t *words = node->words;
+  bool running = true;
+
+  g_loop_depth++;
+
+  for (int i = 0; (i < words->num_words) && (running); i++) {
+    if (words->quoted[i]) {
+      running = run_for_body(node, words->words[i], &status);
+      continue;
+    }
+
+    brace_iterator_t *braces = open_brace_iterator(words->words[i]);
+    char *brace_word = words->words[i];
+
+    // each value is expanded into the arena and released after its
+    // iteration, the loop variable keeps its own copy
+
+    do {
+      if (braces != NULL) {
+        brace_word = next_brace_word(braces);
+
+        if (brace_word == NULL) {
+          break;
+        }
+      }
+
+      arena_mark_t expand_mark = arena_mark(&g_expand_arena);
+
+      running = run_for_word(node, brace_word, &status);
+      arena_release(&g_expand_arena, expand_mark);
+    } while ((running) && (braces != NULL));
+
+    if (braces != NULL) {
+      close_brace_iterator(braces);
+    }
+  }
+
+  g_loop_break = false;
+  g_loop_continue = false;
+  g_loop_depth--;
+
+  return status;
+} /* execute_for() */
+
+/*
+ *  Expand a word that is not split or wildcarded (the case word)
+ */
+
+static char *expand_case_word(single_command_t *words, int index) {
+  if (words->quoted[index]) {
+    return words->words[index];
+  }
+
+  return expand_word(words->words[index]);
+} /* expand_case_word() */
+
+/*
+ *  Run a case command, executing the body of the first item
+ *  with a pattern that matches the word
+ */
+
+static int execute_case(node_t *node) {
+  arena_mark_t expand_mark = arena_mark(&g_expand_arena);
+  char *word = expand_case_word(node->words, 0);
+
+  for (node_t *item = node->left; item != NULL; item = item->right) {
+    bool matched = false;
+
+    for (int i = 0; (i < item->words->num_words) && (!matched); i++) {
+      if (item->words->quoted[i]) {
+        matched = (strcmp(item->words->words[i], word) == 0);
+      } else {
+        matched = glob_matches(expand_pattern(item->words->words[i]), word);
+      }
+    }
+
+    if (matched) {
+      arena_release(&g_expand_arena, expand_mark);
+      return execute_node(item->left);
+    }
+  }
+
+  arena_release(&g_expand_arena, expand_mark);
+
+  return 0;
+} /* execute_case() */
+
+/*
+ *  Execute a command tree and return its exit status
+ */
+
+int execute_node(node_t *node) {
+  if (node == NULL) {
+    return 0;
+  }
+
+  if (node->background) {
+    tty_cooked_mode();
+
+    int ret = fork();
+
+    if (ret == -1) {
+      perror("fork");
+      exit(1);
+    }
+
+    if (ret == 0) {
+      node->background = false;
+      exit(execute_node(node));
+    }
+
+    g_last_background_pid = ret;
+    track_job(ret);
+    g_last_status = 0;
+
+    return 0;
+  }
+
+  int status = 0;
+
+  switch (node->type) {
+  case NODE_COMMAND:
+    status = execute_command(node->command);
+    break;
+  case NODE_SEQUENCE:
+    status = execute_node(node->left);
+
+    if (!loop_interrupted()) {
+      status = execute_node(node->right);
+    }
+    break;
+  case NODE_AND:
+    status = execute_node(node->left);
+
+    if ((status == 0) && (!loop_interrupted())) {
+      status = execute_node(node->right);
+    }
+    break;
+  case NODE_OR:
+    status = execute_node(node->left);
+
+    if ((status != 0) && (!loop_interrupted())) {
+      status = execute_node(node->right);
+    }
+    break;
+  case NODE_IF:
+    status = execute_node(node->left);
+
+    if (loop_interrupted()) {
+      break;
+    }
+
+    if (status == 0) {
+      status = execute_node(node->right);
+    } else if (node->else_part != NULL) {
+      status = execute_node(node->else_part);
+    } else {
+      status = 0;
+    }
+    break;
+  case NODE_WHILE:
+  case NODE_UNTIL:
+    status = execute_loop(node);
+    break;
+  case NODE_FOR:
+    status = execute_for(node);
+    break;
+  case NODE_CASE:
+    status = execute_case(node);
+    break;
+  case NODE_CASE_ITEM:
+    status = execute_node(node->left);
+    break;
+  case NODE_COND:
+    status = evaluate_conditional(node->words);
+    break;
+  }
+
+  g_last_status = status;
+
+  return status;
+} /* execute_node() */
@@ -0,0 +1,77 @@
+#ifndef NODE_H
+#define NODE_H
+
+#include <stdbool.h>
+
+#include "arena.h"
+#include "command.h"
+#include "single_command.h"
+
+// Freed nodes kept for reuse by create_node()
+
+#define NODE_POOL_SIZE (64)
+
+// Command Tree Data Structure
+//
+// A parsed command line is a tree of nodes. Pipelines (command_t) are
+// the leaves, lists and control flow are the inner nodes. The tree is
+// walked by execute_node(), so loop bodies are parsed only once.
+
+typedef enum node_type {
+  NODE_COMMAND,
+  NODE_SEQUENCE,
+  NODE_AND,
+  NODE_OR,
+  NODE_IF,
+  NODE_WHILE,
+  NODE_UNTIL,
+  NODE_FOR,
+  NODE_CASE,
+  NODE_CASE_ITEM,
+  NODE_COND,
+} node_type_t;
+
+typedef struct node {
+  node_type_t type;
+
+  // NODE_COMMAND
+
+  command_t *command;
+
+  // NODE_SEQUENCE, NODE_AND, NODE_OR: left and right
+  // NODE_IF: condition, then part and else part
+  // NODE_WHILE, NODE_UNTIL: condition and body
+  // NODE_FOR: body
+  // NODE_CASE: first item
+  // NODE_CASE_ITEM: body and next item
+
+  struct node *left;
+  struct node *right;
+  struct node *else_part;
+
+  // NODE_FOR: loop variable and word list
+  // NODE_CASE: word to match in words
+  // NODE_CASE_ITEM: patterns in words
+  // NODE_COND: the words between [[ and ]]
+
+  char *var_name;
+  single_command_t *words;
+
+  // Run the node in a child process without waiting for it
+
+  bool background;
+} node_t;
+
+node_t *create_node(node_type_t type);
+node_t *create_command_node(command_t *command);
+node_t *create_binary_node(node_type_t type, node_t *left, node_t *right);
+void set_node_background(node_t *node);
+void free_node(node_t *node);
+int execute_node(node_t *node);
+
+extern int g_loop_depth;
+extern bool g_loop_break;
+extern bool g_loop_continue;
+extern pool_stats_t g_node_pool_stats;
+
+#endif // NODE_H
@@ -0,0 +1,851 @@
+#define _GNU_SOURCE
+#include "prompt.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <pthread.h>
+#include <pwd.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "shell.h"
+#include "vars.h"
+
+#define PROMPT_VCS_VALUE_SIZE (256)
+
+static prompt_state_t g_prompt_state = {0};
+
+// The worker computing \b takes g_vcs_lock to read the directory it
+// is for and to store what it found
+
+static pthread_mutex_t g_vcs_lock = PTHREAD_MUTEX_INITIALIZER;
+static prompt_vcs_t g_vcs = {.wakeup = {-1, -1}};
+
+/*
+ *  Append length bytes of text to the prompt being expanded
+ */
+
+static void prompt_append(size_t *length, const char *text,
+                          size_t text_length) {
+  if (*length + text_length + 1 > g_prompt_state.next_size) {
+    g_prompt_state.next_size =
+        (g_prompt_state.next_size == 0) ? 64 : g_prompt_state.next_size;
+
+    while (*length + text_length + 1 > g_prompt_state.next_size) {
+      g_prompt_state.next_size *= 2;
+    }
+
+    g_prompt_state.next =
+        (char *)realloc(g_prompt_state.next, g_prompt_state.next_size);
+
+    if (g_prompt_state.next == NULL) {
+      perror("realloc");
+      exit(1);
+    }
+  }
+
+  memcpy(g_prompt_state.next + *length, text, text_length);
+  *length += text_length;
+  g_prompt_state.next[*length] = '\0';
+} /* prompt_append() */
+
+/*
+ *  Find the git directory of the work tree directory is in, into
+ *  git_dir. Returns false if it is not in one
+ */
+
+static bool find_git_dir(const char *directory, char *git_dir, size_t size) {
+  char path[PATH_MAX];
+
+  snprintf(path, sizeof(path), "%s", directory);
+
+  while (true) {
+    struct stat file_stat = {0};
+
+    snprintf(git_dir, size, "%s/.git", (strcmp(path, "/") == 0) ? "" : path);
+
+    if (stat(git_dir, &file_stat) == 0) {
+      if (S_ISDIR(file_stat.st_mode)) {
+        return true;
+      }
+
+      // a linked work tree, .git names the git directory
+
+      char line[PATH_MAX];
+      FILE *file = fopen(git_dir, "r");
+
+      if (file == NULL) {
+        return false;
+      }
+
+      bool found = (fgets(line, sizeof(line), file) != NULL) &&
+                   (strncmp(line, "gitdir: ", 8) == 0);
+
+      fclose(file);
+
+      if (!found) {
+        return false;
+      }
+
+      line[strcspn(line, "\n")] = '\0';
+
+      if (line[8] == '/') {
+        snprintf(git_dir, size, "%s", line + 8);
+      } else {
+        snprintf(git_dir, size, "%s/%s", path, line + 8);
+      }
+
+      return true;
+    }
+
+    char *slash = strrchr(path, '/');
+
+    if ((slash == NULL) || (strcmp(path, "/") == 0)) {
+      return false;
+    }
+
+    if (slash == path) {
+      slash[1] = '\0';
+    } else {
+      *slash = '\0';
+    }
+  }
+} /* find_git_dir() */
+
+/*
+ *  Milliseconds left until deadline
+ */
+
+static int remaining_budget(const struct timespec *deadline) {
+  struct timespec now = {0};
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  long remaining = (deadline->tv_sec - now.tv_sec) * 1000 +
+                   (deadline->tv_nsec - now.tv_nsec) / 1000000;
+
+  return (remaining > 0) ? (int)remaining : 0;
+} /* remaining_budget() */
+
+/*
+ *  Find git on the PATH of environment, into path. Returns false if
+ *  it is not there
+ */
+
+static bool find_git(char **environment, char *path, size_t size) {
+  const char *search = "";
+
+  for (int i = 0; (environment != NULL) && (environment[i] != NULL); i++) {
+    if (strncmp(environment[i], "PATH=", 5) == 0) {
+      search = environment[i] + 5;
+      break;
+    }
+  }
+
+  while (*search != '\0') {
+    size_t dir_length = strcspn(search, ":");
+
+    if (dir_length == 0) {
+      snprintf(path, size, "git");
+    } else {
+      snprintf(path, size, "%.*s/git", (int)dir_length, search);
+    }
+
+    if (access(path, X_OK) == 0) {
+      return true;
+    }
+
+    search += dir_length;
+
+    if (*search == ':') {
+      search++;
+    }
+  }
+
+  return false;
+} /* find_git() */
+
+/*
+ *  Child of the worker, turning into git. Signals are all blocked, as
+ *  in the worker, and the handlers it got from the shell are reset
+ *  before they are unblocked
+ */
+
+static int exec_git(void *argument) {
+  prompt_vcs_exec_t *exec = (prompt_vcs_exec_t *)argument;
+  sigset_t mask;
+
+  for (int signum = 1; signum < NSIG; signum++) {
+    struct sigaction action = {0};
+
+    if ((sigaction(signum, NULL, &action) == 0) &&
+        (action.sa_handler != SIG_DFL) && (action.sa_handler != SIG_IGN)) {
+      signal(signum, SIG_DFL);
+    }
+  }
+
+  sigemptyset(&mask);
+  sigprocmask(SIG_SETMASK, &mask, NULL);
+
+  int null = open("/dev/null", O_RDWR);
+
+  if ((null == -1) || (dup2(null, 0) == -1) || (dup2(exec->output, 1) == -1) ||
+      (dup2(null, 2) == -1)) {
+    _exit(127);
+  }
+
+  execve(exec->path, exec->arguments, exec->environment);
+  _exit(127);
+} /* exec_git() */
+
+/*
+ *  Ask git whether the work tree of directory has changes, giving up
+ *  after budget milliseconds. Returns 1 if it has, 0 if not, -1 if git
+ *  took too long and 0 if it could not be run.
+ *  git is started as a child that sends no signal when it exits, so
+ *  the SIGCHLD handler of the shell neither hears of it nor reaps it,
+ *  and only this thread can wait for it or kill it
+ */
+
+static int has_vcs_changes(const char *directory, char **environment,
+                           int budget) {
+  char git[PATH_MAX];
+  int output[2] = {-1, -1};
+
+  if (!find_git(environment, git, sizeof(git))) {
+    return 0;
+  }
+
+  if (pipe(output) == -1) {
+    return 0;
+  }
+
+  fcntl(output[0], F_SETFD, FD_CLOEXEC);
+  fcntl(output[1], F_SETFD, FD_CLOEXEC);
+
+  char *arguments[] = {"git",         "--no-optional-locks",
+                       "-C",          (char *)directory,
+                       "status",      "--porcelain",
+                       "--untracked-files=no", NULL};
+  prompt_vcs_exec_t exec = {.path = git,
+                            .arguments = arguments,
+                            .environment = environment,
+                            .output = output[1]};
+  char *stack = (char *)malloc(PROMPT_VCS_STACK_SIZE);
+
+  if (stack == NULL) {
+    perror("malloc");
+    exit(1);
+  }
+
+  // the child gets a copy of the memory, so the stack can go as soon
+  // as it is started
+
+  pid_t pid = clone(exec_git, stack + PROMPT_VCS_STACK_SIZE, 0, &exec);
+
+  free(stack);
+  close(output[1]);
+
+  if (pid == -1) {
+    close(output[0]);
+    return 0;
+  }
+
+  struct timespec deadline = {0};
+
+  clock_gettime(CLOCK_MONOTONIC, &deadline);
+  deadline.tv_sec += budget / 1000;
+  deadline.tv_nsec += (long)(budget % 1000) * 1000000;
+
+  if (deadline.tv_nsec >= 1000000000) {
+    deadline.tv_sec++;
+    deadline.tv_nsec -= 1000000000;
+  }
+
+  // any line of output is a change, the rest is not waited for
+
+  int result = -1;
+
+  while (result == -1) {
+    struct pollfd input = {.fd = output[0], .events = POLLIN};
+    int ready = poll(&input, 1, remaining_budget(&deadline));
+
+    if ((ready < 0) && (errno == EINTR)) {
+      continue;
+    }
+
+    if (ready <= 0) {
+      break;
+    }
+
+    char buffer[256];
+    ssize_t count = read(output[0], buffer, sizeof(buffer));
+
+    if ((count < 0) && (errno == EINTR)) {
+      continue;
+    }
+
+    result = (count > 0) ? 1 : 0;
+  }
+
+  close(output[0]);
+
+  // nobody else reaps it, so pid is still git, running or a zombie
+
+  kill(pid, SIGKILL);
+
+  while ((waitpid(pid, NULL, __WCLONE) == -1) && (errno == EINTR)) {
+  }
+
+  return result;
+} /* has_vcs_changes() */
+
+/*
+ *  Compute \b for directory into value: the branch checked out, or
+ *  the start of the commit if none is, then * for changes or ? if git
+ *  took longer than the budget. Empty outside a work tree. git is
+ *  looked up and run with environment. Returns true if the budget ran
+ *  out
+ */
+
+static bool find_vcs(const char *directory, char **environment, char *value,
+                     size_t size) {
+  char git_dir[PATH_MAX];
+  char head[PATH_MAX];
+
+  value[0] = '\0';
+
+  if (!find_git_dir(directory, git_dir, sizeof(git_dir))) {
+    return false;
+  }
+
+  strncat(git_dir, "/HEAD", sizeof(git_dir) - strlen(git_dir) - 1);
+
+  FILE *file = fopen(git_dir, "r");
+
+  if (file == NULL) {
+    return false;
+  }
+
+  bool found = (fgets(head, sizeof(head), file) != NULL);
+
+  fclose(file);
+
+  if (!found) {
+    return false;
+  }
+
+  head[strcspn(head, "\n")] = '\0';
+
+  if (strncmp(head, "ref: refs/heads/", 16) == 0) {
+    snprintf(value, size, "%s", head + 16);
+  } else {
+    snprintf(value, size, "%.7s", head);
+  }
+
+  int changes = has_vcs_changes(directory, environment, PROMPT_VCS_BUDGET);
+
+  if (changes != 0) {
+    strncat(value, (changes > 0) ? "*" : "?", size - strlen(value) - 1);
+  }
+
+  return changes < 0;
+} /* find_vcs() */
+
+/*
+ *  Cache entry of directory, NULL if there is none. Called with
+ *  g_vcs_lock held
+ */
+
+static prompt_vcs_entry_t *find_vcs_entry(const char *directory) {
+  for (int i = 0; i < PROMPT_VCS_CACHE_SIZE; i++) {
+    if ((g_vcs.cache[i].directory != NULL) &&
+        (strcmp(g_vcs.cache[i].directory, directory) == 0)) {
+      g_vcs.cache[i].last_used = ++g_vcs.clock;
+      return &g_vcs.cache[i];
+    }
+  }
+
+  return NULL;
+} /* find_vcs_entry() */
+
+/*
+ *  Remember value as \b of directory, replacing the entry used least
+ *  recently if it is new. Returns true if the value changed. Called
+ *  with g_vcs_lock held
+ */
+
+static bool store_vcs(const char *directory, const char *value) {
+  prompt_vcs_entry_t *entry = find_vcs_entry(directory);
+
+  if (entry == NULL) {
+    entry = &g_vcs.cache[0];
+
+    for (int i = 1; i < PROMPT_VCS_CACHE_SIZE; i++) {
+      if (g_vcs.cache[i].last_used < entry->last_used) {
+        entry = &g_vcs.cache[i];
+      }
+    }
+
+    free(entry->directory);
+    free(entry->value);
+    entry->directory = strdup(directory);
+    entry->value = NULL;
+    entry->last_used = ++g_vcs.clock;
+  } else if (strcmp(entry->value, value) == 0) {
+    return false;
+  }
+
+  free(entry->value);
+  entry->value = strdup(value);
+
+  if ((entry->directory == NULL) || (entry->value == NULL)) {
+    perror("strdup");
+    exit(1);
+  }
+
+  return true;
+} /* store_vcs() */
+
+/*
+ *  Copy of the environment exported to commands, for git to run with
+ *  off the main thread
+ */
+
+static char **copy_environment() {
+  char **environment = get_environment();
+  int count = 0;
+
+  while (environment[count] != NULL) {
+    count++;
+  }
+
+  char **copy = (char **)malloc((count + 1) * sizeof(char *));
+
+  if (copy == NULL) {
+    perror("malloc");
+    exit(1);
+  }
+
+  for (int i = 0; i < count; i++) {
+    copy[i] = strdup(environment[i]);
+
+    if (copy[i] == NULL) {
+      perror("strdup");
+      exit(1);
+    }
+  }
+
+  copy[count] = NULL;
+
+  return copy;
+} /* copy_environment() */
+
+/*
+ *  Free a copy made by copy_environment()
+ */
+
+static void free_environment(char **environment) {
+  if (environment == NULL) {
+    return;
+  }
+
+  for (int i = 0; environment[i] != NULL; i++) {
+    free(environment[i]);
+  }
+
+  free(environment);
+} /* free_environment() */
+
+/*
+ *  Worker computing \b for the directory of the prompt shown last,
+ *  until it has answered every prompt that asked. The line editor is
+ *  woken up if a value changed
+ */
+
+static void *update_vcs(void *argument) {
+  char **environment = NULL;
+  bool changed = false;
+
+  (void)argument;
+
+  pthread_mutex_lock(&g_vcs_lock);
+
+  while (g_vcs.answered < g_vcs.requested) {
+    unsigned long request = g_vcs.requested;
+    char *directory = strdup(g_vcs.directory);
+
+    if (directory == NULL) {
+      perror("strdup");
+      exit(1);
+    }
+
+    // the environment of the latest request is taken over, a later
+    // one replaces it in g_vcs
+
+    if (g_vcs.environment != NULL) {
+      free_environment(environment);
+      environment = g_vcs.environment;
+      g_vcs.environment = NULL;
+    }
+
+    pthread_mutex_unlock(&g_vcs_lock);
+
+    char value[PROMPT_VCS_VALUE_SIZE];
+    bool timed_out = find_vcs(directory, environment, value, sizeof(value));
+
+    pthread_mutex_lock(&g_vcs_lock);
+
+    changed = store_vcs(directory, value) || changed;
+    g_vcs.answered = request;
+    g_vcs.num_runs++;
+    g_vcs.num_timeouts += timed_out;
+
+    free(directory);
+  }
+
+  g_vcs.running = false;
+  pthread_mutex_unlock(&g_vcs_lock);
+
+  free_environment(environment);
+
+  if (changed) {
+    write(g_vcs.wakeup[1], "", 1);
+  }
+
+  return NULL;
+} /* update_vcs() */
+
+/*
+ *  Append \b of directory as last found, and if request is set start
+ *  the worker to find it again
+ */
+
+static void append_vcs(size_t *length, const char *directory, bool request) {
+  pthread_mutex_lock(&g_vcs_lock);
+
+  prompt_vcs_entry_t *entry = find_vcs_entry(directory);
+
+  if (entry != NULL) {
+    prompt_append(length, entry->value, strlen(entry->value));
+  }
+
+  if (request) {
+    free(g_vcs.directory);
+    g_vcs.directory = strdup(directory);
+
+    if (g_vcs.directory == NULL) {
+      perror("strdup");
+      exit(1);
+    }
+
+    free_environment(g_vcs.environment);
+    g_vcs.environment = copy_environment();
+    g_vcs.requested++;
+
+    if (g_vcs.wakeup[0] == -1) {
+      if (pipe(g_vcs.wakeup) == -1) {
+        perror("pipe");
+        exit(1);
+      }
+
+      for (int i = 0; i < 2; i++) {
+        fcntl(g_vcs.wakeup[i], F_SETFD, FD_CLOEXEC);
+        fcntl(g_vcs.wakeup[i], F_SETFL, O_NONBLOCK);
+      }
+    }
+
+    if (!g_vcs.running) {
+      pthread_t thread;
+      pthread_attr_t attributes;
+      sigset_t all_signals;
+      sigset_t old_mask;
+
+      // the worker starts with every signal blocked, so a SIGCHLD of
+      // a foreground command is never handled, and its child reaped,
+      // on it
+
+      sigfillset(&all_signals);
+      pthread_sigmask(SIG_SETMASK, &all_signals, &old_mask);
+      pthread_attr_init(&attributes);
+      pthread_attr_setdetachstate(&attributes, PTHREAD_CREATE_DETACHED);
+
+      if (pthread_create(&thread, &attributes, update_vcs, NULL) != 0) {
+        perror("pthread_create");
+        exit(1);
+      }
+
+      pthread_attr_destroy(&attributes);
+      pthread_sigmask(SIG_SETMASK, &old_mask, NULL);
+      g_vcs.running = true;
+    }
+  }
+
+  pthread_mutex_unlock(&g_vcs_lock);
+} /* append_vcs() */
+
+/*
+ *  Number of background jobs still running
+ */
+
+static int count_jobs() {
+  int running = 0;
+
+  for (int i = 0; i < g_prompt_state.num_jobs; i++) {
+    // kill() would test a whole process group for a pid of 0 or less
+
+    if ((g_prompt_state.jobs[i] > 0) &&
+        (kill(g_prompt_state.jobs[i], 0) == 0)) {
+      g_prompt_state.jobs[running++] = g_prompt_state.jobs[i];
+    }
+  }
+
+  g_prompt_state.num_jobs = running;
+
+  return running;
+} /* count_jobs() */
+
+/*
+ *  Append the time the last command took, if it was a second or more
+ */
+
+static void append_duration(size_t *length) {
+  char text[32];
+  int text_length = 0;
+
+  if (g_prompt_state.duration < 1.0) {
+    return;
+  }
+
+  if (g_prompt_state.duration < 60.0) {
+    text_length =
+        snprintf(text, sizeof(text), "%.1fs", g_prompt_state.duration);
+  } else {
+    text_length = snprintf(text, sizeof(text), "%dm%02ds",
+                           (int)g_prompt_state.duration / 60,
+                           (int)g_prompt_state.duration % 60);
+  }
+
+  prompt_append(length, text, text_length);
+} /* append_duration() */
+
+/*
+ *  Expand PS1 into g_prompt_state.next. \b is requested from the worker if
+ *  request is set
+ */
+
+static void expand_prompt(bool request) {
+  const char *ps1 = get_variable("PS1");
+  size_t length = 0;
+
+  prompt_append(&length, "", 0);
+
+  if (ps1 == NULL) {
+    prompt_append(&length, PROMPT_DEFAULT, strlen(PROMPT_DEFAULT));
+    return;
+  }
+
+  char *directory = getcwd(NULL, 0);
+  const char *home = get_variable("HOME");
+  size_t home_length = (home != NULL) ? strlen(home) : 0;
+  char text[64];
+
+  for (const char *c = ps1; *c != '\0'; c++) {
+    if ((*c != '\\') || (c[1] == '\0')) {
+      prompt_append(&length, c, 1);
+      continue;
+    }
+
+    c++;
+
+    switch (*c) {
+    case 'w':
+    case 'W':
+      if (directory == NULL) {
+        break;
+      }
+
+      if ((home_length > 1) && (strncmp(directory, home, home_length) == 0) &&
+          ((directory[home_length] == '\0') ||
+           (directory[home_length] == '/'))) {
+        if ((*c == 'w') || (directory[home_length] == '\0')) {
+          prompt_append(&length, "~", 1);
+          prompt_append(&length, directory + home_length,
+                        strlen(directory + home_length));
+          break;
+        }
+      }
+
+      if ((*c == 'W') && (strcmp(directory, "/") != 0)) {
+        const char *name = strrchr(directory, '/') + 1;
+
+        prompt_append(&length, name, strlen(name));
+      } else {
+        prompt_append(&length, directory, strlen(directory));
+      }
+      break;
+    case 'u': {
+      struct passwd *user = getpwuid(geteuid());
+
+      if (user != NULL) {
+        prompt_append(&length, user->pw_name, strlen(user->pw_name));
+      }
+      break;
+    }
+    case 'h':
+      if (gethostname(text, sizeof(text)) == 0) {
+        text[sizeof(text) - 1] = '\0';
+        prompt_append(&length, text, strcspn(text, "."));
+      }
+      break;
+    case '?':
+      prompt_append(&length, text,
+                    snprintf(text, sizeof(text), "%d", g_last_status));
+      break;
+    case 'j':
+      prompt_append(&length, text,
+                    snprintf(text, sizeof(text), "%d", count_jobs()));
+      break;
+    case 't':
+      append_duration(&length);
+      break;
+    case 'b':
+      if (directory != NULL) {
+        append_vcs(&length, directory, request);
+      }
+      break;
+    case 'e':
+      prompt_append(&length, "\033", 1);
+      break;
+    case 'n':
+      prompt_append(&length, "\n", 1);
+      break;
+    case '$':
+      prompt_append(&length, (geteuid() == 0) ? "#" : "$", 1);
+      break;
+    case '\\':
+      prompt_append(&length, "\\", 1);
+      break;
+    default:
+      prompt_append(&length, c - 1, 2);
+      break;
+    }
+  }
+
+  free(directory);
+} /* expand_prompt() */
+
+/*
+ *  Make the prompt expanded last the one shown
+ */
+
+static const char *show_prompt() {
+  char *text = g_prompt_state.text;
+  size_t text_size = g_prompt_state.text_size;
+
+  g_prompt_state.text = g_prompt_state.next;
+  g_prompt_state.text_size = g_prompt_state.next_size;
+  g_prompt_state.next = text;
+  g_prompt_state.next_size = text_size;
+
+  return g_prompt_state.text;
+} /* show_prompt() */
+
+/*
+ *  The prompt to print, with \b as last found for the directory. The
+ *  time the command that just finished took is taken here
+ */
+
+const char *format_prompt() {
+  if (g_prompt_state.timing) {
+    struct timespec now = {0};
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    g_prompt_state.duration =
+        (now.tv_sec - g_prompt_state.command_start.tv_sec) +
+        (now.tv_nsec - g_prompt_state.command_start.tv_nsec) / 1e9;
+    g_prompt_state.timing = false;
+  }
+
+  g_prompt_state.num_prompts++;
+  expand_prompt(true);
+
+  return show_prompt();
+} /* format_prompt() */
+
+/*
+ *  The prompt expanded again after the worker woke the line editor
+ *  up, or NULL if it did not change
+ */
+
+const char *refresh_prompt() {
+  expand_prompt(false);
+
+  if ((g_prompt_state.text != NULL) &&
+      (strcmp(g_prompt_state.next, g_prompt_state.text) == 0)) {
+    return NULL;
+  }
+
+  g_prompt_state.num_repaints++;
+
+  return show_prompt();
+} /* refresh_prompt() */
+
+/*
+ *  Descriptor that becomes readable when the prompt should be
+ *  refreshed, -1 if PS1 has nothing computed by the worker
+ */
+
+int prompt_wakeup() {
+  return g_vcs.wakeup[0];
+} /* prompt_wakeup() */
+
+/*
+ *  The line read is starting to run
+ */
+
+void start_command_timer() {
+  clock_gettime(CLOCK_MONOTONIC, &g_prompt_state.command_start);
+  g_prompt_state.timing = true;
+} /* start_command_timer() */
+
+/*
+ *  Count pid as a background job for \j until it exits
+ */
+
+void track_job(pid_t pid) {
+  if (g_prompt_state.num_jobs == g_prompt_state.jobs_size) {
+    g_prompt_state.jobs_size =
+        (g_prompt_state.jobs_size == 0) ? 8 : g_prompt_state.jobs_size * 2;
+    g_prompt_state.jobs =
+        (pid_t *)realloc(g_prompt_state.jobs,
+                         g_prompt_state.jobs_size * sizeof(pid_t));
+
+    if (g_prompt_state.jobs == NULL) {
+      perror("realloc");
+      exit(1);
+    }
+  }
+
+  g_prompt_state.jobs[g_prompt_state.num_jobs++] = pid;
+} /* track_job() */
+
+/*
+ *  Print the prompt counters
+ */
+
+void print_prompt_stats() {
+  pthread_mutex_lock(&g_vcs_lock);
+  printf("prompt shown %lu repainted %lu vcs runs %lu timeouts %lu\n",
+         g_prompt_state.num_prompts, g_prompt_state.num_repaints,
+         g_vcs.num_runs, g_vcs.num_timeouts);
+  pthread_mutex_unlock(&g_vcs_lock);
+} /* print_prompt_stats() */
@@ -0,0 +1,107 @@
+#ifndef PROMPT_H
+#define PROMPT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
+#include <time.h>
+
+// Prompt
+//
+// The prompt is PS1 with these escapes expanded, or myshell> when PS1
+// is not set:
+//
+//   \w  working directory, ~ for $HOME    \W  its last component
+//   \u  user name                         \h  host name
+//   \?  exit status of the last command   \j  background jobs running
+//   \t  time the last command took, when it was a second or more
+//   \b  git branch, followed by * when the work tree has changes, or
+//       ? when finding out took longer than the budget
+//   \e  escape, to start color sequences  \n  newline
+//   \$  # for root, $ for others          \\  backslash
+//
+// \b is computed on a worker thread, so the prompt never waits on a
+// slow repository: the value last found for the directory is shown at
+// once and the worker is started, and when it finds something else
+// it writes to a pipe that wakes the line editor up to repaint the
+// prompt. The worker gives git PROMPT_VCS_BUDGET milliseconds to
+// report changes, and runs it with the variables the shell exports.
+
+#define PROMPT_DEFAULT "myshell>"
+#define PROMPT_VCS_BUDGET (1000)
+#define PROMPT_VCS_CACHE_SIZE (16)
+#define PROMPT_VCS_STACK_SIZE (64 * 1024)
+
+typedef struct prompt_vcs_entry {
+  char *directory;
+  char *value;
+  unsigned long last_used;
+} prompt_vcs_entry_t;
+
+typedef struct prompt_vcs_exec {
+  const char *path;
+  char **arguments;
+  char **environment;
+  int output;
+} prompt_vcs_exec_t;
+
+typedef struct prompt_state {
+  // Prompt shown last and the one being expanded
+
+  char *text;
+  size_t text_size;
+  char *next;
+  size_t next_size;
+
+  // Background jobs started
+
+  pid_t *jobs;
+  int num_jobs;
+  int jobs_size;
+
+  // Start of the command being run, and how long the last one took
+
+  struct timespec command_start;
+  bool timing;
+  double duration;
+
+  // Counters reported by the stats builtin
+
+  unsigned long num_prompts;
+  unsigned long num_repaints;
+} prompt_state_t;
+
+typedef struct prompt_vcs {
+  // \b values found last, by directory
+
+  prompt_vcs_entry_t cache[PROMPT_VCS_CACHE_SIZE];
+  unsigned long clock;
+
+  // Directory and environment of the prompt shown last, and the
+  // number of prompts that asked for it and that the worker has
+  // answered
+
+  char *directory;
+  char **environment;
+  unsigned long requested;
+  unsigned long answered;
+  bool running;
+
+  // The worker writes to wakeup[1] when a value changed
+
+  int wakeup[2];
+
+  // Counters reported by the stats builtin
+
+  unsigned long num_runs;
+  unsigned long num_timeouts;
+} prompt_vcs_t;
+
+const char *format_prompt();
+const char *refresh_prompt();
+int prompt_wakeup();
+void start_command_timer();
+void track_job(pid_t pid);
+void print_prompt_stats();
+
+#endif // PROMPT_H
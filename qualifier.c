@@ -0,0 +1,239 @@
+#define _GNU_SOURCE
+
+#include "qualifier.h"
+
+#include <ctype.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "arena.h"
+#include "glob.h"
+
+/*
+ *  Parse an optional unit letter, an optional + or - and a number
+ *  starting at *text into check. Returns false if there is no number.
+ */
+
+static bool parse_amount(const char **text, glob_check_t *check,
+                         const char *units, const long long *unit_sizes) {
+  const char *unit = NULL;
+
+  if ((**text != '\0') && ((unit = strchr(units, **text)) != NULL)) {
+    check->unit = unit_sizes[unit - units];
+    (*text)++;
+  }
+
+  check->compare = '=';
+
+  if ((**text == '+') || (**text == '-')) {
+    check->compare = *(*text)++;
+  }
+
+  if (!isdigit((unsigned char)**text)) {
+    return false;
+  }
+
+  check->amount = strtoll(*text, (char **)text, 10);
+
+  return true;
+} /* parse_amount() */
+
+/*
+ *  Parse the qualifier list between text and end into qualifier.
+ *  Returns false if any of it is not a qualifier.
+ */
+
+static bool parse_qualifiers(const char *text, const char *end,
+                             glob_qualifier_t *qualifier) {
+  static const char *type_letters = "./@=p%";
+  static const unsigned char types[] = {DT_REG,  DT_DIR, DT_LNK,
+                                        DT_SOCK, DT_FIFO, DT_BLK};
+  static const char *size_units = "kKmMgGpP";
+  static const long long size_unit_bytes[] = {
+      1024, 1024, 1024 * 1024, 1024 * 1024, 1024 * 1024 * 1024,
+      1024 * 1024 * 1024, 512, 512};
+  static const char *time_units = "Mwdhms";
+  static const long long time_unit_seconds[] = {30 * 86400, 7 * 86400, 86400,
+                                                3600,       60,        1};
+
+  bool negate = false;
+
+  memset(qualifier, 0, sizeof(glob_qualifier_t));
+
+  while (text < end) {
+    char c = *text++;
+
+    if (c == '^') {
+      negate = !negate;
+      continue;
+    }
+
+    if (c == 'N') {
+      qualifier->null_glob = true;
+      continue;
+    }
+
+    if (qualifier->num_checks == MAX_GLOB_CHECKS) {
+      return false;
+    }
+
+    glob_check_t *check = &qualifier->checks[qualifier->num_checks++];
+
+    check->negate = negate;
+
+    if ((c != '\0') && (strchr(type_letters, c) != NULL)) {
+      check->kind = CHECK_TYPE;
+      check->type = types[strchr(type_letters, c) - type_letters];
+    } else if (c == '*') {
+      check->kind = CHECK_EXECUTABLE;
+      qualifier->stat_mask |= STATX_MODE;
+    } else if (c == 'L') {
+      check->kind = CHECK_SIZE;
+      check->unit = 1;
+      qualifier->stat_mask |= STATX_SIZE;
+
+      if (!parse_amount(&text, check, size_units, size_unit_bytes)) {
+        return false;
+      }
+    } else if ((c == 'm') || (c == 'a') || (c == 'c')) {
+      check->kind = (c == 'm') ? CHECK_MTIME
+                               : ((c == 'a') ? CHECK_ATIME : CHECK_CTIME);
+      check->unit = 86400;
+      qualifier->stat_mask |= (c == 'm') ? STATX_MTIME
+                                         : ((c == 'a') ? STATX_ATIME
+                                                       : STATX_CTIME);
+
+      if (!parse_amount(&text, check, time_units, time_unit_seconds)) {
+        return false;
+      }
+    } else {
+      return false;
+    }
+  }
+
+  return text == end;
+} /* parse_qualifiers() */
+
+/*
+ *  If word ends in a qualifier list after a wildcard pattern, parse
+ *  the list into qualifier and return the pattern without it, in the
+ *  expansion arena. Returns NULL if it does not.
+ */
+
+char *split_glob_qualifier(const char *word, glob_qualifier_t *qualifier) {
+  size_t length = strlen(word);
+
+  if ((length < 3) || (word[length - 1] != ')')) {
+    return NULL;
+  }
+
+  const char *open = strrchr(word, '(');
+
+  if ((open == NULL) || (open == word) || (open[-1] == '\\') ||
+      (open[1] == ')')) {
+    return NULL;
+  }
+
+  if (!parse_qualifiers(open + 1, word + length - 1, qualifier)) {
+    return NULL;
+  }
+
+  char *pattern = arena_strndup(&g_expand_arena, word, open - word);
+
+  if (!has_glob(pattern)) {
+    return NULL;
+  }
+
+  return pattern;
+} /* split_glob_qualifier() */
+
+/*
+ *  Compare a size or age in whole units to a check
+ */
+
+static bool compare_amount(const glob_check_t *check, long long units) {
+  switch (check->compare) {
+  case '+':
+    return units > check->amount;
+  case '-':
+    return units < check->amount;
+  default:
+    return units == check->amount;
+  }
+} /* compare_amount() */
+
+/*
+ *  Age in whole units of check of a statx timestamp
+ */
+
+static long long age_in_units(const glob_check_t *check,
+                              struct statx_timestamp *stamp, time_t now) {
+  long long age = (long long)now - stamp->tv_sec;
+
+  return (age < 0) ? 0 : age / check->unit;
+} /* age_in_units() */
+
+/*
+ *  True if the entry name in dirfd, of d_type type, passes every
+ *  check of qualifier. It is stat'd at most once, only if needed.
+ */
+
+bool match_qualifier(const glob_qualifier_t *qualifier, int dirfd,
+                     const char *name, unsigned char type) {
+  struct statx stx = {0};
+  unsigned int mask = qualifier->stat_mask;
+
+  if ((type == DT_UNKNOWN) && (qualifier->num_checks > 0)) {
+    mask |= STATX_TYPE;
+  }
+
+  if (mask != 0) {
+    if (statx(dirfd, name, AT_SYMLINK_NOFOLLOW, mask, &stx) != 0) {
+      return false;
+    }
+
+    if (type == DT_UNKNOWN) {
+      type = IFTODT(stx.stx_mode);
+    }
+  }
+
+  time_t now = time(NULL);
+
+  for (int i = 0; i < qualifier->num_checks; i++) {
+    const glob_check_t *check = &qualifier->checks[i];
+    bool passed = false;
+
+    switch (check->kind) {
+    case CHECK_TYPE:
+      passed = (type == check->type) ||
+               ((check->type == DT_BLK) && (type == DT_CHR));
+      break;
+    case CHECK_EXECUTABLE:
+      passed = (type == DT_REG) && ((stx.stx_mode & 0111) != 0);
+      break;
+    case CHECK_SIZE:
+      passed = compare_amount(
+          check, (stx.stx_size + check->unit - 1) / check->unit);
+      break;
+    case CHECK_MTIME:
+      passed = compare_amount(check, age_in_units(check, &stx.stx_mtime, now));
+      break;
+    case CHECK_ATIME:
+      passed = compare_amount(check, age_in_units(check, &stx.stx_atime, now));
+      break;
+    case CHECK_CTIME:
+      passed = compare_amount(check, age_in_units(check, &stx.stx_ctime, now));
+      break;
+    }
+
+    if (passed == check->negate) {
+      return false;
+    }
+  }
+
+  return true;
+} /* match_qualifier() */
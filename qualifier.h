@@ -0,0 +1,69 @@
+#ifndef QUALIFIER_H
+#define QUALIFIER_H
+
+#include <stdbool.h>
+
+// Glob Qualifiers
+//
+// A wildcard word may end in a zsh style qualifier list that filters
+// its matches, as in *(.) or *(mh-1). The list is only taken as
+// qualifiers when every character of it parses, otherwise the group
+// is left to the pattern as an extglob.
+//
+//   .  regular file    /  directory    @  symbolic link
+//   =  socket          p  fifo         %  device
+//   *  executable regular file
+//   ^  negate the qualifiers after it
+//   N  expand to nothing when nothing matches
+//   L[kmgp][+-]n         size in bytes, KiB, MiB, GiB or 512 byte blocks
+//   m|a|c[Mwdhms][+-]n   modification, access or change age, in
+//                        months, weeks, days (default), hours, minutes
+//                        or seconds
+//
+// Without + or - a size or age must be exactly n units, + means more
+// and - means less. Types come from d_type, the file is only stat'd
+// for *, sizes and ages, or when the filesystem gives no d_type.
+
+// Most qualifiers in one list
+
+#define MAX_GLOB_CHECKS (16)
+
+typedef enum glob_check_kind {
+  CHECK_TYPE,
+  CHECK_EXECUTABLE,
+  CHECK_SIZE,
+  CHECK_MTIME,
+  CHECK_ATIME,
+  CHECK_CTIME
+} glob_check_kind_t;
+
+typedef struct glob_check {
+  glob_check_kind_t kind;
+  bool negate;
+
+  // d_type wanted by CHECK_TYPE, DT_BLK also accepts DT_CHR
+
+  unsigned char type;
+
+  // '+', '-' or '=' against amount units of unit bytes or seconds
+
+  char compare;
+  long long amount;
+  long long unit;
+} glob_check_t;
+
+typedef struct glob_qualifier {
+  glob_check_t checks[MAX_GLOB_CHECKS];
+  int num_checks;
+  bool null_glob;
+
+  // statx() mask needed by the checks, 0 if d_type is enough
+
+  unsigned int stat_mask;
+} glob_qualifier_t;
+
+char *split_glob_qualifier(const char *word, glob_qualifier_t *qualifier);
+bool match_qualifier(const glob_qualifier_t *qualifier, int dirfd,
+                     const char *name, unsigned char type);
+
+#endif // QUALIFIER_H
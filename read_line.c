@@ -1,22 +1,30 @@
 #include "read_line.h"
 
 #include <regex.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/ioctl.h>
 #include <unistd.h>
 
+#include "complete.h"
+#include "highlight.h"
+#include "history.h"
+#include "history_index.h"
+#include "key_input.h"
+#include "prompt.h"
+#include "regex_cache.h"
+#include "render.h"
+#include "shell.h"
+#include "suggest.h"
 #include "tty_raw_mode.h"
 
 // extern void tty_raw_mode(void);
 
-int g_line_index = 0;
-int g_line_length = 0;
-char g_line_buffer[MAX_BUFFER_LINE] = "";
+gap_buffer_t g_line = {0};
 int g_history_index = 0;
-char **g_history = NULL;
-int g_history_length = 0;
 int g_history_search_index = -1;
 char *g_history_regex = NULL;
 
@@ -28,442 +36,562 @@ void read_line_print_usage() {
   char *usage = "\n"
                 " ctrl-?       Print usage\n"
                 " Backspace    Deletes last character\n"
-                " up arrow     See last command in the history\n";
+                " Delete       Deletes the character under the cursor\n"
+                " Tab          Completes a command or file name\n"
+                " right arrow  Takes the suggestion at the end of the line\n"
+                " Home, End    Move to the start or end of the line\n"
+                " up arrow     See last command in the history, or the\n"
+                "              row above in a command of several rows\n";
 
   write(1, usage, strlen(usage));
 } /* read_line_print_usage() */
 
 /*
- * Input a line with some basic editing.
- * Allows for ctrl-D, ctrl-H, right arrow,
- * left arrow, home and end key.
+ *  Show history entry number in the line buffer
  */
 
-char *read_line() {
+static void recall_history(int number) {
+  const char *line = get_history(number);
 
-  // Set terminal in raw mode
+  gap_set(&g_line, line, strlen(line));
+} /* recall_history() */
 
-  tty_raw_mode();
+/*
+ *  Search the history backwards with the regular expression typed,
+ *  through the trigram index, ctrl-R again continues from the last
+ *  match
+ */
 
-  g_line_length = 0;
+static void search_history() {
+  if (g_history_search_index == -2) {
+    // don't let the user cycle through
 
-  // Read one line until enter is typed
+    gap_clear(&g_line);
+    return;
+  }
 
-  while (1) {
+  // searching, match the regex
 
-    // Read one character in raw mode.
+  if (g_history_search_index == -1) {
+    g_history_regex = strdup(gap_text(&g_line));
 
-    char ch = '\0';
-    read(0, &ch, 1);
+    if (g_history_regex == NULL) {
+      perror("strdup");
+      exit(1);
+    }
+  }
 
-    if (ch >= 32) {
-      if (g_line_index < g_line_length) {
-        memmove(g_line_buffer + g_line_index + 1, g_line_buffer + g_line_index,
-                g_line_length - g_line_index + 1);
-      }
+  regex_t *re = compile_regex(g_history_regex, REG_EXTENDED | REG_NOSUB);
 
-      // It is a printable character.
+  if (re == NULL) {
+    // say so under the line and go on editing it, the next ctrl-R
+    // starts a new search
 
-      // Do echo
+    char message[256];
+    int length = snprintf(message, sizeof(message),
+                          "\nsearch: invalid regular expression %.200s\n",
+                          g_history_regex);
 
-      write(1, &ch, 1);
+    render_finish(gap_text(&g_line),
+                  highlight_line(gap_text(&g_line), gap_length(&g_line)),
+                  gap_length(&g_line), message, length);
+    g_history_search_index = -1;
+    free(g_history_regex);
+    g_history_regex = NULL;
 
-      // If max number of character reached return.
+    print_prompt();
+    render_reset(g_prompt);
+    return;
+  }
 
-      if (g_line_length == (MAX_BUFFER_LINE - 2)) {
-        break;
-      }
+  if (g_history_search_index == -1) {
+    g_history_search_index = g_history.end - 1;
+  }
 
-      // add char to buffer.
+  // if nothing is found the line is left empty
 
-      g_line_buffer[g_line_index] = ch;
+  gap_clear(&g_line);
 
-      g_line_index++;
-      g_line_length++;
+  int match = search_history_index(g_history_regex, re, g_history_search_index);
 
-      if (g_line_index < g_line_length) {
-        for (int j = g_line_index; j < g_line_length; ++j) {
-          write(1, &g_line_buffer[j], 1);
-        }
+  if (match >= 0) {
+    recall_history(match);
 
-        ch = 8;
-        for (int j = g_line_index; j < g_line_length; ++j) {
-          write(1, &ch, 1);
-        }
-      }
+    // ctrl-R again continues with older entries
 
-    } else if (ch == 10) {
-      // <Enter> was typed. Return line
-      // Print newline
+    g_history_search_index = match - 1;
 
-      write(1, &ch, 1);
-      g_history_index = 0;
-      g_history_search_index = -1;
-      free(g_history_regex);
-      g_history_regex = NULL;
+    if (g_history_search_index < g_history.start) {
+      g_history_search_index = -2;
+    }
+  }
+} /* search_history() */
 
-      break;
-    } else if (ch == 18) {
-      if (g_line_length == 0) {
-        // don't search if its empty
+/*
+ *  Position of the start of the row of the line position is on
+ */
 
-        continue;
-      }
+static size_t row_start(size_t position) {
+  while ((position > 0) && (gap_char(&g_line, position - 1) != '\n')) {
+    position--;
+  }
 
-      // i think ctrl-c will always quit the read_line()
-      // call anyways so no need to add an exit
+  return position;
+} /* row_start() */
 
-      // get rid of the whole line
-      int i = 0;
-      for (i = 0; i < g_line_length; i++) {
-        ch = 8;
-        write(1, &ch, 1);
-      }
+/*
+ *  Position of the end of the row of the line position is on
+ */
 
-      // Print spaces on top
+static size_t row_end(size_t position) {
+  while ((position < gap_length(&g_line)) &&
+         (gap_char(&g_line, position) != '\n')) {
+    position++;
+  }
 
-      for (i = 0; i < g_line_length; i++) {
-        ch = ' ';
-        write(1, &ch, 1);
-      }
+  return position;
+} /* row_end() */
 
-      // Print backspaces
+/*
+ *  True if position is on a UTF-8 continuation byte, inside a
+ *  character rather than at its start
+ */
 
-      for (i = 0; i < g_line_length; i++) {
-        ch = 8;
-        write(1, &ch, 1);
-      }
+static bool is_continuation(size_t position) {
+  return (position < gap_length(&g_line)) &&
+         ((gap_char(&g_line, position) & 0xc0) == 0x80);
+} /* is_continuation() */
 
-      if (g_history_search_index == -2) {
-        // don't let the user cycle through
-        g_line_length = 0;
-        g_line_index = 0;
+/*
+ *  Position of the character before the one at position, a multibyte
+ *  character is stepped over whole
+ */
 
-        continue;
-      }
+static size_t previous_char(size_t position) {
+  do {
+    position--;
+  } while ((position > 0) && (is_continuation(position)));
 
-      // searching, match the regex
-      if (g_history_search_index == -1) {
-        g_history_regex = (char *)malloc(g_line_length + 1);
+  return position;
+} /* previous_char() */
 
-        if (g_history_regex == NULL) {
-          perror(g_history_regex);
-          exit(1);
-        }
+/*
+ *  Position of the character after the one at position
+ */
 
-        strncpy(g_history_regex, g_line_buffer, g_line_length);
-        g_history_regex[g_line_length] = '\0';
-      }
+static size_t next_char(size_t position) {
+  do {
+    position++;
+  } while (is_continuation(position));
 
-      // regex stuff
+  return position;
+} /* next_char() */
 
-      regex_t re = {0};
-      int status = regcomp(&re, g_history_regex, REG_EXTENDED);
+/*
+ *  Remove the character before the cursor
+ */
 
-      if (status != 0) {
-        perror("compile");
-        exit(1);
-      }
+static void delete_previous_char() {
+  size_t cursor = gap_cursor(&g_line);
 
-      // if nothing found then display nothing
-      // but always show what the user typed as
-      // being searched below
+  if (cursor > 0) {
+    gap_delete_backward(&g_line, cursor - previous_char(cursor));
+  }
+} /* delete_previous_char() */
 
-      if (g_history_search_index == -1) {
-        g_history_search_index = g_history_length - 1;
-      }
+/*
+ *  Remove the character under the cursor
+ */
 
-      size_t nmatch = 1;
-      regmatch_t match[1] = {{0, 0}};
+static void delete_next_char() {
+  size_t cursor = gap_cursor(&g_line);
 
-      for (int j = g_history_search_index; j >= 0; --j) {
-        if (regexec(&re, g_history[j], nmatch, match, 0) == 0) {
-          // write out the matched line
+  if (cursor < gap_length(&g_line)) {
+    gap_delete_forward(&g_line, next_char(cursor) - cursor);
+  }
+} /* delete_next_char() */
 
-          strcpy(g_line_buffer, g_history[j]);
-          g_line_length = strlen(g_line_buffer);
-          g_line_index = g_line_length;
+/*
+ *  Move the cursor to the row above, or below if down, in the same
+ *  column, counted in characters, or at the end of a shorter row.
+ *  Returns false if it is on the first or last row already
+ */
 
-          write(1, g_line_buffer, g_line_length);
+static bool move_row(bool down) {
+  size_t cursor = gap_cursor(&g_line);
+  size_t start = row_start(cursor);
+  size_t column = 0;
+  size_t target_start = 0;
 
-          g_history_search_index--;
+  for (size_t i = start; i < cursor; i = next_char(i)) {
+    column++;
+  }
 
-          if (g_history_search_index == -1) {
-            g_history_search_index = -2;
-          }
+  if (down) {
+    size_t end = row_end(cursor);
 
-          break;
-        }
-      }
+    if (end == gap_length(&g_line)) {
+      return false;
+    }
 
-      // if something found display it
+    target_start = end + 1;
+  } else {
+    if (start == 0) {
+      return false;
+    }
 
-      regfree(&re);
-    } else if (ch == 1) {
+    target_start = row_start(start - 1);
+  }
 
-      // ctrl-A
+  size_t target_end = row_end(target_start);
+  size_t target = target_start;
 
-      ch = 8;
-      for (int i = 0; i < g_line_index; ++i) {
-        write(1, &ch, 1);
-      }
+  for (size_t i = 0; (i < column) && (target < target_end); i++) {
+    target = next_char(target);
+  }
 
-      g_line_index = 0;
-    } else if (ch == 5) {
-      // ctrl-E
+  gap_move(&g_line, target);
+  return true;
+} /* move_row() */
 
-      for (int i = g_line_index; i < g_line_length; ++i) {
-        ch = g_line_buffer[i];
-        write(1, &ch, 1);
-      }
+/*
+ *  True if the line goes on in another row: it ends with a backslash,
+ *  or leaves an if, a loop or a case open
+ */
 
-      g_line_index = g_line_length;
-    } else if (ch == 31) {
-      // ctrl-?
+static bool continues_line() {
+  const char *line = gap_text(&g_line);
+  int length = gap_length(&g_line);
+  int backslashes = 0;
 
-      read_line_print_usage();
-      g_line_buffer[0] = 0;
-      break;
-    } else if (ch == 4) {
-      if ((g_line_length == 0) || (g_line_length == g_line_index)) {
-        continue;
-      }
+  while ((backslashes < length) && (line[length - 1 - backslashes] == '\\')) {
+    backslashes++;
+  }
 
-      if (g_line_index < g_line_length) {
-        memmove(g_line_buffer + g_line_index, g_line_buffer + g_line_index + 1,
-                g_line_length - g_line_index);
-      }
+  if (backslashes % 2 == 1) {
+    return true;
+  }
 
-      // Remove one character from buffer
+  highlight_line(line, length);
+  return highlight_open_blocks() > 0;
+} /* continues_line() */
 
-      g_line_length--;
-      if (g_line_index > 0) {
-        g_line_index--;
-      }
+/*
+ *  Remove each backslash followed by a newline, which joins the rows
+ *  of the line for the parser
+ */
 
-      for (int j = g_line_index + 1; j < g_line_length; ++j) {
-        write(1, &g_line_buffer[j], 1);
-      }
-      ch = ' ';
-      write(1, &ch, 1);
+static void join_rows() {
+  size_t position = 0;
+
+  while (position + 1 < gap_length(&g_line)) {
+    if (gap_char(&g_line, position) != '\\') {
+      position++;
+    } else if (gap_char(&g_line, position + 1) == '\n') {
+      gap_move(&g_line, position);
+      gap_delete_forward(&g_line, 2);
+    } else {
+      position += 2;
+    }
+  }
+} /* join_rows() */
 
-      ch = 8;
-      for (int j = g_line_index; j < g_line_length + 1; ++j) {
-        write(1, &ch, 1);
-      }
-    } else if (ch == 8) {
-      if (g_line_length == 0) {
-        continue;
-      }
+/*
+ *  Show the matches of a completion in columns below the line, then
+ *  a fresh prompt with the line redrawn on it
+ */
 
-      // <backspace> was typed. Remove previous character read.
+static void list_completions(const completion_t *completion) {
+  struct winsize window = {0};
+  int width = 80;
 
-      // ctrl-H
+  if ((ioctl(1, TIOCGWINSZ, &window) == 0) && (window.ws_col > 0)) {
+    width = window.ws_col;
+  }
 
-      // Go back one character
+  size_t column = 1;
 
-      ch = 8;
-      write(1, &ch, 1);
+  for (int i = 0; i < completion->num_listed; i++) {
+    size_t length = strlen(completion->matches[i]) + 2;
 
-      if (g_line_index < g_line_length) {
-        memmove(g_line_buffer + g_line_index - 1, g_line_buffer + g_line_index,
-                g_line_length - g_line_index + 1);
-      }
+    if (length > column) {
+      column = length;
+    }
+  }
 
-      // Remove one character from buffer
+  int columns = (width / (int)column > 0) ? width / (int)column : 1;
+  char *listing = (char *)malloc(completion->num_listed * (column + 1) + 64);
 
-      g_line_length--;
-      g_line_index--;
+  if (listing == NULL) {
+    perror("malloc");
+    exit(1);
+  }
 
-      for (int j = g_line_index; j < g_line_length; ++j) {
-        write(1, &g_line_buffer[j], 1);
-      }
+  size_t length = 0;
+  listing[length++] = '\n';
 
-      ch = ' ';
-      write(1, &ch, 1);
+  for (int i = 0; i < completion->num_listed; i++) {
+    bool last = ((i + 1) % columns == 0) || (i + 1 == completion->num_listed);
 
-      ch = 8;
-      for (int j = g_line_index; j < g_line_length + 1; ++j) {
-        write(1, &ch, 1);
-      }
-    } else if (ch == 27) {
-      // Escape sequence. Read two chars more
-      //
-      // HINT: Use the program "keyboard-example" to
-      // see the ascii code for the different chars typed.
-
-      char ch1 = '\0';
-      char ch2 = '\0';
-      read(0, &ch1, 1);
-      read(0, &ch2, 1);
-      if ((ch1 == 91) && (ch2 == 65)) {
-        if (g_history_length == 0) {
-          continue;
-        }
+    length += sprintf(listing + length, "%-*s", last ? 0 : (int)column,
+                      completion->matches[i]);
 
-        if (g_history_index >= g_history_length) {
+    if (last) {
+      listing[length++] = '\n';
+    }
+  }
 
-          // do not let them scroll up in history
-          // if they are already at the last entry
-          // g_history_index will equal the length
-          // when they're at the last entry
+  if (completion->num_matches > completion->num_listed) {
+    length += sprintf(listing + length, "and %d more\n",
+                      completion->num_matches - completion->num_listed);
+  }
 
-          continue;
-        }
-        // Up arrow. Print next line in history.
+  render_finish(gap_text(&g_line),
+                highlight_line(gap_text(&g_line), gap_length(&g_line)),
+                gap_length(&g_line), listing, length);
+  free(listing);
 
-        // Erase old line
-        // Print backspaces
+  print_prompt();
+  render_reset(g_prompt);
+} /* list_completions() */
 
-        int i = 0;
-        for (i = 0; i < g_line_length; i++) {
-          ch = 8;
-          write(1, &ch, 1);
-        }
+/*
+ *  Complete the word before the cursor
+ */
 
-        // Print spaces on top
+static void complete_line() {
+  completion_t completion;
 
-        for (i = 0; i < g_line_length; i++) {
-          ch = ' ';
-          write(1, &ch, 1);
-        }
+  complete_word(gap_text(&g_line), gap_cursor(&g_line), &completion);
 
-        // Print backspaces
+  if (completion.insert_length > 0) {
+    gap_insert(&g_line, completion.insert, completion.insert_length);
+  } else if (completion.num_matches > 1) {
+    list_completions(&completion);
+  }
+} /* complete_line() */
 
-        for (i = 0; i < g_line_length; i++) {
-          ch = 8;
-          write(1, &ch, 1);
-        }
+/*
+ *  Rest of the most recent history line starting with the line, when
+ *  the cursor is at its end. Returns NULL if there is none
+ */
 
-        // Copy line from history
+static const char *find_hint(int *hint_length) {
+  size_t length = gap_length(&g_line);
 
-        int active_index = -1;
+  *hint_length = 0;
 
-        if (g_history_length == 1) {
-          active_index = 0;
-        } else {
-          active_index = g_history_length - g_history_index - 1;
-        }
+  if ((length == 0) || (gap_cursor(&g_line) < length)) {
+    return NULL;
+  }
 
-        strcpy(g_line_buffer, g_history[active_index]);
-        g_line_length = strlen(g_line_buffer);
-        g_line_index = g_line_length;
+  const char *suggestion = find_suggestion(gap_text(&g_line), length);
 
-        g_history_index = g_history_index + 1;
+  if (suggestion == NULL) {
+    return NULL;
+  }
 
-        // echo line
+  *hint_length = strlen(suggestion + length);
 
-        write(1, g_line_buffer, g_line_length);
-      } else if ((ch1 == 91) && (ch2 == 66)) {
+  return suggestion + length;
+} /* find_hint() */
 
-        // down arrow
+/*
+ *  Move the cursor to the end of its row, taking the suggestion if
+ *  it is at the end of the line already
+ */
 
-        if (g_history_length == 0) {
-          continue;
-        }
+static void move_to_end() {
+  int hint_length = 0;
+  const char *hint = find_hint(&hint_length);
 
-        if (g_history_index <= 0) {
-          continue;
-        }
+  if (hint_length > 0) {
+    gap_insert(&g_line, hint, hint_length);
+  }
 
-        // Erase old line
-        // Print backspaces
+  gap_move(&g_line, row_end(gap_cursor(&g_line)));
+} /* move_to_end() */
 
-        int i = 0;
-        for (i = 0; i < g_line_length; i++) {
-          ch = 8;
-          write(1, &ch, 1);
-        }
+/*
+ * Input a line with some basic editing.
+ * Allows for ctrl-D, ctrl-H, right arrow,
+ * left arrow, home and end key.
+ * Keys are decoded by read_key(), typed runs and pastes are inserted
+ * in one step into the gap buffer g_line, and the buffer is drawn by
+ * render_line(), one write per key, highlighted by highlight_line()
+ * and with the suggestion from the history after it. Enter after a
+ * backslash or inside an if, a loop or a case starts a new row of
+ * the same line.
+ */
 
-        // Print spaces on top
+char *read_line() {
 
-        for (i = 0; i < g_line_length; i++) {
-          ch = ' ';
-          write(1, &ch, 1);
-        }
+  // Set terminal in raw mode
 
-        // Print backspaces
+  tty_raw_mode();
 
-        for (i = 0; i < g_line_length; i++) {
-          ch = 8;
-          write(1, &ch, 1);
-        }
+  update_history();
+  update_command_index();
 
-        if (g_history_index == g_history_length) {
+  gap_clear(&g_line);
+  render_reset(g_prompt);
+  render_text(BRACKETED_PASTE_ON, strlen(BRACKETED_PASTE_ON));
+  set_key_wakeup(prompt_wakeup());
 
-          // if they want to stop browsing history show
-          // a blank line.
+  // Read one line until enter is typed
 
-          g_line_index = 0;
-          g_line_length = 0;
-          g_history_index--;
+  bool done = false;
 
-          continue;
-        }
+  while (!done) {
+    int hint_length = 0;
+    const char *hint = find_hint(&hint_length);
 
-        // Copy line from history
+    const char *line = gap_text(&g_line);
+    int length = gap_length(&g_line);
+    const unsigned char *colors = highlight_line(line, length);
 
-        int active_index = -1;
+    render_line(line, colors, length, gap_cursor(&g_line), hint, hint_length);
 
-        g_history_index--;
+    key_event_t key = {0};
+    read_key(&key);
 
-        if (g_history_index < g_history_length) {
-          active_index = g_history_length - g_history_index;
-        } else {
-          active_index = 0;
-        }
+    switch (key.kind) {
+    case KEY_EOF:
+      done = true;
+      break;
+    case KEY_WAKEUP:
+      // the prompt has something new to show, draw it again followed
+      // by the line
 
-        strcpy(g_line_buffer, g_history[active_index]);
-        g_line_length = strlen(g_line_buffer);
-        g_line_index = g_line_length;
+      if (g_prompt[0] != '\0') {
+        const char *prompt = refresh_prompt();
 
-        // echo line
+        if (prompt != NULL) {
+          g_prompt = prompt;
+          render_prompt(prompt);
+        }
+      }
+      break;
+    case KEY_TEXT:
+    case KEY_PASTE:
+      gap_insert(&g_line, key.text, key.length);
+      break;
+    case KEY_BACKSPACE:
+      // <backspace> was typed. Remove previous character read.
 
-        write(1, g_line_buffer, g_line_length);
-      } else if ((ch1 == 91) && (ch2 == 68)) {
+      delete_previous_char();
+      break;
+    case KEY_DELETE:
+      delete_next_char();
+      break;
+    case KEY_HOME:
+      gap_move(&g_line, row_start(gap_cursor(&g_line)));
+      break;
+    case KEY_END:
+      move_to_end();
+      break;
+    case KEY_UP:
+      // Show the previous line in the history, unless they are
+      // already at the oldest entry
+
+      if ((!move_row(false)) &&
+          (g_history_index < g_history.end - g_history.start)) {
+        recall_history(g_history.end - g_history_index - 1);
+        g_history_index++;
+      }
+      break;
+    case KEY_DOWN:
+      if ((!move_row(true)) && (g_history_index > 0)) {
+        g_history_index--;
 
-        // left arrow
+        if (g_history_index == 0) {
+          // if they want to stop browsing history show
+          // a blank line.
 
-        // Go back one character
+          gap_clear(&g_line);
+        } else {
+          recall_history(g_history.end - g_history_index);
+        }
+      }
+      break;
+    case KEY_LEFT:
+      if (gap_cursor(&g_line) > 0) {
+        gap_move(&g_line, previous_char(gap_cursor(&g_line)));
+      }
+      break;
+    case KEY_RIGHT:
+      if (gap_cursor(&g_line) < gap_length(&g_line)) {
+        gap_move(&g_line, next_char(gap_cursor(&g_line)));
+      } else {
+        move_to_end();
+      }
+      break;
+    case KEY_CONTROL:
+      if (((key.c == 10) || (key.c == 13)) && (continues_line())) {
+        // <Enter> in an unfinished line, continue it on a new row
+
+        gap_move(&g_line, gap_length(&g_line));
+        gap_insert(&g_line, "\n", 1);
+      } else if ((key.c == 10) || (key.c == 13)) {
+        // <Enter> was typed. Return line
+        // Print newline
+
+        render_finish(line, highlight_line(line, length), length, "\n", 1);
+        g_history_index = 0;
+        g_history_search_index = -1;
+        free(g_history_regex);
+        g_history_regex = NULL;
+
+        done = true;
+      } else if (key.c == 18) {
+        // ctrl-R, don't search if its empty
+
+        if (gap_length(&g_line) > 0) {
+          search_history();
+        }
+      } else if (key.c == 9) {
+        // <tab>, complete the word before the cursor
 
-        if (g_line_index > 0) {
-          ch = 8;
-          write(1, &ch, 1);
+        complete_line();
+      } else if (key.c == 1) {
+        // ctrl-A
 
-          g_line_index--;
-        }
-      } else if ((ch1 == 91) && (ch2 == 67)) {
+        gap_move(&g_line, row_start(gap_cursor(&g_line)));
+      } else if (key.c == 5) {
+        // ctrl-E
 
-        // right arrow
+        move_to_end();
+      } else if (key.c == 31) {
+        // ctrl-?
 
-        if (g_line_index < g_line_length) {
-          // ch = ' ';
-          ch = g_line_buffer[g_line_index];
-          write(1, &ch, 1);
+        read_line_print_usage();
+        gap_clear(&g_line);
+        done = true;
+      } else if (key.c == 4) {
+        // ctrl-D, remove the character under the cursor
 
-          g_line_index++;
-        }
+        delete_next_char();
       }
+      break;
+    default:
+      break;
     }
   }
 
-  // Add eol and null char at the end of string
+  render_text(BRACKETED_PASTE_OFF, strlen(BRACKETED_PASTE_OFF));
+
+  add_history(gap_text(&g_line));
 
-  g_line_buffer[g_line_length] = 10;
-  g_line_length++;
-  g_line_buffer[g_line_length] = 0;
+  // The cursor is at the start of a fresh row, not after a prompt
 
-  g_line_length = 0;
-  g_line_index = 0;
+  g_prompt = "";
+  start_command_timer();
 
-  char *line_to_save = malloc(strlen(g_line_buffer) + 1);
-  strcpy(line_to_save, g_line_buffer);
-  line_to_save[strlen(g_line_buffer) - 1] = '\0';
+  // Add eol at the end of string
 
-  g_history =
-      (char **)realloc(g_history, (g_history_length + 1) * sizeof(char *));
-  g_history[g_history_length] = line_to_save;
-  g_history_length++;
+  join_rows();
+  gap_move(&g_line, gap_length(&g_line));
+  gap_insert(&g_line, "\n", 1);
 
-  return g_line_buffer;
+  return gap_text(&g_line);
 } /* read_line() */
@@ -0,0 +1,70 @@
+#include "regex_cache.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct cached_regex {
+  char *pattern;
+  int flags;
+  regex_t re;
+
+  // Value of g_regex_clock when the entry was last used, 0 if the
+  // entry is empty
+
+  unsigned long last_used;
+} cached_regex_t;
+
+static cached_regex_t g_regex_cache[MAX_CACHED_REGEX];
+static unsigned long g_regex_clock = 0;
+
+/*
+ *  Return the compiled form of pattern, compiling it only if it is
+ *  not already cached. Returns NULL if the pattern does not compile.
+ */
+
+regex_t *compile_regex(const char *pattern, int flags) {
+  cached_regex_t *victim = &g_regex_cache[0];
+
+  for (int i = 0; i < MAX_CACHED_REGEX; i++) {
+    cached_regex_t *entry = &g_regex_cache[i];
+
+    if ((entry->last_used != 0) && (entry->flags == flags) &&
+        (!strcmp(entry->pattern, pattern))) {
+      entry->last_used = ++g_regex_clock;
+      return &entry->re;
+    }
+
+    if (entry->last_used < victim->last_used) {
+      victim = entry;
+    }
+  }
+
+  regex_t re = {0};
+
+  if (regcomp(&re, pattern, flags) != 0) {
+    return NULL;
+  }
+
+  char *copy = strdup(pattern);
+
+  if (copy == NULL) {
+    perror("strdup");
+    exit(1);
+  }
+
+  // evict the least recently used entry
+
+  if (victim->last_used != 0) {
+    regfree(&victim->re);
+    free(victim->pattern);
+  }
+
+  victim->pattern = copy;
+  victim->flags = flags;
+  victim->re = re;
+  victim->last_used = ++g_regex_clock;
+
+  return &victim->re;
+} /* compile_regex() */
@@ -0,0 +1,17 @@
+#ifndef REGEX_CACHE_H
+#define REGEX_CACHE_H
+
+#include <regex.h>
+
+// Compiled Regular Expression Cache
+//
+// Patterns are compiled once and kept in a small least recently used
+// cache, so a pattern used in a loop is not recompiled every time.
+// The returned regex_t belongs to the cache and must not be freed.
+// It stays valid until MAX_CACHED_REGEX other patterns are compiled.
+
+#define MAX_CACHED_REGEX (32)
+
+regex_t *compile_regex(const char *pattern, int flags);
+
+#endif // REGEX_CACHE_H
@@ -0,0 +1,445 @@
+#include "render.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+static render_state_t g_render = {0};
+
+// SGR sequence of each render_color_t
+
+static const char *g_render_sgr[] = {"\033[0m",    "\033[0;31m", "\033[0;32m",
+                                     "\033[0;33m", "\033[0;34m", "\033[0;35m",
+                                     "\033[0;36m", "\033[0;90m"};
+
+/*
+ *  Grow a buffer to hold at least size bytes
+ */
+
+static char *reserve_buffer(char *buffer, size_t *buffer_size, size_t size) {
+  if (size <= *buffer_size) {
+    return buffer;
+  }
+
+  *buffer_size = (*buffer_size == 0) ? 256 : *buffer_size;
+
+  while (*buffer_size < size) {
+    *buffer_size *= 2;
+  }
+
+  buffer = (char *)realloc(buffer, *buffer_size);
+
+  if (buffer == NULL) {
+    perror("realloc");
+    exit(1);
+  }
+
+  return buffer;
+} /* reserve_buffer() */
+
+/*
+ *  Append bytes to the frame
+ */
+
+static void frame_append(const char *text, size_t length) {
+  g_render.frame = reserve_buffer(g_render.frame, &g_render.frame_size,
+                                  g_render.frame_length + length);
+
+  memcpy(g_render.frame + g_render.frame_length, text, length);
+  g_render.frame_length += length;
+} /* frame_append() */
+
+/*
+ *  Append a cursor movement to row and column
+ */
+
+static void frame_move(int row, int column) {
+  char sequence[32];
+
+  if (row != g_render.cursor_row) {
+    int count = row - g_render.cursor_row;
+    int length = snprintf(sequence, sizeof(sequence), "\033[%d%c",
+                          (count < 0) ? -count : count,
+                          (count < 0) ? 'A' : 'B');
+
+    frame_append(sequence, length);
+  }
+
+  if (column == 0) {
+    if (g_render.cursor_column != 0) {
+      frame_append("\r", 1);
+    }
+  } else if (column != g_render.cursor_column) {
+    int count = column - g_render.cursor_column;
+    int length = snprintf(sequence, sizeof(sequence), "\033[%d%c",
+                          (count < 0) ? -count : count,
+                          (count < 0) ? 'D' : 'C');
+
+    frame_append(sequence, length);
+  }
+
+  g_render.cursor_row = row;
+  g_render.cursor_column = column;
+} /* frame_move() */
+
+/*
+ *  Row and column after the first count wanted characters are
+ *  drawn. Characters wrap to the next row at the width of the
+ *  terminal, and a newline ends its row. UTF-8 continuation bytes
+ *  take no room. The column is the width when the last character
+ *  filled its row and the terminal has not wrapped yet
+ */
+
+static void layout(int count, int *row, int *column) {
+  *row = 0;
+  *column = g_render.origin;
+
+  for (int i = 0; i < count; i++) {
+    if (g_render.wanted[i] == '\n') {
+      (*row)++;
+      *column = 0;
+    } else if ((g_render.wanted[i] & 0xc0) != 0x80) {
+      if (*column >= g_render.width) {
+        (*row)++;
+        *column = 0;
+      }
+
+      (*column)++;
+    }
+  }
+} /* layout() */
+
+/*
+ *  Row and column the cursor goes to in front of the wanted
+ *  character at index, or after the last one when index is the
+ *  length
+ */
+
+static void locate(int index, int length, int *row, int *column) {
+  layout(index, row, column);
+
+  if (*column < g_render.width) {
+    return;
+  }
+
+  if ((index < length) && (g_render.wanted[index] == '\n')) {
+    // a newline after a full row, the cursor stays on the row
+
+    *column = g_render.width - 1;
+  } else {
+    (*row)++;
+    *column = 0;
+  }
+} /* locate() */
+
+/*
+ *  Send the frame with one write
+ */
+
+static void frame_flush() {
+  size_t written = 0;
+
+  while (written < g_render.frame_length) {
+    ssize_t result = write(1, g_render.frame + written,
+                           g_render.frame_length - written);
+
+    if (result <= 0) {
+      break;
+    }
+
+    written += result;
+  }
+
+  if (g_render.frame_length > 0) {
+    g_render.num_frames++;
+    g_render.num_bytes += g_render.frame_length;
+  }
+
+  g_render.frame_length = 0;
+} /* frame_flush() */
+
+/*
+ *  Lay out prompt, printed from the start of a row, for the column it
+ *  leaves the cursor at and the number of rows above that one. Escape
+ *  sequences and UTF-8 continuation bytes take no room
+ */
+
+static void measure_prompt(const char *prompt) {
+  int row = 0;
+  int column = 0;
+
+  for (const unsigned char *c = (const unsigned char *)prompt; *c != '\0';
+       c++) {
+    if (*c == '\033') {
+      if (c[1] == '[') {
+        c += 2;
+
+        while ((*c != '\0') && ((*c < 0x40) || (*c > 0x7e))) {
+          c++;
+        }
+
+        if (*c == '\0') {
+          break;
+        }
+      } else if (c[1] != '\0') {
+        c++;
+      }
+    } else if (*c == '\n') {
+      row++;
+      column = 0;
+    } else if (*c == '\r') {
+      column = 0;
+    } else if ((*c >= 32) && ((*c & 0xc0) != 0x80)) {
+      if (column >= g_render.width) {
+        row++;
+        column = 0;
+      }
+
+      column++;
+    }
+  }
+
+  if (column >= g_render.width) {
+    // the prompt filled its row and the terminal has not wrapped yet
+
+    frame_append("\r\n", 2);
+    row++;
+    column = 0;
+  }
+
+  g_render.prompt_rows = row;
+  g_render.origin = column;
+  g_render.screen_length = 0;
+  g_render.cursor_row = 0;
+  g_render.cursor_column = column;
+} /* measure_prompt() */
+
+/*
+ *  Forget the screen contents, the cursor is right after prompt
+ */
+
+void render_reset(const char *prompt) {
+  struct winsize window = {0};
+
+  g_render.width = 80;
+
+  if ((ioctl(1, TIOCGWINSZ, &window) == 0) && (window.ws_col > 0)) {
+    g_render.width = window.ws_col;
+  }
+
+  measure_prompt(prompt);
+} /* render_reset() */
+
+/*
+ *  Replace the prompt the line is drawn after, the line is drawn
+ *  again whole by the next render_line(), in the same write
+ */
+
+void render_prompt(const char *prompt) {
+  frame_move(-g_render.prompt_rows, 0);
+  frame_append("\033[J", 3);
+  frame_append(prompt, strlen(prompt));
+  measure_prompt(prompt);
+} /* render_prompt() */
+
+/*
+ *  Compose the frame that brings the screen up to date with the
+ *  wanted characters and puts the cursor at column cursor. Only what
+ *  changed, in character or color, is written
+ */
+
+static void compose_wanted(int length, int cursor) {
+  int common = 0;
+
+  while ((common < length) && (common < g_render.screen_length) &&
+         (g_render.wanted[common] == g_render.screen[common]) &&
+         (g_render.wanted_colors[common] ==
+          g_render.screen_colors[common])) {
+    common++;
+  }
+
+  // a character that changed is rewritten whole, from its first byte
+
+  while ((common > 0) &&
+         (((common < length) && ((g_render.wanted[common] & 0xc0) == 0x80)) ||
+          ((common < g_render.screen_length) &&
+           ((g_render.screen[common] & 0xc0) == 0x80)))) {
+    common--;
+  }
+
+  // rewrite from the first difference, the cursor then ends up at
+  // the end of the line
+
+  int row = 0;
+  int column = 0;
+
+  if ((common < length) || (common < g_render.screen_length)) {
+    locate(common, length, &row, &column);
+    frame_move(row, column);
+
+    if (common < g_render.screen_length) {
+      frame_append("\033[J", 3);
+    }
+
+    unsigned char color = RENDER_DEFAULT;
+
+    for (int i = common; i < length; i++) {
+      if (g_render.wanted_colors[i] != color) {
+        color = g_render.wanted_colors[i];
+        frame_append(g_render_sgr[color], strlen(g_render_sgr[color]));
+      }
+
+      if (g_render.wanted[i] == '\n') {
+        frame_append("\r\n", 2);
+      } else {
+        frame_append(g_render.wanted + i, 1);
+      }
+    }
+
+    if (color != RENDER_DEFAULT) {
+      frame_append(g_render_sgr[RENDER_DEFAULT],
+                   strlen(g_render_sgr[RENDER_DEFAULT]));
+    }
+
+    // when the line fills its last row the terminal has not wrapped
+    // yet, start the next row so the cursor can go there
+
+    if (common < length) {
+      layout(length, &row, &column);
+
+      if (column >= g_render.width) {
+        frame_append("\r\n", 2);
+        row++;
+        column = 0;
+      }
+
+      g_render.cursor_row = row;
+      g_render.cursor_column = column;
+    }
+  }
+
+  locate(cursor, length, &row, &column);
+  frame_move(row, column);
+
+  // the wanted screen is now the screen
+
+  char *text = g_render.screen;
+  size_t text_size = g_render.screen_size;
+  unsigned char *colors = g_render.screen_colors;
+  size_t colors_size = g_render.screen_colors_size;
+
+  g_render.screen = g_render.wanted;
+  g_render.screen_size = g_render.wanted_size;
+  g_render.screen_colors = g_render.wanted_colors;
+  g_render.screen_colors_size = g_render.wanted_colors_size;
+  g_render.wanted = text;
+  g_render.wanted_size = text_size;
+  g_render.wanted_colors = colors;
+  g_render.wanted_colors_size = colors_size;
+
+  g_render.screen_length = length;
+} /* compose_wanted() */
+
+/*
+ *  Append length characters of text in color, or in colors when it
+ *  is not NULL, to the wanted screen, each newline followed by the
+ *  continuation prompt. Returns the new length of the wanted screen
+ */
+
+static int append_wanted(int wanted_length, const char *text,
+                         const unsigned char *colors, unsigned char color,
+                         int length) {
+  int continuation = strlen(RENDER_CONTINUATION);
+  int newlines = 0;
+
+  for (int i = 0; i < length; i++) {
+    newlines += (text[i] == '\n');
+  }
+
+  size_t size = wanted_length + length + newlines * continuation + 1;
+
+  g_render.wanted =
+      reserve_buffer(g_render.wanted, &g_render.wanted_size, size);
+  g_render.wanted_colors = (unsigned char *)reserve_buffer(
+      (char *)g_render.wanted_colors, &g_render.wanted_colors_size, size);
+
+  for (int i = 0; i < length; i++) {
+    g_render.wanted[wanted_length] = text[i];
+    g_render.wanted_colors[wanted_length++] =
+        (colors != NULL) ? colors[i] : color;
+
+    if (text[i] == '\n') {
+      memcpy(g_render.wanted + wanted_length, RENDER_CONTINUATION,
+             continuation);
+      memset(g_render.wanted_colors + wanted_length, RENDER_DEFAULT,
+             continuation);
+      wanted_length += continuation;
+    }
+  }
+
+  return wanted_length;
+} /* append_wanted() */
+
+/*
+ *  Compose the frame for line in colors, NULL for the default color,
+ *  followed by hint in grey
+ */
+
+static void compose_line(const char *line, const unsigned char *colors,
+                         int length, int cursor, const char *hint,
+                         int hint_length) {
+  int wanted_cursor = append_wanted(0, line, colors, RENDER_DEFAULT, cursor);
+  int wanted_length = append_wanted(wanted_cursor, line + cursor,
+                                    (colors != NULL) ? colors + cursor : NULL,
+                                    RENDER_DEFAULT, length - cursor);
+
+  wanted_length =
+      append_wanted(wanted_length, hint, NULL, RENDER_GREY, hint_length);
+
+  compose_wanted(wanted_length, wanted_cursor);
+} /* compose_line() */
+
+/*
+ *  Bring the screen up to date with line and put the cursor at
+ *  column cursor, with one write. A suggested continuation of the
+ *  line, hint, is shown after it in grey
+ */
+
+void render_line(const char *line, const unsigned char *colors, int length,
+                 int cursor, const char *hint, int hint_length) {
+  compose_line(line, colors, length, cursor, hint, hint_length);
+  frame_flush();
+} /* render_line() */
+
+/*
+ *  Draw the finished line without its hint, followed by text such as
+ *  the newline, with one write
+ */
+
+void render_finish(const char *line, const unsigned char *colors, int length,
+                   const char *text, size_t text_length) {
+  compose_line(line, colors, length, length, "", 0);
+  frame_append(text, text_length);
+  frame_flush();
+} /* render_finish() */
+
+/*
+ *  Write text that is not part of the line, such as the newline
+ *  after it, with one write
+ */
+
+void render_text(const char *text, size_t length) {
+  frame_append(text, length);
+  frame_flush();
+} /* render_text() */
+
+/*
+ *  Print the rendering counters
+ */
+
+void print_render_stats() {
+  printf("render frames %lu bytes %lu\n", g_render.num_frames,
+         g_render.num_bytes);
+} /* print_render_stats() */
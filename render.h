@@ -0,0 +1,90 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include <stddef.h>
+
+// Line Editor Rendering
+//
+// Each keystroke composes a frame in a buffer: the cursor is moved to
+// the first character that differs from what is on the screen, the
+// rest of the line is written, a stale tail is erased and the cursor
+// is moved to its place, all with ANSI escape sequences. The frame is
+// sent with a single write(). Each character has a color, set with
+// SGR sequences only where it changes, and a hint, such as an
+// autosuggestion, is drawn in grey after the line and diffed along
+// with it.
+//
+// A line may span several rows of the screen, where it wraps at the
+// width of the terminal and after each newline in it. The rows after
+// a newline start with RENDER_CONTINUATION. The row and column of a
+// character are found by laying the line out from the column the
+// prompt ends at, and the cursor is moved between rows with relative
+// movements only. The prompt itself can be replaced while the line is
+// edited, it is drawn again followed by the whole line.
+
+typedef enum render_color {
+  RENDER_DEFAULT,
+  RENDER_RED,
+  RENDER_GREEN,
+  RENDER_YELLOW,
+  RENDER_BLUE,
+  RENDER_MAGENTA,
+  RENDER_CYAN,
+  RENDER_GREY
+} render_color_t;
+
+#define RENDER_CONTINUATION "> "
+
+typedef struct render_state {
+  // Characters after the prompt as they are on the screen, the line
+  // followed by its hint with each newline followed by the
+  // continuation prompt, and their colors
+
+  char *screen;
+  unsigned char *screen_colors;
+  int screen_length;
+  size_t screen_size;
+  size_t screen_colors_size;
+
+  // Row of the cursor counted from the row the prompt ends on, and
+  // its column on the screen
+
+  int cursor_row;
+  int cursor_column;
+
+  // Column the prompt ends at, the rows of the prompt above that
+  // one, and the width of the terminal
+
+  int origin;
+  int prompt_rows;
+  int width;
+
+  // Screen wanted by the frame being composed
+
+  char *wanted;
+  unsigned char *wanted_colors;
+  size_t wanted_size;
+  size_t wanted_colors_size;
+
+  // Frame being composed
+
+  char *frame;
+  size_t frame_length;
+  size_t frame_size;
+
+  // Counters reported by the stats builtin
+
+  unsigned long num_frames;
+  unsigned long num_bytes;
+} render_state_t;
+
+void render_reset(const char *prompt);
+void render_prompt(const char *prompt);
+void render_line(const char *line, const unsigned char *colors, int length,
+                 int cursor, const char *hint, int hint_length);
+void render_finish(const char *line, const unsigned char *colors, int length,
+                   const char *text, size_t text_length);
+void render_text(const char *text, size_t length);
+void print_render_stats();
+
+#endif // RENDER_H
@@ -8,18 +8,32 @@
 #include <unistd.h>
 
 #include "command.h"
+#include "complete.h"
+#include "history.h"
+#include "prompt.h"
 #include "single_command.h"
+#include "vars.h"
 #include "y.tab.h"
 
 command_t *g_current_command = NULL;
 single_command_t *g_current_single_command = NULL;
 bool g_prompt_printed = false;
 bool g_prompts_off = false;
+
+// Prompt the cursor was left after, empty once a line has been read
+// after it
+
+const char *g_prompt = "";
 int g_last_background_pid = 0;
 int g_last_executed_pid = 0;
+int g_last_status = 0;
 char **g_argv = NULL;
 char *g_last_arg = NULL;
 
+// Start of the current command line in g_line_arena
+
+arena_mark_t g_line_mark = {NULL, 0};
+
 /*
  * Reset global commands
  */
@@ -31,22 +45,8 @@ void reset_shell() {
   free_single_command(g_current_single_command);
   g_current_single_command = NULL;
 
-  g_current_command = (command_t *)malloc(sizeof(command_t));
-  g_current_single_command =
-      (single_command_t *)malloc(sizeof(single_command_t));
-
-  if (g_current_command == NULL) {
-    perror("malloc");
-    exit(1);
-  }
-
-  if (g_current_single_command == NULL) {
-    perror("malloc");
-    exit(1);
-  }
-
-  create_command(g_current_command);
-  create_single_command(g_current_single_command);
+  g_current_command = new_command();
+  g_current_single_command = new_single_command();
 
   if (isatty(STDIN_FILENO)) {
     print_prompt();
@@ -61,7 +61,8 @@ int yyparse(void);
 
 void print_prompt() {
   if (g_prompts_off == false) {
-    printf("myshell>");
+    g_prompt = format_prompt();
+    fputs(g_prompt, stdout);
     fflush(stdout);
   }
 } /* print_prompt() */
@@ -107,12 +108,9 @@ void child_collector(int signum) {
 int main(int argc, char *argv[]) {
   (void)argc;
   g_argv = argv;
-  g_current_command = (command_t *)malloc(sizeof(command_t));
-  g_current_single_command =
-      (single_command_t *)malloc(sizeof(single_command_t));
-
-  create_command(g_current_command);
-  create_single_command(g_current_single_command);
+  init_variables(environ);
+  g_current_command = new_command();
+  g_current_single_command = new_single_command();
 
   struct sigaction signal_action = {.sa_handler = termination_handler,
                                     .sa_mask = {{0}},
@@ -140,14 +138,17 @@ int main(int argc, char *argv[]) {
   }
 
   char *shellrc = ".shellrc";
-  char *home_shellrc = malloc(strlen(getenv("HOME")) + 10);
-  strcpy(home_shellrc, getenv("HOME"));
-  strcpy(home_shellrc + strlen(getenv("HOME")), "/.shellrc");
+  char *home = get_variable("HOME");
+  char *home_shellrc = malloc(strlen(home) + 10);
+  strcpy(home_shellrc, home);
+  strcpy(home_shellrc + strlen(home), "/.shellrc");
 
   source(shellrc, true);
   source(home_shellrc, true);
 
   if (isatty(STDIN_FILENO)) {
+    open_history();
+    update_command_index();
     print_prompt();
   }
 
@@ -1,6 +1,7 @@
 #ifndef SHELL_H
 #define SHELL_H
 
+#include "arena.h"
 #include "command.h"
 #include "single_command.h"
 
@@ -13,17 +14,21 @@
 void print_prompt();
 void child_collector(int signum);
 void source(char *file_name, bool init);
-char *expand_variables(char *original_word);
+void source_string(char *text);
+void reset_lex_state();
 
 extern command_t *g_current_command;
 extern single_command_t *g_current_single_command;
 extern bool g_prompt_printed;
 extern bool g_prompts_off;
+extern const char *g_prompt;
 extern char **environ;
 extern int g_last_background_pid;
 extern int g_last_executed_pid;
+extern int g_last_status;
 extern char **g_argv;
 extern char *g_last_arg;
+extern arena_mark_t g_line_mark;
 
 void reset_shell();
 #endif // SHELL_H
@@ -11,10 +11,27 @@
 %union
 {
   char * string;
+  int number;
+  struct node * node;
+  struct single_command * words;
 }
 
-%token <string> WORD PIPE QUOTED_WORD
+%token <string> WORD QUOTED_WORD
+%token PIPE
 %token NOTOKEN NEWLINE STDOUT STDIN STDERR BOTH APPEND APPENDBOTH AMPERSAND
+%token SEMI DSEMI AND_IF OR_IF RPAREN
+%token IF THEN ELSE ELIF FI WHILE UNTIL DO DONE FOR IN CASE ESAC
+%token COND_START COND_END
+
+%type <node> complete_command list and_or pipeline compound_command
+%type <node> compound_list term if_clause else_part do_group
+%type <node> while_clause until_clause for_clause case_clause cond_command
+%type <node> case_list case_list_ns case_item case_item_ns
+%type <words> word_list case_word pattern
+%type <number> separator_op separator
+
+%destructor { free_node($$); } <node>
+%destructor { free_single_command($$); } <words>
 
 %{
 
@@ -26,12 +43,21 @@
 #include <unistd.h>
 
 #include "command.h"
+#include "node.h"
 #include "single_command.h"
 #include "shell.h"
 
 void yyerror(const char * s);
 int yylex();
 
+/*
+ * Allocates a single command used to hold a list of words
+ */
+
+single_command_t * new_word_list() {
+  return new_single_command();
+}
+
 %}
 
 %%
@@ -46,55 +72,326 @@ entire_command_list:
   ;
 
 entire_command:
-      single_command_list io_modifier_list NEWLINE {
-        execute_command(g_current_command);
+      complete_command NEWLINE {
+        execute_node($1);
+        free_node($1);
 
-        if (g_last_arg != NULL) {
-          free(g_last_arg);
-          g_last_arg = NULL;
+        // the words of the line are not needed anymore
+        arena_release(&g_line_arena, g_line_mark);
+
+        // print prompt again if isatty()
+        if ((isatty(STDIN_FILENO)) && (g_prompt_printed == false)) {
+          print_prompt();
         }
+        else {
+          g_prompt_printed = false;
+        }
+      }
+  |   NEWLINE {
+        arena_release(&g_line_arena, g_line_mark);
 
-        if (g_current_command->num_single_commands != 0) {
-          single_command_t* last_single_command = g_current_command->single_commands[g_current_command->num_single_commands - 1];
-          g_last_arg = last_single_command->arguments[last_single_command->num_args - 1];
-          g_last_arg = strdup(g_last_arg);
+        // print prompt again if isatty()?
+        if (isatty(STDIN_FILENO)) {
+          print_prompt();
         }
+      }
+  |   error NEWLINE {
+        // throw away the rest of the line and start over
+        yyerrok;
+        reset_lex_state();
+        reset_shell();
+        arena_release(&g_line_arena, g_line_mark);
+      }
+  ;
 
-        // free g_current_command and g_current_single_command
-        free_command(g_current_command);
-        g_current_command = NULL;
-        // need to free this as after every single command
-        // i malloc for the next, so after the last one
-        // g_sing_cmd will be malloced
-        free_single_command(g_current_single_command);
-        g_current_single_command = NULL;
-        // allocate and run the create() functions for
-        // them again to prepare for the next command
-        g_current_command = (command_t *) malloc(sizeof(command_t));
+complete_command:
+      list
+  |   list separator_op {
+        if ($2) {
+          set_node_background($1);
+        }
+        $$ = $1;
+      }
+  ;
 
-        if (g_current_command == NULL) {
-          perror("malloc");
-          exit(1);
+list:
+      list separator_op and_or {
+        if ($2) {
+          set_node_background($1);
         }
+        $$ = create_binary_node(NODE_SEQUENCE, $1, $3);
+      }
+  |   and_or
+  ;
 
-        g_current_single_command = (single_command_t *) malloc(sizeof(single_command_t));
+and_or:
+      pipeline
+  |   and_or AND_IF linebreak pipeline {
+        $$ = create_binary_node(NODE_AND, $1, $4);
+      }
+  |   and_or OR_IF linebreak pipeline {
+        $$ = create_binary_node(NODE_OR, $1, $4);
+      }
+  ;
+
+pipeline:
+      single_command_list io_modifier_list {
+        // the pipeline is done, hand g_current_command to the tree
+        // and start a new one
+        $$ = create_command_node(g_current_command);
+
+        g_current_command = new_command();
+      }
+  |   compound_command
+  ;
+
+compound_command:
+      if_clause
+  |   while_clause
+  |   until_clause
+  |   for_clause
+  |   case_clause
+  |   cond_command
+  ;
 
-        if (g_current_single_command == NULL) {
-          perror("malloc");
-          exit(1);
+compound_list:
+      linebreak term {
+        $$ = $2;
+      }
+  |   linebreak term separator {
+        if ($3) {
+          set_node_background($2);
         }
-        
-        create_command(g_current_command);
-        create_single_command(g_current_single_command);
+        $$ = $2;
       }
-  |   NEWLINE {
-        // print prompt again if isatty()?
-        if (isatty(STDIN_FILENO)) {
-          print_prompt();
+  ;
+
+term:
+      term separator and_or {
+        if ($2) {
+          set_node_background($1);
         }
+        $$ = create_binary_node(NODE_SEQUENCE, $1, $3);
+      }
+  |   and_or
+  ;
+
+if_clause:
+      IF compound_list THEN compound_list else_part FI {
+        $$ = create_node(NODE_IF);
+        $$->left = $2;
+        $$->right = $4;
+        $$->else_part = $5;
+      }
+  |   IF compound_list THEN compound_list FI {
+        $$ = create_node(NODE_IF);
+        $$->left = $2;
+        $$->right = $4;
+      }
+  ;
+
+else_part:
+      ELIF compound_list THEN compound_list {
+        $$ = create_node(NODE_IF);
+        $$->left = $2;
+        $$->right = $4;
+      }
+  |   ELIF compound_list THEN compound_list else_part {
+        $$ = create_node(NODE_IF);
+        $$->left = $2;
+        $$->right = $4;
+        $$->else_part = $5;
+      }
+  |   ELSE compound_list {
+        $$ = $2;
+      }
+  ;
+
+while_clause:
+      WHILE compound_list do_group {
+        $$ = create_node(NODE_WHILE);
+        $$->left = $2;
+        $$->right = $3;
       }
   ;
 
+until_clause:
+      UNTIL compound_list do_group {
+        $$ = create_node(NODE_UNTIL);
+        $$->left = $2;
+        $$->right = $3;
+      }
+  ;
+
+for_clause:
+      FOR WORD linebreak IN word_list sequential_sep do_group {
+        $$ = create_node(NODE_FOR);
+        $$->var_name = $2;
+        $$->words = $5;
+        $$->left = $7;
+      }
+  |   FOR WORD linebreak IN sequential_sep do_group {
+        $$ = create_node(NODE_FOR);
+        $$->var_name = $2;
+        $$->words = new_word_list();
+        $$->left = $6;
+      }
+  ;
+
+word_list:
+      word_list WORD {
+        insert_word($1, $2, false);
+        $$ = $1;
+      }
+  |   word_list QUOTED_WORD {
+        insert_word($1, $2, true);
+        $$ = $1;
+      }
+  |   WORD {
+        $$ = new_word_list();
+        insert_word($$, $1, false);
+      }
+  |   QUOTED_WORD {
+        $$ = new_word_list();
+        insert_word($$, $1, true);
+      }
+  ;
+
+cond_command:
+      COND_START word_list COND_END {
+        $$ = create_node(NODE_COND);
+        $$->words = $2;
+      }
+  ;
+
+do_group:
+      DO compound_list DONE {
+        $$ = $2;
+      }
+  ;
+
+case_clause:
+      CASE case_word linebreak IN linebreak case_list ESAC {
+        $$ = create_node(NODE_CASE);
+        $$->words = $2;
+        $$->left = $6;
+      }
+  |   CASE case_word linebreak IN linebreak case_list_ns ESAC {
+        $$ = create_node(NODE_CASE);
+        $$->words = $2;
+        $$->left = $6;
+      }
+  |   CASE case_word linebreak IN linebreak ESAC {
+        $$ = create_node(NODE_CASE);
+        $$->words = $2;
+      }
+  ;
+
+case_word:
+      WORD {
+        $$ = new_word_list();
+        insert_word($$, $1, false);
+      }
+  |   QUOTED_WORD {
+        $$ = new_word_list();
+        insert_word($$, $1, true);
+      }
+  ;
+
+case_list_ns:
+      case_list case_item_ns {
+        // items are chained through right, keep them in order
+        node_t * item = $1;
+        while (item->right != NULL) {
+          item = item->right;
+        }
+        item->right = $2;
+        $$ = $1;
+      }
+  |   case_item_ns
+  ;
+
+case_list:
+      case_list case_item {
+        node_t * item = $1;
+        while (item->right != NULL) {
+          item = item->right;
+        }
+        item->right = $2;
+        $$ = $1;
+      }
+  |   case_item
+  ;
+
+case_item_ns:
+      pattern RPAREN linebreak {
+        $$ = create_node(NODE_CASE_ITEM);
+        $$->words = $1;
+      }
+  |   pattern RPAREN compound_list {
+        $$ = create_node(NODE_CASE_ITEM);
+        $$->words = $1;
+        $$->left = $3;
+      }
+  ;
+
+case_item:
+      pattern RPAREN linebreak DSEMI linebreak {
+        $$ = create_node(NODE_CASE_ITEM);
+        $$->words = $1;
+      }
+  |   pattern RPAREN compound_list DSEMI linebreak {
+        $$ = create_node(NODE_CASE_ITEM);
+        $$->words = $1;
+        $$->left = $3;
+      }
+  ;
+
+pattern:
+      case_word
+  |   pattern PIPE WORD {
+        insert_word($1, $3, false);
+        $$ = $1;
+      }
+  |   pattern PIPE QUOTED_WORD {
+        insert_word($1, $3, true);
+        $$ = $1;
+      }
+  ;
+
+separator_op:
+      AMPERSAND {
+        $$ = 1;
+      }
+  |   SEMI {
+        $$ = 0;
+      }
+  ;
+
+separator:
+      separator_op linebreak {
+        $$ = $1;
+      }
+  |   newline_list {
+        $$ = 0;
+      }
+  ;
+
+sequential_sep:
+      SEMI linebreak
+  |   newline_list
+  ;
+
+linebreak:
+      newline_list
+  |  /* can be empty */
+  ;
+
+newline_list:
+      newline_list NEWLINE
+  |   NEWLINE
+  ;
+
 single_command_list:
       single_command_list PIPE single_command
   |   single_command
@@ -102,24 +399,14 @@ single_command_list:
 
 single_command:
       executable argument_list {
-        if (strcmp(g_current_single_command->arguments[0], "exit") == 0) {
-          exit(0);
-        }
         insert_single_command(g_current_command, g_current_single_command);
         // free_single_command(g_current_single_command);
         // do not free single_command, g_cur_cmd only
         // holds a list of ptrs, not the sing_cmds themselves
         // as far as I understand, the ptrs are stored
-        // inside of command, so I can just malloc
+        // inside of command, so a pooled one can be taken
         // here for the next command
-        g_current_single_command = (single_command_t *) malloc(sizeof(single_command_t));
-
-        if (g_current_single_command == NULL) {
-          perror("malloc");
-          exit(1);
-        }
-
-        create_single_command(g_current_single_command);
+        g_current_single_command = new_single_command();
       }
   ;
 
@@ -130,43 +417,20 @@ argument_list:
 
 argument:
       WORD {
-        // insert_argument(g_current_single_command, $1);
-
-        if ((strchr($1, '?') == NULL) && (strchr($1, '*') == NULL)) {
-          insert_argument(g_current_single_command, $1);
-        }
-        else {
-          int og_args = g_current_single_command->num_args;
-          expand_wildcards("", $1);
-
-          if (og_args == g_current_single_command->num_args) {
-            insert_argument(g_current_single_command, $1);
-          }
-        }
+        // words are expanded and wildcarded when the command runs
+        insert_word(g_current_single_command, $1, false);
       }
   |   QUOTED_WORD {
-        insert_argument(g_current_single_command, $1);
+        insert_word(g_current_single_command, $1, true);
       }
   ;
 
 executable:
       WORD {
-        // insert_argument(g_current_single_command, $1);
-
-        if ((strchr($1, '?') == NULL) && (strchr($1, '*') == NULL)) {
-          insert_argument(g_current_single_command, $1);
-        }
-        else {
-          int og_args = g_current_single_command->num_args;
-          expand_wildcards("", $1);
-
-          if (og_args == g_current_single_command->num_args) {
-            insert_argument(g_current_single_command, $1);
-          }
-        }
+        insert_word(g_current_single_command, $1, false);
       }
   |   QUOTED_WORD {
-        insert_argument(g_current_single_command, $1);
+        insert_word(g_current_single_command, $1, true);
       }
   ;
 
@@ -206,7 +470,7 @@ io_modifier:
           g_current_command->out_file = $2;
         }
 
-        g_current_command->err_file = strdup($2);
+        g_current_command->err_file = $2;
       }
   |   APPEND WORD {
         if (g_current_command->out_file != NULL) {
@@ -228,13 +492,10 @@ io_modifier:
           g_current_command->out_file = $2;
         }
 
-        g_current_command->err_file = strdup($2);
+        g_current_command->err_file = $2;
         g_current_command->append_out = true;
         g_current_command->append_err = true;
       }
-  |   AMPERSAND {
-        g_current_command->background = true;
-      }
   ;
 
 
@@ -243,7 +504,7 @@ io_modifier:
 void
 yyerror(const char * s)
 {
-  fprintf(stderr,"%s", s);
+  fprintf(stderr,"%s\n", s);
 }
 
 #if 0
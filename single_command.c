@@ -1,14 +1,20 @@
 #include "single_command.h"
 
-#include <assert.h>
-#include <dirent.h>
-#include <regex.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "brace.h"
+#include "expand.h"
+#include "glob.h"
 #include "shell.h"
+#include "wildcard.h"
+
+pool_stats_t g_single_command_pool_stats = {.name = "simple"};
+
+static single_command_t *g_single_command_pool[SINGLE_COMMAND_POOL_SIZE];
+static int g_single_command_pool_size = 0;
 
 /*
  *  Initialize a single command
@@ -17,254 +23,247 @@
 void create_single_command(single_command_t *simp) {
   simp->arguments = NULL;
   simp->num_args = 0;
+  simp->max_args = 0;
+  simp->glob_start = -1;
+  simp->glob_end = -1;
+  simp->num_glob_ranges = 0;
+
+  simp->words = NULL;
+  simp->quoted = NULL;
+  simp->num_words = 0;
+  simp->max_words = 0;
 } /* create_single_command() */
 
 /*
- *  Free everything in a single command
+ *  Get an empty single command, reusing a freed one and its arrays
+ *  if there is one
  */
 
-void free_single_command(single_command_t *simp) {
-  for (int i = 0; i < simp->num_args; i++) {
-    free(simp->arguments[i]);
-    simp->arguments[i] = NULL;
+single_command_t *new_single_command() {
+  if (g_single_command_pool_size > 0) {
+    g_single_command_pool_stats.num_reused++;
+    return g_single_command_pool[--g_single_command_pool_size];
   }
 
-  if (simp->arguments != NULL) {
-    free(simp->arguments);
+  single_command_t *simp = (single_command_t *)malloc(sizeof(single_command_t));
+
+  if (simp == NULL) {
+    perror("malloc");
+    exit(1);
   }
 
-  free(simp);
-} /* free_single_command() */
+  g_single_command_pool_stats.num_malloced++;
+  create_single_command(simp);
+
+  return simp;
+} /* new_single_command() */
 
 /*
- * Sorts an array of strings
- * used for sorting a dir listing
- * when wildcarding
+ *  Forget the expanded arguments of a single command, keeping its
+ *  words. The strings belong to the expansion arena.
  */
 
-char **sort_array_strings(char **array, int num_entries) {
-  char **sorted_array = (char **)malloc(num_entries * sizeof(char *));
-
-  int num_inserted = 0;
-  int index_inserted_arr = -1;
+void clear_arguments(single_command_t *simp) {
+  simp->num_args = 0;
+  simp->glob_start = -1;
+  simp->glob_end = -1;
+  simp->num_glob_ranges = 0;
 
-  while (num_inserted < num_entries) {
-    char *next_insert = NULL;
+  if (simp->arguments != NULL) {
+    simp->arguments[0] = NULL;
+  }
+} /* clear_arguments() */
 
-    for (int i = 0; i < num_entries; ++i) {
-      char *string_it = array[i];
+/*
+ *  Free a single command. The words belong to the line arena, the
+ *  struct and its arrays go back to the pool.
+ */
 
-      if (string_it != NULL) {
-        if (next_insert == NULL) {
-          next_insert = string_it;
-          index_inserted_arr = i;
-        } else if (strcmp(next_insert, string_it) > 0) {
-          next_insert = string_it;
-          index_inserted_arr = i;
-        }
-      }
-    }
+void free_single_command(single_command_t *simp) {
+  simp->num_args = 0;
+  simp->num_words = 0;
 
-    sorted_array[num_inserted] = next_insert;
-    array[index_inserted_arr] = NULL;
-    ++num_inserted;
+  if (g_single_command_pool_size < SINGLE_COMMAND_POOL_SIZE) {
+    g_single_command_pool[g_single_command_pool_size++] = simp;
+    return;
   }
 
-  return sorted_array;
-} /* sort_array_strings() */
+  free(simp->arguments);
+  free(simp->words);
+  free(simp->quoted);
+  free(simp);
+} /* free_single_command() */
 
 /*
- * Expands the wildcards ? and *
+ *  Expands the wildcards ?, *, [...] and extglob groups, and **
+ *  for any number of directories, keeping the matches that pass
+ *  the qualifier
  */
 
-void expand_wildcards(char *prefix, char *suffix) {
-  if (suffix[0] == 0) {
-    insert_argument(g_current_single_command, strdup(prefix));
-    return;
+void expand_wildcards(single_command_t *simp, const char *pattern,
+                      glob_qualifier_t *qualifier) {
+  glob_iterator_t *iterator = open_glob_iterator(pattern, qualifier);
+  char *match = NULL;
+
+  // the iterator sorts the matches of ** as one list itself
+
+  while ((match = next_glob_match(iterator)) != NULL) {
+    insert_argument(simp, arena_strdup(&g_expand_arena, match));
   }
 
-  char *s = strchr(suffix, '/');
+  close_glob_iterator(iterator);
+} /* expand_wildcards() */
 
-  char component[1024] = "";
+/*
+ *  Insert an argument into the list of arguments in a single command
+ */
 
-  if (s != NULL) {
-    strncpy(component, suffix, s - suffix);
-    component[s - suffix] = '\0';
-    suffix = s + 1;
-  } else {
-    strcpy(component, suffix);
-    component[strlen(suffix)] = '\0';
-    suffix = suffix + strlen(suffix);
+void insert_argument(single_command_t *simp, char *argument) {
+  if (argument == NULL) {
+    return;
   }
 
-  char new_prefix[1030] = "";
-
-  if ((strchr(component, '?') == NULL) && (strchr(component, '*') == NULL)) {
-    if ((strlen(component) == 1) && (component[0] == '/')) {
-      expand_wildcards(component, suffix);
-    } else {
-      if ((strlen(prefix) == 1) && (prefix[0] == '/')) {
-        snprintf(new_prefix, sizeof(new_prefix), "%s%s", prefix, component);
-        expand_wildcards(new_prefix, suffix);
-        return;
-      }
-
-      snprintf(new_prefix, sizeof(new_prefix), "%s/%s", prefix, component);
-      expand_wildcards(new_prefix, suffix);
-      return;
+  // grow by doubling, one slot is kept for the NULL terminator
+
+  if (simp->num_args + 1 >= simp->max_args) {
+    simp->max_args = (simp->max_args == 0) ? 8 : simp->max_args * 2;
+    simp->arguments =
+        (char **)realloc(simp->arguments, simp->max_args * sizeof(char *));
+
+    if (simp->arguments == NULL) {
+      perror("realloc");
+      exit(1);
     }
   }
 
-  // convert wildcard to regular expression
+  simp->num_args++;
+  simp->arguments[simp->num_args - 1] = argument;
+  simp->arguments[simp->num_args] = NULL;
+} /* insert_argument() */
 
-  // 3 because null term, then ^ and $
+/*
+ *  Insert a word, as parsed, into the list of words in a single command.
+ *  Quoted words are passed through expansion untouched.
+ */
 
-  char *regex = (char *)malloc(2 * strlen(component) + 3);
-  char *arg_pos = component;
-  char *regex_pos = regex;
+void insert_word(single_command_t *simp, char *word, bool quoted) {
+  if (word == NULL) {
+    return;
+  }
 
-  *regex_pos++ = '^';
+  if (simp->num_words == simp->max_words) {
+    simp->max_words = (simp->max_words == 0) ? 8 : simp->max_words * 2;
+    simp->words =
+        (char **)realloc(simp->words, simp->max_words * sizeof(char *));
+    simp->quoted =
+        (bool *)realloc(simp->quoted, simp->max_words * sizeof(bool));
 
-  while (*arg_pos) {
-    if (*arg_pos == '*') {
-      *regex_pos++ = '.';
-      *regex_pos++ = '*';
-    } else if (*arg_pos == '?') {
-      *regex_pos++ = '.';
-    } else if (*arg_pos == '.') {
-      *regex_pos++ = '\\';
-      *regex_pos++ = '.';
-    } else {
-      *regex_pos++ = *arg_pos;
+    if ((simp->words == NULL) || (simp->quoted == NULL)) {
+      perror("realloc");
+      exit(1);
     }
-    arg_pos++;
   }
 
-  *regex_pos++ = '$';
-  *regex_pos++ = '\0';
-
-  // compile regular expression
-
-  regex_t re = {0};
-  int status = regcomp(&re, regex, REG_EXTENDED);
+  simp->num_words++;
 
-  if (status != 0) {
-    perror("compile");
-    return;
-  }
+  simp->words[simp->num_words - 1] = word;
+  simp->quoted[simp->num_words - 1] = quoted;
+} /* insert_word() */
 
-  // List directory and add matches
+/*
+ *  Add one field of an expanded word as an argument, without its
+ *  escapes, or the files it matches if it is a wildcard
+ */
 
-  DIR *dir = NULL;
+static void glob_argument(single_command_t *simp, char *word) {
+  glob_qualifier_t qualifier;
+  char *pattern = split_glob_qualifier(word, &qualifier);
 
-  if (strlen(prefix) == 0) {
-    dir = opendir(".");
-  } else {
-    dir = opendir(prefix);
+  if (pattern == NULL) {
+    pattern = word;
+    memset(&qualifier, 0, sizeof(qualifier));
   }
 
-  if (dir == NULL) {
+  if (!has_glob(pattern)) {
+    insert_argument(simp, remove_glob_escapes(word));
     return;
   }
 
-  struct dirent *ent = NULL;
-  int max_entries = 20;
-  int num_entries = 0;
-  char **array = (char **)malloc(max_entries * sizeof(char *));
-
-  while ((ent = readdir(dir)) != NULL) {
-
-    regmatch_t match[1] = {{0, 0}};
-
-    // looking for one match within the entry
-
-    size_t nmatch = 1;
-
-    if (regexec(&re, ent->d_name, nmatch, match, 0) == 0) {
-      if (ent->d_name[0] == '.') {
-        if (component[0] == '.') {
-          if (num_entries == max_entries) {
-            max_entries *= 2;
-            array = realloc(array, max_entries * sizeof(char *));
-            assert(array != NULL);
-          }
-
-          array[num_entries] = strdup(ent->d_name);
-          ++num_entries;
-        }
-      } else {
-        if (num_entries == max_entries) {
-          max_entries *= 2;
-          array = realloc(array, max_entries * sizeof(char *));
-          assert(array != NULL);
-        }
-
-        array[num_entries] = strdup(ent->d_name);
-        ++num_entries;
-      }
-    }
-  }
+  int og_args = simp->num_args;
+  expand_wildcards(simp, pattern, &qualifier);
 
-  char **sorted_array = sort_array_strings(array, num_entries);
+  if (og_args == simp->num_args) {
+    if (!qualifier.null_glob) {
+      insert_argument(simp, remove_glob_escapes(word));
+    }
+  } else {
+    // remembered so batch can split the matches, matches right after
+    // those of the last wildcard extend its range
 
-  for (int j = 0; j < num_entries; ++j) {
-    free(array[j]);
-  }
+    if (simp->glob_start == -1) {
+      simp->glob_start = og_args;
+    }
 
-  free(array);
-  array = NULL;
-
-  for (int i = 0; i < num_entries; ++i) {
-    if ((strlen(prefix) == 0) ||
-        ((strlen(prefix) == 1) && (prefix[0] == '/'))) {
-      sprintf(new_prefix, "%s%s", prefix, sorted_array[i]);
-      expand_wildcards(new_prefix, suffix);
-    } else {
-      sprintf(new_prefix, "%s/%s", prefix, sorted_array[i]);
-      expand_wildcards(new_prefix, suffix);
+    if (simp->glob_end != og_args) {
+      simp->num_glob_ranges++;
     }
+
+    simp->glob_end = simp->num_args;
   }
+} /* glob_argument() */
 
-  free(sorted_array);
+/*
+ *  Expand one unquoted word, after brace expansion, into arguments
+ */
 
-  // only free array because I don't strdup the
-  // array elements when inserting args, so freeing the
-  // single command will free those strings later
+static void expand_argument(single_command_t *simp, char *brace_word) {
+  int num_fields = 0;
+  char **fields = expand_fields(brace_word, &num_fields);
 
-  free(regex);
-  regfree(&re);
-  closedir(dir);
-} /* expand_wildcards() */
+  for (int i = 0; i < num_fields; i++) {
+    glob_argument(simp, fields[i]);
+  }
+} /* expand_argument() */
 
 /*
- *  Insert an argument into the list of arguments in a single command
+ *  Expand the words of a single command into its arguments.
+ *  Runs brace expansion, variable and tilde expansion and then
+ *  wildcarding, replacing the arguments of any previous expansion.
  */
 
-void insert_argument(single_command_t *simp, char *argument) {
-  if (argument == NULL) {
-    return;
-  }
+void expand_single_command(single_command_t *simp) {
+  clear_arguments(simp);
 
-  simp->num_args++;
-  simp->arguments =
-      (char **)realloc(simp->arguments, (simp->num_args + 1) * sizeof(char *));
+  for (int i = 0; i < simp->num_words; i++) {
+    if (simp->quoted[i]) {
+      insert_argument(simp, simp->words[i]);
+      continue;
+    }
 
-  if (simp->arguments == NULL) {
-    perror("realloc");
-    exit(1);
-  }
+    brace_iterator_t *braces = open_brace_iterator(simp->words[i]);
 
-  simp->arguments[simp->num_args - 1] = argument;
-  simp->arguments[simp->num_args] = NULL;
-} /* insert_argument() */
+    if (braces == NULL) {
+      expand_argument(simp, simp->words[i]);
+      continue;
+    }
+
+    char *brace_word = NULL;
+
+    while ((brace_word = next_brace_word(braces)) != NULL) {
+      expand_argument(simp, brace_word);
+    }
+
+    close_brace_iterator(braces);
+  }
+} /* expand_single_command() */
 
 /*
  *  Print a single command in a pretty format
  */
 
 void print_single_command(single_command_t *simp) {
-  for (int i = 0; i < simp->num_args; i++) {
-    printf("\"%s\" \t", simp->arguments[i]);
+  for (int i = 0; i < simp->num_words; i++) {
+    printf("\"%s\" \t", simp->words[i]);
   }
 
   printf("\n\n");
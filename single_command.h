@@ -1,18 +1,54 @@
 #ifndef SINGLE_COMMAND_H
 #define SINGLE_COMMAND_H
 
+#include <stdbool.h>
+
+#include "arena.h"
+#include "qualifier.h"
+
+// Freed single commands kept for reuse by new_single_command()
+
+#define SINGLE_COMMAND_POOL_SIZE (64)
+
 typedef struct single_command {
   char *executable;
   char **arguments;
 
   int num_args;
+  int max_args;
+
+  // Arguments [glob_start, glob_end) came from wildcards, -1 if none.
+  // There are several ranges when other arguments come between
+  // wildcards, and only the matches are in [glob_start, glob_end) if
+  // there is one
+
+  int glob_start;
+  int glob_end;
+  int num_glob_ranges;
+
+  // Words as they were parsed. They are expanded into arguments
+  // every time the command runs, so a loop body can be re-executed
+  // without going back through the lexer.
+
+  char **words;
+  bool *quoted;
+
+  int num_words;
+  int max_words;
 } single_command_t;
 
 void create_single_command(single_command_t *);
+single_command_t *new_single_command();
 void free_single_command(single_command_t *);
 void insert_argument(single_command_t *, char *);
+void insert_word(single_command_t *, char *, bool);
+void expand_single_command(single_command_t *);
+void clear_arguments(single_command_t *);
 void print_single_command(single_command_t *);
 char *free_array_strings(char **array, int num_entries);
-void expand_wildcards(char *prefix, char *suffix);
+void expand_wildcards(single_command_t *simp, const char *pattern,
+                      glob_qualifier_t *qualifier);
+
+extern pool_stats_t g_single_command_pool_stats;
 
 #endif // SINGLE_COMMAND_H
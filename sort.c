@@ -0,0 +1,279 @@
+#include "sort.h"
+
+#include <locale.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "arena.h"
+#include "vars.h"
+
+typedef struct sort_entry {
+  const unsigned char *key;
+  char *string;
+} sort_entry_t;
+
+// A range of entries, still to be sorted from byte depth on
+
+typedef struct sort_bucket {
+  sort_entry_t *entries;
+  sort_entry_t *scratch;
+  size_t count;
+} sort_bucket_t;
+
+typedef struct sort_work {
+  sort_bucket_t buckets[256];
+  int num_buckets;
+
+  // Index of the next bucket a thread takes
+
+  int next_bucket;
+} sort_work_t;
+
+// Collation locale currently set with setlocale(), NULL for C
+
+static char *g_collate_locale = NULL;
+
+/*
+ *  Sort entries whose keys are equal before depth by insertion
+ */
+
+static void insertion_sort(sort_entry_t *entries, size_t count,
+                           size_t depth) {
+  for (size_t i = 1; i < count; i++) {
+    sort_entry_t entry = entries[i];
+    size_t j = i;
+
+    while ((j > 0) && (strcmp((const char *)entries[j - 1].key + depth,
+                              (const char *)entry.key + depth) > 0)) {
+      entries[j] = entries[j - 1];
+      j--;
+    }
+
+    entries[j] = entry;
+  }
+} /* insertion_sort() */
+
+/*
+ *  Distribute entries over 256 buckets by their byte at depth, using
+ *  scratch as the destination before copying back. Fills in starts
+ *  with the first index of each bucket.
+ */
+
+static void partition(sort_entry_t *entries, sort_entry_t *scratch,
+                      size_t count, size_t depth, size_t starts[257]) {
+  size_t counts[256] = {0};
+
+  for (size_t i = 0; i < count; i++) {
+    counts[entries[i].key[depth]]++;
+  }
+
+  starts[0] = 0;
+
+  for (int i = 0; i < 256; i++) {
+    starts[i + 1] = starts[i] + counts[i];
+  }
+
+  size_t next[256];
+
+  memcpy(next, starts, sizeof(next));
+
+  for (size_t i = 0; i < count; i++) {
+    scratch[next[entries[i].key[depth]]++] = entries[i];
+  }
+
+  memcpy(entries, scratch, count * sizeof(sort_entry_t));
+} /* partition() */
+
+/*
+ *  MSD radix sort of entries whose keys are equal before depth
+ */
+
+static void radix_sort(sort_entry_t *entries, sort_entry_t *scratch,
+                       size_t count, size_t depth) {
+  if (count < SORT_INSERTION_THRESHOLD) {
+    insertion_sort(entries, count, depth);
+    return;
+  }
+
+  size_t starts[257];
+
+  partition(entries, scratch, count, depth, starts);
+
+  // bucket 0 holds keys that ended here, they are all equal
+
+  for (int i = 1; i < 256; i++) {
+    size_t size = starts[i + 1] - starts[i];
+
+    if (size > 1) {
+      radix_sort(entries + starts[i], scratch + starts[i], size, depth + 1);
+    }
+  }
+} /* radix_sort() */
+
+/*
+ *  Thread body, sorts buckets until none are left
+ */
+
+static void *sort_worker(void *arg) {
+  sort_work_t *work = (sort_work_t *)arg;
+  int index = 0;
+
+  while ((index = __atomic_fetch_add(&work->next_bucket, 1,
+                                     __ATOMIC_RELAXED)) < work->num_buckets) {
+    sort_bucket_t *bucket = &work->buckets[index];
+
+    radix_sort(bucket->entries, bucket->scratch, bucket->count, 1);
+  }
+
+  return NULL;
+} /* sort_worker() */
+
+/*
+ *  Split entries by their first byte and sort the buckets on
+ *  several threads. Falls back to one thread if none can be started.
+ */
+
+static void parallel_sort(sort_entry_t *entries, sort_entry_t *scratch,
+                          size_t count) {
+  size_t starts[257];
+  sort_work_t work = {.num_buckets = 0, .next_bucket = 0};
+
+  partition(entries, scratch, count, 0, starts);
+
+  for (int i = 1; i < 256; i++) {
+    size_t size = starts[i + 1] - starts[i];
+
+    if (size > 1) {
+      work.buckets[work.num_buckets++] = (sort_bucket_t){
+          entries + starts[i], scratch + starts[i], size};
+    }
+  }
+
+  long num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+
+  if (num_threads > SORT_MAX_THREADS) {
+    num_threads = SORT_MAX_THREADS;
+  }
+
+  if (num_threads > work.num_buckets) {
+    num_threads = work.num_buckets;
+  }
+
+  pthread_t threads[SORT_MAX_THREADS];
+  int num_started = 0;
+
+  // the calling thread is one of the workers, the others start with
+  // every signal blocked so none of the shell's handlers run on them
+
+  sigset_t all_signals;
+  sigset_t old_mask;
+
+  sigfillset(&all_signals);
+  pthread_sigmask(SIG_SETMASK, &all_signals, &old_mask);
+
+  while (num_started < num_threads - 1) {
+    if (pthread_create(&threads[num_started], NULL, sort_worker, &work)) {
+      break;
+    }
+
+    num_started++;
+  }
+
+  pthread_sigmask(SIG_SETMASK, &old_mask, NULL);
+
+  sort_worker(&work);
+
+  for (int i = 0; i < num_started; i++) {
+    pthread_join(threads[i], NULL);
+  }
+} /* parallel_sort() */
+
+/*
+ *  True if names should be ordered by the collation of LC_ALL or
+ *  LC_COLLATE, setting that locale if it changed
+ */
+
+static bool use_collation() {
+  char *locale = get_variable("LC_ALL");
+
+  if ((locale == NULL) || (locale[0] == '\0')) {
+    locale = get_variable("LC_COLLATE");
+  }
+
+  if ((locale == NULL) || (locale[0] == '\0') || (!strcmp(locale, "C")) ||
+      (!strcmp(locale, "POSIX"))) {
+    return false;
+  }
+
+  if ((g_collate_locale != NULL) && (!strcmp(g_collate_locale, locale))) {
+    return true;
+  }
+
+  if (setlocale(LC_COLLATE, locale) == NULL) {
+    // unknown locale, sort by bytes
+
+    setlocale(LC_COLLATE, "C");
+    free(g_collate_locale);
+    g_collate_locale = NULL;
+    return false;
+  }
+
+  free(g_collate_locale);
+  g_collate_locale = strdup(locale);
+
+  return g_collate_locale != NULL;
+} /* use_collation() */
+
+/*
+ *  Sort strings in place, in byte order or in the collation order
+ *  of the locale in LC_ALL or LC_COLLATE
+ */
+
+void sort_strings(char **strings, size_t count) {
+  if (count < 2) {
+    return;
+  }
+
+  sort_entry_t *entries = (sort_entry_t *)malloc(2 * count * sizeof(sort_entry_t));
+
+  if (entries == NULL) {
+    perror("malloc");
+    exit(1);
+  }
+
+  sort_entry_t *scratch = entries + count;
+  bool collate = use_collation();
+
+  for (size_t i = 0; i < count; i++) {
+    entries[i].string = strings[i];
+    entries[i].key = (const unsigned char *)strings[i];
+
+    if (collate) {
+      // strxfrm() keys compare by bytes in collation order, the
+      // keys are released with the expanded words
+
+      size_t length = strxfrm(NULL, strings[i], 0) + 1;
+      char *key = (char *)arena_alloc(&g_expand_arena, length);
+
+      strxfrm(key, strings[i], length);
+      entries[i].key = (const unsigned char *)key;
+    }
+  }
+
+  if (count >= SORT_PARALLEL_THRESHOLD) {
+    parallel_sort(entries, scratch, count);
+  } else {
+    radix_sort(entries, scratch, count, 0);
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    strings[i] = entries[i].string;
+  }
+
+  free(entries);
+} /* sort_strings() */
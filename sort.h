@@ -0,0 +1,24 @@
+#ifndef SORT_H
+#define SORT_H
+
+#include <stddef.h>
+
+// String Sorting
+//
+// Sorts wildcard matches with an MSD radix sort over the bytes of
+// each name. Runs shorter than SORT_INSERTION_THRESHOLD finish with
+// insertion sort, and lists longer than SORT_PARALLEL_THRESHOLD have
+// their first byte buckets sorted by several threads. When LC_ALL or
+// LC_COLLATE names a locale other than C or POSIX, names are ordered
+// by their strxfrm() keys instead of their bytes.
+
+#define SORT_INSERTION_THRESHOLD (32)
+#define SORT_PARALLEL_THRESHOLD (64 * 1024)
+
+// Most threads used for one sort
+
+#define SORT_MAX_THREADS (16)
+
+void sort_strings(char **strings, size_t count);
+
+#endif // SORT_H
@@ -0,0 +1,249 @@
+#include "suggest.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static suggest_node_t g_suggest_root = {0};
+static int g_num_suggest_nodes = 0;
+static size_t g_suggest_bytes = 0;
+
+/*
+ *  Allocate a node whose label is a copy of length bytes of label
+ */
+
+static suggest_node_t *new_suggest_node(const char *label, size_t length) {
+  // the label shares the allocation of the node
+
+  suggest_node_t *node =
+      (suggest_node_t *)calloc(1, sizeof(suggest_node_t) + length);
+
+  if (node == NULL) {
+    perror("calloc");
+    exit(1);
+  }
+
+  g_num_suggest_nodes++;
+  g_suggest_bytes += sizeof(suggest_node_t) + length;
+
+  node->label = (char *)(node + 1);
+  node->label_length = length;
+  memcpy(node->label, label, length);
+
+  return node;
+} /* new_suggest_node() */
+
+/*
+ *  Free a node and everything below it
+ */
+
+static void free_suggest_node(suggest_node_t *node) {
+  while (node->child != NULL) {
+    suggest_node_t *child = node->child;
+
+    node->child = child->sibling;
+    free_suggest_node(child);
+  }
+
+  // a split node's label may start inside its allocation
+
+  g_num_suggest_nodes--;
+  g_suggest_bytes -= sizeof(suggest_node_t) +
+                     (node->label - (char *)(node + 1)) + node->label_length;
+  free(node);
+} /* free_suggest_node() */
+
+/*
+ *  Link to the child of node whose label starts with c, or to where
+ *  it would be inserted
+ */
+
+static suggest_node_t **find_child_link(suggest_node_t *node, char c) {
+  suggest_node_t **link = &node->child;
+
+  while ((*link != NULL) &&
+         ((unsigned char)(*link)->label[0] < (unsigned char)c)) {
+    link = &(*link)->sibling;
+  }
+
+  return link;
+} /* find_child_link() */
+
+/*
+ *  Node the whole of text leads to, NULL if there is none
+ */
+
+static suggest_node_t *find_node(const char *text, size_t length) {
+  suggest_node_t *node = &g_suggest_root;
+
+  while (length > 0) {
+    suggest_node_t *child = *find_child_link(node, *text);
+
+    if ((child == NULL) || (child->label_length > length) ||
+        (memcmp(child->label, text, child->label_length) != 0)) {
+      return NULL;
+    }
+
+    text += child->label_length;
+    length -= child->label_length;
+    node = child;
+  }
+
+  return node;
+} /* find_node() */
+
+/*
+ *  Add a line, or make it the most recent one on its path if it is
+ *  already there. Called each time the line enters the history
+ */
+
+void add_suggestion(history_entry_t *entry) {
+  const char *text = entry->text;
+  size_t remaining = entry->length;
+  suggest_node_t *end = find_node(text, remaining);
+  bool is_new = (end == NULL) || (end->entry != entry);
+  suggest_node_t *node = &g_suggest_root;
+
+  while (1) {
+    node->best = entry;
+    node->num_entries += is_new;
+
+    if (remaining == 0) {
+      break;
+    }
+
+    suggest_node_t **link = find_child_link(node, *text);
+
+    if ((*link == NULL) || ((*link)->label[0] != *text)) {
+      suggest_node_t *leaf = new_suggest_node(text, remaining);
+
+      leaf->sibling = *link;
+      *link = leaf;
+      node = leaf;
+      text += remaining;
+      remaining = 0;
+      continue;
+    }
+
+    suggest_node_t *child = *link;
+    size_t common = 0;
+
+    while ((common < child->label_length) && (common < remaining) &&
+           (child->label[common] == text[common])) {
+      common++;
+    }
+
+    if (common < child->label_length) {
+      // split the edge where the line leaves it
+
+      suggest_node_t *parent = new_suggest_node(child->label, common);
+
+      parent->sibling = child->sibling;
+      parent->child = child;
+      parent->best = child->best;
+      parent->num_entries = child->num_entries;
+      child->sibling = NULL;
+      child->label += common;
+      child->label_length -= common;
+      *link = parent;
+      child = parent;
+    }
+
+    node = child;
+    text += common;
+    remaining -= common;
+  }
+
+  node->entry = entry;
+} /* add_suggestion() */
+
+/*
+ *  Remove entry from node, reached by the line up to text, and below.
+ *  Returns true if the node has no lines left
+ */
+
+static bool remove_below(suggest_node_t *node, const char *text,
+                         size_t remaining, history_entry_t *entry) {
+  node->num_entries--;
+
+  if (remaining == 0) {
+    node->entry = NULL;
+  } else {
+    suggest_node_t **link = find_child_link(node, *text);
+    suggest_node_t *child = *link;
+
+    if ((child != NULL) && (child->label_length <= remaining) &&
+        (memcmp(child->label, text, child->label_length) == 0) &&
+        remove_below(child, text + child->label_length,
+                     remaining - child->label_length, entry)) {
+      *link = child->sibling;
+      free_suggest_node(child);
+    }
+  }
+
+  if (node->best == entry) {
+    // only happens if lines did not leave in order of use
+
+    node->best = node->entry;
+
+    for (suggest_node_t *child = node->child; child != NULL;
+         child = child->sibling) {
+      if ((node->best == NULL) ||
+          ((child->best != NULL) &&
+           (child->best->last_number > node->best->last_number))) {
+        node->best = child->best;
+      }
+    }
+  }
+
+  return node->num_entries == 0;
+} /* remove_below() */
+
+/*
+ *  Remove a line that left the history
+ */
+
+void remove_suggestion(history_entry_t *entry) {
+  if (find_node(entry->text, entry->length) == NULL) {
+    return;
+  }
+
+  remove_below(&g_suggest_root, entry->text, entry->length, entry);
+} /* remove_suggestion() */
+
+/*
+ *  Most recently used history line starting with the length bytes of
+ *  prefix, NULL if there is none
+ */
+
+const char *find_suggestion(const char *prefix, size_t length) {
+  suggest_node_t *node = &g_suggest_root;
+
+  while (length > 0) {
+    suggest_node_t *child = *find_child_link(node, *prefix);
+    size_t compared =
+        (child != NULL) && (child->label_length < length)
+            ? child->label_length
+            : length;
+
+    if ((child == NULL) || (memcmp(child->label, prefix, compared) != 0)) {
+      return NULL;
+    }
+
+    prefix += compared;
+    length -= compared;
+    node = child;
+  }
+
+  return (node->best != NULL) ? node->best->text : NULL;
+} /* find_suggestion() */
+
+/*
+ *  Print the size of the suggestion trie
+ */
+
+void print_suggest_stats() {
+  printf("suggest nodes %d bytes %zu\n", g_num_suggest_nodes,
+         g_suggest_bytes);
+} /* print_suggest_stats() */
@@ -0,0 +1,41 @@
+#ifndef SUGGEST_H
+#define SUGGEST_H
+
+#include <stddef.h>
+
+#include "history.h"
+
+// History Autosuggestions
+//
+// The interned history lines are kept in a radix trie, each edge
+// labelled with the characters it spans. Every node points to the
+// most recently used line at or below it, so the suggestion for what
+// has been typed is found by walking the typed characters once. The
+// line a node points to is the last one below it to leave the
+// history, since lines leave the history oldest use first, so when
+// it goes the node has no lines left and is removed.
+
+typedef struct suggest_node {
+  char *label;
+  size_t label_length;
+
+  // Children are sorted by the first character of their label
+
+  struct suggest_node *child;
+  struct suggest_node *sibling;
+
+  // Line ending at the node, and the most recently used line at or
+  // below it
+
+  history_entry_t *entry;
+  history_entry_t *best;
+
+  int num_entries;
+} suggest_node_t;
+
+void add_suggestion(history_entry_t *entry);
+void remove_suggestion(history_entry_t *entry);
+const char *find_suggestion(const char *prefix, size_t length);
+void print_suggest_stats();
+
+#endif // SUGGEST_H
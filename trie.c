@@ -0,0 +1,179 @@
+#include "trie.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Longest word trie_words() rebuilds
+
+#define MAX_TRIE_WORD (4096)
+
+/*
+ *  Create an empty trie
+ */
+
+trie_t *new_trie() {
+  trie_t *trie = (trie_t *)calloc(1, sizeof(trie_t));
+
+  if (trie == NULL) {
+    perror("calloc");
+    exit(1);
+  }
+
+  trie->arena.name = "trie";
+  trie->root = (trie_node_t *)arena_alloc(&trie->arena, sizeof(trie_node_t));
+  memset(trie->root, 0, sizeof(trie_node_t));
+
+  return trie;
+} /* new_trie() */
+
+/*
+ *  Free a trie and all its nodes
+ */
+
+void free_trie(trie_t *trie) {
+  if (trie == NULL) {
+    return;
+  }
+
+  arena_free(&trie->arena);
+  free(trie);
+} /* free_trie() */
+
+/*
+ *  Child of node for c, added in order if missing
+ */
+
+static trie_node_t *find_child(trie_t *trie, trie_node_t *node,
+                               unsigned char c) {
+  trie_node_t **link = &node->child;
+
+  while ((*link != NULL) && ((*link)->c < c)) {
+    link = &(*link)->sibling;
+  }
+
+  if ((*link != NULL) && ((*link)->c == c)) {
+    return *link;
+  }
+
+  trie_node_t *child =
+      (trie_node_t *)arena_alloc(&trie->arena, sizeof(trie_node_t));
+  memset(child, 0, sizeof(trie_node_t));
+  child->c = c;
+  child->sibling = *link;
+  *link = child;
+
+  return child;
+} /* find_child() */
+
+/*
+ *  Add a word with its d_type, a word added twice is kept once
+ */
+
+void trie_insert(trie_t *trie, const char *word, unsigned char type) {
+  trie_node_t *existing = trie_find(trie, word);
+
+  if ((existing != NULL) && (existing->is_word)) {
+    return;
+  }
+
+  trie_node_t *node = trie->root;
+  node->num_words++;
+
+  for (; *word != '\0'; word++) {
+    node = find_child(trie, node, *word);
+    node->num_words++;
+  }
+
+  node->is_word = true;
+  node->type = type;
+} /* trie_insert() */
+
+/*
+ *  Node reached by prefix, NULL if no word starts with it
+ */
+
+trie_node_t *trie_find(trie_t *trie, const char *prefix) {
+  trie_node_t *node = trie->root;
+
+  for (; (node != NULL) && (*prefix != '\0'); prefix++) {
+    trie_node_t *child = node->child;
+
+    while ((child != NULL) && (child->c < (unsigned char)*prefix)) {
+      child = child->sibling;
+    }
+
+    node = ((child != NULL) && (child->c == (unsigned char)*prefix)) ? child
+                                                                     : NULL;
+  }
+
+  return ((node != NULL) && (node->num_words > 0)) ? node : NULL;
+} /* trie_find() */
+
+/*
+ *  Write the characters every word below node shares after it into
+ *  buffer, NUL terminated, and return how many there are
+ */
+
+size_t trie_extension(const trie_node_t *node, char *buffer, size_t size) {
+  size_t length = 0;
+
+  while ((!node->is_word) && (node->child != NULL) &&
+         (node->child->sibling == NULL) && (length + 1 < size)) {
+    node = node->child;
+    buffer[length++] = node->c;
+  }
+
+  buffer[length] = '\0';
+
+  return length;
+} /* trie_extension() */
+
+/*
+ *  Add the words below node to words in sorted order
+ */
+
+static void collect_words(const trie_node_t *node, char *word, size_t length,
+                          char **words, int *num_words, int max_words,
+                          arena_t *arena) {
+  if (node->is_word) {
+    if (*num_words == max_words) {
+      return;
+    }
+
+    words[(*num_words)++] = arena_strndup(arena, word, length);
+  }
+
+  if (length + 1 >= MAX_TRIE_WORD) {
+    return;
+  }
+
+  for (const trie_node_t *child = node->child;
+       (child != NULL) && (*num_words < max_words); child = child->sibling) {
+    word[length] = child->c;
+    collect_words(child, word, length + 1, words, num_words, max_words,
+                  arena);
+  }
+} /* collect_words() */
+
+/*
+ *  Fill words with at most max_words of the words below node, which
+ *  was reached by prefix, copied into arena. Returns how many were
+ *  added
+ */
+
+int trie_words(const trie_node_t *node, const char *prefix, char **words,
+               int max_words, arena_t *arena) {
+  char word[MAX_TRIE_WORD];
+  size_t length = strlen(prefix);
+  int num_words = 0;
+
+  if (length >= MAX_TRIE_WORD) {
+    return 0;
+  }
+
+  memcpy(word, prefix, length);
+  collect_words(node, word, length, words, &num_words, max_words, arena);
+
+  return num_words;
+} /* trie_words() */
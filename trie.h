@@ -0,0 +1,44 @@
+#ifndef TRIE_H
+#define TRIE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "arena.h"
+
+// Prefix Trie
+//
+// Words are stored one character per node, the children of a node in
+// a sorted sibling list, and every node counts the words at or below
+// it. Finding the words that start with a prefix walks the prefix
+// only, and the part all of them share is read off the single child
+// chain below it. Nodes come from an arena of the trie, so a trie is
+// freed in one step.
+
+typedef struct trie_node {
+  struct trie_node *child;
+  struct trie_node *sibling;
+  unsigned char c;
+
+  // Whether a word ends here and its d_type
+
+  bool is_word;
+  unsigned char type;
+
+  int num_words;
+} trie_node_t;
+
+typedef struct trie {
+  arena_t arena;
+  trie_node_t *root;
+} trie_t;
+
+trie_t *new_trie();
+void free_trie(trie_t *trie);
+void trie_insert(trie_t *trie, const char *word, unsigned char type);
+trie_node_t *trie_find(trie_t *trie, const char *prefix);
+size_t trie_extension(const trie_node_t *node, char *buffer, size_t size);
+int trie_words(const trie_node_t *node, const char *prefix, char **words,
+               int max_words, arena_t *arena);
+
+#endif // TRIE_H
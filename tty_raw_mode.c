@@ -1,26 +1,181 @@
 #include "tty_raw_mode.h"
 
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <string.h>
-#include <termios.h>
+#include <unistd.h>
+
+static tty_state_t g_tty = {0};
+
+/*
+ *  Put the terminal in mode with one tcsetattr()
+ */
+
+static void set_tty_mode(tty_mode_t mode) {
+  const struct termios *tty_attr =
+      (mode == TTY_RAW) ? &g_tty.raw : &g_tty.original;
+
+  if (tcsetattr(0, TCSANOW, tty_attr) == 0) {
+    g_tty.mode = mode;
+
+    if (mode == TTY_RAW) {
+      g_tty.num_raw_switches++;
+    } else {
+      g_tty.num_cooked_switches++;
+    }
+  }
+} /* set_tty_mode() */
+
+static void install_tty_handlers();
+
+/*
+ *  ctrl-Z, give the terminal back in its original mode and stop, then
+ *  return to raw mode if it was in it when continued
+ */
+
+static void tty_stop_handler(int signum) {
+  int saved_errno = errno;
+  bool raw = (g_tty.mode == TTY_RAW);
+
+  if (raw) {
+    set_tty_mode(TTY_COOKED);
+  }
+
+  g_tty.num_stops++;
+
+  // stop with the default action, the signal is blocked while its
+  // handler runs
+
+  sigset_t mask;
+
+  sigemptyset(&mask);
+  sigaddset(&mask, signum);
+  signal(signum, SIG_DFL);
+  sigprocmask(SIG_UNBLOCK, &mask, NULL);
+  raise(signum);
+
+  // continued
+
+  sigprocmask(SIG_BLOCK, &mask, NULL);
+  install_tty_handlers();
+
+  if (raw) {
+    set_tty_mode(TTY_RAW);
+  }
+
+  errno = saved_errno;
+} /* tty_stop_handler() */
+
+/*
+ *  Continued after a stop that could not be caught, raw mode may have
+ *  been changed meanwhile
+ */
+
+static void tty_continue_handler(int signum) {
+  int saved_errno = errno;
+
+  (void)signum;
+
+  if (g_tty.mode == TTY_RAW) {
+    set_tty_mode(TTY_RAW);
+  }
+
+  errno = saved_errno;
+} /* tty_continue_handler() */
+
+/*
+ *  Catch SIGTSTP and SIGCONT
+ */
+
+static void install_tty_handlers() {
+  struct sigaction stop_action = {.sa_handler = tty_stop_handler,
+                                  .sa_flags = SA_RESTART};
+  struct sigaction continue_action = {.sa_handler = tty_continue_handler,
+                                      .sa_flags = SA_RESTART};
+
+  sigemptyset(&stop_action.sa_mask);
+  sigemptyset(&continue_action.sa_mask);
+
+  if ((sigaction(SIGTSTP, &stop_action, NULL) == -1) ||
+      (sigaction(SIGCONT, &continue_action, NULL) == -1)) {
+    perror("sigaction");
+    exit(1);
+  }
+} /* install_tty_handlers() */
+
+/*
+ *  Restore the original settings when the shell exits
+ */
+
+static void restore_tty() {
+  tty_cooked_mode();
+} /* restore_tty() */
+
+/*
+ *  Read the settings the terminal has now as its original ones, and
+ *  make the raw mode from them. Returns false if it is not a terminal
+ */
+
+static bool read_tty_settings() {
+  if (tcgetattr(0, &g_tty.original) == -1) {
+    return false;
+  }
+
+  g_tty.raw = g_tty.original;
+
+  /* Set raw mode. */
+  g_tty.raw.c_lflag &= (~(ICANON | ECHO));
+  g_tty.raw.c_cc[VTIME] = 0;
+  g_tty.raw.c_cc[VMIN] = 1;
+
+  return true;
+} /* read_tty_settings() */
 
 /*
  * Sets terminal into raw mode.
  * This causes having the characters available
  * immediately instead of waiting for a newline.
  * Also there is no automatic echo.
+ * Nothing is done if the terminal is in raw mode already. Otherwise
+ * the settings are read again first, so a change made with stty by
+ * the last command is kept and put back before the next one.
  */
 
 void tty_raw_mode(void) {
-  struct termios tty_attr = {0};
+  if (g_tty.mode == TTY_RAW) {
+    return;
+  }
 
-  tcgetattr(0, &tty_attr);
+  if (!read_tty_settings()) {
+    return;
+  }
 
-  /* Set raw mode. */
-  tty_attr.c_lflag &= (~(ICANON | ECHO));
-  tty_attr.c_cc[VTIME] = 0;
-  tty_attr.c_cc[VMIN] = 1;
+  if (!g_tty.saved) {
+    g_tty.saved = true;
+    g_tty.mode = TTY_COOKED;
+    install_tty_handlers();
+    atexit(restore_tty);
+  }
 
-  tcsetattr(0, TCSANOW, &tty_attr);
+  set_tty_mode(TTY_RAW);
 } /* tty_raw_mode() */
+
+/*
+ *  Put back the settings the terminal had before raw mode, if it is
+ *  in raw mode, such as before a command is started
+ */
+
+void tty_cooked_mode(void) {
+  if ((g_tty.saved) && (g_tty.mode != TTY_COOKED)) {
+    set_tty_mode(TTY_COOKED);
+  }
+} /* tty_cooked_mode() */
+
+/*
+ *  Print the terminal mode counters
+ */
+
+void print_tty_stats() {
+  printf("tty raw switches %lu cooked switches %lu stops %lu\n",
+         g_tty.num_raw_switches, g_tty.num_cooked_switches, g_tty.num_stops);
+} /* print_tty_stats() */
@@ -1,6 +1,46 @@
 #ifndef TTY_RAW_MODE_H
 #define TTY_RAW_MODE_H
 
+#include <signal.h>
+#include <stdbool.h>
+#include <termios.h>
+
+// Terminal Mode
+//
+// The settings the terminal has when the shell goes to read a line
+// are kept, along with the raw mode the line editor needs, and the
+// terminal is only switched when the mode wanted differs from the one
+// it is in: to raw when a line is read, back to the original settings
+// before a command is started in the foreground. The settings are
+// read again each time raw mode is entered, so changes made with
+// stty are kept. A line of builtins
+// costs no switch at all. When the shell is stopped with ctrl-Z the
+// original settings are put back for the shell that resumes, and raw
+// mode is set again when it is continued.
+
+typedef enum tty_mode {
+  TTY_COOKED,
+  TTY_RAW
+} tty_mode_t;
+
+typedef struct tty_state {
+  struct termios original;
+  struct termios raw;
+  bool saved;
+
+  // Mode the terminal is in, changed in the signal handlers too
+
+  volatile sig_atomic_t mode;
+
+  // Counters reported by the stats builtin
+
+  unsigned long num_raw_switches;
+  unsigned long num_cooked_switches;
+  unsigned long num_stops;
+} tty_state_t;
+
 void tty_raw_mode(void);
+void tty_cooked_mode(void);
+void print_tty_stats();
 
 #endif // TTY_RAW_MODE_H
@@ -0,0 +1,276 @@
+#include "vars.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static shell_var_t *g_vars = NULL;
+static size_t g_var_slots = 0;
+
+// Slots holding a variable or a deleted marker
+
+static size_t g_used_slots = 0;
+
+// Number of exported variables, and a counter bumped every time the
+// exported set changes
+
+static size_t g_num_exported = 0;
+static unsigned long g_export_generation = 1;
+
+static char **g_envp = NULL;
+static unsigned long g_envp_generation = 0;
+
+/*
+ *  FNV-1a hash of a variable name
+ */
+
+static uint64_t hash_name(const char *name) {
+  uint64_t hash = 14695981039346656037ULL;
+
+  while (*name) {
+    hash ^= (unsigned char)*name++;
+    hash *= 1099511628211ULL;
+  }
+
+  return hash;
+} /* hash_name() */
+
+/*
+ *  Find the slot of name. If it is not there, returns the slot it
+ *  would be inserted into.
+ */
+
+static shell_var_t *find_slot(const char *name) {
+  size_t mask = g_var_slots - 1;
+  size_t index = hash_name(name) & mask;
+  shell_var_t *tombstone = NULL;
+
+  while (1) {
+    shell_var_t *var = &g_vars[index];
+
+    if (var->name == NULL) {
+      if (var->deleted) {
+        if (tombstone == NULL) {
+          tombstone = var;
+        }
+      } else {
+        return (tombstone != NULL) ? tombstone : var;
+      }
+    } else if (!strcmp(var->name, name)) {
+      return var;
+    }
+
+    index = (index + 1) & mask;
+  }
+} /* find_slot() */
+
+/*
+ *  Allocate a table of the given number of slots and move every
+ *  variable into it, dropping deleted markers
+ */
+
+static void resize_table(size_t slots) {
+  shell_var_t *old_vars = g_vars;
+  size_t old_slots = g_var_slots;
+
+  g_vars = (shell_var_t *)calloc(slots, sizeof(shell_var_t));
+
+  if (g_vars == NULL) {
+    perror("calloc");
+    exit(1);
+  }
+
+  g_var_slots = slots;
+  g_used_slots = 0;
+
+  for (size_t i = 0; i < old_slots; i++) {
+    if (old_vars[i].name != NULL) {
+      *find_slot(old_vars[i].name) = old_vars[i];
+      g_used_slots++;
+    }
+  }
+
+  free(old_vars);
+} /* resize_table() */
+
+/*
+ *  Fill the table from the environment the shell was started with,
+ *  every one of these variables is exported
+ */
+
+void init_variables(char **envp) {
+  resize_table(INITIAL_VAR_SLOTS);
+
+  for (int i = 0; envp[i] != NULL; i++) {
+    char *equals = strchr(envp[i], '=');
+
+    if (equals == NULL) {
+      continue;
+    }
+
+    char *name = strndup(envp[i], equals - envp[i]);
+
+    if (name == NULL) {
+      perror("strndup");
+      exit(1);
+    }
+
+    set_variable(name, equals + 1, true);
+    free(name);
+  }
+} /* init_variables() */
+
+/*
+ *  Value of a variable, NULL if it is not set
+ */
+
+char *get_variable(const char *name) {
+  if (g_vars == NULL) {
+    return NULL;
+  }
+
+  shell_var_t *var = find_slot(name);
+
+  return var->name ? var->value : NULL;
+} /* get_variable() */
+
+/*
+ *  Set a variable. A new variable is exported if exported is true,
+ *  an existing one keeps being exported once it has been.
+ */
+
+void set_variable(const char *name, const char *value, bool exported) {
+  if (g_vars == NULL) {
+    resize_table(INITIAL_VAR_SLOTS);
+  }
+
+  // keep at most 3/4 of the slots in use so probes stay short
+
+  if ((g_used_slots + 1) * 4 > g_var_slots * 3) {
+    resize_table(g_var_slots * 2);
+  }
+
+  shell_var_t *var = find_slot(name);
+  char *new_value = strdup(value);
+
+  if (new_value == NULL) {
+    perror("strdup");
+    exit(1);
+  }
+
+  if (var->name == NULL) {
+    if (!var->deleted) {
+      g_used_slots++;
+    }
+
+    var->name = strdup(name);
+
+    if (var->name == NULL) {
+      perror("strdup");
+      exit(1);
+    }
+
+    var->value = new_value;
+    var->exported = false;
+    var->deleted = false;
+  } else {
+    free(var->value);
+    var->value = new_value;
+  }
+
+  if ((exported) && (!var->exported)) {
+    var->exported = true;
+    g_num_exported++;
+  }
+
+  if (var->exported) {
+    g_export_generation++;
+  }
+} /* set_variable() */
+
+/*
+ *  Remove a variable
+ */
+
+void unset_variable(const char *name) {
+  if (g_vars == NULL) {
+    return;
+  }
+
+  shell_var_t *var = find_slot(name);
+
+  if (var->name == NULL) {
+    return;
+  }
+
+  if (var->exported) {
+    g_num_exported--;
+    g_export_generation++;
+  }
+
+  free(var->name);
+  free(var->value);
+
+  var->name = NULL;
+  var->value = NULL;
+  var->exported = false;
+  var->deleted = true;
+} /* unset_variable() */
+
+/*
+ *  The exported variables as a NULL terminated "name=value" array for
+ *  exec. Rebuilt only if an exported variable changed since the last
+ *  call. The array belongs to the store.
+ */
+
+char **get_environment() {
+  if (g_envp_generation == g_export_generation) {
+    return g_envp;
+  }
+
+  if (g_envp != NULL) {
+    for (int i = 0; g_envp[i] != NULL; i++) {
+      free(g_envp[i]);
+    }
+
+    free(g_envp);
+  }
+
+  g_envp = (char **)malloc((g_num_exported + 1) * sizeof(char *));
+
+  if (g_envp == NULL) {
+    perror("malloc");
+    exit(1);
+  }
+
+  size_t count = 0;
+
+  for (size_t i = 0; i < g_var_slots; i++) {
+    shell_var_t *var = &g_vars[i];
+
+    if ((var->name == NULL) || (!var->exported)) {
+      continue;
+    }
+
+    size_t name_len = strlen(var->name);
+    size_t value_len = strlen(var->value);
+    char *entry = (char *)malloc(name_len + value_len + 2);
+
+    if (entry == NULL) {
+      perror("malloc");
+      exit(1);
+    }
+
+    memcpy(entry, var->name, name_len);
+    entry[name_len] = '=';
+    memcpy(entry + name_len + 1, var->value, value_len + 1);
+
+    g_envp[count++] = entry;
+  }
+
+  g_envp[count] = NULL;
+  g_envp_generation = g_export_generation;
+
+  return g_envp;
+} /* get_environment() */
@@ -0,0 +1,33 @@
+#ifndef VARS_H
+#define VARS_H
+
+#include <stdbool.h>
+
+// Shell Variable Store
+//
+// Variables live in an open addressing hash table. Exported variables
+// are passed to commands, the others are only seen by the shell. The
+// envp array given to exec is rebuilt only after the exported set has
+// changed, tracked by a generation counter.
+
+// Starting number of slots, always a power of two
+
+#define INITIAL_VAR_SLOTS (256)
+
+typedef struct shell_var {
+  char *name;
+  char *value;
+  bool exported;
+
+  // Slot of a removed variable, kept so probing continues past it
+
+  bool deleted;
+} shell_var_t;
+
+void init_variables(char **envp);
+char *get_variable(const char *name);
+void set_variable(const char *name, const char *value, bool exported);
+void unset_variable(const char *name);
+char **get_environment();
+
+#endif // VARS_H
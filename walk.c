@@ -0,0 +1,346 @@
+#define _GNU_SOURCE
+
+#include "walk.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "arena.h"
+#include "sort.h"
+#include "vars.h"
+
+// A growable array of malloc'd paths
+
+typedef struct path_list {
+  char **paths;
+  int num_paths;
+  int max_paths;
+} path_list_t;
+
+typedef struct walk_state {
+  int root_fd;
+  bool directories_only;
+
+  char **pruned;
+  int num_pruned;
+
+  // Directories waiting to be read, and the number being read.
+  // The walk is over when both are empty.
+
+  pthread_mutex_t lock;
+  pthread_cond_t work_ready;
+  path_list_t queue;
+  int num_busy;
+} walk_state_t;
+
+typedef struct walk_worker {
+  pthread_t thread;
+  walk_state_t *state;
+  path_list_t found;
+} walk_worker_t;
+
+/*
+ *  Append a path to a list
+ */
+
+static void append_path(path_list_t *list, char *path) {
+  if (list->num_paths == list->max_paths) {
+    list->max_paths = (list->max_paths == 0) ? 64 : list->max_paths * 2;
+    list->paths =
+        (char **)realloc(list->paths, list->max_paths * sizeof(char *));
+
+    if (list->paths == NULL) {
+      perror("realloc");
+      exit(1);
+    }
+  }
+
+  list->paths[list->num_paths++] = path;
+} /* append_path() */
+
+/*
+ *  Join a directory relative to the root and a name in it
+ */
+
+static char *join_path(const char *directory, const char *name) {
+  size_t length = strlen(directory);
+  char *path = (char *)malloc(length + strlen(name) + 2);
+
+  if (path == NULL) {
+    perror("malloc");
+    exit(1);
+  }
+
+  if (length == 0) {
+    strcpy(path, name);
+  } else {
+    sprintf(path, "%s/%s", directory, name);
+  }
+
+  return path;
+} /* join_path() */
+
+/*
+ *  True if name is in GLOBPRUNE
+ */
+
+static bool is_pruned(walk_state_t *state, const char *name) {
+  for (int i = 0; i < state->num_pruned; i++) {
+    if (!strcmp(state->pruned[i], name)) {
+      return true;
+    }
+  }
+
+  return false;
+} /* is_pruned() */
+
+/*
+ *  Read one directory, recording its entries in found and queueing
+ *  its subdirectories
+ */
+
+static void read_tree_directory(walk_worker_t *worker, const char *directory) {
+  walk_state_t *state = worker->state;
+  int fd = openat(state->root_fd, (directory[0] == '\0') ? "." : directory,
+                  O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+
+  if (fd == -1) {
+    return;
+  }
+
+  char buffer[WALK_BUFFER_SIZE];
+  ssize_t size = 0;
+
+  while ((size = getdents64(fd, buffer, sizeof(buffer))) > 0) {
+    for (ssize_t offset = 0; offset < size;) {
+      struct dirent64 *ent = (struct dirent64 *)(buffer + offset);
+      offset += ent->d_reclen;
+
+      if (ent->d_name[0] == '.') {
+        continue;
+      }
+
+      unsigned char type = ent->d_type;
+
+      if (type == DT_UNKNOWN) {
+        struct stat st;
+
+        if (fstatat(fd, ent->d_name, &st, AT_SYMLINK_NOFOLLOW) == 0) {
+          type = S_ISDIR(st.st_mode) ? DT_DIR : DT_REG;
+        }
+      }
+
+      if (((type != DT_DIR) && (state->directories_only)) ||
+          ((type == DT_DIR) && (is_pruned(state, ent->d_name)))) {
+        continue;
+      }
+
+      char *path = join_path(directory, ent->d_name);
+
+      append_path(&worker->found, path);
+
+      if (type == DT_DIR) {
+        char *queued = strdup(path);
+
+        if (queued == NULL) {
+          perror("strdup");
+          exit(1);
+        }
+
+        pthread_mutex_lock(&state->lock);
+        append_path(&state->queue, queued);
+        pthread_cond_signal(&state->work_ready);
+        pthread_mutex_unlock(&state->lock);
+      }
+    }
+  }
+
+  close(fd);
+} /* read_tree_directory() */
+
+/*
+ *  Thread body, reads queued directories until the walk is over
+ */
+
+static void *walk_worker(void *arg) {
+  walk_worker_t *worker = (walk_worker_t *)arg;
+  walk_state_t *state = worker->state;
+
+  pthread_mutex_lock(&state->lock);
+
+  while (true) {
+    while ((state->queue.num_paths == 0) && (state->num_busy > 0)) {
+      pthread_cond_wait(&state->work_ready, &state->lock);
+    }
+
+    if (state->queue.num_paths == 0) {
+      break;
+    }
+
+    char *directory = state->queue.paths[--state->queue.num_paths];
+
+    state->num_busy++;
+    pthread_mutex_unlock(&state->lock);
+
+    read_tree_directory(worker, directory);
+    free(directory);
+
+    pthread_mutex_lock(&state->lock);
+    state->num_busy--;
+
+    // wake the others so they can see the walk is over
+
+    if ((state->num_busy == 0) && (state->queue.num_paths == 0)) {
+      pthread_cond_broadcast(&state->work_ready);
+    }
+  }
+
+  pthread_mutex_unlock(&state->lock);
+
+  return NULL;
+} /* walk_worker() */
+
+/*
+ *  Split GLOBPRUNE into the names of directories not to descend into
+ */
+
+static void read_pruned_names(walk_state_t *state) {
+  char *value = get_variable("GLOBPRUNE");
+
+  state->pruned = NULL;
+  state->num_pruned = 0;
+
+  if ((value == NULL) || (value[0] == '\0')) {
+    return;
+  }
+
+  char *names = arena_strdup(&g_expand_arena, value);
+  int max_pruned = 1;
+
+  for (char *c = names; *c != '\0'; c++) {
+    max_pruned += (*c == ':');
+  }
+
+  state->pruned = (char **)arena_alloc(&g_expand_arena,
+                                       max_pruned * sizeof(char *));
+
+  for (char *name = strtok(names, ":"); name != NULL;
+       name = strtok(NULL, ":")) {
+    state->pruned[state->num_pruned++] = name;
+  }
+} /* read_pruned_names() */
+
+/*
+ *  List every entry below the directory open as dirfd, or only its
+ *  directories, as sorted paths relative to it. The array and paths
+ *  are in the expansion arena. Returns NULL if it cannot be read.
+ */
+
+char **walk_tree(int dirfd, bool directories_only, int *num_paths) {
+  walk_state_t state = {0};
+
+  state.root_fd = openat(dirfd, ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+  if (state.root_fd == -1) {
+    return NULL;
+  }
+
+  state.directories_only = directories_only;
+  read_pruned_names(&state);
+  pthread_mutex_init(&state.lock, NULL);
+  pthread_cond_init(&state.work_ready, NULL);
+
+  char *start = strdup("");
+
+  if (start == NULL) {
+    perror("strdup");
+    exit(1);
+  }
+
+  append_path(&state.queue, start);
+
+  long num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+
+  if (num_threads > WALK_MAX_THREADS) {
+    num_threads = WALK_MAX_THREADS;
+  }
+
+  if (num_threads < 1) {
+    num_threads = 1;
+  }
+
+  walk_worker_t workers[WALK_MAX_THREADS];
+  int num_started = 1;
+
+  memset(workers, 0, sizeof(workers));
+
+  for (int i = 0; i < num_threads; i++) {
+    workers[i].state = &state;
+  }
+
+  // the calling thread is the first worker, the others start with
+  // every signal blocked so a SIGCHLD of a foreground command is never
+  // handled, and its child reaped, on them
+
+  sigset_t all_signals;
+  sigset_t old_mask;
+
+  sigfillset(&all_signals);
+  pthread_sigmask(SIG_SETMASK, &all_signals, &old_mask);
+
+  for (int i = 1; i < num_threads; i++) {
+    if (pthread_create(&workers[i].thread, NULL, walk_worker, &workers[i])) {
+      break;
+    }
+
+    num_started++;
+  }
+
+  pthread_sigmask(SIG_SETMASK, &old_mask, NULL);
+
+  walk_worker(&workers[0]);
+
+  int total = 0;
+
+  for (int i = 0; i < num_started; i++) {
+    if (i > 0) {
+      pthread_join(workers[i].thread, NULL);
+    }
+
+    total += workers[i].found.num_paths;
+  }
+
+  // merge the paths found by each thread into the arena
+
+  char **paths = (char **)arena_alloc(&g_expand_arena,
+                                      (total + 1) * sizeof(char *));
+  int count = 0;
+
+  for (int i = 0; i < num_started; i++) {
+    for (int j = 0; j < workers[i].found.num_paths; j++) {
+      paths[count++] = arena_strdup(&g_expand_arena, workers[i].found.paths[j]);
+      free(workers[i].found.paths[j]);
+    }
+
+    free(workers[i].found.paths);
+  }
+
+  paths[count] = NULL;
+
+  free(state.queue.paths);
+  pthread_mutex_destroy(&state.lock);
+  pthread_cond_destroy(&state.work_ready);
+  close(state.root_fd);
+
+  sort_strings(paths, count);
+  *num_paths = count;
+
+  return paths;
+} /* walk_tree() */
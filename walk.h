@@ -0,0 +1,24 @@
+#ifndef WALK_H
+#define WALK_H
+
+#include <stdbool.h>
+
+// Parallel Directory Walker
+//
+// Lists a directory tree for ** wildcards. Directories are read with
+// getdents64() on descriptors opened relative to the root, by worker
+// threads sharing one queue of directories still to be read. Hidden
+// entries are skipped and symbolic links are not followed.
+// Directories named in the colon separated GLOBPRUNE variable (for
+// example node_modules:build) are left out along with everything
+// below them.
+
+#define WALK_MAX_THREADS (16)
+
+// Bytes read by one getdents64() call
+
+#define WALK_BUFFER_SIZE (32 * 1024)
+
+char **walk_tree(int dirfd, bool directories_only, int *num_paths);
+
+#endif // WALK_H
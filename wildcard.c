@@ -0,0 +1,482 @@
+#include "wildcard.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "arena.h"
+#include "dircache.h"
+#include "glob.h"
+#include "sort.h"
+#include "walk.h"
+
+/*
+ *  Join a wildcard prefix and a path below it into a malloc'd string
+ */
+
+static char *join_prefix(const char *prefix, const char *path) {
+  size_t prefix_length = strlen(prefix);
+  size_t length = prefix_length + strlen(path) + 2;
+  char *joined = (char *)malloc(length);
+
+  if (joined == NULL) {
+    perror("malloc");
+    exit(1);
+  }
+
+  if ((prefix_length == 0) || (prefix[prefix_length - 1] == '/')) {
+    snprintf(joined, length, "%s%s", prefix, path);
+  } else {
+    snprintf(joined, length, "%s/%s", prefix, path);
+  }
+
+  return joined;
+} /* join_prefix() */
+
+/*
+ *  Copy names into one malloc'd block holding the pointer array
+ *  followed by the strings, sorted
+ */
+
+static char **pack_names(char **names, int count) {
+  size_t size = (count + 1) * sizeof(char *);
+
+  for (int i = 0; i < count; i++) {
+    size += strlen(names[i]) + 1;
+  }
+
+  char **packed = (char **)malloc(size);
+
+  if (packed == NULL) {
+    perror("malloc");
+    exit(1);
+  }
+
+  char *strings = (char *)(packed + count + 1);
+
+  for (int i = 0; i < count; i++) {
+    size_t length = strlen(names[i]) + 1;
+
+    memcpy(strings, names[i], length);
+    packed[i] = strings;
+    strings += length;
+  }
+
+  packed[count] = NULL;
+  sort_strings(packed, count);
+
+  return packed;
+} /* pack_names() */
+
+/*
+ *  Sorted names in dirfd matching component. When it is not the last
+ *  component only directories, or links that may be one, are kept.
+ *  Types are filtered from d_type before anything is stat'd.
+ */
+
+static char **list_matches(int dirfd, const char *component, bool last,
+                           const glob_qualifier_t *qualifier, int *count) {
+  glob_pattern_t *glob = compile_glob(component);
+  unsigned char *types = NULL;
+  int num_names = 0;
+  char **names = read_directory(dirfd, &types, &num_names, NULL);
+
+  *count = 0;
+
+  if (names == NULL) {
+    return NULL;
+  }
+
+  // the listing belongs to the directory cache, matches are
+  // collected first and copied out
+
+  char **matches = (char **)malloc((num_names + 1) * sizeof(char *));
+
+  if (matches == NULL) {
+    perror("malloc");
+    exit(1);
+  }
+
+  for (int i = 0; i < num_names; i++) {
+    char *name = names[i];
+
+    if ((name[0] == '.') && (component[0] != '.')) {
+      continue;
+    }
+
+    if ((!last) && (types[i] != DT_DIR) && (types[i] != DT_LNK) &&
+        (types[i] != DT_UNKNOWN)) {
+      continue;
+    }
+
+    if (!match_glob(glob, name)) {
+      continue;
+    }
+
+    if ((last) && (!match_qualifier(qualifier, dirfd, name, types[i]))) {
+      continue;
+    }
+
+    matches[(*count)++] = name;
+  }
+
+  char **packed = pack_names(matches, *count);
+
+  free(matches);
+
+  return packed;
+} /* list_matches() */
+
+/*
+ *  Paths below dirfd matched by a ** component. As the last component
+ *  these are every file and directory passing the qualifier, otherwise
+ *  the directories, and first "" for zero directories.
+ */
+
+static char **list_tree(int dirfd, bool last,
+                        const glob_qualifier_t *qualifier, int *count) {
+  arena_mark_t mark = arena_mark(&g_expand_arena);
+  int num_paths = 0;
+  char **paths = walk_tree(dirfd, !last, &num_paths);
+
+  *count = 0;
+
+  if (paths == NULL) {
+    arena_release(&g_expand_arena, mark);
+    return NULL;
+  }
+
+  char **matches = (char **)malloc((num_paths + 2) * sizeof(char *));
+
+  if (matches == NULL) {
+    perror("malloc");
+    exit(1);
+  }
+
+  if (!last) {
+    matches[(*count)++] = "";
+  }
+
+  for (int i = 0; i < num_paths; i++) {
+    if ((!last) || (match_qualifier(qualifier, dirfd, paths[i], DT_UNKNOWN))) {
+      matches[(*count)++] = paths[i];
+    }
+  }
+
+  char **packed = pack_names(matches, *count);
+
+  free(matches);
+  arena_release(&g_expand_arena, mark);
+
+  return packed;
+} /* list_tree() */
+
+/*
+ *  Push a level for the names matched by a component
+ */
+
+static void push_level(glob_iterator_t *iterator, int dirfd, char *prefix,
+                       const char *rest, char **names, int num_names) {
+  if (iterator->num_levels == iterator->max_levels) {
+    iterator->max_levels =
+        (iterator->max_levels == 0) ? 8 : iterator->max_levels * 2;
+    iterator->levels = (glob_level_t *)realloc(
+        iterator->levels, iterator->max_levels * sizeof(glob_level_t));
+
+    if (iterator->levels == NULL) {
+      perror("realloc");
+      exit(1);
+    }
+  }
+
+  glob_level_t *level = &iterator->levels[iterator->num_levels++];
+
+  level->dirfd = dirfd;
+  level->prefix = prefix;
+  level->rest = rest;
+  level->last = (rest[0] == '\0');
+  level->names = names;
+  level->num_names = num_names;
+  level->next_name = 0;
+} /* push_level() */
+
+/*
+ *  Close a directory descriptor owned by the iterator
+ */
+
+static void close_dirfd(int dirfd) {
+  if (dirfd != AT_FDCWD) {
+    close(dirfd);
+  }
+} /* close_dirfd() */
+
+/*
+ *  Resolve the components of suffix below the directory dirfd that
+ *  prefix names, taking ownership of both. Literal components are
+ *  followed directly, the first wildcard pushes a level. Returns the
+ *  match if suffix had no wildcards left and names a file, else NULL.
+ */
+
+static char *descend(glob_iterator_t *iterator, int dirfd, char *prefix,
+                     const char *suffix) {
+  while (suffix[0] != '\0') {
+    const char *slash = strchr(suffix, '/');
+    size_t length =
+        (slash == NULL) ? strlen(suffix) : (size_t)(slash - suffix);
+    const char *rest = (slash == NULL) ? suffix + length : slash + 1;
+    bool last = (rest[0] == '\0');
+    char *component = strndup(suffix, length);
+
+    if (component == NULL) {
+      perror("strndup");
+      exit(1);
+    }
+
+    suffix = rest;
+
+    if (length == 0) {
+      // doubled slash
+
+      free(component);
+      continue;
+    }
+
+    if (!strcmp(component, "**") || (has_glob(component))) {
+      int num_names = 0;
+      char **names =
+          (!strcmp(component, "**"))
+              ? list_tree(dirfd, last, &iterator->qualifier, &num_names)
+              : list_matches(dirfd, component, last, &iterator->qualifier,
+                             &num_names);
+
+      free(component);
+
+      if (names == NULL) {
+        close_dirfd(dirfd);
+        free(prefix);
+        return NULL;
+      }
+
+      push_level(iterator, dirfd, prefix, rest, names, num_names);
+      return NULL;
+    }
+
+    remove_glob_escapes(component);
+
+    char *path = join_prefix(prefix, component);
+    struct stat st;
+
+    free(prefix);
+    prefix = path;
+
+    if (last) {
+      bool found =
+          (fstatat(dirfd, component, &st, AT_SYMLINK_NOFOLLOW) == 0) &&
+          (match_qualifier(&iterator->qualifier, dirfd, component,
+                           DT_UNKNOWN));
+
+      free(component);
+      close_dirfd(dirfd);
+
+      if (!found) {
+        free(prefix);
+        return NULL;
+      }
+
+      return prefix;
+    }
+
+    int fd = openat(dirfd, component, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+    free(component);
+    close_dirfd(dirfd);
+    dirfd = fd;
+
+    if (dirfd == -1) {
+      free(prefix);
+      return NULL;
+    }
+  }
+
+  // only reached when the pattern ends in a doubled slash
+
+  close_dirfd(dirfd);
+
+  return prefix;
+} /* descend() */
+
+/*
+ *  Start iterating over the matches of pattern that pass qualifier
+ */
+
+glob_iterator_t *open_glob_iterator(const char *pattern,
+                                    const glob_qualifier_t *qualifier) {
+  glob_iterator_t *iterator =
+      (glob_iterator_t *)calloc(1, sizeof(glob_iterator_t));
+
+  if (iterator != NULL) {
+    iterator->pattern = strdup(pattern);
+  }
+
+  if ((iterator == NULL) || (iterator->pattern == NULL)) {
+    perror("malloc");
+    exit(1);
+  }
+
+  iterator->qualifier = *qualifier;
+
+  int dirfd = AT_FDCWD;
+  const char *suffix = iterator->pattern;
+
+  if (suffix[0] == '/') {
+    dirfd = open("/", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    suffix++;
+
+    if (dirfd == -1) {
+      return iterator;
+    }
+  }
+
+  iterator->pending =
+      descend(iterator, dirfd, strdup((dirfd == AT_FDCWD) ? "" : "/"), suffix);
+
+  // the walk yields ** matches directory by directory, they are
+  // collected and sorted as one list
+
+  if (strstr(pattern, "**") != NULL) {
+    int max_sorted = 64;
+    int num_sorted = 0;
+    char **sorted = (char **)malloc(max_sorted * sizeof(char *));
+    char *match = NULL;
+
+    if (sorted == NULL) {
+      perror("malloc");
+      exit(1);
+    }
+
+    while ((match = next_glob_match(iterator)) != NULL) {
+      if (num_sorted == max_sorted) {
+        max_sorted *= 2;
+        sorted = (char **)realloc(sorted, max_sorted * sizeof(char *));
+
+        if (sorted == NULL) {
+          perror("realloc");
+          exit(1);
+        }
+      }
+
+      // the match is taken over from the iterator
+
+      sorted[num_sorted++] = match;
+      iterator->current = NULL;
+    }
+
+    sort_strings(sorted, num_sorted);
+    iterator->sorted = sorted;
+    iterator->num_sorted = num_sorted;
+  }
+
+  return iterator;
+} /* open_glob_iterator() */
+
+/*
+ *  Return the next match, or NULL when there are no more. The string
+ *  belongs to the iterator and is valid until the next call.
+ */
+
+char *next_glob_match(glob_iterator_t *iterator) {
+  free(iterator->current);
+  iterator->current = NULL;
+
+  if (iterator->sorted != NULL) {
+    if (iterator->next_sorted == iterator->num_sorted) {
+      return NULL;
+    }
+
+    iterator->current = iterator->sorted[iterator->next_sorted++];
+    return iterator->current;
+  }
+
+  if (iterator->pending != NULL) {
+    iterator->current = iterator->pending;
+    iterator->pending = NULL;
+    return iterator->current;
+  }
+
+  while (iterator->num_levels > 0) {
+    glob_level_t *level = &iterator->levels[iterator->num_levels - 1];
+
+    if (level->next_name == level->num_names) {
+      close_dirfd(level->dirfd);
+      free(level->prefix);
+      free(level->names);
+      iterator->num_levels--;
+      continue;
+    }
+
+    char *name = level->names[level->next_name++];
+
+    // "" is the zero directories matched by a **
+
+    char *path = (name[0] == '\0') ? strdup(level->prefix)
+                                   : join_prefix(level->prefix, name);
+
+    if (path == NULL) {
+      perror("strdup");
+      exit(1);
+    }
+
+    if (level->last) {
+      iterator->current = path;
+      return path;
+    }
+
+    int fd = openat(level->dirfd, (name[0] == '\0') ? "." : name,
+                    O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+    if (fd == -1) {
+      free(path);
+      continue;
+    }
+
+    // may push a level, moving the level array
+
+    char *match = descend(iterator, fd, path, level->rest);
+
+    if (match != NULL) {
+      iterator->current = match;
+      return match;
+    }
+  }
+
+  return NULL;
+} /* next_glob_match() */
+
+/*
+ *  Stop iterating, closing the directories still open
+ */
+
+void close_glob_iterator(glob_iterator_t *iterator) {
+  while (iterator->num_levels > 0) {
+    glob_level_t *level = &iterator->levels[--iterator->num_levels];
+
+    close_dirfd(level->dirfd);
+    free(level->prefix);
+    free(level->names);
+  }
+
+  for (int i = iterator->next_sorted; i < iterator->num_sorted; i++) {
+    free(iterator->sorted[i]);
+  }
+
+  free(iterator->sorted);
+  free(iterator->levels);
+  free(iterator->pending);
+  free(iterator->current);
+  free(iterator->pattern);
+  free(iterator);
+} /* close_glob_iterator() */
@@ -0,0 +1,67 @@
+#ifndef WILDCARD_H
+#define WILDCARD_H
+
+#include <stdbool.h>
+
+#include "qualifier.h"
+
+// Streaming Wildcard Expansion
+//
+// A glob iterator yields the matches of a wildcard pattern one at a
+// time, walking the pattern depth first with a directory descriptor
+// per level. Only the sorted matches of the directories on the
+// current path are held, so memory is bounded by the directories
+// being read rather than by the whole result, and the first match is
+// returned as soon as its directory is read. Each directory is read
+// when the walk enters it.
+//
+// A ** component lists the whole tree below it when it is entered.
+// The matches of a pattern with ** are collected when the iterator is
+// opened and sorted as one list, so a for loop gets them in the same
+// order as the arguments of a command.
+
+typedef struct glob_level {
+  // Directory the names are in, closed when the level is popped
+
+  int dirfd;
+  char *prefix;
+
+  // Pattern components after the one matched by this level
+
+  const char *rest;
+  bool last;
+
+  // Sorted matches, names point into the same allocation
+
+  char **names;
+  int num_names;
+  int next_name;
+} glob_level_t;
+
+typedef struct glob_iterator {
+  char *pattern;
+  glob_qualifier_t qualifier;
+
+  glob_level_t *levels;
+  int num_levels;
+  int max_levels;
+
+  // A match found before any level was pushed, and the last match
+  // returned, freed by the next call
+
+  char *pending;
+  char *current;
+
+  // All the matches of a ** pattern, sorted, and the next to return
+
+  char **sorted;
+  int num_sorted;
+  int next_sorted;
+} glob_iterator_t;
+
+glob_iterator_t *open_glob_iterator(const char *pattern,
+                                    const glob_qualifier_t *qualifier);
+char *next_glob_match(glob_iterator_t *iterator);
+void close_glob_iterator(glob_iterator_t *iterator);
+
+#endif // WILDCARD_H
@@ -63,65 +63,92 @@
 /* Pull parsers.  */
 #define YYPULL 1
 
-#ifndef YY_CAST
-#ifdef __cplusplus
-#define YY_CAST(Type, Val) static_cast<Type>(Val)
-#define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type>(Val)
-#else
-#define YY_CAST(Type, Val) ((Type)(Val))
-#define YY_REINTERPRET_CAST(Type, Val) ((Type)(Val))
-#endif
-#endif
-#ifndef YY_NULLPTR
-#if defined __cplusplus
-#if 201103L <= __cplusplus
-#define YY_NULLPTR nullptr
-#else
-#define YY_NULLPTR 0
-#endif
-#else
-#define YY_NULLPTR ((void *)0)
-#endif
-#endif
+
+
+
+
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
+#  else
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
+# ifndef YY_NULLPTR
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
+#  else
+#   define YY_NULLPTR ((void*)0)
+#  endif
+# endif
 
 /* Use api.header.include to #include this header
    instead of duplicating it here.  */
 #ifndef YY_YY_Y_TAB_H_INCLUDED
-#define YY_YY_Y_TAB_H_INCLUDED
+# define YY_YY_Y_TAB_H_INCLUDED
 /* Debug traces.  */
 #ifndef YYDEBUG
-#define YYDEBUG 1
+# define YYDEBUG 1
 #endif
 #if YYDEBUG
 extern int yydebug;
 #endif
 /* "%code requires" blocks.  */
-#line 15 "shell.y"
+#line 7 "shell.y"
+
+
 
 #line 108 "y.tab.c"
 
 /* Token kinds.  */
 #ifndef YYTOKENTYPE
-#define YYTOKENTYPE
-enum yytokentype {
-  YYEMPTY = -2,
-  YYEOF = 0,         /* "end of file"  */
-  YYerror = 256,     /* error  */
-  YYUNDEF = 257,     /* "invalid token"  */
-  WORD = 258,        /* WORD  */
-  PIPE = 259,        /* PIPE  */
-  QUOTED_WORD = 260, /* QUOTED_WORD  */
-  NOTOKEN = 261,     /* NOTOKEN  */
-  NEWLINE = 262,     /* NEWLINE  */
-  STDOUT = 263,      /* STDOUT  */
-  STDIN = 264,       /* STDIN  */
-  STDERR = 265,      /* STDERR  */
-  BOTH = 266,        /* BOTH  */
-  APPEND = 267,      /* APPEND  */
-  APPENDBOTH = 268,  /* APPENDBOTH  */
-  AMPERSAND = 269    /* AMPERSAND  */
-};
-typedef enum yytokentype yytoken_kind_t;
+# define YYTOKENTYPE
+  enum yytokentype
+  {
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    WORD = 258,                    /* WORD  */
+    QUOTED_WORD = 259,             /* QUOTED_WORD  */
+    PIPE = 260,                    /* PIPE  */
+    NOTOKEN = 261,                 /* NOTOKEN  */
+    NEWLINE = 262,                 /* NEWLINE  */
+    STDOUT = 263,                  /* STDOUT  */
+    STDIN = 264,                   /* STDIN  */
+    STDERR = 265,                  /* STDERR  */
+    BOTH = 266,                    /* BOTH  */
+    APPEND = 267,                  /* APPEND  */
+    APPENDBOTH = 268,              /* APPENDBOTH  */
+    AMPERSAND = 269,               /* AMPERSAND  */
+    SEMI = 270,                    /* SEMI  */
+    DSEMI = 271,                   /* DSEMI  */
+    AND_IF = 272,                  /* AND_IF  */
+    OR_IF = 273,                   /* OR_IF  */
+    RPAREN = 274,                  /* RPAREN  */
+    IF = 275,                      /* IF  */
+    THEN = 276,                    /* THEN  */
+    ELSE = 277,                    /* ELSE  */
+    ELIF = 278,                    /* ELIF  */
+    FI = 279,                      /* FI  */
+    WHILE = 280,                   /* WHILE  */
+    UNTIL = 281,                   /* UNTIL  */
+    DO = 282,                      /* DO  */
+    DONE = 283,                    /* DONE  */
+    FOR = 284,                     /* FOR  */
+    IN = 285,                      /* IN  */
+    CASE = 286,                    /* CASE  */
+    ESAC = 287,                    /* ESAC  */
+    COND_START = 288,              /* COND_START  */
+    COND_END = 289                 /* COND_END  */
+  };
+  typedef enum yytokentype yytoken_kind_t;
 #endif
 /* Token kinds.  */
 #define YYEMPTY -2
@@ -129,8 +156,8 @@ typedef enum yytokentype yytoken_kind_t;
 #define YYerror 256
 #define YYUNDEF 257
 #define WORD 258
-#define PIPE 259
-#define QUOTED_WORD 260
+#define QUOTED_WORD 259
+#define PIPE 260
 #define NOTOKEN 261
 #define NEWLINE 262
 #define STDOUT 263
@@ -140,79 +167,168 @@ typedef enum yytokentype yytoken_kind_t;
 #define APPEND 267
 #define APPENDBOTH 268
 #define AMPERSAND 269
+#define SEMI 270
+#define DSEMI 271
+#define AND_IF 272
+#define OR_IF 273
+#define RPAREN 274
+#define IF 275
+#define THEN 276
+#define ELSE 277
+#define ELIF 278
+#define FI 279
+#define WHILE 280
+#define UNTIL 281
+#define DO 282
+#define DONE 283
+#define FOR 284
+#define IN 285
+#define CASE 286
+#define ESAC 287
+#define COND_START 288
+#define COND_END 289
 
 /* Value type.  */
-#if !defined YYSTYPE && !defined YYSTYPE_IS_DECLARED
-union YYSTYPE {
-#line 20 "shell.y"
+#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
+union YYSTYPE
+{
+#line 12 "shell.y"
+
+  char * string;
+  int number;
+  struct node * node;
+  struct single_command * words;
 
-  char *string;
+#line 203 "y.tab.c"
 
-#line 160 "y.tab.c"
 };
 typedef union YYSTYPE YYSTYPE;
-#define YYSTYPE_IS_TRIVIAL 1
-#define YYSTYPE_IS_DECLARED 1
+# define YYSTYPE_IS_TRIVIAL 1
+# define YYSTYPE_IS_DECLARED 1
 #endif
 
+
 extern YYSTYPE yylval;
 
-int yyparse(void);
+
+int yyparse (void);
+
 
 #endif /* !YY_YY_Y_TAB_H_INCLUDED  */
 /* Symbol kind.  */
-enum yysymbol_kind_t {
+enum yysymbol_kind_t
+{
   YYSYMBOL_YYEMPTY = -2,
-  YYSYMBOL_YYEOF = 0,                /* "end of file"  */
-  YYSYMBOL_YYerror = 1,              /* error  */
-  YYSYMBOL_YYUNDEF = 2,              /* "invalid token"  */
-  YYSYMBOL_WORD = 3,                 /* WORD  */
-  YYSYMBOL_PIPE = 4,                 /* PIPE  */
-  YYSYMBOL_QUOTED_WORD = 5,          /* QUOTED_WORD  */
-  YYSYMBOL_NOTOKEN = 6,              /* NOTOKEN  */
-  YYSYMBOL_NEWLINE = 7,              /* NEWLINE  */
-  YYSYMBOL_STDOUT = 8,               /* STDOUT  */
-  YYSYMBOL_STDIN = 9,                /* STDIN  */
-  YYSYMBOL_STDERR = 10,              /* STDERR  */
-  YYSYMBOL_BOTH = 11,                /* BOTH  */
-  YYSYMBOL_APPEND = 12,              /* APPEND  */
-  YYSYMBOL_APPENDBOTH = 13,          /* APPENDBOTH  */
-  YYSYMBOL_AMPERSAND = 14,           /* AMPERSAND  */
-  YYSYMBOL_YYACCEPT = 15,            /* $accept  */
-  YYSYMBOL_goal = 16,                /* goal  */
-  YYSYMBOL_entire_command_list = 17, /* entire_command_list  */
-  YYSYMBOL_entire_command = 18,      /* entire_command  */
-  YYSYMBOL_single_command_list = 19, /* single_command_list  */
-  YYSYMBOL_single_command = 20,      /* single_command  */
-  YYSYMBOL_argument_list = 21,       /* argument_list  */
-  YYSYMBOL_argument = 22,            /* argument  */
-  YYSYMBOL_executable = 23,          /* executable  */
-  YYSYMBOL_io_modifier_list = 24,    /* io_modifier_list  */
-  YYSYMBOL_io_modifier = 25          /* io_modifier  */
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_WORD = 3,                       /* WORD  */
+  YYSYMBOL_QUOTED_WORD = 4,                /* QUOTED_WORD  */
+  YYSYMBOL_PIPE = 5,                       /* PIPE  */
+  YYSYMBOL_NOTOKEN = 6,                    /* NOTOKEN  */
+  YYSYMBOL_NEWLINE = 7,                    /* NEWLINE  */
+  YYSYMBOL_STDOUT = 8,                     /* STDOUT  */
+  YYSYMBOL_STDIN = 9,                      /* STDIN  */
+  YYSYMBOL_STDERR = 10,                    /* STDERR  */
+  YYSYMBOL_BOTH = 11,                      /* BOTH  */
+  YYSYMBOL_APPEND = 12,                    /* APPEND  */
+  YYSYMBOL_APPENDBOTH = 13,                /* APPENDBOTH  */
+  YYSYMBOL_AMPERSAND = 14,                 /* AMPERSAND  */
+  YYSYMBOL_SEMI = 15,                      /* SEMI  */
+  YYSYMBOL_DSEMI = 16,                     /* DSEMI  */
+  YYSYMBOL_AND_IF = 17,                    /* AND_IF  */
+  YYSYMBOL_OR_IF = 18,                     /* OR_IF  */
+  YYSYMBOL_RPAREN = 19,                    /* RPAREN  */
+  YYSYMBOL_IF = 20,                        /* IF  */
+  YYSYMBOL_THEN = 21,                      /* THEN  */
+  YYSYMBOL_ELSE = 22,                      /* ELSE  */
+  YYSYMBOL_ELIF = 23,                      /* ELIF  */
+  YYSYMBOL_FI = 24,                        /* FI  */
+  YYSYMBOL_WHILE = 25,                     /* WHILE  */
+  YYSYMBOL_UNTIL = 26,                     /* UNTIL  */
+  YYSYMBOL_DO = 27,                        /* DO  */
+  YYSYMBOL_DONE = 28,                      /* DONE  */
+  YYSYMBOL_FOR = 29,                       /* FOR  */
+  YYSYMBOL_IN = 30,                        /* IN  */
+  YYSYMBOL_CASE = 31,                      /* CASE  */
+  YYSYMBOL_ESAC = 32,                      /* ESAC  */
+  YYSYMBOL_COND_START = 33,                /* COND_START  */
+  YYSYMBOL_COND_END = 34,                  /* COND_END  */
+  YYSYMBOL_YYACCEPT = 35,                  /* $accept  */
+  YYSYMBOL_goal = 36,                      /* goal  */
+  YYSYMBOL_entire_command_list = 37,       /* entire_command_list  */
+  YYSYMBOL_entire_command = 38,            /* entire_command  */
+  YYSYMBOL_complete_command = 39,          /* complete_command  */
+  YYSYMBOL_list = 40,                      /* list  */
+  YYSYMBOL_and_or = 41,                    /* and_or  */
+  YYSYMBOL_pipeline = 42,                  /* pipeline  */
+  YYSYMBOL_compound_command = 43,          /* compound_command  */
+  YYSYMBOL_compound_list = 44,             /* compound_list  */
+  YYSYMBOL_term = 45,                      /* term  */
+  YYSYMBOL_if_clause = 46,                 /* if_clause  */
+  YYSYMBOL_else_part = 47,                 /* else_part  */
+  YYSYMBOL_while_clause = 48,              /* while_clause  */
+  YYSYMBOL_until_clause = 49,              /* until_clause  */
+  YYSYMBOL_for_clause = 50,                /* for_clause  */
+  YYSYMBOL_word_list = 51,                 /* word_list  */
+  YYSYMBOL_cond_command = 52,              /* cond_command  */
+  YYSYMBOL_do_group = 53,                  /* do_group  */
+  YYSYMBOL_case_clause = 54,               /* case_clause  */
+  YYSYMBOL_case_word = 55,                 /* case_word  */
+  YYSYMBOL_case_list_ns = 56,              /* case_list_ns  */
+  YYSYMBOL_case_list = 57,                 /* case_list  */
+  YYSYMBOL_case_item_ns = 58,              /* case_item_ns  */
+  YYSYMBOL_case_item = 59,                 /* case_item  */
+  YYSYMBOL_pattern = 60,                   /* pattern  */
+  YYSYMBOL_separator_op = 61,              /* separator_op  */
+  YYSYMBOL_separator = 62,                 /* separator  */
+  YYSYMBOL_sequential_sep = 63,            /* sequential_sep  */
+  YYSYMBOL_linebreak = 64,                 /* linebreak  */
+  YYSYMBOL_newline_list = 65,              /* newline_list  */
+  YYSYMBOL_single_command_list = 66,       /* single_command_list  */
+  YYSYMBOL_single_command = 67,            /* single_command  */
+  YYSYMBOL_argument_list = 68,             /* argument_list  */
+  YYSYMBOL_argument = 69,                  /* argument  */
+  YYSYMBOL_executable = 70,                /* executable  */
+  YYSYMBOL_io_modifier_list = 71,          /* io_modifier_list  */
+  YYSYMBOL_io_modifier = 72                /* io_modifier  */
 };
 typedef enum yysymbol_kind_t yysymbol_kind_t;
 
+
 /* Second part of user prologue.  */
-#line 27 "shell.y"
+#line 36 "shell.y"
+
 
-#include <malloc.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <malloc.h>
 #include <unistd.h>
 
 #include "command.h"
-#include "shell.h"
+#include "node.h"
 #include "single_command.h"
+#include "shell.h"
 
-void yyerror(const char *s);
+void yyerror(const char * s);
 int yylex();
 
-#line 229 "y.tab.c"
+/*
+ * Allocates a single command used to hold a list of words
+ */
+
+single_command_t * new_word_list() {
+  return new_single_command();
+}
+
+
+#line 328 "y.tab.c"
+
 
 #ifdef short
-#undef short
+# undef short
 #endif
 
 /* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
@@ -220,11 +336,11 @@ int yylex();
    so that the code can choose integer types of a good width.  */
 
 #ifndef __PTRDIFF_MAX__
-#include <limits.h> /* INFRINGES ON USER NAME SPACE */
-#if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
-#include <stdint.h> /* INFRINGES ON USER NAME SPACE */
-#define YY_STDINT_H
-#endif
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
 #endif
 
 /* Narrow types that promote to a signed type and that can represent a
@@ -254,16 +370,16 @@ typedef short yytype_int16;
    (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
    <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
 #ifdef __hpux
-#undef UINT_LEAST8_MAX
-#undef UINT_LEAST16_MAX
-#define UINT_LEAST8_MAX 255
-#define UINT_LEAST16_MAX 65535
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
 #endif
 
 #if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
 typedef __UINT_LEAST8_TYPE__ yytype_uint8;
-#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H &&                  \
-       UINT_LEAST8_MAX <= INT_MAX)
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
 typedef uint_least8_t yytype_uint8;
 #elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
 typedef unsigned char yytype_uint8;
@@ -273,8 +389,8 @@ typedef short yytype_uint8;
 
 #if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
 typedef __UINT_LEAST16_TYPE__ yytype_uint16;
-#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H &&                 \
-       UINT_LEAST16_MAX <= INT_MAX)
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
 typedef uint_least16_t yytype_uint16;
 #elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
 typedef unsigned short yytype_uint16;
@@ -283,467 +399,616 @@ typedef int yytype_uint16;
 #endif
 
 #ifndef YYPTRDIFF_T
-#if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
-#define YYPTRDIFF_T __PTRDIFF_TYPE__
-#define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
-#elif defined PTRDIFF_MAX
-#ifndef ptrdiff_t
-#include <stddef.h> /* INFRINGES ON USER NAME SPACE */
-#endif
-#define YYPTRDIFF_T ptrdiff_t
-#define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
-#else
-#define YYPTRDIFF_T long
-#define YYPTRDIFF_MAXIMUM LONG_MAX
-#endif
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
 #endif
 
 #ifndef YYSIZE_T
-#ifdef __SIZE_TYPE__
-#define YYSIZE_T __SIZE_TYPE__
-#elif defined size_t
-#define YYSIZE_T size_t
-#elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
-#include <stddef.h> /* INFRINGES ON USER NAME SPACE */
-#define YYSIZE_T size_t
-#else
-#define YYSIZE_T unsigned
-#endif
+# ifdef __SIZE_TYPE__
+#  define YYSIZE_T __SIZE_TYPE__
+# elif defined size_t
+#  define YYSIZE_T size_t
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  define YYSIZE_T size_t
+# else
+#  define YYSIZE_T unsigned
+# endif
 #endif
 
-#define YYSIZE_MAXIMUM                                                         \
-  YY_CAST(YYPTRDIFF_T,                                                         \
-          (YYPTRDIFF_MAXIMUM < YY_CAST(YYSIZE_T, -1) ? YYPTRDIFF_MAXIMUM       \
-                                                     : YY_CAST(YYSIZE_T, -1)))
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
 
-#define YYSIZEOF(X) YY_CAST(YYPTRDIFF_T, sizeof(X))
 
 /* Stored state numbers (used for stacks). */
-typedef yytype_int8 yy_state_t;
+typedef yytype_uint8 yy_state_t;
 
 /* State numbers in computations.  */
 typedef int yy_state_fast_t;
 
 #ifndef YY_
-#if defined YYENABLE_NLS && YYENABLE_NLS
-#if ENABLE_NLS
-#include <libintl.h> /* INFRINGES ON USER NAME SPACE */
-#define YY_(Msgid) dgettext("bison-runtime", Msgid)
-#endif
-#endif
-#ifndef YY_
-#define YY_(Msgid) Msgid
-#endif
+# if defined YYENABLE_NLS && YYENABLE_NLS
+#  if ENABLE_NLS
+#   include <libintl.h> /* INFRINGES ON USER NAME SPACE */
+#   define YY_(Msgid) dgettext ("bison-runtime", Msgid)
+#  endif
+# endif
+# ifndef YY_
+#  define YY_(Msgid) Msgid
+# endif
 #endif
 
+
 #ifndef YY_ATTRIBUTE_PURE
-#if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
-#define YY_ATTRIBUTE_PURE __attribute__((__pure__))
-#else
-#define YY_ATTRIBUTE_PURE
-#endif
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
 #endif
 
 #ifndef YY_ATTRIBUTE_UNUSED
-#if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
-#define YY_ATTRIBUTE_UNUSED __attribute__((__unused__))
-#else
-#define YY_ATTRIBUTE_UNUSED
-#endif
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
+# else
+#  define YY_ATTRIBUTE_UNUSED
+# endif
 #endif
 
 /* Suppress unused-variable warnings by "using" E.  */
-#if !defined lint || defined __GNUC__
-#define YY_USE(E) ((void)(E))
+#if ! defined lint || defined __GNUC__
+# define YY_USE(E) ((void) (E))
 #else
-#define YY_USE(E) /* empty */
+# define YY_USE(E) /* empty */
 #endif
 
 /* Suppress an incorrect diagnostic about yylval being uninitialized.  */
-#if defined __GNUC__ && !defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
-#if __GNUC__ * 100 + __GNUC_MINOR__ < 407
-#define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                                    \
-  _Pragma("GCC diagnostic push")                                               \
-      _Pragma("GCC diagnostic ignored \"-Wuninitialized\"")
-#else
-#define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                                    \
-  _Pragma("GCC diagnostic push")                                               \
-      _Pragma("GCC diagnostic ignored \"-Wuninitialized\"")                    \
-          _Pragma("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
-#endif
-#define YY_IGNORE_MAYBE_UNINITIALIZED_END _Pragma("GCC diagnostic pop")
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
+    _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
+    _Pragma ("GCC diagnostic pop")
 #else
-#define YY_INITIAL_VALUE(Value) Value
+# define YY_INITIAL_VALUE(Value) Value
 #endif
 #ifndef YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
-#define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
-#define YY_IGNORE_MAYBE_UNINITIALIZED_END
+# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END
 #endif
 #ifndef YY_INITIAL_VALUE
-#define YY_INITIAL_VALUE(Value) /* Nothing. */
+# define YY_INITIAL_VALUE(Value) /* Nothing. */
 #endif
 
-#if defined __cplusplus && defined __GNUC__ && !defined __ICC && 6 <= __GNUC__
-#define YY_IGNORE_USELESS_CAST_BEGIN                                           \
-  _Pragma("GCC diagnostic push")                                               \
-      _Pragma("GCC diagnostic ignored \"-Wuseless-cast\"")
-#define YY_IGNORE_USELESS_CAST_END _Pragma("GCC diagnostic pop")
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
 #endif
 #ifndef YY_IGNORE_USELESS_CAST_BEGIN
-#define YY_IGNORE_USELESS_CAST_BEGIN
-#define YY_IGNORE_USELESS_CAST_END
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
 #endif
 
-#define YY_ASSERT(E) ((void)(0 && (E)))
+
+#define YY_ASSERT(E) ((void) (0 && (E)))
 
 #if !defined yyoverflow
 
 /* The parser invokes alloca or malloc; define the necessary symbols.  */
 
-#ifdef YYSTACK_USE_ALLOCA
-#if YYSTACK_USE_ALLOCA
-#ifdef __GNUC__
-#define YYSTACK_ALLOC __builtin_alloca
-#elif defined __BUILTIN_VA_ARG_INCR
-#include <alloca.h> /* INFRINGES ON USER NAME SPACE */
-#elif defined _AIX
-#define YYSTACK_ALLOC __alloca
-#elif defined _MSC_VER
-#include <malloc.h> /* INFRINGES ON USER NAME SPACE */
-#define alloca _alloca
-#else
-#define YYSTACK_ALLOC alloca
-#if !defined _ALLOCA_H && !defined EXIT_SUCCESS
-#include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
-/* Use EXIT_SUCCESS as a witness for stdlib.h.  */
-#ifndef EXIT_SUCCESS
-#define EXIT_SUCCESS 0
-#endif
-#endif
-#endif
-#endif
-#endif
-
-#ifdef YYSTACK_ALLOC
-/* Pacify GCC's 'empty if-body' warning.  */
-#define YYSTACK_FREE(Ptr)                                                      \
-  do { /* empty */                                                             \
-    ;                                                                          \
-  } while (0)
-#ifndef YYSTACK_ALLOC_MAXIMUM
-/* The OS might guarantee only one guard page at the bottom of the stack,
-   and a page size can be as small as 4096 bytes.  So we cannot safely
-   invoke alloca (N) if N exceeds 4096.  Use a slightly smaller number
-   to allow for a few compiler-allocated temporary stack slots.  */
-#define YYSTACK_ALLOC_MAXIMUM 4032 /* reasonable circa 2006 */
-#endif
-#else
-#define YYSTACK_ALLOC YYMALLOC
-#define YYSTACK_FREE YYFREE
-#ifndef YYSTACK_ALLOC_MAXIMUM
-#define YYSTACK_ALLOC_MAXIMUM YYSIZE_MAXIMUM
-#endif
-#if (defined __cplusplus && !defined EXIT_SUCCESS &&                           \
-     !((defined YYMALLOC || defined malloc) &&                                 \
-       (defined YYFREE || defined free)))
-#include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
-#ifndef EXIT_SUCCESS
-#define EXIT_SUCCESS 0
-#endif
-#endif
-#ifndef YYMALLOC
-#define YYMALLOC malloc
-#if !defined malloc && !defined EXIT_SUCCESS
-void *malloc(YYSIZE_T); /* INFRINGES ON USER NAME SPACE */
-#endif
-#endif
-#ifndef YYFREE
-#define YYFREE free
-#if !defined free && !defined EXIT_SUCCESS
-void free(void *); /* INFRINGES ON USER NAME SPACE */
-#endif
-#endif
-#endif
+# ifdef YYSTACK_USE_ALLOCA
+#  if YYSTACK_USE_ALLOCA
+#   ifdef __GNUC__
+#    define YYSTACK_ALLOC __builtin_alloca
+#   elif defined __BUILTIN_VA_ARG_INCR
+#    include <alloca.h> /* INFRINGES ON USER NAME SPACE */
+#   elif defined _AIX
+#    define YYSTACK_ALLOC __alloca
+#   elif defined _MSC_VER
+#    include <malloc.h> /* INFRINGES ON USER NAME SPACE */
+#    define alloca _alloca
+#   else
+#    define YYSTACK_ALLOC alloca
+#    if ! defined _ALLOCA_H && ! defined EXIT_SUCCESS
+#     include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
+      /* Use EXIT_SUCCESS as a witness for stdlib.h.  */
+#     ifndef EXIT_SUCCESS
+#      define EXIT_SUCCESS 0
+#     endif
+#    endif
+#   endif
+#  endif
+# endif
+
+# ifdef YYSTACK_ALLOC
+   /* Pacify GCC's 'empty if-body' warning.  */
+#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (0)
+#  ifndef YYSTACK_ALLOC_MAXIMUM
+    /* The OS might guarantee only one guard page at the bottom of the stack,
+       and a page size can be as small as 4096 bytes.  So we cannot safely
+       invoke alloca (N) if N exceeds 4096.  Use a slightly smaller number
+       to allow for a few compiler-allocated temporary stack slots.  */
+#   define YYSTACK_ALLOC_MAXIMUM 4032 /* reasonable circa 2006 */
+#  endif
+# else
+#  define YYSTACK_ALLOC YYMALLOC
+#  define YYSTACK_FREE YYFREE
+#  ifndef YYSTACK_ALLOC_MAXIMUM
+#   define YYSTACK_ALLOC_MAXIMUM YYSIZE_MAXIMUM
+#  endif
+#  if (defined __cplusplus && ! defined EXIT_SUCCESS \
+       && ! ((defined YYMALLOC || defined malloc) \
+             && (defined YYFREE || defined free)))
+#   include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
+#   ifndef EXIT_SUCCESS
+#    define EXIT_SUCCESS 0
+#   endif
+#  endif
+#  ifndef YYMALLOC
+#   define YYMALLOC malloc
+#   if ! defined malloc && ! defined EXIT_SUCCESS
+void *malloc (YYSIZE_T); /* INFRINGES ON USER NAME SPACE */
+#   endif
+#  endif
+#  ifndef YYFREE
+#   define YYFREE free
+#   if ! defined free && ! defined EXIT_SUCCESS
+void free (void *); /* INFRINGES ON USER NAME SPACE */
+#   endif
+#  endif
+# endif
 #endif /* !defined yyoverflow */
 
-#if (!defined yyoverflow &&                                                    \
-     (!defined __cplusplus ||                                                  \
-      (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
+#if (! defined yyoverflow \
+     && (! defined __cplusplus \
+         || (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
 
 /* A type that is properly aligned for any stack member.  */
-union yyalloc {
+union yyalloc
+{
   yy_state_t yyss_alloc;
   YYSTYPE yyvs_alloc;
 };
 
 /* The size of the maximum gap between one aligned stack and the next.  */
-#define YYSTACK_GAP_MAXIMUM (YYSIZEOF(union yyalloc) - 1)
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
 
 /* The size of an array large to enough to hold all stacks, each with
    N elements.  */
-#define YYSTACK_BYTES(N)                                                       \
-  ((N) * (YYSIZEOF(yy_state_t) + YYSIZEOF(YYSTYPE)) + YYSTACK_GAP_MAXIMUM)
+# define YYSTACK_BYTES(N) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE)) \
+      + YYSTACK_GAP_MAXIMUM)
 
-#define YYCOPY_NEEDED 1
+# define YYCOPY_NEEDED 1
 
 /* Relocate STACK from its old location to the new one.  The
    local variables YYSIZE and YYSTACKSIZE give the old and new number of
    elements in the stack, and YYPTR gives the new location of the
    stack.  Advance YYPTR to a properly aligned location for the next
    stack.  */
-#define YYSTACK_RELOCATE(Stack_alloc, Stack)                                   \
-  do {                                                                         \
-    YYPTRDIFF_T yynewbytes;                                                    \
-    YYCOPY(&yyptr->Stack_alloc, Stack, yysize);                                \
-    Stack = &yyptr->Stack_alloc;                                               \
-    yynewbytes = yystacksize * YYSIZEOF(*Stack) + YYSTACK_GAP_MAXIMUM;         \
-    yyptr += yynewbytes / YYSIZEOF(*yyptr);                                    \
-  } while (0)
+# define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
+    do                                                                  \
+      {                                                                 \
+        YYPTRDIFF_T yynewbytes;                                         \
+        YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
+        Stack = &yyptr->Stack_alloc;                                    \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
+      }                                                                 \
+    while (0)
 
 #endif
 
 #if defined YYCOPY_NEEDED && YYCOPY_NEEDED
 /* Copy COUNT objects from SRC to DST.  The source and destination do
    not overlap.  */
-#ifndef YYCOPY
-#if defined __GNUC__ && 1 < __GNUC__
-#define YYCOPY(Dst, Src, Count)                                                \
-  __builtin_memcpy(Dst, Src, YY_CAST(YYSIZE_T, (Count)) * sizeof(*(Src)))
-#else
-#define YYCOPY(Dst, Src, Count)                                                \
-  do {                                                                         \
-    YYPTRDIFF_T yyi;                                                           \
-    for (yyi = 0; yyi < (Count); yyi++)                                        \
-      (Dst)[yyi] = (Src)[yyi];                                                 \
-  } while (0)
-#endif
-#endif
+# ifndef YYCOPY
+#  if defined __GNUC__ && 1 < __GNUC__
+#   define YYCOPY(Dst, Src, Count) \
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
+#  else
+#   define YYCOPY(Dst, Src, Count)              \
+      do                                        \
+        {                                       \
+          YYPTRDIFF_T yyi;                      \
+          for (yyi = 0; yyi < (Count); yyi++)   \
+            (Dst)[yyi] = (Src)[yyi];            \
+        }                                       \
+      while (0)
+#  endif
+# endif
 #endif /* !YYCOPY_NEEDED */
 
 /* YYFINAL -- State number of the termination state.  */
-#define YYFINAL 10
+#define YYFINAL  42
 /* YYLAST -- Last index in YYTABLE.  */
-#define YYLAST 26
+#define YYLAST   146
 
 /* YYNTOKENS -- Number of terminals.  */
-#define YYNTOKENS 15
+#define YYNTOKENS  35
 /* YYNNTS -- Number of nonterminals.  */
-#define YYNNTS 11
+#define YYNNTS  38
 /* YYNRULES -- Number of rules.  */
-#define YYNRULES 24
+#define YYNRULES  84
 /* YYNSTATES -- Number of states.  */
-#define YYNSTATES 34
+#define YYNSTATES  137
 
 /* YYMAXUTOK -- Last valid token kind.  */
-#define YYMAXUTOK 269
+#define YYMAXUTOK   289
+
 
 /* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
    as returned by yylex, with out-of-bounds checking.  */
-#define YYTRANSLATE(YYX)                                                       \
-  (0 <= (YYX) && (YYX) <= YYMAXUTOK                                            \
-       ? YY_CAST(yysymbol_kind_t, yytranslate[YYX])                            \
-       : YYSYMBOL_YYUNDEF)
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
 
 /* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
    as returned by yylex.  */
-static const yytype_int8 yytranslate[] = {
-    0, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,  2,  2,  2,  2, 2, 2, 2, 2, 2, 2,
-    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,  2,  2,  2,  2, 2, 2, 2, 2, 2, 2,
-    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,  2,  2,  2,  2, 2, 2, 2, 2, 2, 2,
-    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,  2,  2,  2,  2, 2, 2, 2, 2, 2, 2,
-    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,  2,  2,  2,  2, 2, 2, 2, 2, 2, 2,
-    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,  2,  2,  2,  2, 2, 2, 2, 2, 2, 2,
-    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,  2,  2,  2,  2, 2, 2, 2, 2, 2, 2,
-    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,  2,  2,  2,  2, 2, 2, 2, 2, 2, 2,
-    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,  2,  2,  2,  2, 2, 2, 2, 2, 2, 2,
-    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,  2,  2,  2,  2, 2, 2, 2, 2, 2, 2,
-    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,  2,  2,  2,  2, 2, 2, 2, 2, 2, 2,
-    2, 2, 2, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14};
+static const yytype_int8 yytranslate[] =
+{
+       0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     1,     2,     3,     4,
+       5,     6,     7,     8,     9,    10,    11,    12,    13,    14,
+      15,    16,    17,    18,    19,    20,    21,    22,    23,    24,
+      25,    26,    27,    28,    29,    30,    31,    32,    33,    34
+};
 
 #if YYDEBUG
 /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
-static const yytype_uint8 yyrline[] = {
-    0,   48,  48,  52,  53,  57,  98,  107, 108, 112, 135, 136, 140,
-    155, 161, 176, 182, 183, 187, 196, 205, 208, 219, 230, 243};
+static const yytype_int16 yyrline[] =
+{
+       0,    66,    66,    70,    71,    75,    90,    98,   108,   109,
+     118,   124,   128,   129,   132,   138,   145,   149,   150,   151,
+     152,   153,   154,   158,   161,   170,   176,   180,   186,   194,
+     199,   205,   211,   219,   227,   233,   242,   246,   250,   254,
+     261,   268,   274,   279,   284,   291,   295,   302,   311,   315,
+     323,   327,   331,   339,   343,   351,   352,   356,   363,   366,
+     372,   375,   381,   382,   386,   387,   391,   392,   396,   397,
+     401,   414,   415,   419,   423,   429,   432,   438,   439,   443,
+     452,   461,   464,   475,   486
+};
 #endif
 
 /** Accessing symbol of state STATE.  */
-#define YY_ACCESSING_SYMBOL(State) YY_CAST(yysymbol_kind_t, yystos[State])
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
 
 #if YYDEBUG || 0
 /* The user-facing name of the symbol whose (internal) number is
    YYSYMBOL.  No bounds checking.  */
-static const char *yysymbol_name(yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
 
 /* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
    First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
-static const char *const yytname[] = {"\"end of file\"",
-                                      "error",
-                                      "\"invalid token\"",
-                                      "WORD",
-                                      "PIPE",
-                                      "QUOTED_WORD",
-                                      "NOTOKEN",
-                                      "NEWLINE",
-                                      "STDOUT",
-                                      "STDIN",
-                                      "STDERR",
-                                      "BOTH",
-                                      "APPEND",
-                                      "APPENDBOTH",
-                                      "AMPERSAND",
-                                      "$accept",
-                                      "goal",
-                                      "entire_command_list",
-                                      "entire_command",
-                                      "single_command_list",
-                                      "single_command",
-                                      "argument_list",
-                                      "argument",
-                                      "executable",
-                                      "io_modifier_list",
-                                      "io_modifier",
-                                      YY_NULLPTR};
-
-static const char *yysymbol_name(yysymbol_kind_t yysymbol) {
+static const char *const yytname[] =
+{
+  "\"end of file\"", "error", "\"invalid token\"", "WORD", "QUOTED_WORD",
+  "PIPE", "NOTOKEN", "NEWLINE", "STDOUT", "STDIN", "STDERR", "BOTH",
+  "APPEND", "APPENDBOTH", "AMPERSAND", "SEMI", "DSEMI", "AND_IF", "OR_IF",
+  "RPAREN", "IF", "THEN", "ELSE", "ELIF", "FI", "WHILE", "UNTIL", "DO",
+  "DONE", "FOR", "IN", "CASE", "ESAC", "COND_START", "COND_END", "$accept",
+  "goal", "entire_command_list", "entire_command", "complete_command",
+  "list", "and_or", "pipeline", "compound_command", "compound_list",
+  "term", "if_clause", "else_part", "while_clause", "until_clause",
+  "for_clause", "word_list", "cond_command", "do_group", "case_clause",
+  "case_word", "case_list_ns", "case_list", "case_item_ns", "case_item",
+  "pattern", "separator_op", "separator", "sequential_sep", "linebreak",
+  "newline_list", "single_command_list", "single_command", "argument_list",
+  "argument", "executable", "io_modifier_list", "io_modifier", YY_NULLPTR
+};
+
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
+{
   return yytname[yysymbol];
 }
 #endif
 
-#define YYPACT_NINF (-8)
+#define YYPACT_NINF (-49)
 
-#define yypact_value_is_default(Yyn) ((Yyn) == YYPACT_NINF)
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
 
-#define YYTABLE_NINF (-1)
+#define YYTABLE_NINF (-3)
 
-#define yytable_value_is_error(Yyn) 0
+#define yytable_value_is_error(Yyn) \
+  0
 
 /* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
    STATE-NUM.  */
-static const yytype_int8 yypact[] = {
-    5,  -8, -8, -8, 14, 5,  -8, 12, -8, -8, -8, -8, 6,  -7, 10, -8, -8,
-    15, 16, 17, 18, 19, 20, -8, -8, -8, -8, -8, -8, -8, -8, -8, -8, -8};
+static const yytype_int16 yypact[] =
+{
+      42,    -1,   -49,   -49,   -49,    18,    18,    18,    25,    11,
+      20,    30,     9,   -49,    32,    55,    39,   -49,   -49,   -49,
+     -49,   -49,   -49,   -49,   -49,    27,   -49,   -49,   -49,   -49,
+      45,    92,    34,    10,    10,    18,   -49,   -49,    18,   -49,
+     -49,    16,   -49,   -49,   -49,   -49,   -49,    92,    18,    18,
+     107,   118,   111,    18,    39,    69,   -49,    18,   -49,   -49,
+      14,    33,   -49,   -49,   -49,    39,    92,    92,   -49,    75,
+      77,    79,    82,    88,    90,   -49,   -49,   -49,   -49,    37,
+      18,    92,    34,    72,    94,    18,   -49,   -49,   -49,   -49,
+     -49,   -49,   -49,   -49,    18,    18,   -49,    24,   -49,    39,
+     -49,    18,   101,    10,    34,     1,   -49,    98,   -49,   -49,
+      10,   -49,   -49,   -49,    71,    23,   -49,   -49,    12,    18,
+     -49,   -49,   -49,   -49,   -49,   129,    18,   112,   -49,   -49,
+     106,    61,   -49,    18,    18,   -49,   -49
+};
 
 /* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
    Performed when YYTABLE does not specify something else to do.  Zero
    means the default is an error.  */
-static const yytype_int8 yydefact[] = {
-    0, 14, 15, 6, 0, 2, 4,  17, 8,  11, 1,  3,  0,  0,  9,  7,  5,
-    0, 0,  0,  0, 0, 0, 24, 16, 12, 13, 10, 18, 19, 20, 21, 22, 23};
+static const yytype_int8 yydefact[] =
+{
+       0,     0,    75,    76,     6,    65,    65,    65,     0,     0,
+       0,     0,     0,     4,     0,     8,    11,    12,    16,    17,
+      18,    19,    20,    22,    21,    78,    69,    72,     7,    67,
+       0,     0,    64,     0,     0,    65,    45,    46,    65,    38,
+      39,     0,     1,     3,     5,    58,    59,     9,    65,    65,
+       0,    15,    70,    65,    26,    23,    66,    65,    32,    33,
+       0,     0,    36,    37,    40,    10,     0,     0,    68,     0,
+       0,     0,     0,     0,     0,    77,    73,    74,    71,     0,
+      65,    24,    61,     0,     0,    65,    13,    14,    79,    80,
+      81,    82,    83,    84,    65,    65,    28,     0,    60,    25,
+      41,    65,     0,     0,    63,     0,    31,     0,    27,    62,
+       0,    35,    44,    55,     0,     0,    48,    50,     0,    65,
+      34,    43,    42,    47,    49,     0,    65,    29,    56,    57,
+      52,    51,    30,    65,    65,    54,    53
+};
 
 /* YYPGOTO[NTERM-NUM].  */
-static const yytype_int8 yypgoto[] = {-8, -8, -8, 21, -8, 13,
-                                      -8, -8, -8, -8, -8};
+static const yytype_int16 yypgoto[] =
+{
+     -49,   -49,   -49,   126,   -49,   -49,   -29,    70,   -49,    -6,
+     -49,   -49,    -3,   -49,   -49,   -49,    56,   -49,   -31,   -49,
+     130,   -49,   -49,    26,    28,   -49,    87,   -49,    43,   -27,
+     -48,   -49,    96,   -49,   -49,   -49,   -49,   -49
+};
 
 /* YYDEFGOTO[NTERM-NUM].  */
-static const yytype_int8 yydefgoto[] = {0, 4, 5, 6, 7, 8, 14, 27, 9, 13, 24};
+static const yytype_int8 yydefgoto[] =
+{
+       0,    11,    12,    13,    14,    15,    16,    17,    18,    30,
+      55,    19,    97,    20,    21,    22,    41,    23,    58,    24,
+     113,   114,   115,   116,   117,   118,    47,    81,   103,    31,
+      32,    25,    26,    52,    78,    27,    51,    75
+};
 
 /* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
    positive, shift that token.  If negative, reduce the rule whose
    number is the opposite.  If YYTABLE_NINF, syntax error.  */
-static const yytype_int8 yytable[] = {16, 17, 18, 19, 20, 21, 22, 23, 1,
-                                      1,  2,  2,  3,  25, 10, 26, 12, 0,
-                                      28, 29, 30, 31, 32, 33, 0,  15, 11};
+static const yytype_int16 yytable[] =
+{
+      33,    34,    54,    59,    36,    37,    28,    82,    60,    -2,
+       1,    61,     2,     3,    36,    37,     4,   125,    65,    62,
+      63,    66,    67,    39,    40,    29,    36,    37,    35,     5,
+      42,   126,    50,   112,     6,     7,   104,    57,     8,    44,
+       9,    56,    10,     1,    84,     2,     3,    79,   108,     4,
+      64,    83,    99,    98,   104,   122,    48,    49,   105,    94,
+      95,    96,     5,    85,     2,     3,    53,     6,     7,    45,
+      46,     8,   111,     9,   109,    10,    29,   134,    88,   120,
+      89,     5,    90,    45,    46,    91,     6,     7,   106,   107,
+       8,    92,     9,    93,    10,     2,     3,    39,    40,   131,
+     100,    29,    54,   121,    62,    63,   135,   136,    29,   101,
+       2,     3,     5,   127,    76,    77,   101,     6,     7,   119,
+     130,     8,   133,     9,   132,    10,    69,    70,    71,    72,
+      73,    74,   128,   129,    94,    95,    86,    87,    43,    38,
+     102,   123,    80,   124,     0,   110,    68
+};
 
-static const yytype_int8 yycheck[] = {7, 8, 9, 10, 11, 12, 13, 14, 3,
-                                      3, 5, 5, 7,  3,  0,  5,  4,  -1,
-                                      3, 3, 3, 3,  3,  3,  -1, 12, 5};
+static const yytype_int16 yycheck[] =
+{
+       6,     7,    31,    34,     3,     4,     7,    55,    35,     0,
+       1,    38,     3,     4,     3,     4,     7,     5,    47,     3,
+       4,    48,    49,     3,     4,     7,     3,     4,     3,    20,
+       0,    19,     5,    32,    25,    26,    84,    27,    29,     7,
+      31,     7,    33,     1,    30,     3,     4,    53,    24,     7,
+      34,    57,    81,    80,   102,    32,    17,    18,    85,    22,
+      23,    24,    20,    30,     3,     4,    21,    25,    26,    14,
+      15,    29,   103,    31,   101,    33,     7,    16,     3,   110,
+       3,    20,     3,    14,    15,     3,    25,    26,    94,    95,
+      29,     3,    31,     3,    33,     3,     4,     3,     4,   126,
+      28,     7,   131,    32,     3,     4,   133,   134,     7,    15,
+       3,     4,    20,   119,     3,     4,    15,    25,    26,    21,
+     126,    29,    16,    31,   127,    33,     8,     9,    10,    11,
+      12,    13,     3,     4,    22,    23,    66,    67,    12,     9,
+      84,   115,    55,   115,    -1,   102,    50
+};
 
 /* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
    state STATE-NUM.  */
-static const yytype_int8 yystos[] = {
-    0, 3, 5,  7,  16, 17, 18, 19, 20, 23, 0,  18, 4, 24, 21, 20, 7,
-    8, 9, 10, 11, 12, 13, 14, 25, 3,  5,  22, 3,  3, 3,  3,  3,  3};
+static const yytype_int8 yystos[] =
+{
+       0,     1,     3,     4,     7,    20,    25,    26,    29,    31,
+      33,    36,    37,    38,    39,    40,    41,    42,    43,    46,
+      48,    49,    50,    52,    54,    66,    67,    70,     7,     7,
+      44,    64,    65,    44,    44,     3,     3,     4,    55,     3,
+       4,    51,     0,    38,     7,    14,    15,    61,    17,    18,
+       5,    71,    68,    21,    41,    45,     7,    27,    53,    53,
+      64,    64,     3,     4,    34,    41,    64,    64,    67,     8,
+       9,    10,    11,    12,    13,    72,     3,     4,    69,    44,
+      61,    62,    65,    44,    30,    30,    42,    42,     3,     3,
+       3,     3,     3,     3,    22,    23,    24,    47,    64,    41,
+      28,    15,    51,    63,    65,    64,    44,    44,    24,    64,
+      63,    53,    32,    55,    56,    57,    58,    59,    60,    21,
+      53,    32,    32,    58,    59,     5,    19,    44,     3,     4,
+      44,    64,    47,    16,    16,    64,    64
+};
 
 /* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
-static const yytype_int8 yyr1[] = {0,  15, 16, 17, 17, 18, 18, 19, 19,
-                                   20, 21, 21, 22, 22, 23, 23, 24, 24,
-                                   25, 25, 25, 25, 25, 25, 25};
+static const yytype_int8 yyr1[] =
+{
+       0,    35,    36,    37,    37,    38,    38,    38,    39,    39,
+      40,    40,    41,    41,    41,    42,    42,    43,    43,    43,
+      43,    43,    43,    44,    44,    45,    45,    46,    46,    47,
+      47,    47,    48,    49,    50,    50,    51,    51,    51,    51,
+      52,    53,    54,    54,    54,    55,    55,    56,    56,    57,
+      57,    58,    58,    59,    59,    60,    60,    60,    61,    61,
+      62,    62,    63,    63,    64,    64,    65,    65,    66,    66,
+      67,    68,    68,    69,    69,    70,    70,    71,    71,    72,
+      72,    72,    72,    72,    72
+};
+
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
+{
+       0,     2,     1,     2,     1,     2,     1,     2,     1,     2,
+       3,     1,     1,     4,     4,     2,     1,     1,     1,     1,
+       1,     1,     1,     2,     3,     3,     1,     6,     5,     4,
+       5,     2,     3,     3,     7,     6,     2,     2,     1,     1,
+       3,     3,     7,     7,     6,     1,     1,     2,     1,     2,
+       1,     3,     3,     5,     5,     1,     3,     3,     1,     1,
+       2,     1,     2,     1,     1,     0,     2,     1,     3,     1,
+       2,     2,     0,     1,     1,     1,     1,     2,     0,     2,
+       2,     2,     2,     2,     2
+};
 
-/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.
- */
-static const yytype_int8 yyr2[] = {0, 2, 1, 2, 1, 3, 1, 3, 1, 2, 2, 0, 1,
-                                   1, 1, 1, 2, 0, 2, 2, 2, 2, 2, 2, 1};
 
 enum { YYENOMEM = -2 };
 
-#define yyerrok (yyerrstatus = 0)
-#define yyclearin (yychar = YYEMPTY)
-
-#define YYACCEPT goto yyacceptlab
-#define YYABORT goto yyabortlab
-#define YYERROR goto yyerrorlab
-#define YYNOMEM goto yyexhaustedlab
-
-#define YYRECOVERING() (!!yyerrstatus)
-
-#define YYBACKUP(Token, Value)                                                 \
-  do                                                                           \
-    if (yychar == YYEMPTY) {                                                   \
-      yychar = (Token);                                                        \
-      yylval = (Value);                                                        \
-      YYPOPSTACK(yylen);                                                       \
-      yystate = *yyssp;                                                        \
-      goto yybackup;                                                           \
-    } else {                                                                   \
-      yyerror(YY_("syntax error: cannot back up"));                            \
-      YYERROR;                                                                 \
-    }                                                                          \
+#define yyerrok         (yyerrstatus = 0)
+#define yyclearin       (yychar = YYEMPTY)
+
+#define YYACCEPT        goto yyacceptlab
+#define YYABORT         goto yyabortlab
+#define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
+
+
+#define YYRECOVERING()  (!!yyerrstatus)
+
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
   while (0)
 
 /* Backward compatibility with an undocumented macro.
    Use YYerror or YYUNDEF. */
 #define YYERRCODE YYUNDEF
 
+
 /* Enable debugging if requested.  */
 #if YYDEBUG
 
-#ifndef YYFPRINTF
-#include <stdio.h> /* INFRINGES ON USER NAME SPACE */
-#define YYFPRINTF fprintf
-#endif
+# ifndef YYFPRINTF
+#  include <stdio.h> /* INFRINGES ON USER NAME SPACE */
+#  define YYFPRINTF fprintf
+# endif
+
+# define YYDPRINTF(Args)                        \
+do {                                            \
+  if (yydebug)                                  \
+    YYFPRINTF Args;                             \
+} while (0)
+
+
+
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
+do {                                                                      \
+  if (yydebug)                                                            \
+    {                                                                     \
+      YYFPRINTF (stderr, "%s ", Title);                                   \
+      yy_symbol_print (stderr,                                            \
+                  Kind, Value); \
+      YYFPRINTF (stderr, "\n");                                           \
+    }                                                                     \
+} while (0)
 
-#define YYDPRINTF(Args)                                                        \
-  do {                                                                         \
-    if (yydebug)                                                               \
-      YYFPRINTF Args;                                                          \
-  } while (0)
-
-#define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                          \
-  do {                                                                         \
-    if (yydebug) {                                                             \
-      YYFPRINTF(stderr, "%s ", Title);                                         \
-      yy_symbol_print(stderr, Kind, Value);                                    \
-      YYFPRINTF(stderr, "\n");                                                 \
-    }                                                                          \
-  } while (0)
 
 /*-----------------------------------.
 | Print this symbol's value on YYO.  |
 `-----------------------------------*/
 
-static void yy_symbol_value_print(FILE *yyo, yysymbol_kind_t yykind,
-                                  YYSTYPE const *const yyvaluep) {
+static void
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
+{
   FILE *yyoutput = yyo;
-  YY_USE(yyoutput);
+  YY_USE (yyoutput);
   if (!yyvaluep)
     return;
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
-  YY_USE(yykind);
+  YY_USE (yykind);
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
+
 /*---------------------------.
 | Print this symbol on YYO.  |
 `---------------------------*/
 
-static void yy_symbol_print(FILE *yyo, yysymbol_kind_t yykind,
-                            YYSTYPE const *const yyvaluep) {
-  YYFPRINTF(yyo, "%s %s (", yykind < YYNTOKENS ? "token" : "nterm",
-            yysymbol_name(yykind));
+static void
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
+{
+  YYFPRINTF (yyo, "%s %s (",
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
 
-  yy_symbol_value_print(yyo, yykind, yyvaluep);
-  YYFPRINTF(yyo, ")");
+  yy_symbol_value_print (yyo, yykind, yyvaluep);
+  YYFPRINTF (yyo, ")");
 }
 
 /*------------------------------------------------------------------.
@@ -751,59 +1016,69 @@ static void yy_symbol_print(FILE *yyo, yysymbol_kind_t yykind,
 | TOP (included).                                                   |
 `------------------------------------------------------------------*/
 
-static void yy_stack_print(yy_state_t *yybottom, yy_state_t *yytop) {
-  YYFPRINTF(stderr, "Stack now");
-  for (; yybottom <= yytop; yybottom++) {
-    int yybot = *yybottom;
-    YYFPRINTF(stderr, " %d", yybot);
-  }
-  YYFPRINTF(stderr, "\n");
+static void
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
+{
+  YYFPRINTF (stderr, "Stack now");
+  for (; yybottom <= yytop; yybottom++)
+    {
+      int yybot = *yybottom;
+      YYFPRINTF (stderr, " %d", yybot);
+    }
+  YYFPRINTF (stderr, "\n");
 }
 
-#define YY_STACK_PRINT(Bottom, Top)                                            \
-  do {                                                                         \
-    if (yydebug)                                                               \
-      yy_stack_print((Bottom), (Top));                                         \
-  } while (0)
+# define YY_STACK_PRINT(Bottom, Top)                            \
+do {                                                            \
+  if (yydebug)                                                  \
+    yy_stack_print ((Bottom), (Top));                           \
+} while (0)
+
 
 /*------------------------------------------------.
 | Report that the YYRULE is going to be reduced.  |
 `------------------------------------------------*/
 
-static void yy_reduce_print(yy_state_t *yyssp, YYSTYPE *yyvsp, int yyrule) {
+static void
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
+                 int yyrule)
+{
   int yylno = yyrline[yyrule];
   int yynrhs = yyr2[yyrule];
   int yyi;
-  YYFPRINTF(stderr, "Reducing stack by rule %d (line %d):\n", yyrule - 1,
-            yylno);
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
+             yyrule - 1, yylno);
   /* The symbols being reduced.  */
-  for (yyi = 0; yyi < yynrhs; yyi++) {
-    YYFPRINTF(stderr, "   $%d = ", yyi + 1);
-    yy_symbol_print(stderr, YY_ACCESSING_SYMBOL(+yyssp[yyi + 1 - yynrhs]),
-                    &yyvsp[(yyi + 1) - (yynrhs)]);
-    YYFPRINTF(stderr, "\n");
-  }
+  for (yyi = 0; yyi < yynrhs; yyi++)
+    {
+      YYFPRINTF (stderr, "   $%d = ", yyi + 1);
+      yy_symbol_print (stderr,
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)]);
+      YYFPRINTF (stderr, "\n");
+    }
 }
 
-#define YY_REDUCE_PRINT(Rule)                                                  \
-  do {                                                                         \
-    if (yydebug)                                                               \
-      yy_reduce_print(yyssp, yyvsp, Rule);                                     \
-  } while (0)
+# define YY_REDUCE_PRINT(Rule)          \
+do {                                    \
+  if (yydebug)                          \
+    yy_reduce_print (yyssp, yyvsp, Rule); \
+} while (0)
 
 /* Nonzero means print parse trace.  It is left uninitialized so that
    multiple parsers can coexist.  */
 int yydebug;
 #else /* !YYDEBUG */
-#define YYDPRINTF(Args) ((void)0)
-#define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
-#define YY_STACK_PRINT(Bottom, Top)
-#define YY_REDUCE_PRINT(Rule)
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
+# define YY_STACK_PRINT(Bottom, Top)
+# define YY_REDUCE_PRINT(Rule)
 #endif /* !YYDEBUG */
 
+
 /* YYINITDEPTH -- initial size of the parser's stacks.  */
 #ifndef YYINITDEPTH
-#define YYINITDEPTH 200
+# define YYINITDEPTH 200
 #endif
 
 /* YYMAXDEPTH -- maximum size the stacks can grow to (effective only
@@ -814,25 +1089,169 @@ int yydebug;
    evaluated with infinite-precision integer arithmetic.  */
 
 #ifndef YYMAXDEPTH
-#define YYMAXDEPTH 10000
+# define YYMAXDEPTH 10000
 #endif
 
+
+
+
+
+
 /*-----------------------------------------------.
 | Release the memory associated to this symbol.  |
 `-----------------------------------------------*/
 
-static void yydestruct(const char *yymsg, yysymbol_kind_t yykind,
-                       YYSTYPE *yyvaluep) {
-  YY_USE(yyvaluep);
+static void
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep)
+{
+  YY_USE (yyvaluep);
   if (!yymsg)
     yymsg = "Deleting";
-  YY_SYMBOL_PRINT(yymsg, yykind, yyvaluep, yylocationp);
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
 
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
-  YY_USE(yykind);
+  switch (yykind)
+    {
+    case YYSYMBOL_complete_command: /* complete_command  */
+#line 33 "shell.y"
+            { free_node(((*yyvaluep).node)); }
+#line 1120 "y.tab.c"
+        break;
+
+    case YYSYMBOL_list: /* list  */
+#line 33 "shell.y"
+            { free_node(((*yyvaluep).node)); }
+#line 1126 "y.tab.c"
+        break;
+
+    case YYSYMBOL_and_or: /* and_or  */
+#line 33 "shell.y"
+            { free_node(((*yyvaluep).node)); }
+#line 1132 "y.tab.c"
+        break;
+
+    case YYSYMBOL_pipeline: /* pipeline  */
+#line 33 "shell.y"
+            { free_node(((*yyvaluep).node)); }
+#line 1138 "y.tab.c"
+        break;
+
+    case YYSYMBOL_compound_command: /* compound_command  */
+#line 33 "shell.y"
+            { free_node(((*yyvaluep).node)); }
+#line 1144 "y.tab.c"
+        break;
+
+    case YYSYMBOL_compound_list: /* compound_list  */
+#line 33 "shell.y"
+            { free_node(((*yyvaluep).node)); }
+#line 1150 "y.tab.c"
+        break;
+
+    case YYSYMBOL_term: /* term  */
+#line 33 "shell.y"
+            { free_node(((*yyvaluep).node)); }
+#line 1156 "y.tab.c"
+        break;
+
+    case YYSYMBOL_if_clause: /* if_clause  */
+#line 33 "shell.y"
+            { free_node(((*yyvaluep).node)); }
+#line 1162 "y.tab.c"
+        break;
+
+    case YYSYMBOL_else_part: /* else_part  */
+#line 33 "shell.y"
+            { free_node(((*yyvaluep).node)); }
+#line 1168 "y.tab.c"
+        break;
+
+    case YYSYMBOL_while_clause: /* while_clause  */
+#line 33 "shell.y"
+            { free_node(((*yyvaluep).node)); }
+#line 1174 "y.tab.c"
+        break;
+
+    case YYSYMBOL_until_clause: /* until_clause  */
+#line 33 "shell.y"
+            { free_node(((*yyvaluep).node)); }
+#line 1180 "y.tab.c"
+        break;
+
+    case YYSYMBOL_for_clause: /* for_clause  */
+#line 33 "shell.y"
+            { free_node(((*yyvaluep).node)); }
+#line 1186 "y.tab.c"
+        break;
+
+    case YYSYMBOL_word_list: /* word_list  */
+#line 34 "shell.y"
+            { free_single_command(((*yyvaluep).words)); }
+#line 1192 "y.tab.c"
+        break;
+
+    case YYSYMBOL_cond_command: /* cond_command  */
+#line 33 "shell.y"
+            { free_node(((*yyvaluep).node)); }
+#line 1198 "y.tab.c"
+        break;
+
+    case YYSYMBOL_do_group: /* do_group  */
+#line 33 "shell.y"
+            { free_node(((*yyvaluep).node)); }
+#line 1204 "y.tab.c"
+        break;
+
+    case YYSYMBOL_case_clause: /* case_clause  */
+#line 33 "shell.y"
+            { free_node(((*yyvaluep).node)); }
+#line 1210 "y.tab.c"
+        break;
+
+    case YYSYMBOL_case_word: /* case_word  */
+#line 34 "shell.y"
+            { free_single_command(((*yyvaluep).words)); }
+#line 1216 "y.tab.c"
+        break;
+
+    case YYSYMBOL_case_list_ns: /* case_list_ns  */
+#line 33 "shell.y"
+            { free_node(((*yyvaluep).node)); }
+#line 1222 "y.tab.c"
+        break;
+
+    case YYSYMBOL_case_list: /* case_list  */
+#line 33 "shell.y"
+            { free_node(((*yyvaluep).node)); }
+#line 1228 "y.tab.c"
+        break;
+
+    case YYSYMBOL_case_item_ns: /* case_item_ns  */
+#line 33 "shell.y"
+            { free_node(((*yyvaluep).node)); }
+#line 1234 "y.tab.c"
+        break;
+
+    case YYSYMBOL_case_item: /* case_item  */
+#line 33 "shell.y"
+            { free_node(((*yyvaluep).node)); }
+#line 1240 "y.tab.c"
+        break;
+
+    case YYSYMBOL_pattern: /* pattern  */
+#line 34 "shell.y"
+            { free_single_command(((*yyvaluep).words)); }
+#line 1246 "y.tab.c"
+        break;
+
+      default:
+        break;
+    }
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
+
 /* Lookahead token kind.  */
 int yychar;
 
@@ -841,30 +1260,35 @@ YYSTYPE yylval;
 /* Number of syntax errors so far.  */
 int yynerrs;
 
+
+
+
 /*----------.
 | yyparse.  |
 `----------*/
 
-int yyparse(void) {
-  yy_state_fast_t yystate = 0;
-  /* Number of tokens to shift before error messages enabled.  */
-  int yyerrstatus = 0;
+int
+yyparse (void)
+{
+    yy_state_fast_t yystate = 0;
+    /* Number of tokens to shift before error messages enabled.  */
+    int yyerrstatus = 0;
 
-  /* Refer to the stacks through separate pointers, to allow yyoverflow
-     to reallocate them elsewhere.  */
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
+       to reallocate them elsewhere.  */
 
-  /* Their size.  */
-  YYPTRDIFF_T yystacksize = YYINITDEPTH;
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
 
-  /* The state stack: array, bottom, top.  */
-  yy_state_t yyssa[YYINITDEPTH];
-  yy_state_t *yyss = yyssa;
-  yy_state_t *yyssp = yyss;
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
 
-  /* The semantic value stack: array, bottom, top.  */
-  YYSTYPE yyvsa[YYINITDEPTH];
-  YYSTYPE *yyvs = yyvsa;
-  YYSTYPE *yyvsp = yyvs;
+    /* The semantic value stack: array, bottom, top.  */
+    YYSTYPE yyvsa[YYINITDEPTH];
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
 
   int yyn;
   /* The return value of yyparse.  */
@@ -875,18 +1299,21 @@ int yyparse(void) {
      action routines.  */
   YYSTYPE yyval;
 
-#define YYPOPSTACK(N) (yyvsp -= (N), yyssp -= (N))
+
+
+#define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))
 
   /* The number of symbols on the RHS of the reduced rule.
      Keep to zero when no symbol should be popped.  */
   int yylen = 0;
 
-  YYDPRINTF((stderr, "Starting parse\n"));
+  YYDPRINTF ((stderr, "Starting parse\n"));
 
   yychar = YYEMPTY; /* Cause a token to be read.  */
 
   goto yysetstate;
 
+
 /*------------------------------------------------------------.
 | yynewstate -- push a new state, which is found in yystate.  |
 `------------------------------------------------------------*/
@@ -895,83 +1322,88 @@ yynewstate:
      have just been pushed.  So pushing a state here evens the stacks.  */
   yyssp++;
 
+
 /*--------------------------------------------------------------------.
 | yysetstate -- set current state (the top of the stack) to yystate.  |
 `--------------------------------------------------------------------*/
 yysetstate:
-  YYDPRINTF((stderr, "Entering state %d\n", yystate));
-  YY_ASSERT(0 <= yystate && yystate < YYNSTATES);
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
   YY_IGNORE_USELESS_CAST_BEGIN
-  *yyssp = YY_CAST(yy_state_t, yystate);
+  *yyssp = YY_CAST (yy_state_t, yystate);
   YY_IGNORE_USELESS_CAST_END
-  YY_STACK_PRINT(yyss, yyssp);
+  YY_STACK_PRINT (yyss, yyssp);
 
   if (yyss + yystacksize - 1 <= yyssp)
 #if !defined yyoverflow && !defined YYSTACK_RELOCATE
     YYNOMEM;
 #else
-  {
-    /* Get the current used size of the three stacks, in elements.  */
-    YYPTRDIFF_T yysize = yyssp - yyss + 1;
-
-#if defined yyoverflow
-    {
-      /* Give user a chance to reallocate the stack.  Use copies of
-         these so that the &'s don't force the real ones into
-         memory.  */
-      yy_state_t *yyss1 = yyss;
-      YYSTYPE *yyvs1 = yyvs;
-
-      /* Each stack pointer address is followed by the size of the
-         data in use in that stack, in bytes.  This used to be a
-         conditional around just the two extra args, but that might
-         be undefined if yyoverflow is a macro.  */
-      yyoverflow(YY_("memory exhausted"), &yyss1, yysize * YYSIZEOF(*yyssp),
-                 &yyvs1, yysize * YYSIZEOF(*yyvsp), &yystacksize);
-      yyss = yyss1;
-      yyvs = yyvs1;
-    }
-#else /* defined YYSTACK_RELOCATE */
-    /* Extend the stack our own way.  */
-    if (YYMAXDEPTH <= yystacksize)
-      YYNOMEM;
-    yystacksize *= 2;
-    if (YYMAXDEPTH < yystacksize)
-      yystacksize = YYMAXDEPTH;
-
     {
-      yy_state_t *yyss1 = yyss;
-      union yyalloc *yyptr =
-          YY_CAST(union yyalloc *,
-                  YYSTACK_ALLOC(YY_CAST(YYSIZE_T, YYSTACK_BYTES(yystacksize))));
-      if (!yyptr)
+      /* Get the current used size of the three stacks, in elements.  */
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
+
+# if defined yyoverflow
+      {
+        /* Give user a chance to reallocate the stack.  Use copies of
+           these so that the &'s don't force the real ones into
+           memory.  */
+        yy_state_t *yyss1 = yyss;
+        YYSTYPE *yyvs1 = yyvs;
+
+        /* Each stack pointer address is followed by the size of the
+           data in use in that stack, in bytes.  This used to be a
+           conditional around just the two extra args, but that might
+           be undefined if yyoverflow is a macro.  */
+        yyoverflow (YY_("memory exhausted"),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
+                    &yystacksize);
+        yyss = yyss1;
+        yyvs = yyvs1;
+      }
+# else /* defined YYSTACK_RELOCATE */
+      /* Extend the stack our own way.  */
+      if (YYMAXDEPTH <= yystacksize)
         YYNOMEM;
-      YYSTACK_RELOCATE(yyss_alloc, yyss);
-      YYSTACK_RELOCATE(yyvs_alloc, yyvs);
-#undef YYSTACK_RELOCATE
-      if (yyss1 != yyssa)
-        YYSTACK_FREE(yyss1);
-    }
-#endif
+      yystacksize *= 2;
+      if (YYMAXDEPTH < yystacksize)
+        yystacksize = YYMAXDEPTH;
+
+      {
+        yy_state_t *yyss1 = yyss;
+        union yyalloc *yyptr =
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
+        if (! yyptr)
+          YYNOMEM;
+        YYSTACK_RELOCATE (yyss_alloc, yyss);
+        YYSTACK_RELOCATE (yyvs_alloc, yyvs);
+#  undef YYSTACK_RELOCATE
+        if (yyss1 != yyssa)
+          YYSTACK_FREE (yyss1);
+      }
+# endif
 
-    yyssp = yyss + yysize - 1;
-    yyvsp = yyvs + yysize - 1;
+      yyssp = yyss + yysize - 1;
+      yyvsp = yyvs + yysize - 1;
 
-    YY_IGNORE_USELESS_CAST_BEGIN
-    YYDPRINTF(
-        (stderr, "Stack size increased to %ld\n", YY_CAST(long, yystacksize)));
-    YY_IGNORE_USELESS_CAST_END
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
 
-    if (yyss + yystacksize - 1 <= yyssp)
-      YYABORT;
-  }
+      if (yyss + yystacksize - 1 <= yyssp)
+        YYABORT;
+    }
 #endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
 
+
   if (yystate == YYFINAL)
     YYACCEPT;
 
   goto yybackup;
 
+
 /*-----------.
 | yybackup.  |
 `-----------*/
@@ -981,33 +1413,39 @@ yybackup:
 
   /* First try to decide what to do without reference to lookahead token.  */
   yyn = yypact[yystate];
-  if (yypact_value_is_default(yyn))
+  if (yypact_value_is_default (yyn))
     goto yydefault;
 
   /* Not known => get a lookahead token if don't already have one.  */
 
   /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
-  if (yychar == YYEMPTY) {
-    YYDPRINTF((stderr, "Reading a token\n"));
-    yychar = yylex();
-  }
+  if (yychar == YYEMPTY)
+    {
+      YYDPRINTF ((stderr, "Reading a token\n"));
+      yychar = yylex ();
+    }
 
-  if (yychar <= YYEOF) {
-    yychar = YYEOF;
-    yytoken = YYSYMBOL_YYEOF;
-    YYDPRINTF((stderr, "Now at end of input.\n"));
-  } else if (yychar == YYerror) {
-    /* The scanner already issued an error message, process directly
-       to error recovery.  But do not keep the error token as
-       lookahead, it is too special and may lead us to an endless
-       loop in error recovery. */
-    yychar = YYUNDEF;
-    yytoken = YYSYMBOL_YYerror;
-    goto yyerrlab1;
-  } else {
-    yytoken = YYTRANSLATE(yychar);
-    YY_SYMBOL_PRINT("Next token is", yytoken, &yylval, &yylloc);
-  }
+  if (yychar <= YYEOF)
+    {
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
+      YYDPRINTF ((stderr, "Now at end of input.\n"));
+    }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      goto yyerrlab1;
+    }
+  else
+    {
+      yytoken = YYTRANSLATE (yychar);
+      YY_SYMBOL_PRINT ("Next token is", yytoken, &yylval, &yylloc);
+    }
 
   /* If the proper action on seeing token YYTOKEN is to reduce or to
      detect an error, take that action.  */
@@ -1015,12 +1453,13 @@ yybackup:
   if (yyn < 0 || YYLAST < yyn || yycheck[yyn] != yytoken)
     goto yydefault;
   yyn = yytable[yyn];
-  if (yyn <= 0) {
-    if (yytable_value_is_error(yyn))
-      goto yyerrlab;
-    yyn = -yyn;
-    goto yyreduce;
-  }
+  if (yyn <= 0)
+    {
+      if (yytable_value_is_error (yyn))
+        goto yyerrlab;
+      yyn = -yyn;
+      goto yyreduce;
+    }
 
   /* Count tokens shifted since error; after three, turn off error
      status.  */
@@ -1028,7 +1467,7 @@ yybackup:
     yyerrstatus--;
 
   /* Shift the lookahead token.  */
-  YY_SYMBOL_PRINT("Shifting", yytoken, &yylval, &yylloc);
+  YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
   yystate = yyn;
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
   *++yyvsp = yylval;
@@ -1038,6 +1477,7 @@ yybackup:
   yychar = YYEMPTY;
   goto yynewstate;
 
+
 /*-----------------------------------------------------------.
 | yydefault -- do the default action for the current state.  |
 `-----------------------------------------------------------*/
@@ -1047,6 +1487,7 @@ yydefault:
     goto yyerrlab;
   goto yyreduce;
 
+
 /*-----------------------------.
 | yyreduce -- do a reduction.  |
 `-----------------------------*/
@@ -1062,247 +1503,583 @@ yyreduce:
      users should not rely upon it.  Assigning to YYVAL
      unconditionally makes the parser a bit smaller, and it avoids a
      GCC warning that YYVAL may be used uninitialized.  */
-  yyval = yyvsp[1 - yylen];
+  yyval = yyvsp[1-yylen];
 
-  YY_REDUCE_PRINT(yyn);
-  switch (yyn) {
-  case 5: /* entire_command: single_command_list io_modifier_list NEWLINE  */
-#line 57 "shell.y"
-  {
-    execute_command(g_current_command);
 
-    if (g_last_arg != NULL) {
-      free(g_last_arg);
-      g_last_arg = NULL;
-    }
+  YY_REDUCE_PRINT (yyn);
+  switch (yyn)
+    {
+  case 5: /* entire_command: complete_command NEWLINE  */
+#line 75 "shell.y"
+                               {
+        execute_node((yyvsp[-1].node));
+        free_node((yyvsp[-1].node));
+
+        // the words of the line are not needed anymore
+        arena_release(&g_line_arena, g_line_mark);
+
+        // print prompt again if isatty()
+        if ((isatty(STDIN_FILENO)) && (g_prompt_printed == false)) {
+          print_prompt();
+        }
+        else {
+          g_prompt_printed = false;
+        }
+      }
+#line 1530 "y.tab.c"
+    break;
 
-    if (g_current_command->num_single_commands != 0) {
-      single_command_t *last_single_command =
-          g_current_command
-              ->single_commands[g_current_command->num_single_commands - 1];
-      g_last_arg =
-          last_single_command->arguments[last_single_command->num_args - 1];
-      g_last_arg = strdup(g_last_arg);
-    }
+  case 6: /* entire_command: NEWLINE  */
+#line 90 "shell.y"
+              {
+        arena_release(&g_line_arena, g_line_mark);
+
+        // print prompt again if isatty()?
+        if (isatty(STDIN_FILENO)) {
+          print_prompt();
+        }
+      }
+#line 1543 "y.tab.c"
+    break;
 
-    // free g_current_command and g_current_single_command
-    free_command(g_current_command);
-    g_current_command = NULL;
-    // need to free this as after every single command
-    // i malloc for the next, so after the last one
-    // g_sing_cmd will be malloced
-    free_single_command(g_current_single_command);
-    g_current_single_command = NULL;
-    // allocate and run the create() functions for
-    // them again to prepare for the next command
-    g_current_command = (command_t *)malloc(sizeof(command_t));
-
-    if (g_current_command == NULL) {
-      perror("malloc");
-      exit(1);
-    }
+  case 7: /* entire_command: error NEWLINE  */
+#line 98 "shell.y"
+                    {
+        // throw away the rest of the line and start over
+        yyerrok;
+        reset_lex_state();
+        reset_shell();
+        arena_release(&g_line_arena, g_line_mark);
+      }
+#line 1555 "y.tab.c"
+    break;
 
-    g_current_single_command =
-        (single_command_t *)malloc(sizeof(single_command_t));
+  case 9: /* complete_command: list separator_op  */
+#line 109 "shell.y"
+                        {
+        if ((yyvsp[0].number)) {
+          set_node_background((yyvsp[-1].node));
+        }
+        (yyval.node) = (yyvsp[-1].node);
+      }
+#line 1566 "y.tab.c"
+    break;
 
-    if (g_current_single_command == NULL) {
-      perror("malloc");
-      exit(1);
-    }
+  case 10: /* list: list separator_op and_or  */
+#line 118 "shell.y"
+                               {
+        if ((yyvsp[-1].number)) {
+          set_node_background((yyvsp[-2].node));
+        }
+        (yyval.node) = create_binary_node(NODE_SEQUENCE, (yyvsp[-2].node), (yyvsp[0].node));
+      }
+#line 1577 "y.tab.c"
+    break;
 
-    create_command(g_current_command);
-    create_single_command(g_current_single_command);
-  }
-#line 1236 "y.tab.c"
-  break;
+  case 13: /* and_or: and_or AND_IF linebreak pipeline  */
+#line 129 "shell.y"
+                                       {
+        (yyval.node) = create_binary_node(NODE_AND, (yyvsp[-3].node), (yyvsp[0].node));
+      }
+#line 1585 "y.tab.c"
+    break;
 
-  case 6: /* entire_command: NEWLINE  */
-#line 98 "shell.y"
-  {
-    // print prompt again if isatty()?
-    if (isatty(STDIN_FILENO)) {
-      print_prompt();
-    }
-  }
-#line 1247 "y.tab.c"
-  break;
+  case 14: /* and_or: and_or OR_IF linebreak pipeline  */
+#line 132 "shell.y"
+                                      {
+        (yyval.node) = create_binary_node(NODE_OR, (yyvsp[-3].node), (yyvsp[0].node));
+      }
+#line 1593 "y.tab.c"
+    break;
 
-  case 9: /* single_command: executable argument_list  */
-#line 112 "shell.y"
-  {
-    if (strcmp(g_current_single_command->arguments[0], "exit") == 0) {
-      exit(0);
-    }
-    insert_single_command(g_current_command, g_current_single_command);
-    // free_single_command(g_current_single_command);
-    // do not free single_command, g_cur_cmd only
-    // holds a list of ptrs, not the sing_cmds themselves
-    // as far as I understand, the ptrs are stored
-    // inside of command, so I can just malloc
-    // here for the next command
-    g_current_single_command =
-        (single_command_t *)malloc(sizeof(single_command_t));
-
-    if (g_current_single_command == NULL) {
-      perror("malloc");
-      exit(1);
-    }
+  case 15: /* pipeline: single_command_list io_modifier_list  */
+#line 138 "shell.y"
+                                           {
+        // the pipeline is done, hand g_current_command to the tree
+        // and start a new one
+        (yyval.node) = create_command_node(g_current_command);
 
-    create_single_command(g_current_single_command);
-  }
-#line 1272 "y.tab.c"
-  break;
+        g_current_command = new_command();
+      }
+#line 1605 "y.tab.c"
+    break;
 
-  case 12: /* argument: WORD  */
-#line 140 "shell.y"
-  {
-    // insert_argument(g_current_single_command, $1);
+  case 23: /* compound_list: linebreak term  */
+#line 158 "shell.y"
+                     {
+        (yyval.node) = (yyvsp[0].node);
+      }
+#line 1613 "y.tab.c"
+    break;
 
-    if ((strchr((yyvsp[0].string), '?') == NULL) &&
-        (strchr((yyvsp[0].string), '*') == NULL)) {
-      insert_argument(g_current_single_command, (yyvsp[0].string));
-    } else {
-      int og_args = g_current_single_command->num_args;
-      expand_wildcards("", (yyvsp[0].string));
+  case 24: /* compound_list: linebreak term separator  */
+#line 161 "shell.y"
+                               {
+        if ((yyvsp[0].number)) {
+          set_node_background((yyvsp[-1].node));
+        }
+        (yyval.node) = (yyvsp[-1].node);
+      }
+#line 1624 "y.tab.c"
+    break;
 
-      if (og_args == g_current_single_command->num_args) {
-        insert_argument(g_current_single_command, (yyvsp[0].string));
+  case 25: /* term: term separator and_or  */
+#line 170 "shell.y"
+                            {
+        if ((yyvsp[-1].number)) {
+          set_node_background((yyvsp[-2].node));
+        }
+        (yyval.node) = create_binary_node(NODE_SEQUENCE, (yyvsp[-2].node), (yyvsp[0].node));
       }
-    }
-  }
-#line 1292 "y.tab.c"
-  break;
+#line 1635 "y.tab.c"
+    break;
 
-  case 13: /* argument: QUOTED_WORD  */
-#line 155 "shell.y"
-  {
-    insert_argument(g_current_single_command, (yyvsp[0].string));
-  }
-#line 1300 "y.tab.c"
-  break;
+  case 27: /* if_clause: IF compound_list THEN compound_list else_part FI  */
+#line 180 "shell.y"
+                                                       {
+        (yyval.node) = create_node(NODE_IF);
+        (yyval.node)->left = (yyvsp[-4].node);
+        (yyval.node)->right = (yyvsp[-2].node);
+        (yyval.node)->else_part = (yyvsp[-1].node);
+      }
+#line 1646 "y.tab.c"
+    break;
 
-  case 14: /* executable: WORD  */
-#line 161 "shell.y"
-  {
-    // insert_argument(g_current_single_command, $1);
+  case 28: /* if_clause: IF compound_list THEN compound_list FI  */
+#line 186 "shell.y"
+                                             {
+        (yyval.node) = create_node(NODE_IF);
+        (yyval.node)->left = (yyvsp[-3].node);
+        (yyval.node)->right = (yyvsp[-1].node);
+      }
+#line 1656 "y.tab.c"
+    break;
 
-    if ((strchr((yyvsp[0].string), '?') == NULL) &&
-        (strchr((yyvsp[0].string), '*') == NULL)) {
-      insert_argument(g_current_single_command, (yyvsp[0].string));
-    } else {
-      int og_args = g_current_single_command->num_args;
-      expand_wildcards("", (yyvsp[0].string));
+  case 29: /* else_part: ELIF compound_list THEN compound_list  */
+#line 194 "shell.y"
+                                            {
+        (yyval.node) = create_node(NODE_IF);
+        (yyval.node)->left = (yyvsp[-2].node);
+        (yyval.node)->right = (yyvsp[0].node);
+      }
+#line 1666 "y.tab.c"
+    break;
 
-      if (og_args == g_current_single_command->num_args) {
-        insert_argument(g_current_single_command, (yyvsp[0].string));
+  case 30: /* else_part: ELIF compound_list THEN compound_list else_part  */
+#line 199 "shell.y"
+                                                      {
+        (yyval.node) = create_node(NODE_IF);
+        (yyval.node)->left = (yyvsp[-3].node);
+        (yyval.node)->right = (yyvsp[-1].node);
+        (yyval.node)->else_part = (yyvsp[0].node);
       }
-    }
-  }
-#line 1320 "y.tab.c"
-  break;
+#line 1677 "y.tab.c"
+    break;
 
-  case 15: /* executable: QUOTED_WORD  */
-#line 176 "shell.y"
-  {
-    insert_argument(g_current_single_command, (yyvsp[0].string));
-  }
-#line 1328 "y.tab.c"
-  break;
+  case 31: /* else_part: ELSE compound_list  */
+#line 205 "shell.y"
+                         {
+        (yyval.node) = (yyvsp[0].node);
+      }
+#line 1685 "y.tab.c"
+    break;
 
-  case 18: /* io_modifier: STDOUT WORD  */
-#line 187 "shell.y"
-  {
-    if (g_current_command->out_file != NULL) {
-      printf("Ambiguous output redirect.\n");
-      reset_shell();
-    } else {
-      g_current_command->out_file = (yyvsp[0].string);
-    }
-  }
-#line 1342 "y.tab.c"
-  break;
+  case 32: /* while_clause: WHILE compound_list do_group  */
+#line 211 "shell.y"
+                                   {
+        (yyval.node) = create_node(NODE_WHILE);
+        (yyval.node)->left = (yyvsp[-1].node);
+        (yyval.node)->right = (yyvsp[0].node);
+      }
+#line 1695 "y.tab.c"
+    break;
 
-  case 19: /* io_modifier: STDIN WORD  */
-#line 196 "shell.y"
-  {
-    if (g_current_command->in_file != NULL) {
-      printf("Ambiguous input redirect.\n");
-      reset_shell();
-    } else {
-      g_current_command->in_file = (yyvsp[0].string);
-    }
-  }
-#line 1356 "y.tab.c"
-  break;
+  case 33: /* until_clause: UNTIL compound_list do_group  */
+#line 219 "shell.y"
+                                   {
+        (yyval.node) = create_node(NODE_UNTIL);
+        (yyval.node)->left = (yyvsp[-1].node);
+        (yyval.node)->right = (yyvsp[0].node);
+      }
+#line 1705 "y.tab.c"
+    break;
 
-  case 20: /* io_modifier: STDERR WORD  */
-#line 205 "shell.y"
-  {
-    g_current_command->err_file = (yyvsp[0].string);
-  }
-#line 1364 "y.tab.c"
-  break;
+  case 34: /* for_clause: FOR WORD linebreak IN word_list sequential_sep do_group  */
+#line 227 "shell.y"
+                                                              {
+        (yyval.node) = create_node(NODE_FOR);
+        (yyval.node)->var_name = (yyvsp[-5].string);
+        (yyval.node)->words = (yyvsp[-2].words);
+        (yyval.node)->left = (yyvsp[0].node);
+      }
+#line 1716 "y.tab.c"
+    break;
 
-  case 21: /* io_modifier: BOTH WORD  */
-#line 208 "shell.y"
-  {
-    if (g_current_command->out_file != NULL) {
-      printf("Ambiguous output redirect.\n");
-      reset_shell();
-    } else {
-      g_current_command->out_file = (yyvsp[0].string);
-    }
+  case 35: /* for_clause: FOR WORD linebreak IN sequential_sep do_group  */
+#line 233 "shell.y"
+                                                    {
+        (yyval.node) = create_node(NODE_FOR);
+        (yyval.node)->var_name = (yyvsp[-4].string);
+        (yyval.node)->words = new_word_list();
+        (yyval.node)->left = (yyvsp[0].node);
+      }
+#line 1727 "y.tab.c"
+    break;
 
-    g_current_command->err_file = strdup((yyvsp[0].string));
-  }
-#line 1380 "y.tab.c"
-  break;
+  case 36: /* word_list: word_list WORD  */
+#line 242 "shell.y"
+                     {
+        insert_word((yyvsp[-1].words), (yyvsp[0].string), false);
+        (yyval.words) = (yyvsp[-1].words);
+      }
+#line 1736 "y.tab.c"
+    break;
 
-  case 22: /* io_modifier: APPEND WORD  */
-#line 219 "shell.y"
-  {
-    if (g_current_command->out_file != NULL) {
-      printf("Ambiguous output redirect.\n");
-      reset_shell();
-    } else {
-      g_current_command->out_file = (yyvsp[0].string);
-    }
+  case 37: /* word_list: word_list QUOTED_WORD  */
+#line 246 "shell.y"
+                            {
+        insert_word((yyvsp[-1].words), (yyvsp[0].string), true);
+        (yyval.words) = (yyvsp[-1].words);
+      }
+#line 1745 "y.tab.c"
+    break;
 
-    g_current_command->append_out = true;
-  }
-#line 1396 "y.tab.c"
-  break;
+  case 38: /* word_list: WORD  */
+#line 250 "shell.y"
+           {
+        (yyval.words) = new_word_list();
+        insert_word((yyval.words), (yyvsp[0].string), false);
+      }
+#line 1754 "y.tab.c"
+    break;
 
-  case 23: /* io_modifier: APPENDBOTH WORD  */
-#line 230 "shell.y"
-  {
-    if (g_current_command->out_file != NULL) {
-      printf("Ambiguous output redirect.\n");
-      reset_shell();
-    } else {
-      g_current_command->out_file = (yyvsp[0].string);
-    }
+  case 39: /* word_list: QUOTED_WORD  */
+#line 254 "shell.y"
+                  {
+        (yyval.words) = new_word_list();
+        insert_word((yyval.words), (yyvsp[0].string), true);
+      }
+#line 1763 "y.tab.c"
+    break;
 
-    g_current_command->err_file = strdup((yyvsp[0].string));
-    g_current_command->append_out = true;
-    g_current_command->append_err = true;
-  }
-#line 1414 "y.tab.c"
-  break;
+  case 40: /* cond_command: COND_START word_list COND_END  */
+#line 261 "shell.y"
+                                    {
+        (yyval.node) = create_node(NODE_COND);
+        (yyval.node)->words = (yyvsp[-1].words);
+      }
+#line 1772 "y.tab.c"
+    break;
 
-  case 24: /* io_modifier: AMPERSAND  */
-#line 243 "shell.y"
-  {
-    g_current_command->background = true;
-  }
-#line 1422 "y.tab.c"
-  break;
+  case 41: /* do_group: DO compound_list DONE  */
+#line 268 "shell.y"
+                            {
+        (yyval.node) = (yyvsp[-1].node);
+      }
+#line 1780 "y.tab.c"
+    break;
+
+  case 42: /* case_clause: CASE case_word linebreak IN linebreak case_list ESAC  */
+#line 274 "shell.y"
+                                                           {
+        (yyval.node) = create_node(NODE_CASE);
+        (yyval.node)->words = (yyvsp[-5].words);
+        (yyval.node)->left = (yyvsp[-1].node);
+      }
+#line 1790 "y.tab.c"
+    break;
 
-#line 1426 "y.tab.c"
+  case 43: /* case_clause: CASE case_word linebreak IN linebreak case_list_ns ESAC  */
+#line 279 "shell.y"
+                                                              {
+        (yyval.node) = create_node(NODE_CASE);
+        (yyval.node)->words = (yyvsp[-5].words);
+        (yyval.node)->left = (yyvsp[-1].node);
+      }
+#line 1800 "y.tab.c"
+    break;
 
-  default:
+  case 44: /* case_clause: CASE case_word linebreak IN linebreak ESAC  */
+#line 284 "shell.y"
+                                                 {
+        (yyval.node) = create_node(NODE_CASE);
+        (yyval.node)->words = (yyvsp[-4].words);
+      }
+#line 1809 "y.tab.c"
     break;
-  }
+
+  case 45: /* case_word: WORD  */
+#line 291 "shell.y"
+           {
+        (yyval.words) = new_word_list();
+        insert_word((yyval.words), (yyvsp[0].string), false);
+      }
+#line 1818 "y.tab.c"
+    break;
+
+  case 46: /* case_word: QUOTED_WORD  */
+#line 295 "shell.y"
+                  {
+        (yyval.words) = new_word_list();
+        insert_word((yyval.words), (yyvsp[0].string), true);
+      }
+#line 1827 "y.tab.c"
+    break;
+
+  case 47: /* case_list_ns: case_list case_item_ns  */
+#line 302 "shell.y"
+                             {
+        // items are chained through right, keep them in order
+        node_t * item = (yyvsp[-1].node);
+        while (item->right != NULL) {
+          item = item->right;
+        }
+        item->right = (yyvsp[0].node);
+        (yyval.node) = (yyvsp[-1].node);
+      }
+#line 1841 "y.tab.c"
+    break;
+
+  case 49: /* case_list: case_list case_item  */
+#line 315 "shell.y"
+                          {
+        node_t * item = (yyvsp[-1].node);
+        while (item->right != NULL) {
+          item = item->right;
+        }
+        item->right = (yyvsp[0].node);
+        (yyval.node) = (yyvsp[-1].node);
+      }
+#line 1854 "y.tab.c"
+    break;
+
+  case 51: /* case_item_ns: pattern RPAREN linebreak  */
+#line 327 "shell.y"
+                               {
+        (yyval.node) = create_node(NODE_CASE_ITEM);
+        (yyval.node)->words = (yyvsp[-2].words);
+      }
+#line 1863 "y.tab.c"
+    break;
+
+  case 52: /* case_item_ns: pattern RPAREN compound_list  */
+#line 331 "shell.y"
+                                   {
+        (yyval.node) = create_node(NODE_CASE_ITEM);
+        (yyval.node)->words = (yyvsp[-2].words);
+        (yyval.node)->left = (yyvsp[0].node);
+      }
+#line 1873 "y.tab.c"
+    break;
+
+  case 53: /* case_item: pattern RPAREN linebreak DSEMI linebreak  */
+#line 339 "shell.y"
+                                               {
+        (yyval.node) = create_node(NODE_CASE_ITEM);
+        (yyval.node)->words = (yyvsp[-4].words);
+      }
+#line 1882 "y.tab.c"
+    break;
+
+  case 54: /* case_item: pattern RPAREN compound_list DSEMI linebreak  */
+#line 343 "shell.y"
+                                                   {
+        (yyval.node) = create_node(NODE_CASE_ITEM);
+        (yyval.node)->words = (yyvsp[-4].words);
+        (yyval.node)->left = (yyvsp[-2].node);
+      }
+#line 1892 "y.tab.c"
+    break;
+
+  case 56: /* pattern: pattern PIPE WORD  */
+#line 352 "shell.y"
+                        {
+        insert_word((yyvsp[-2].words), (yyvsp[0].string), false);
+        (yyval.words) = (yyvsp[-2].words);
+      }
+#line 1901 "y.tab.c"
+    break;
+
+  case 57: /* pattern: pattern PIPE QUOTED_WORD  */
+#line 356 "shell.y"
+                               {
+        insert_word((yyvsp[-2].words), (yyvsp[0].string), true);
+        (yyval.words) = (yyvsp[-2].words);
+      }
+#line 1910 "y.tab.c"
+    break;
+
+  case 58: /* separator_op: AMPERSAND  */
+#line 363 "shell.y"
+                {
+        (yyval.number) = 1;
+      }
+#line 1918 "y.tab.c"
+    break;
+
+  case 59: /* separator_op: SEMI  */
+#line 366 "shell.y"
+           {
+        (yyval.number) = 0;
+      }
+#line 1926 "y.tab.c"
+    break;
+
+  case 60: /* separator: separator_op linebreak  */
+#line 372 "shell.y"
+                             {
+        (yyval.number) = (yyvsp[-1].number);
+      }
+#line 1934 "y.tab.c"
+    break;
+
+  case 61: /* separator: newline_list  */
+#line 375 "shell.y"
+                   {
+        (yyval.number) = 0;
+      }
+#line 1942 "y.tab.c"
+    break;
+
+  case 70: /* single_command: executable argument_list  */
+#line 401 "shell.y"
+                               {
+        insert_single_command(g_current_command, g_current_single_command);
+        // free_single_command(g_current_single_command);
+        // do not free single_command, g_cur_cmd only
+        // holds a list of ptrs, not the sing_cmds themselves
+        // as far as I understand, the ptrs are stored
+        // inside of command, so a pooled one can be taken
+        // here for the next command
+        g_current_single_command = new_single_command();
+      }
+#line 1957 "y.tab.c"
+    break;
+
+  case 73: /* argument: WORD  */
+#line 419 "shell.y"
+           {
+        // words are expanded and wildcarded when the command runs
+        insert_word(g_current_single_command, (yyvsp[0].string), false);
+      }
+#line 1966 "y.tab.c"
+    break;
+
+  case 74: /* argument: QUOTED_WORD  */
+#line 423 "shell.y"
+                  {
+        insert_word(g_current_single_command, (yyvsp[0].string), true);
+      }
+#line 1974 "y.tab.c"
+    break;
+
+  case 75: /* executable: WORD  */
+#line 429 "shell.y"
+           {
+        insert_word(g_current_single_command, (yyvsp[0].string), false);
+      }
+#line 1982 "y.tab.c"
+    break;
+
+  case 76: /* executable: QUOTED_WORD  */
+#line 432 "shell.y"
+                  {
+        insert_word(g_current_single_command, (yyvsp[0].string), true);
+      }
+#line 1990 "y.tab.c"
+    break;
+
+  case 79: /* io_modifier: STDOUT WORD  */
+#line 443 "shell.y"
+                  {
+        if (g_current_command->out_file != NULL) {
+          printf("Ambiguous output redirect.\n");
+          reset_shell();
+        }
+        else {
+          g_current_command->out_file = (yyvsp[0].string);
+        }
+      }
+#line 2004 "y.tab.c"
+    break;
+
+  case 80: /* io_modifier: STDIN WORD  */
+#line 452 "shell.y"
+                 {
+        if (g_current_command->in_file != NULL) { 
+           printf("Ambiguous input redirect.\n");
+           reset_shell();
+        }
+        else {
+           g_current_command->in_file = (yyvsp[0].string);
+        }
+      }
+#line 2018 "y.tab.c"
+    break;
+
+  case 81: /* io_modifier: STDERR WORD  */
+#line 461 "shell.y"
+                  {
+        g_current_command->err_file = (yyvsp[0].string);
+      }
+#line 2026 "y.tab.c"
+    break;
+
+  case 82: /* io_modifier: BOTH WORD  */
+#line 464 "shell.y"
+                {
+        if (g_current_command->out_file != NULL) {
+          printf("Ambiguous output redirect.\n");
+          reset_shell();
+        }
+        else {
+          g_current_command->out_file = (yyvsp[0].string);
+        }
+
+        g_current_command->err_file = (yyvsp[0].string);
+      }
+#line 2042 "y.tab.c"
+    break;
+
+  case 83: /* io_modifier: APPEND WORD  */
+#line 475 "shell.y"
+                  {
+        if (g_current_command->out_file != NULL) {
+          printf("Ambiguous output redirect.\n");
+          reset_shell();
+        }
+        else {
+          g_current_command->out_file = (yyvsp[0].string);
+        }
+
+        g_current_command->append_out = true;
+      }
+#line 2058 "y.tab.c"
+    break;
+
+  case 84: /* io_modifier: APPENDBOTH WORD  */
+#line 486 "shell.y"
+                      {
+        if (g_current_command->out_file != NULL) {
+          printf("Ambiguous output redirect.\n");
+          reset_shell();
+        }
+        else {
+          g_current_command->out_file = (yyvsp[0].string);
+        }
+
+        g_current_command->err_file = (yyvsp[0].string);
+        g_current_command->append_out = true;
+        g_current_command->append_err = true;
+      }
+#line 2076 "y.tab.c"
+    break;
+
+
+#line 2080 "y.tab.c"
+
+      default: break;
+    }
   /* User semantic actions sometimes alter yychar, and that requires
      that yytoken be updated with the new translation.  We take the
      approach of translating immediately before every use of yytoken.
@@ -1314,10 +2091,9 @@ yyreduce:
      case of YYERROR or YYBACKUP, subsequent parser actions might lead
      to an incorrect destructor call or verbose syntax error message
      before the lookahead is translated.  */
-  YY_SYMBOL_PRINT("-> $$ =", YY_CAST(yysymbol_kind_t, yyr1[yyn]), &yyval,
-                  &yyloc);
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
 
-  YYPOPSTACK(yylen);
+  YYPOPSTACK (yylen);
   yylen = 0;
 
   *++yyvsp = yyval;
@@ -1329,43 +2105,51 @@ yyreduce:
     const int yylhs = yyr1[yyn] - YYNTOKENS;
     const int yyi = yypgoto[yylhs] + *yyssp;
     yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
-                   ? yytable[yyi]
-                   : yydefgoto[yylhs]);
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
   }
 
   goto yynewstate;
 
+
 /*--------------------------------------.
 | yyerrlab -- here on detecting error.  |
 `--------------------------------------*/
 yyerrlab:
   /* Make sure we have latest lookahead translation.  See comments at
      user semantic actions for why this is necessary.  */
-  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE(yychar);
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
   /* If not already recovering from an error, report this error.  */
-  if (!yyerrstatus) {
-    ++yynerrs;
-    yyerror(YY_("syntax error"));
-  }
-
-  if (yyerrstatus == 3) {
-    /* If just tried and failed to reuse lookahead token after an
-       error, discard it.  */
+  if (!yyerrstatus)
+    {
+      ++yynerrs;
+      yyerror (YY_("syntax error"));
+    }
 
-    if (yychar <= YYEOF) {
-      /* Return failure if at end of input.  */
-      if (yychar == YYEOF)
-        YYABORT;
-    } else {
-      yydestruct("Error: discarding", yytoken, &yylval);
-      yychar = YYEMPTY;
+  if (yyerrstatus == 3)
+    {
+      /* If just tried and failed to reuse lookahead token after an
+         error, discard it.  */
+
+      if (yychar <= YYEOF)
+        {
+          /* Return failure if at end of input.  */
+          if (yychar == YYEOF)
+            YYABORT;
+        }
+      else
+        {
+          yydestruct ("Error: discarding",
+                      yytoken, &yylval);
+          yychar = YYEMPTY;
+        }
     }
-  }
 
   /* Else will try to reuse lookahead token after shifting the error
      token.  */
   goto yyerrlab1;
 
+
 /*---------------------------------------------------.
 | yyerrorlab -- error raised explicitly by YYERROR.  |
 `---------------------------------------------------*/
@@ -1378,50 +2162,58 @@ yyerrorlab:
 
   /* Do not reclaim the symbols of the rule whose action triggered
      this YYERROR.  */
-  YYPOPSTACK(yylen);
+  YYPOPSTACK (yylen);
   yylen = 0;
-  YY_STACK_PRINT(yyss, yyssp);
+  YY_STACK_PRINT (yyss, yyssp);
   yystate = *yyssp;
   goto yyerrlab1;
 
+
 /*-------------------------------------------------------------.
 | yyerrlab1 -- common code for both syntax error and YYERROR.  |
 `-------------------------------------------------------------*/
 yyerrlab1:
-  yyerrstatus = 3; /* Each real token shifted decrements this.  */
+  yyerrstatus = 3;      /* Each real token shifted decrements this.  */
 
   /* Pop stack until we find a state that shifts the error token.  */
-  for (;;) {
-    yyn = yypact[yystate];
-    if (!yypact_value_is_default(yyn)) {
-      yyn += YYSYMBOL_YYerror;
-      if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror) {
-        yyn = yytable[yyn];
-        if (0 < yyn)
-          break;
-      }
-    }
+  for (;;)
+    {
+      yyn = yypact[yystate];
+      if (!yypact_value_is_default (yyn))
+        {
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
+            {
+              yyn = yytable[yyn];
+              if (0 < yyn)
+                break;
+            }
+        }
+
+      /* Pop the current state because it cannot handle the error token.  */
+      if (yyssp == yyss)
+        YYABORT;
 
-    /* Pop the current state because it cannot handle the error token.  */
-    if (yyssp == yyss)
-      YYABORT;
 
-    yydestruct("Error: popping", YY_ACCESSING_SYMBOL(yystate), yyvsp);
-    YYPOPSTACK(1);
-    yystate = *yyssp;
-    YY_STACK_PRINT(yyss, yyssp);
-  }
+      yydestruct ("Error: popping",
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp);
+      YYPOPSTACK (1);
+      yystate = *yyssp;
+      YY_STACK_PRINT (yyss, yyssp);
+    }
 
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
   *++yyvsp = yylval;
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 
+
   /* Shift the error token.  */
-  YY_SYMBOL_PRINT("Shifting", YY_ACCESSING_SYMBOL(yyn), yyvsp, yylsp);
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
 
   yystate = yyn;
   goto yynewstate;
 
+
 /*-------------------------------------.
 | yyacceptlab -- YYACCEPT comes here.  |
 `-------------------------------------*/
@@ -1429,6 +2221,7 @@ yyacceptlab:
   yyresult = 0;
   goto yyreturnlab;
 
+
 /*-----------------------------------.
 | yyabortlab -- YYABORT comes here.  |
 `-----------------------------------*/
@@ -1436,43 +2229,54 @@ yyabortlab:
   yyresult = 1;
   goto yyreturnlab;
 
+
 /*-----------------------------------------------------------.
 | yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
 `-----------------------------------------------------------*/
 yyexhaustedlab:
-  yyerror(YY_("memory exhausted"));
+  yyerror (YY_("memory exhausted"));
   yyresult = 2;
   goto yyreturnlab;
 
+
 /*----------------------------------------------------------.
 | yyreturnlab -- parsing is finished, clean up and return.  |
 `----------------------------------------------------------*/
 yyreturnlab:
-  if (yychar != YYEMPTY) {
-    /* Make sure we have latest lookahead translation.  See comments at
-       user semantic actions for why this is necessary.  */
-    yytoken = YYTRANSLATE(yychar);
-    yydestruct("Cleanup: discarding lookahead", yytoken, &yylval);
-  }
+  if (yychar != YYEMPTY)
+    {
+      /* Make sure we have latest lookahead translation.  See comments at
+         user semantic actions for why this is necessary.  */
+      yytoken = YYTRANSLATE (yychar);
+      yydestruct ("Cleanup: discarding lookahead",
+                  yytoken, &yylval);
+    }
   /* Do not reclaim the symbols of the rule whose action triggered
      this YYABORT or YYACCEPT.  */
-  YYPOPSTACK(yylen);
-  YY_STACK_PRINT(yyss, yyssp);
-  while (yyssp != yyss) {
-    yydestruct("Cleanup: popping", YY_ACCESSING_SYMBOL(+*yyssp), yyvsp);
-    YYPOPSTACK(1);
-  }
+  YYPOPSTACK (yylen);
+  YY_STACK_PRINT (yyss, yyssp);
+  while (yyssp != yyss)
+    {
+      yydestruct ("Cleanup: popping",
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp);
+      YYPOPSTACK (1);
+    }
 #ifndef yyoverflow
   if (yyss != yyssa)
-    YYSTACK_FREE(yyss);
+    YYSTACK_FREE (yyss);
 #endif
 
   return yyresult;
 }
 
-#line 249 "shell.y"
+#line 502 "shell.y"
 
-void yyerror(const char *s) { fprintf(stderr, "%s", s); }
+
+void
+yyerror(const char * s)
+{
+  fprintf(stderr,"%s\n", s);
+}
 
 #if 0
 main()
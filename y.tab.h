@@ -36,41 +36,64 @@
    private implementation details that can be changed or removed.  */
 
 #ifndef YY_YY_Y_TAB_H_INCLUDED
-#define YY_YY_Y_TAB_H_INCLUDED
+# define YY_YY_Y_TAB_H_INCLUDED
 /* Debug traces.  */
 #ifndef YYDEBUG
-#define YYDEBUG 1
+# define YYDEBUG 1
 #endif
 #if YYDEBUG
 extern int yydebug;
 #endif
 /* "%code requires" blocks.  */
-#line 15 "shell.y"
+#line 7 "shell.y"
+
+
 
 #line 53 "y.tab.h"
 
 /* Token kinds.  */
 #ifndef YYTOKENTYPE
-#define YYTOKENTYPE
-enum yytokentype {
-  YYEMPTY = -2,
-  YYEOF = 0,         /* "end of file"  */
-  YYerror = 256,     /* error  */
-  YYUNDEF = 257,     /* "invalid token"  */
-  WORD = 258,        /* WORD  */
-  PIPE = 259,        /* PIPE  */
-  QUOTED_WORD = 260, /* QUOTED_WORD  */
-  NOTOKEN = 261,     /* NOTOKEN  */
-  NEWLINE = 262,     /* NEWLINE  */
-  STDOUT = 263,      /* STDOUT  */
-  STDIN = 264,       /* STDIN  */
-  STDERR = 265,      /* STDERR  */
-  BOTH = 266,        /* BOTH  */
-  APPEND = 267,      /* APPEND  */
-  APPENDBOTH = 268,  /* APPENDBOTH  */
-  AMPERSAND = 269    /* AMPERSAND  */
-};
-typedef enum yytokentype yytoken_kind_t;
+# define YYTOKENTYPE
+  enum yytokentype
+  {
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    WORD = 258,                    /* WORD  */
+    QUOTED_WORD = 259,             /* QUOTED_WORD  */
+    PIPE = 260,                    /* PIPE  */
+    NOTOKEN = 261,                 /* NOTOKEN  */
+    NEWLINE = 262,                 /* NEWLINE  */
+    STDOUT = 263,                  /* STDOUT  */
+    STDIN = 264,                   /* STDIN  */
+    STDERR = 265,                  /* STDERR  */
+    BOTH = 266,                    /* BOTH  */
+    APPEND = 267,                  /* APPEND  */
+    APPENDBOTH = 268,              /* APPENDBOTH  */
+    AMPERSAND = 269,               /* AMPERSAND  */
+    SEMI = 270,                    /* SEMI  */
+    DSEMI = 271,                   /* DSEMI  */
+    AND_IF = 272,                  /* AND_IF  */
+    OR_IF = 273,                   /* OR_IF  */
+    RPAREN = 274,                  /* RPAREN  */
+    IF = 275,                      /* IF  */
+    THEN = 276,                    /* THEN  */
+    ELSE = 277,                    /* ELSE  */
+    ELIF = 278,                    /* ELIF  */
+    FI = 279,                      /* FI  */
+    WHILE = 280,                   /* WHILE  */
+    UNTIL = 281,                   /* UNTIL  */
+    DO = 282,                      /* DO  */
+    DONE = 283,                    /* DONE  */
+    FOR = 284,                     /* FOR  */
+    IN = 285,                      /* IN  */
+    CASE = 286,                    /* CASE  */
+    ESAC = 287,                    /* ESAC  */
+    COND_START = 288,              /* COND_START  */
+    COND_END = 289                 /* COND_END  */
+  };
+  typedef enum yytokentype yytoken_kind_t;
 #endif
 /* Token kinds.  */
 #define YYEMPTY -2
@@ -78,8 +101,8 @@ typedef enum yytokentype yytoken_kind_t;
 #define YYerror 256
 #define YYUNDEF 257
 #define WORD 258
-#define PIPE 259
-#define QUOTED_WORD 260
+#define QUOTED_WORD 259
+#define PIPE 260
 #define NOTOKEN 261
 #define NEWLINE 262
 #define STDOUT 263
@@ -89,23 +112,51 @@ typedef enum yytokentype yytoken_kind_t;
 #define APPEND 267
 #define APPENDBOTH 268
 #define AMPERSAND 269
+#define SEMI 270
+#define DSEMI 271
+#define AND_IF 272
+#define OR_IF 273
+#define RPAREN 274
+#define IF 275
+#define THEN 276
+#define ELSE 277
+#define ELIF 278
+#define FI 279
+#define WHILE 280
+#define UNTIL 281
+#define DO 282
+#define DONE 283
+#define FOR 284
+#define IN 285
+#define CASE 286
+#define ESAC 287
+#define COND_START 288
+#define COND_END 289
 
 /* Value type.  */
-#if !defined YYSTYPE && !defined YYSTYPE_IS_DECLARED
-union YYSTYPE {
-#line 20 "shell.y"
+#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
+union YYSTYPE
+{
+#line 12 "shell.y"
+
+  char * string;
+  int number;
+  struct node * node;
+  struct single_command * words;
 
-  char *string;
+#line 148 "y.tab.h"
 
-#line 105 "y.tab.h"
 };
 typedef union YYSTYPE YYSTYPE;
-#define YYSTYPE_IS_TRIVIAL 1
-#define YYSTYPE_IS_DECLARED 1
+# define YYSTYPE_IS_TRIVIAL 1
+# define YYSTYPE_IS_DECLARED 1
 #endif
 
+
 extern YYSTYPE yylval;
 
-int yyparse(void);
+
+int yyparse (void);
+
 
 #endif /* !YY_YY_Y_TAB_H_INCLUDED  */